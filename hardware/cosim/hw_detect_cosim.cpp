@@ -0,0 +1,592 @@
+/**
+*
+* @file hw_detect_cosim.cpp
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements a Verilator co-simulation of hw_detect.v against the detection math
+* of the firmware.  hw_detect.v is compiled to C++ by Verilator and clocked from here with
+* PWM waveforms that are made up a cycle at a time.  A golden model watches the same pwm
+* stream: it keeps the length of every complete period and, whenever hw_detect latches a
+* new pair, works out what the pair must be (the sum of (interval - 1) of the last 2^k
+* periods, saturated at COUNT_MAX) and what frequency and duty cycle the waveform really
+* has.  The latched counts are then run through the real calc_freq()/calc_duty() of
+* testpwm.c and MEAS_FreqMilliHz()/MEAS_DutyHundredths() of meas.c, and every result is
+* compared with the golden one (all four round to the nearest unit, so they must match
+* exactly).  It has two modes:
+*
+*	o	sweep (default) - every accumulation exponent k (0..15) with period lengths from 2
+*		clocks up to a window of 2^k periods of -w clocks, a few per octave, each with the
+*		shortest, a 50% and the longest high interval.  Then the single-count and the
+*		window sums are driven into saturation.
+*	o	random (-r segments) - segments of random k, period length and duty cycle with
+*		random jitter of each interval (so consecutive periods differ) and a k change at a
+*		random clock of the first period of the segment.
+*
+* The statistics unit is left out of the model (-GSTATS_ENABLE=0) and the gate is short
+* (-GGATE_HZ): neither is checked here, and without the statistics unit the model is a few
+* hundred lines of C++ that runs at tens of millions of clocks per second.
+*
+* cosim/run_cosim.sh does the build below in a directory of its own and runs the sweep and
+* random segments.  Build by hand (from hardware/, Verilator 4.200 or later):
+*	gcc -O2 -Wall -I../software/hostsim -I../software/hostsim/include -I../software/testpwm \
+*		-Dmain=testpwm_main -c ../software/testpwm/[a-z]*.c ../software/hostsim/hostsim.c \
+*		../software/hostsim/hostsim_[a-l]*.c ../software/hostsim/hostsim_[n-z]*.c
+*	ar rcs libtestpwm_host.a *.o && rm *.o
+*	verilator --cc --exe --build -j 0 -O3 --x-assign fast --x-initial fast --noassert \
+*		-Wno-fatal -GSTATS_ENABLE=0 -GGATE_HZ=100000 --top-module hw_detect \
+*		-CFLAGS "-O2 -I$PWD/../software/hostsim/include -iquote $PWD/../software/testpwm" \
+*		-LDFLAGS "$PWD/libtestpwm_host.a -lm -lrt" -o hw_detect_cosim \
+*		hw_detect.v hw_stats.v cosim/hw_detect_cosim.cpp
+*
+* The first two commands build testpwm and the host simulation drivers (see hostsim_main.c)
+* without hostsim_main.c, so testpwm.c's calc_freq() and calc_duty() link as they are.  The
+* program ends up in obj_dir/.  testpwm/ is included with -iquote: with -I its sched.h
+* would hide the <sched.h> that the C++ thread headers include.
+*
+* Usage: obj_dir/hw_detect_cosim [-r segments] [-s seed] [-w log2_window] [-p points_per_octave] [-v]
+*
+* Exit status is 1 if any check failed.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of the co-simulation harness
+* 1.01a	ri	10/16/26	-iquote for testpwm/ in the build, run_cosim.sh
+* </pre>
+*
+******************************************************************************/
+
+/***************************** Include Files *********************************/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <unistd.h>
+
+#include "verilated.h"
+#include "Vhw_detect.h"
+
+#include "xil_types.h"
+#include "meas.h"
+#include "testpwm.h"
+
+/************************** Constant Definitions *****************************/
+#define CLK_FREQ_HZ				100000000U		// hw_detect clock (CPU_CLOCK_FREQ_HZ of testpwm)
+#define COUNT_MAX				0xFFFFFFU		// hw_detect counts saturate here
+#define MAX_K					15
+#define HIST_PERIODS			(1U << MAX_K)	// periods the golden model remembers
+
+#define DEFAULT_LOG2_WINDOW		20				// sweep windows up to 2^20 clocks (testpwm's choice of k)
+#define DEFAULT_PER_OCTAVE		2
+#define WINDOWS_PER_POINT		2				// latched pairs checked at each sweep point
+#define MAX_REPORTS				20				// failures printed in full
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	u32		high;						// high interval (clocks)
+	u32		low;						// low interval (clocks)
+} period_t;
+
+/**
+* Clocks hw_detect with a PWM waveform and checks every pair it latches.
+*/
+class Cosim
+{
+public:
+	explicit Cosim(VerilatedContext *ContextPtr);
+	~Cosim();
+
+	void	reset(void);
+	void	set_k(u32 k) { top->accum_k = k; }
+	void	set_k_at(u32 k, u32 clocks) { pending_k = k; k_countdown = clocks; }
+	void	period(u32 high, u32 low);
+	void	wait_windows(u32 high, u32 low, u32 windows);
+
+	u64		cycles;						// clocks simulated
+	u64		pairs;						// latched pairs checked
+	u64		saturated;					// ... of which had a saturated count
+	u64		failures;					// failed checks
+	bool	verbose;
+
+private:
+	void	tick(bool level);
+	void	check(void);
+	void	fail(const char *what, u64 got, u64 want);
+
+	std::unique_ptr<Vhw_detect>	top;
+
+	u32		last_seq;					// sequence number of the last latched pair
+	u32		latched;					// pairs latched since the last wait_windows()
+	u32		pending_k;					// k to apply after k_countdown more clocks
+	u32		k_countdown;				// 0 = none pending
+
+	// golden model: the pwm stream as hw_detect sees it
+
+	bool		level;					// pwm level of the last clock
+	bool		started;				// a transition has been seen since reset
+	bool		high_ok;				// high_len is a complete high interval
+	u32			run_len;				// clocks at the current level
+	u32			high_len;				// high interval of the current period
+	period_t	hist[HIST_PERIODS];		// last complete periods (ring)
+	u32			hist_next;
+	u64			hist_count;
+};
+
+/************************** Function Prototypes ******************************/
+static void		usage(void);
+static u64		div_round(unsigned __int128 num, u64 den);
+static void		sweep(Cosim &sim, u32 log2_window, u32 per_octave);
+static void		random_segments(Cosim &sim, std::mt19937_64 &rng, u32 segments, u32 log2_window);
+
+/************************** Variable Definitions *****************************/
+
+
+/****************************************************************************/
+/**
+* Verilator calls this for $time when the model is not given a context
+*
+******************************************************************************/
+double sc_time_stamp()
+{
+	return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	u32				segments = 0;
+	u64				seed = 1;
+	u32				log2_window = DEFAULT_LOG2_WINDOW;
+	u32				per_octave = DEFAULT_PER_OCTAVE;
+	bool			verbose = false;
+	int				opt;
+
+	while ((opt = getopt(argc, argv, "r:s:w:p:v")) != -1)
+	{
+		switch (opt)
+		{
+			case 'r':	segments = strtoul(optarg, NULL, 0);			break;
+			case 's':	seed = strtoull(optarg, NULL, 0);				break;
+			case 'w':	log2_window = strtoul(optarg, NULL, 0);			break;
+			case 'p':	per_octave = strtoul(optarg, NULL, 0);			break;
+			case 'v':	verbose = true;									break;
+			default:	usage();										return 2;
+		}
+	}
+	if ((log2_window < 1) || (log2_window > 24) || (per_octave < 1))
+	{
+		usage();
+		return 2;
+	}
+
+	std::unique_ptr<VerilatedContext> context(new VerilatedContext);
+	context->commandArgs(argc, argv);
+
+	Cosim			sim(context.get());
+	sim.verbose = verbose;
+
+	auto start = std::chrono::steady_clock::now();
+
+	sim.reset();
+	if (segments == 0)
+	{
+		sweep(sim, log2_window, per_octave);
+	}
+	else
+	{
+		std::mt19937_64 rng(seed);
+		random_segments(sim, rng, segments, log2_window);
+	}
+
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("%llu clocks, %llu pairs checked (%llu saturated), %llu failures\n",
+		(unsigned long long) sim.cycles, (unsigned long long) sim.pairs,
+		(unsigned long long) sim.saturated, (unsigned long long) sim.failures);
+	printf("%.2f s, %.1f Mclocks/s\n", secs, (secs > 0) ? (sim.cycles / secs / 1e6) : 0.0);
+
+	return (sim.failures != 0) ? 1 : 0;
+}
+
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: hw_detect_cosim [-r segments] [-s seed] [-w log2_window] [-p points_per_octave] [-v]\n");
+	fprintf(stderr, "       default is the sweep; -r runs random segments instead\n");
+}
+
+
+/****************************************************************************/
+/**
+* Rounds num / den to the nearest integer (halves up), as the firmware does
+*
+******************************************************************************/
+static u64 div_round(unsigned __int128 num, u64 den)
+{
+	return (u64) (((num * 2) + den) / ((unsigned __int128) den * 2));
+}
+
+
+/****************************************************************************/
+/**
+* The sweep: every k, period lengths from 2 clocks up to a window of 2^log2_window
+* clocks, shortest/50%/longest high interval, then the saturation corners
+*
+******************************************************************************/
+static void sweep(Cosim &sim, u32 log2_window, u32 per_octave)
+{
+	for (u32 k = 0; k <= MAX_K; k++)
+	{
+		u32		last = 0;
+
+		sim.set_k(k);
+		for (u32 i = 0; ; i++)
+		{
+			// 2 * 2^(i / per_octave), rounded to a whole clock
+
+			u32 len = (u32) ((2.0 * std::pow(2.0, (double) i / per_octave)) + 0.5);
+
+			if (((u64) len << k) > (1ULL << log2_window))
+			{
+				break;
+			}
+			if (len == last)
+			{
+				continue;
+			}
+			last = len;
+
+			u32 highs[3] = { 1, len / 2, len - 1 };
+
+			for (u32 d = 0; d < 3; d++)
+			{
+				if ((d > 0) && (highs[d] == highs[d - 1]))
+				{
+					continue;
+				}
+				sim.wait_windows(highs[d], len - highs[d], WINDOWS_PER_POINT);
+			}
+		}
+		if (sim.verbose)
+		{
+			printf("k = %2u: %llu clocks so far\n", k, (unsigned long long) sim.cycles);
+		}
+	}
+
+	// a single count that saturates, then window sums that saturate
+
+	sim.set_k(0);
+	sim.wait_windows(COUNT_MAX + 3, 2, WINDOWS_PER_POINT);
+	sim.set_k(1);
+	sim.wait_windows((COUNT_MAX / 2) + 9, 3, WINDOWS_PER_POINT);
+	sim.wait_windows(3, (COUNT_MAX / 2) + 9, WINDOWS_PER_POINT);
+}
+
+
+/****************************************************************************/
+/**
+* Random segments: random k, period, duty cycle and jitter, k changed in the middle of
+* the first period
+*
+******************************************************************************/
+static void random_segments(Cosim &sim, std::mt19937_64 &rng, u32 segments, u32 log2_window)
+{
+	for (u32 s = 0; s < segments; s++)
+	{
+		u32		k = rng() % (MAX_K + 1);
+		u32		max_len = (u32) ((1ULL << log2_window) >> k);
+		u32		len, high, jitter, periods;
+
+		if (max_len < 2)
+		{
+			k = log2_window - 1;
+			max_len = 2;
+		}
+
+		// log-uniform period length, uniform duty cycle, jitter up to 1/8 of the interval
+
+		len = (u32) std::exp2(1.0 + (std::uniform_real_distribution<double>(0.0, 1.0)(rng) *
+			std::log2(max_len / 2.0)));
+		len = std::max(2U, std::min(len, max_len));
+		high = 1 + (rng() % (len - 1));
+		jitter = (u32) (rng() % ((len / 8) + 1));
+
+		periods = (2U << k) + 1 + (rng() % ((1U << k) + 1));
+		for (u32 p = 0; p < periods; p++)
+		{
+			u32 h = high, l = len - high;
+
+			if (jitter != 0)
+			{
+				h = std::max(1, (int) h + (int) (rng() % (2 * jitter + 1)) - (int) jitter);
+				l = std::max(1, (int) l + (int) (rng() % (2 * jitter + 1)) - (int) jitter);
+			}
+			if (p == 0)
+			{
+				sim.set_k_at(k, 1 + (rng() % (h + l)));
+			}
+			sim.period(h, l);
+		}
+	}
+}
+
+
+/************************** Cosim *******************************************/
+
+Cosim::Cosim(VerilatedContext *ContextPtr) :
+	cycles(0), pairs(0), saturated(0), failures(0), verbose(false),
+	top(new Vhw_detect(ContextPtr)),
+	last_seq(0), latched(0), pending_k(0), k_countdown(0),
+	level(false), started(false), high_ok(false), run_len(0), high_len(0),
+	hist_next(0), hist_count(0)
+{
+	top->clock = 0;
+	top->reset = 0;
+	top->pwm = 0;
+	top->accum_k = 0;
+	top->gate_sel = 0;
+	top->stats_cmd = 0;
+	top->eval();
+}
+
+
+Cosim::~Cosim()
+{
+	top->final();
+}
+
+
+/****************************************************************************/
+/**
+* Resets hw_detect with pwm low and starts the golden model over
+*
+******************************************************************************/
+void Cosim::reset(void)
+{
+	top->pwm = 0;
+	top->reset = 1;
+	for (int i = 0; i < 4; i++)
+	{
+		top->clock = 1;
+		top->eval();
+		top->clock = 0;
+		top->eval();
+	}
+	top->reset = 0;
+
+	level = false;
+	started = false;
+	high_ok = false;
+	run_len = 0;
+	last_seq = 0;
+	hist_next = 0;
+	hist_count = 0;
+}
+
+
+/****************************************************************************/
+/**
+* One clock with pwm at "level"
+*
+* The golden model follows the pwm stream the way hw_detect sees it: a period is complete
+* at the rising edge after a complete high interval (one that started at a transition)
+* and a low interval.
+*
+******************************************************************************/
+void Cosim::tick(bool lvl)
+{
+	if (lvl != level)
+	{
+		if (lvl)
+		{
+			if (high_ok)
+			{
+				hist[hist_next].high = high_len;
+				hist[hist_next].low = run_len;
+				hist_next = (hist_next + 1) % HIST_PERIODS;
+				hist_count++;
+			}
+		}
+		else
+		{
+			high_len = run_len;
+			high_ok = started;
+		}
+		started = true;
+		level = lvl;
+		run_len = 0;
+	}
+	run_len++;
+
+	if (k_countdown != 0)
+	{
+		if (--k_countdown == 0)
+		{
+			top->accum_k = pending_k;
+		}
+	}
+
+	top->pwm = lvl;
+	top->clock = 1;
+	top->eval();
+	cycles++;
+
+	if ((top->high_count >> 28) != last_seq)
+	{
+		last_seq = top->high_count >> 28;
+		latched++;
+		check();
+	}
+
+	top->clock = 0;
+	top->eval();
+}
+
+
+/****************************************************************************/
+/**
+* One PWM period: "high" clocks high, then "low" clocks low
+*
+******************************************************************************/
+void Cosim::period(u32 high, u32 low)
+{
+	for (u32 i = 0; i < high; i++)
+	{
+		tick(true);
+	}
+	for (u32 i = 0; i < low; i++)
+	{
+		tick(false);
+	}
+}
+
+
+/****************************************************************************/
+/**
+* Repeats a period until hw_detect has latched "windows" more pairs
+*
+******************************************************************************/
+void Cosim::wait_windows(u32 high, u32 low, u32 windows)
+{
+	latched = 0;
+	while (latched < windows)
+	{
+		period(high, low);
+	}
+}
+
+
+/****************************************************************************/
+/**
+* Checks the pair hw_detect just latched against the golden model
+*
+* The pair must hold the sums of (interval - 1) of the last 2^k complete periods.  If
+* neither saturated, the frequency and duty cycle of the firmware must round the real
+* ones (worked out from the period lengths) to the nearest unit.
+*
+******************************************************************************/
+void Cosim::check(void)
+{
+	u32		hc = top->high_count;
+	u32		lc = top->low_count;
+	u32		k = (hc >> 24) & 0x0F;
+	u32		n = 1U << k;
+	u32		high = hc & COUNT_MAX;
+	u32		low = lc & COUNT_MAX;
+	u64		want_high = 0, want_low = 0, clocks = 0, high_clocks = 0;
+
+	pairs++;
+
+	if ((lc >> 28) != (hc >> 28))
+	{
+		fail("sequence numbers differ", lc >> 28, hc >> 28);
+		return;
+	}
+	if (k != top->accum_k)
+	{
+		fail("latched k", k, top->accum_k);
+		return;
+	}
+	if (hist_count < n)
+	{
+		fail("pair latched before 2^k periods", hist_count, n);
+		return;
+	}
+
+	for (u32 i = 1; i <= n; i++)
+	{
+		const period_t *p = &hist[(hist_next + HIST_PERIODS - i) % HIST_PERIODS];
+
+		want_high += std::min(p->high - 1, COUNT_MAX);
+		want_low += std::min(p->low - 1, COUNT_MAX);
+		high_clocks += p->high;
+		clocks += (u64) p->high + p->low;
+	}
+	want_high = std::min(want_high, (u64) COUNT_MAX);
+	want_low = std::min(want_low, (u64) COUNT_MAX);
+
+	if (high != want_high)
+	{
+		fail("high count", high, want_high);
+	}
+	if (low != want_low)
+	{
+		fail("low count", low, want_low);
+	}
+	if ((high == COUNT_MAX) || (low == COUNT_MAX))
+	{
+		saturated++;
+		return;
+	}
+
+	// the firmware math, against the waveform: n periods in "clocks" clocks
+
+	u64 want_hz = div_round((unsigned __int128) CLK_FREQ_HZ * n, clocks);
+	u64 want_mhz = div_round((unsigned __int128) CLK_FREQ_HZ * MEAS_FREQ_SCALE * n, clocks);
+	u64 want_pct = div_round((unsigned __int128) 100 * high_clocks, clocks);
+	u64 want_hundredths = div_round((unsigned __int128) MEAS_DUTY_SCALE * high_clocks, clocks);
+
+	u64 got;
+
+	got = calc_freq(high, low, k, true);
+	if (got != want_hz)
+	{
+		fail("calc_freq", got, want_hz);
+	}
+	got = MEAS_FreqMilliHz(CLK_FREQ_HZ, high, low, k);
+	if (got != want_mhz)
+	{
+		fail("MEAS_FreqMilliHz", got, want_mhz);
+	}
+	got = calc_duty(high, low, k);
+	if (got != want_pct)
+	{
+		fail("calc_duty", got, want_pct);
+	}
+	got = MEAS_DutyHundredths(high, low, k);
+	if (got != want_hundredths)
+	{
+		fail("MEAS_DutyHundredths", got, want_hundredths);
+	}
+}
+
+
+void Cosim::fail(const char *what, u64 got, u64 want)
+{
+	failures++;
+	if (failures <= MAX_REPORTS)
+	{
+		const period_t *p = &hist[(hist_next + HIST_PERIODS - 1) % HIST_PERIODS];
+
+		printf("FAIL at clock %llu: %s = %llu, want %llu (k = %u, last period %u/%u)\n",
+			(unsigned long long) cycles, what, (unsigned long long) got,
+			(unsigned long long) want, (unsigned) top->accum_k, p->high, p->low);
+	}
+}
@@ -0,0 +1,114 @@
+#!/bin/bash
+#
+# run_cosim.sh --> builds the hw_detect.v co-simulation with Verilator and runs it
+#
+#
+# Author:	Rehan Iqbal
+# Organization: Portland State University
+#
+# Description:
+#
+# Runs the build of hw_detect_cosim.cpp (see its header) in an output directory: the
+# testpwm and host simulation drivers into libtestpwm_host.a, then hw_detect.v and the
+# harness with Verilator.  Then it runs the sweep and a run of random segments and prints
+# the result, the run time and the simulation rate (Mclocks/s) of each.  The build log and
+# the output of both runs stay in the output directory.
+#
+# Usage: run_cosim.sh [-o dir] [-r segments] [-s seed]
+#
+#		-o		build & log directory (default: a new directory in /tmp)
+#		-r		random segments to run after the sweep (default: 2000, 0 = none)
+#		-s		seed of the random segments (default: 1)
+#
+# Exit status is 0 if the build succeeded and both runs passed.
+#
+####################################################################################################
+
+set -u
+
+cd "$(dirname "$0")/.." || exit 2
+hw=$PWD
+sw=$hw/../software
+
+out=""
+segments=2000
+seed=1
+
+usage() {
+	echo "usage: run_cosim.sh [-o dir] [-r segments] [-s seed]" >&2
+	exit 2
+}
+
+while getopts "o:r:s:h" opt; do
+	case $opt in
+		o)	out=$OPTARG ;;
+		r)	segments=$OPTARG ;;
+		s)	seed=$OPTARG ;;
+		*)	usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if ! command -v verilator > /dev/null 2>&1; then
+	echo "run_cosim.sh: verilator is not installed" >&2
+	exit 2
+fi
+if ! [ "$segments" -ge 0 ] 2>/dev/null; then
+	usage
+fi
+if [ -z "$out" ]; then
+	out=$(mktemp -d /tmp/hw_detect_cosim.XXXXXX) || exit 2
+fi
+mkdir -p "$out" && out=$(cd "$out" && pwd) || exit 2
+
+# build: the drivers without hostsim_main.c, then the Verilator model and the harness.
+# testpwm/ is a quote-only include directory for the C++ build: its sched.h would
+# otherwise stand in for the <sched.h> of the C++ thread headers
+
+echo "building in $out"
+
+(
+	cd "$out" &&
+	gcc -O2 -Wall -I"$sw/hostsim" -I"$sw/hostsim/include" -I"$sw/testpwm" \
+		-Dmain=testpwm_main -c "$sw"/testpwm/[a-z]*.c "$sw/hostsim/hostsim.c" \
+		"$sw"/hostsim/hostsim_[a-l]*.c "$sw"/hostsim/hostsim_[n-z]*.c &&
+	ar rcs libtestpwm_host.a *.o && rm -f *.o &&
+	cd "$hw" &&
+	verilator --cc --exe --build -j 0 -O3 --x-assign fast --x-initial fast --noassert \
+		-Wno-fatal -GSTATS_ENABLE=0 -GGATE_HZ=100000 --top-module hw_detect \
+		-CFLAGS "-O2 -I$sw/hostsim/include -iquote $sw/testpwm" \
+		-LDFLAGS "$out/libtestpwm_host.a -lm -lrt" --Mdir "$out/obj_dir" -o hw_detect_cosim \
+		hw_detect.v hw_stats.v cosim/hw_detect_cosim.cpp
+) > "$out/build.log" 2>&1
+
+if [ $? -ne 0 ]; then
+	echo "run_cosim.sh: build failed (see $out/build.log)" >&2
+	tail -20 "$out/build.log" >&2
+	exit 1
+fi
+
+# run the sweep and the random segments
+
+failed=0
+
+run() {
+	local name=$1
+	shift
+	"$out/obj_dir/hw_detect_cosim" "$@" > "$out/$name.log" 2>&1
+	local rc=$?
+	if [ $rc -eq 0 ]; then
+		echo "$name: PASS"
+	else
+		echo "$name: FAIL (exit status $rc, see $out/$name.log)"
+		grep "^FAIL" "$out/$name.log" | head -10
+		failed=$((failed + 1))
+	fi
+	tail -2 "$out/$name.log" | sed 's/^/    /'
+}
+
+run sweep
+if [ "$segments" -ne 0 ]; then
+	run random -r "$segments" -s "$seed"
+fi
+
+[ $failed -eq 0 ]
@@ -12,6 +12,42 @@
 // It implements a simple state machine to determine high-to-low and low-to-high
 // transitions, and then store a counted value to one of two registers.
 //
+// The high count is held at the high-to-low transition and both counts are latched
+// together at the low-to-high transition, so the outputs always hold the high & low
+// intervals of the same PWM period(s).  Each output carries a 4-bit sequence number in
+// bits [31:28], the accumulation exponent k in bits [27:24] and the count in bits [23:0].
+// The sequence number changes every time a new pair is latched (1, 2, ... 15, 1, ...) and
+// is 0 until the first complete period after reset.  Software reads both channels and
+// reads again if the sequence numbers differ, i.e. if a new pair was latched between the
+// two reads.
+//
+// At high PWM frequencies a single period is only a few clocks long (20 clocks at 5MHz),
+// so software can select k (accum_k) to have the high & low counts of 2^k consecutive
+// periods added together before the pair is latched.  Each period adds (interval - 1),
+// so the latched counts are (sum of intervals - 2^k).  A change of accum_k restarts the
+// accumulation, and the k that a pair was accumulated with is latched with it.  The sums
+// saturate at COUNT_MAX, so k should be chosen to keep 2^k periods well below that.
+//
+// Range: the sequence number and k take the top byte of each output, so the counts are 24
+// bits.  A high or low interval longer than COUNT_MAX + 1 clocks (167.8 msec at 100MHz)
+// saturates at COUNT_MAX: every duty cycle is measured down to 5.97Hz, a 50% duty cycle
+// down to 2.99Hz, and below that the period pair is only a lower bound (software has to
+// treat a saturated count as out of range, see hwdet.h).  The slowest PWM_FREQ_* setting
+// of testpwm (10Hz) is within range.
+//
+// A second engine counts the rising edges of pwm in a fixed gate of GATE_CLOCKS clocks
+// (1 / GATE_HZ seconds).  Counting edges gives its best precision at high frequencies,
+// where the period counts are short, and is independent of the period engine and of k.
+// While gate_sel is high both outputs show the gated counter instead of the period pair:
+// high_count = {gate sequence, 4'b0, edges in the last gate} and low_count = {gate
+// sequence, 4'b0, GATE_CLOCKS}.  The gate sequence number works like the one of the
+// period pair and changes at the end of every gate.
+//
+// With STATS_ENABLE set, every single period (whatever k is) also goes to a statistics
+// unit (hw_stats.v) that keeps the min/max/sum/sum of squares of the period and the high
+// time and a histogram of the period deviations.  Software reads it through stats_cmd and
+// stats_data (a third GPIO) and takes atomic snapshots of it; see hw_stats.v.
+//
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
 module hw_detect #(
@@ -22,26 +58,77 @@ module hw_detect #(
 
 	// Define some timing parameters
 
-	parameter integer 	CLK_FREQUENCY_HZ = 100000000)
+	parameter integer 	CLK_FREQUENCY_HZ = 100000000,
+	parameter integer	GATE_HZ = 10,				// gated counter: 100 msec gate
+	parameter integer	STATS_ENABLE = 1,			// 1 = include the statistics unit
+	parameter integer	HIST_BITS = 8)				// 2^HIST_BITS histogram bins
 
 	/******************************************************************/
 	/* Port declarations							                  */
 	/******************************************************************/
 
-	(				
+	(
 	input 					clock,			// 100MHz system clock
 	input 			 		reset,			// active-high reset signal from Nexys4
 	input 					pwm,			// PWM signal from AXI Timer in EMBSYS
+	input		[3:0]		accum_k,		// accumulate 2^accum_k periods per latched pair
+	input					gate_sel,		// 1 = outputs show the gated edge counter
+	input		[31:0]		stats_cmd,		// statistics command & register select (hw_stats.v)
 
-	output reg	[31:0]		high_count,		// how long PWM was 'high' --> GPIO input on Microblaze
-	output reg	[31:0]		low_count);		// how long PWM was 'low' --> GPIO input on Microblaze
+	output		[31:0]		high_count,		// {sequence, k, how long PWM was 'high'} --> GPIO input on Microblaze
+	output		[31:0]		low_count,		// {sequence, k, how long PWM was 'low'} --> GPIO input on Microblaze
+	output		[31:0]		stats_data);	// selected statistics register --> GPIO input on Microblaze
 
 	/******************************************************************/
 	/* Local parameters and values		                  	  		  */
 	/******************************************************************/
 
-	reg			[31:0]		count;			// 32-bit counter used for high/low count intervals
+	localparam	[23:0]		COUNT_MAX = 24'hFFFFFF;		// counts saturate (167.8 msec at 100MHz, see Range above)
+
+	reg			[23:0]		count;			// 24-bit counter used for high/low count intervals
 	reg 					prev_pwm; 		// previous state of PWM; used to detect transitions
+	reg						started;		// a transition has been seen since reset
+	reg						high_ok;		// high_hold holds a complete high interval
+	reg			[23:0]		high_hold;		// high count of the current period
+	reg			[3:0]		k;				// accumulation exponent of the current window
+	reg			[15:0]		periods;		// complete periods added to the current window
+	reg			[23:0]		high_acc;		// high counts of the current window
+	reg			[23:0]		low_acc;		// low counts of the current window
+	reg			[23:0]		high_latch;		// high counts of the last complete window
+	reg			[23:0]		low_latch;		// low counts of the last complete window
+	reg			[3:0]		k_latch;		// accumulation exponent of the last complete window
+	reg			[3:0]		seq;			// sequence number of the latched pair (0 = none yet)
+
+	localparam	[23:0]		GATE_CLOCKS = CLK_FREQUENCY_HZ / GATE_HZ;	// gate length (must fit in 24 bits)
+
+	reg			[23:0]		gate_timer;		// clocks into the current gate
+	reg			[23:0]		edges;			// rising edges in the current gate
+	reg			[23:0]		gate_latch;		// rising edges in the last complete gate
+	reg			[3:0]		gate_seq;		// sequence number of the last complete gate (0 = none yet)
+
+	wire					pwm_rise;		// low-to-high transition of pwm in this clock
+	wire		[24:0]		high_sum;		// window counts including the period that just ended
+	wire		[24:0]		low_sum;
+	wire					window_done;	// the period that just ended completes the window
+	wire					period_done;	// a complete period ends in this clock
+
+	/******************************************************************/
+	/* Outputs										                  */
+	/******************************************************************/
+
+	assign high_count = gate_sel ? {gate_seq, 4'b0, gate_latch} : {seq, k_latch, high_latch};
+	assign low_count = gate_sel ? {gate_seq, 4'b0, GATE_CLOCKS} : {seq, k_latch, low_latch};
+
+	assign pwm_rise = (pwm == 1'b1) && (prev_pwm == 1'b0);
+	assign period_done = pwm_rise && high_ok;
+
+	/******************************************************************/
+	/* Accumulate 2^k periods						                  */
+	/******************************************************************/
+
+	assign high_sum = high_acc + high_hold;
+	assign low_sum = low_acc + count;
+	assign window_done = (periods == ((17'd1 << k) - 1'b1));
 
 	/******************************************************************/
 	/* Obtain the counts for high & low intervals	                  */
@@ -51,41 +138,152 @@ module hw_detect #(
 
 		if (reset) begin					// check for synchronous reset
 
-			count <= 32'b0;					// clear the counter
-			high_count <= 32'b0;			// clear the 'high' register
-			low_count <= 32'b0;				// clear the 'low' register
-			prev_pwm <= 1'b0;				// clear the previous state
+			count <= 24'b0;					// clear the counter
+			high_hold <= 24'b0;				// clear the held 'high' count
+			high_acc <= 24'b0;				// clear the window
+			low_acc <= 24'b0;
+			periods <= 16'b0;
+			k <= accum_k;
+			high_latch <= 24'b0;			// clear the 'high' register
+			low_latch <= 24'b0;				// clear the 'low' register
+			k_latch <= 4'b0;
+			seq <= 4'b0;					// no pair latched yet
+			started <= 1'b0;
+			high_ok <= 1'b0;
+			prev_pwm <= pwm;				// sample the current state so the first transition is real
 
 		end
 
-		else if (pwm == 1'b1) begin 		// check if PWM is currently high
+		else begin
 
-			if (prev_pwm != pwm) begin 		// if so, check whether there was a low-to-high transition
-				count <= 32'b0; 			// clear the counter
-				low_count <= count;			// store the 'low' count
-				prev_pwm <= 1'b1;			// update the previous state to 'high'
-			end
+			if (pwm == 1'b1) begin 			// check if PWM is currently high
+
+				if (prev_pwm != pwm) begin 	// if so, check whether there was a low-to-high transition
+					count <= 24'b0; 		// clear the counter
+					prev_pwm <= 1'b1;		// update the previous state to 'high'
+					started <= 1'b1;
+				end
+
+				else if (count != COUNT_MAX) begin
+					count <= count + 1'b1;	// otherwise, just increment count
+				end
 
-			else begin
-				count <= count + 1'b1;		// otherwise, just increment count		
 			end
 
-		end
+			else begin 						// PWM is currently low
 
-		else if (pwm == 1'b0) begin 		// check if PWM is currently low
+				if (prev_pwm != pwm) begin 	// if so, check whether there was a high-to-low transition
+					count <= 24'b0; 		// clear the counter
+					high_hold <= count; 	// hold the 'high' count until the period ends
+					high_ok <= started;		// the high interval is complete if it started at a transition
+					prev_pwm <= pwm; 		// update the previous state to 'low'
+					started <= 1'b1;
+				end
+
+				else if (count != COUNT_MAX) begin
+					count <= count + 1'b1; 	// otherwise, just increment count
+				end
 
-			if (prev_pwm != pwm) begin 		// if so, check whether there was a high-to-low transition
-				count <= 32'b0; 			// clear the counter
-				high_count <= count; 		// store the 'high' count
-				prev_pwm <= pwm; 			// update the previous state to 'low'
 			end
 
-			else begin
-				count <= count + 1'b1; 		// otherwise, just increment count
+			// add the period that ends at a low-to-high transition to the window and latch
+			// the window once it holds 2^k periods.  A new k restarts the window
+
+			if (accum_k != k) begin
+				k <= accum_k;
+				high_acc <= 24'b0;
+				low_acc <= 24'b0;
+				periods <= 16'b0;
 			end
-		
+
+			else if (period_done) begin
+
+				if (window_done) begin
+					high_latch <= high_sum[24] ? COUNT_MAX : high_sum[23:0];
+					low_latch <= low_sum[24] ? COUNT_MAX : low_sum[23:0];
+					k_latch <= k;
+					seq <= (seq == 4'd15) ? 4'd1 : seq + 1'b1;
+					high_acc <= 24'b0;
+					low_acc <= 24'b0;
+					periods <= 16'b0;
+				end
+
+				else begin
+					high_acc <= high_sum[24] ? COUNT_MAX : high_sum[23:0];
+					low_acc <= low_sum[24] ? COUNT_MAX : low_sum[23:0];
+					periods <= periods + 1'b1;
+				end
+
+			end
+
 		end
-		
+
 	end
 
+	/******************************************************************/
+	/* Count the rising edges in a fixed gate		                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+
+			gate_timer <= 24'b0;
+			edges <= 24'b0;
+			gate_latch <= 24'b0;
+			gate_seq <= 4'b0;
+
+		end
+
+		else if (gate_timer == (GATE_CLOCKS - 1'b1)) begin		// end of the gate
+
+			gate_timer <= 24'b0;
+			gate_latch <= edges + pwm_rise;			// at most GATE_CLOCKS / 2, never saturates
+			edges <= 24'b0;
+			gate_seq <= (gate_seq == 4'd15) ? 4'd1 : gate_seq + 1'b1;
+
+		end
+
+		else begin
+
+			gate_timer <= gate_timer + 1'b1;
+			edges <= edges + pwm_rise;
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Statistics of every period					                  */
+	/******************************************************************/
+
+	generate
+
+		if (STATS_ENABLE) begin : stats
+
+			hw_stats #(
+
+				.HIST_BITS			(HIST_BITS))
+
+			STATS(
+
+				.clock				(clock),			// I [ 0 ] 100MHz system clock
+				.reset				(reset),			// I [ 0 ] active-high reset signal from Nexys4
+				.sample				(period_done),		// I [ 0 ] a period ended
+				.high				(high_hold),		// I [23:0] its high count
+				.low				(count),			// I [23:0] its low count
+				.cmd				(stats_cmd),		// I [31:0] command & register select
+
+				.data				(stats_data));		// O [31:0] selected statistics register
+
+		end
+
+		else begin : no_stats
+
+			assign stats_data = 32'b0;
+
+		end
+
+	endgenerate
+
 endmodule
\ No newline at end of file
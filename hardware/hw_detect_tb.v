@@ -1,70 +1,858 @@
 `timescale  1 ns / 1 ns
 
-module hw_detect_tb();
+// hw_detect_tb.v --> self-checking regression of hw_detect.v
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// A generator drives pwm one period at a time and a golden model (the observer) watches
+// the pwm stream the way hw_detect sees it: it keeps the length of every complete period
+// (a high interval that started at a transition followed by a low interval) and counts the
+// rising edges of every gate.  Whenever the outputs show a new sequence number the checker
+// compares them with the model: the sequence number must be the next one, the pair must
+// hold the sums of (interval - 1) of the last 2^k periods (saturated at COUNT_MAX) with the
+// k the window was accumulated with, and the gated count must hold the rising edges of the
+// last gate.  Both outputs must carry the same sequence number at every clock.
+//
+// The tests (see run_test()):
+//
+//		sweep		periods from 2 clocks to 2^max_log2 clocks (1.5x steps), each with a 1
+//					clock high interval, 50% and a 1 clock low interval, each with k = 0 and
+//					with the largest k that keeps 2^k periods within 2^win_log2 clocks
+//		saturation	a single count and window sums beyond COUNT_MAX
+//		jitter		random period, duty cycle and k with every interval jittered and the k
+//					changed in the middle of a period
+//		reset		reset for 1 to 3 clocks at a random point of a period
+//		stuck		pwm stuck high or stuck low for 5000 clocks and for longer than
+//					COUNT_MAX; no pair may be latched while it is stuck
+//		gate		the gated edge counter at a few frequencies
+//		stats		(STATS_ENABLE) snapshots of the statistics unit with a steady waveform
+//
+// The counts are 24 bits (a range limit of hw_detect, see its header), so intervals beyond
+// COUNT_MAX + 1 clocks only saturate: the saturation and stuck tests run a little past
+// COUNT_MAX to check that they saturate and stay saturated, which covers the whole range.
+//
+// The tests are numbered and the regression can be split into shards: a shard runs the
+// tests whose number modulo +shards= is +shard=.  run_tb.sh runs the shards in parallel.
+// Plusargs (all optional):
+//
+//		+shard=n +shards=n		run every shards-th test starting with test shard (0 / 1)
+//		+test=n					run only test n
+//		+seed=n					seed of the random tests (SEED)
+//		+max_log2=n				longest sweep period (MAX_LOG2, at most 24)
+//		+win_log2=n				longest accumulation window (WIN_LOG2)
+//		+jitter=n +resets=n		number of jitter and reset tests (JITTER_TESTS, RESET_TESTS)
+//		+verbose				print every test
+//
+// The last line is "hw_detect_tb: shard ... : PASS" or "... : FAIL".
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hw_detect_tb #(
+
+	/******************************************************************/
+	/* Parameter declarations						                  */
+	/******************************************************************/
+
+	parameter integer	GATE_HZ = 100000,			// 1000 cycle gate so the simulation stays short
+	parameter integer	STATS_ENABLE = 1,			// include (and test) the statistics unit
+	parameter integer	HIST_BITS = 8,				// 2^HIST_BITS histogram bins
+	parameter integer	MAX_LOG2 = 20,				// sweep periods up to 2^MAX_LOG2 clocks
+	parameter integer	WIN_LOG2 = 16,				// accumulation windows up to 2^WIN_LOG2 clocks
+	parameter integer	JITTER_TESTS = 32,
+	parameter integer	RESET_TESTS = 16,
+	parameter integer	SEED = 1)
+
+	();
 
 	/******************************************************************/
 	/* Declaring the internal variables	  				              */
 	/******************************************************************/
 
-	localparam CLK_PERIOD = 10;
+	localparam 				CLK_PERIOD = 10;
+	localparam	integer		COUNT_MAX = 24'hFFFFFF;				// hw_detect counts saturate here
+	localparam	integer		GATE_CLOCKS = 100000000 / GATE_HZ;
+	localparam	integer		BINS = 1 << HIST_BITS;
+	localparam	integer		HIST_PERIODS = 32768;				// periods the observer remembers (2^15)
+	localparam	integer		MAX_REPORTS = 20;					// errors printed in full
+
+	localparam	integer		SAT_TESTS = 3;
+	localparam	integer		STUCK_TESTS = 4;
+	localparam	integer		GATE_TESTS = 4;
+	localparam	integer		STATS_TESTS = STATS_ENABLE ? 4 : 0;
+
+	localparam	[1:0]		GEN_PERIODIC = 2'd0;				// generator modes
+	localparam	[1:0]		GEN_STUCK_HIGH = 2'd1;
+	localparam	[1:0]		GEN_STUCK_LOW = 2'd2;
 
 	reg 				clock;				// system clock
 	reg 				reset;				// active-high reset signal
 	reg 				pwm;				// PWM signal
+	reg		[3:0]		accum_k;			// accumulate 2^accum_k periods per pair
+	reg					gate_sel;			// 1 = outputs show the gated edge counter
+	reg		[31:0]		stats_cmd;			// statistics command & register select
+
+	wire 	[31:0] 		high_count; 		// {sequence, k, how long PWM was 'high'}
+	wire 	[31:0] 		low_count;			// {sequence, k, how long PWM was 'low'}
+	wire	[31:0]		stats_data;			// selected statistics register
+
+	// run time configuration (plusargs)
+
+	integer				shard, shards, only_test, seed, max_log2, win_log2, jitter_tests, reset_tests;
+	reg					verbose;
+
+	// scoreboard
+
+	integer				tests;				// tests run
+	integer				checks;				// pairs and gates checked
+	integer				errors;
+	integer				latch_count;		// new sequence numbers seen
+	integer				cur_test;
+
+	// generator
+
+	reg		[1:0]		gen_mode;
+	integer				gen_high, gen_low, gen_jitter;
+	integer				gen_seed;
+	reg					gen_stuck;			// the generator is in a stuck mode
+	reg					gen_restart;		// start a period with the new settings now
+	integer				gh, gl, gc;
+
+	// observer (the golden model)
+
+	reg					ob_level;			// pwm level hw_detect saw last
+	reg					ob_started;			// a transition has been seen since reset
+	reg					ob_high_ok;			// ob_high_len is a complete high interval
+	reg					ob_reset;			// reset was seen since the last check
+	reg					ob_rise;
+	reg					ob_gate_sel;		// gate_sel hw_detect saw last
+	reg		[3:0]		ob_k;				// accum_k hw_detect saw last
+	integer				ob_run;				// clocks at the current level
+	integer				ob_high_len;		// high interval of the current period
+	reg		[31:0]		hist_h [0:HIST_PERIODS-1];
+	reg		[31:0]		hist_l [0:HIST_PERIODS-1];
+	integer				hist_next;
+	integer				hist_count;
+	integer				g_timer, g_edges, g_expect;
+
+	// checker
 
-	wire 	[31:0] 		high_count; 		// how long PWM was 'high'
-	wire 	[31:0] 		low_count;			// how long PWM was 'low'
+	reg		[3:0]		last_seq;
+	reg					last_gate_sel;
+	reg		[63:0]		want_h, want_l;
+	integer				i, n, idx;
+
+	integer				t, num_tests;
+	reg					stats_toggle;
 
 	/******************************************************************/
 	/* Instantiating the DUT 						                  */
 	/******************************************************************/
 
-	hw_detect DUT(
+	hw_detect #(
+
+		.GATE_HZ			(GATE_HZ),
+		.STATS_ENABLE		(STATS_ENABLE),
+		.HIST_BITS			(HIST_BITS))
+
+	DUT(
 
 		.clock				(clock),			// I [ 0 ] 100MHz system clock
 		.reset 				(reset),			// I [ 0 ] active-high reset signal from Nexys4
 		.pwm 				(pwm),				// I [ 0 ] PWM signal from AXI Timer in EMBSYS
+		.accum_k			(accum_k),			// I [3:0] accumulate 2^accum_k periods per pair
+		.gate_sel			(gate_sel),			// I [ 0 ] 1 = outputs show the gated edge counter
+		.stats_cmd			(stats_cmd),		// I [31:0] statistics command & register select
+
+		.high_count 		(high_count),		// O [31:0] {sequence, k, how long PWM was 'high'} --> GPIO input on Microblaze
+		.low_count 			(low_count),		// O [31:0] {sequence, k, how long PWM was 'low'} --> GPIO input on Microblaze
+		.stats_data			(stats_data));		// O [31:0] selected statistics register
 
-		.high_count 		(high_count),		// O [31:0] how long PWM was 'high' --> GPIO input on Microblaze
-		.low_count 			(low_count));		// O [31:0] how long PWM was 'low' --> GPIO input on Microblaze
-	
 	/******************************************************************/
-	/* Running the testbench simluation				                  */
+	/* Clock and PWM generator						                  */
 	/******************************************************************/
 
-	// set conditions for initial inputs
+	// toggle clock repeatedly (rising edges at 5, 15, 25 ...)
 
 	initial begin
-		#0 clock <= 1'b0;
-		#0 reset <= 1'b0;
-		#0 pwm <= 1'b0;
+		clock = 1'b0;
+		forever #(CLK_PERIOD/2) clock = ~clock;
 	end
 
-	// toggle clock repeatedly
+	// the generator changes pwm 1 ns after a falling edge, one period at a time, with the
+	// settings at the start of the period.  Every interval is jittered by up to gen_jitter.
+	// set_wave() cuts the current period short, so a long period does not hold up the
+	// next test
 
-	always begin
-		#(CLK_PERIOD/2) clock <= ~clock;
+	initial begin
+		pwm = 1'b0;
+		gen_stuck = 1'b0;
+		#(CLK_PERIOD + 1);
+		forever begin
+			gen_restart = 1'b0;
+			if (gen_mode == GEN_PERIODIC) begin
+				gen_stuck = 1'b0;
+				gh = gen_high;
+				gl = gen_low;
+				if (gen_jitter != 0) begin
+					gh = gh + ({$random(gen_seed)} % (2 * gen_jitter + 1)) - gen_jitter;
+					gl = gl + ({$random(gen_seed)} % (2 * gen_jitter + 1)) - gen_jitter;
+					if (gh < 1) gh = 1;
+					if (gl < 1) gl = 1;
+				end
+				pwm = 1'b1;
+				for (gc = 0; (gc < gh) && !gen_restart; gc = gc + 1)
+					#(CLK_PERIOD);
+				if (!gen_restart) begin
+					pwm = 1'b0;
+					for (gc = 0; (gc < gl) && !gen_restart; gc = gc + 1)
+						#(CLK_PERIOD);
+				end
+			end
+			else begin
+				gen_stuck = 1'b1;
+				pwm = (gen_mode == GEN_STUCK_HIGH);
+				#(CLK_PERIOD);
+			end
+		end
 	end
 
-	// reset the device
+	/******************************************************************/
+	/* Observer: the pwm stream as hw_detect sees it	              */
+	/******************************************************************/
 
-	initial begin
-		#(5 * CLK_PERIOD) reset <= 1'b1;		// apply reset after 5 cycles
-		#(5 * CLK_PERIOD) reset <= 1'b0;		// keep reset applied for 5 cycles
+	always @(posedge clock) begin
+
+		ob_rise = pwm && !ob_level;
+		ob_k = accum_k;
+		ob_gate_sel = gate_sel;
+
+		if (reset) begin
+			ob_level = pwm;
+			ob_started = 1'b0;
+			ob_high_ok = 1'b0;
+			ob_run = 0;
+			ob_reset = 1'b1;
+			hist_next = 0;
+			hist_count = 0;
+			g_timer = 0;
+			g_edges = 0;
+		end
+
+		else begin
+
+			// a period is complete at the rising edge after a complete high interval
+
+			if (pwm != ob_level) begin
+				if (pwm) begin
+					if (ob_high_ok) begin
+						hist_h[hist_next] = ob_high_len;
+						hist_l[hist_next] = ob_run;
+						hist_next = (hist_next + 1) % HIST_PERIODS;
+						hist_count = hist_count + 1;
+					end
+				end
+				else begin
+					ob_high_len = ob_run;
+					ob_high_ok = ob_started;
+				end
+				ob_started = 1'b1;
+				ob_level = pwm;
+				ob_run = 0;
+			end
+			ob_run = ob_run + 1;
+
+			// rising edges in the gate
+
+			if (g_timer == GATE_CLOCKS - 1) begin
+				g_expect = g_edges + ob_rise;
+				g_timer = 0;
+				g_edges = 0;
+			end
+			else begin
+				g_timer = g_timer + 1;
+				g_edges = g_edges + ob_rise;
+			end
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Checker (falling edges, when the outputs are stable)           */
+	/******************************************************************/
+
+	always @(negedge clock) begin
+
+		if (high_count[31:28] != low_count[31:28]) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): sequence numbers differ (%0d, %0d)", cur_test, high_count[31:28], low_count[31:28]);
+		end
+
+		else if (ob_reset) begin
+			ob_reset = 1'b0;
+			last_gate_sel = ob_gate_sel;
+			last_seq = high_count[31:28];
+			if (!ob_gate_sel && (high_count != 32'b0 || low_count != 32'b0)) begin
+				errors = errors + 1;
+				if (errors <= MAX_REPORTS)
+					$display($time, " --> ERROR (test %0d): outputs not cleared by reset (%h, %h)", cur_test, high_count, low_count);
+			end
+		end
+
+		else if (ob_gate_sel != last_gate_sel) begin		// the outputs switched over
+			last_gate_sel = ob_gate_sel;
+			last_seq = high_count[31:28];
+		end
+
+		else if (high_count[31:28] != last_seq) begin
+
+			latch_count = latch_count + 1;
+			checks = checks + 1;
+
+			if (high_count[31:28] != ((last_seq == 4'd15) ? 4'd1 : last_seq + 1'b1)) begin
+				errors = errors + 1;
+				if (errors <= MAX_REPORTS)
+					$display($time, " --> ERROR (test %0d): sequence %0d follows %0d", cur_test, high_count[31:28], last_seq);
+			end
+			last_seq = high_count[31:28];
+
+			if (ob_gate_sel) begin
+
+				if ((high_count[27:0] != g_expect) || (low_count[27:0] != GATE_CLOCKS)) begin
+					errors = errors + 1;
+					if (errors <= MAX_REPORTS)
+						$display($time, " --> ERROR (test %0d): gate %0d/%0d edges, want %0d/%0d", cur_test,
+							high_count[27:0], low_count[27:0], g_expect, GATE_CLOCKS);
+				end
+
+			end
+
+			else begin
+
+				// the sums of (interval - 1) of the last 2^k periods
+
+				n = 1 << high_count[27:24];
+				want_h = 0;
+				want_l = 0;
+				for (i = 1; i <= n; i = i + 1) begin
+					idx = (hist_next + HIST_PERIODS - i) % HIST_PERIODS;
+					want_h = want_h + ((hist_h[idx] - 1 > COUNT_MAX) ? COUNT_MAX : hist_h[idx] - 1);
+					want_l = want_l + ((hist_l[idx] - 1 > COUNT_MAX) ? COUNT_MAX : hist_l[idx] - 1);
+				end
+				if (want_h > COUNT_MAX) want_h = COUNT_MAX;
+				if (want_l > COUNT_MAX) want_l = COUNT_MAX;
+
+				if (high_count[27:24] != ob_k) begin
+					errors = errors + 1;
+					if (errors <= MAX_REPORTS)
+						$display($time, " --> ERROR (test %0d): k = %0d, want %0d", cur_test, high_count[27:24], ob_k);
+				end
+				else if (hist_count < n) begin
+					errors = errors + 1;
+					if (errors <= MAX_REPORTS)
+						$display($time, " --> ERROR (test %0d): pair latched after %0d of %0d periods", cur_test, hist_count, n);
+				end
+				else if ((high_count[23:0] != want_h) || (low_count[23:0] != want_l)) begin
+					errors = errors + 1;
+					if (errors <= MAX_REPORTS)
+						$display($time, " --> ERROR (test %0d): k = %0d, counts %0d/%0d, want %0d/%0d", cur_test,
+							high_count[27:24], high_count[23:0], low_count[23:0], want_h, want_l);
+				end
+
+			end
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Test helpers									                  */
+	/******************************************************************/
+
+	// wait until 1 ns after the next falling edge (when the test drives the inputs)
+
+	task drive_point;
+	begin
+		@(negedge clock);
+		#1;
+	end
+	endtask
+
+	task wait_clocks;
+		input integer		clocks;
+		integer				c;
+	begin
+		for (c = 0; c < clocks; c = c + 1)
+			@(negedge clock);
+		#1;
+	end
+	endtask
+
+	// wait for "windows" more new sequence numbers, at most max_clocks clocks
+
+	task wait_latches;
+		input integer		windows;
+		input integer		max_clocks;
+		integer				target, c;
+	begin
+		target = latch_count + windows;
+		c = 0;
+		while ((latch_count < target) && (c < max_clocks)) begin
+			@(negedge clock);
+			c = c + 1;
+		end
+		#1;
+		if (latch_count < target) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): %0d of %0d new pairs in %0d clocks", cur_test,
+					latch_count + windows - target, windows, max_clocks);
+		end
+	end
+	endtask
+
+	task set_wave;
+		input integer		high;
+		input integer		low;
+		input integer		jitter;
+	begin
+		gen_high = high;
+		gen_low = low;
+		gen_jitter = jitter;
+		gen_mode = GEN_PERIODIC;
+		gen_restart = 1'b1;
+	end
+	endtask
+
+	// largest k that keeps 2^k periods of "period" clocks within 2^win_log2 clocks
+
+	function integer max_k;
+		input integer		period;
+		integer				k;
+		reg		[63:0]		window;
+	begin
+		max_k = 0;
+		window = period;
+		for (k = 1; k <= 15; k = k + 1) begin
+			window = window << 1;
+			if (window <= (64'd1 << win_log2))
+				max_k = k;
+		end
+	end
+	endfunction
+
+	// statistics unit: read a register (or bin), take a snapshot
+
+	task stats_read;
+		input [9:0]			sel;
+		output [31:0]		value;
+	begin
+		stats_cmd = {stats_toggle, 21'b0, sel};
+		wait_clocks(3);
+		value = stats_data;
+	end
+	endtask
+
+	task stats_snapshot;
+		reg		[31:0]		status;
+		integer				polls;
+	begin
+		stats_toggle = ~stats_toggle;
+		stats_cmd = {stats_toggle, 31'b0};
+		wait_clocks(2);
+		polls = 0;
+		status = 32'h80000000;
+		while (status[31] && (polls < BINS + 100)) begin
+			stats_read(10'd0, status);
+			polls = polls + 1;
+		end
+		if (status[31]) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): statistics snapshot stays busy", cur_test);
+		end
 	end
+	endtask
 
-	// adjust PWM high & low intervals
+	/******************************************************************/
+	/* Tests										                  */
+	/******************************************************************/
+
+	// sweep test i: period 2 * 1.5^j (alternately 2^m and 1.5 * 2^m), three duty cycles,
+	// k = 0 and the largest k for the period
+
+	task sweep_test;
+		input integer		i;
+		integer				j, d, period, high, k;
+	begin
+		j = i / 6;
+		d = (i % 6) / 2;
+		period = (2 + (j & 1)) << (j >> 1);
+		high = (d == 0) ? 1 : ((d == 1) ? period / 2 : period - 1);
+		k = (i % 2) ? max_k(period) : 0;
+
+		if (verbose)
+			$display($time, " --> test %0d: sweep period %0d high %0d k %0d", cur_test, period, high, k);
 
-	always begin
-		#(10 * CLK_PERIOD) pwm = ~pwm; 			// low interval is 10 cycles
-		#(20 * CLK_PERIOD) pwm = ~pwm;			// high interval is 20 cycles
+		set_wave(high, period - high, 0);
+		accum_k = k;
+		wait_latches(2, (4 << k) * period + 1000);
 	end
+	endtask
 
-	// continuously monitor the high & low counts
+	// saturation test i: a high interval beyond COUNT_MAX, the longest exact single period,
+	// a window sum beyond COUNT_MAX
+
+	task sat_test;
+		input integer		i;
+		integer				high, low, k;
+	begin
+		case (i)
+			0:			begin high = COUNT_MAX + 3;			low = 2;				k = 0;	end
+			1:			begin high = (COUNT_MAX + 1) / 2;	low = (COUNT_MAX + 1) / 2;	k = 0;	end
+			default:	begin high = (COUNT_MAX / 2) + 9;	low = 3;				k = 1;	end
+		endcase
+
+		if (verbose)
+			$display($time, " --> test %0d: saturation high %0d low %0d k %0d", cur_test, high, low, k);
+
+		set_wave(high, low, 0);
+		accum_k = k;
+		wait_latches(2, (4 << k) * (high + low) + 1000);
+	end
+	endtask
+
+	// jitter test i: random period (2 - 4096 clocks), duty cycle, jitter and k.  The k
+	// changes at a random clock
+
+	task jitter_test;
+		input integer		i;
+		integer				s, period, high, jitter, k;
+	begin
+		s = seed + (i * 7919);
+		period = 2 + ({$random(s)} % (2 << ({$random(s)} % 12)));
+		high = 1 + ({$random(s)} % (period - 1));
+		jitter = {$random(s)} % ((period / 8) + 1);
+		k = {$random(s)} % 16;
+		if (k > max_k(period + 2 * jitter))
+			k = max_k(period + 2 * jitter);
+
+		if (verbose)
+			$display($time, " --> test %0d: jitter period %0d high %0d jitter %0d k %0d", cur_test, period, high, jitter, k);
+
+		gen_seed = s;
+		set_wave(high, period - high, jitter);
+		wait_clocks({$random(s)} % (period + 1));
+		accum_k = k;
+		wait_latches(3, (5 << k) * (period + 2 * jitter) + 1000);
+	end
+	endtask
+
+	// reset test i: reset for 1 - 3 clocks at a random clock of a period
+
+	task reset_test;
+		input integer		i;
+		integer				s, period, high, k;
+	begin
+		s = seed + (i * 104729);
+		period = 2 + ({$random(s)} % 4095);
+		high = 1 + ({$random(s)} % (period - 1));
+		k = {$random(s)} % 4;
+
+		if (verbose)
+			$display($time, " --> test %0d: reset period %0d high %0d k %0d", cur_test, period, high, k);
+
+		set_wave(high, period - high, 0);
+		accum_k = k;
+		wait_latches(1, (3 << k) * period + 1000);
+		wait_clocks({$random(s)} % period);
+		reset = 1'b1;
+		wait_clocks(1 + ({$random(s)} % 3));
+		reset = 1'b0;
+		wait_latches(2, (4 << k) * period + 1000);
+	end
+	endtask
+
+	// stuck test i: pwm stuck high / low for 5000 clocks (i = 0, 1) and for longer than
+	// COUNT_MAX (i = 2, 3)
+
+	task stuck_test;
+		input integer		i;
+		integer				clocks, seen;
+	begin
+		clocks = (i < 2) ? 5000 : COUNT_MAX + 100;
+
+		if (verbose)
+			$display($time, " --> test %0d: stuck %s for %0d clocks", cur_test, (i % 2) ? "low " : "high", clocks);
+
+		set_wave(40, 60, 0);
+		accum_k = 0;
+		wait_latches(2, 1000);
+
+		// the rising edge that starts a stuck high period still ends the period before
+
+		gen_mode = (i % 2) ? GEN_STUCK_LOW : GEN_STUCK_HIGH;
+		while (!gen_stuck)
+			@(negedge clock);
+		wait_clocks(2);
+		seen = latch_count;
+		wait_clocks(clocks);
+		if (latch_count != seen) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): %0d pairs latched while pwm was stuck", cur_test, latch_count - seen);
+		end
+
+		set_wave(40, 60, 0);
+		wait_latches(2, 1000);
+	end
+	endtask
+
+	// gate test i: the gated edge counter
+
+	task gate_test;
+		input integer		i;
+		integer				period;
+	begin
+		case (i)
+			0:			period = 2;
+			1:			period = 37;
+			2:			period = 1000;
+			default:	period = 7777;
+		endcase
+
+		if (verbose)
+			$display($time, " --> test %0d: gate period %0d", cur_test, period);
+
+		set_wave(period / 2, period - (period / 2), 0);
+		gate_sel = 1'b1;
+		wait_latches(3, (4 * GATE_CLOCKS) + (2 * period));
+		gate_sel = 1'b0;
+		wait_clocks(1);
+	end
+	endtask
+
+	// stats test i: a steady waveform between two snapshots; every period must be the
+	// same, all in the center bin of the histogram
+
+	task stats_test;
+		input integer		i;
+		integer				period, high, periods;
+		reg		[31:0]		status, num, clocks, info, lo, hi, bin;
+		reg		[63:0]		p, h;
+	begin
+		case (i)
+			0:			begin period = 30;		high = 20;		end
+			1:			begin period = 2;		high = 1;		end
+			2:			begin period = 1000;	high = 1;		end
+			default:	begin period = 4099;	high = 4098;	end
+		endcase
+		periods = (period < 500) ? 40 : 5;
+
+		if (verbose)
+			$display($time, " --> test %0d: stats period %0d high %0d", cur_test, period, high);
+
+		set_wave(high, period - high, 0);
+		accum_k = 0;
+		wait_latches(2, (3 * period) + 1000);
+
+		// center the histogram on the period, then count "periods" periods
+
+		stats_cmd = {stats_toggle, 1'b1, 1'b0, 5'd0, period[23:0]};
+		wait_clocks(2);
+		stats_snapshot;
+		wait_clocks(periods * period);
+		stats_snapshot;
+
+		stats_read(10'd0, status);
+		stats_read(10'd1, num);
+		stats_read(10'd2, clocks);
+		stats_read(10'd3, info);
+		p = period;
+		h = high;
+
+		if ((status[30:0] != {2'b0, 5'd0, period[23:0]}) || (info[31:24] != HIST_BITS) || (num == 0) ||
+			(clocks + period < num * period) || (clocks > (num + 1) * period)) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): stats status %h info %h, %0d periods in %0d clocks", cur_test,
+					status, info, num, clocks);
+		end
+
+		// min, max, sum and sum of squares of the period (registers 4 - 9) and the high
+		// time (10 - 15)
+
+		stats_read(10'd4, lo);
+		stats_read(10'd5, hi);
+		if ((lo != period) || (hi != period)) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): period min %0d max %0d, want %0d", cur_test, lo, hi, period);
+		end
+		stats_read(10'd6, lo);
+		stats_read(10'd7, hi);
+		if ({hi, lo} != num * p) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): period sum %0d, want %0d", cur_test, {hi, lo}, num * p);
+		end
+		stats_read(10'd8, lo);
+		stats_read(10'd9, hi);
+		if ({hi, lo} != num * p * p) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): period sum of squares %0d, want %0d", cur_test, {hi, lo}, num * p * p);
+		end
+		stats_read(10'd10, lo);
+		stats_read(10'd11, hi);
+		if ((lo != high) || (hi != high)) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): high min %0d max %0d, want %0d", cur_test, lo, hi, high);
+		end
+		stats_read(10'd12, lo);
+		stats_read(10'd13, hi);
+		if ({hi, lo} != num * h) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): high sum %0d, want %0d", cur_test, {hi, lo}, num * h);
+		end
+		stats_read(10'd14, lo);
+		stats_read(10'd15, hi);
+		if ({hi, lo} != num * h * h) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): high sum of squares %0d, want %0d", cur_test, {hi, lo}, num * h * h);
+		end
+
+		// histogram: everything in the center bin
+
+		stats_read((10'd1 << 9) | (BINS / 2 - 1), lo);
+		stats_read((10'd1 << 9) | (BINS / 2), bin);
+		stats_read((10'd1 << 9) | (BINS / 2 + 1), hi);
+		if ((bin != num) || (lo != 0) || (hi != 0)) begin
+			errors = errors + 1;
+			if (errors <= MAX_REPORTS)
+				$display($time, " --> ERROR (test %0d): bins %0d %0d %0d, want 0 %0d 0", cur_test, lo, bin, hi, num);
+		end
+		checks = checks + 1;
+	end
+	endtask
+
+	// test t: the tests are numbered sweep, saturation, jitter, reset, stuck, gate, stats
+
+	task run_test;
+		input integer		t;
+		integer				i;
+	begin
+		cur_test = t;
+		i = t;
+		if (i < (2 * max_log2 - 2) * 6)
+			sweep_test(i);
+		else begin
+			i = i - (2 * max_log2 - 2) * 6;
+			if (i < SAT_TESTS)
+				sat_test(i);
+			else begin
+				i = i - SAT_TESTS;
+				if (i < jitter_tests)
+					jitter_test(i);
+				else begin
+					i = i - jitter_tests;
+					if (i < reset_tests)
+						reset_test(i);
+					else begin
+						i = i - reset_tests;
+						if (i < STUCK_TESTS)
+							stuck_test(i);
+						else begin
+							i = i - STUCK_TESTS;
+							if (i < GATE_TESTS)
+								gate_test(i);
+							else
+								stats_test(i - GATE_TESTS);
+						end
+					end
+				end
+			end
+		end
+		tests = tests + 1;
+	end
+	endtask
+
+	/******************************************************************/
+	/* Running the testbench simluation				                  */
+	/******************************************************************/
 
 	initial begin
-		$monitor($time, " --> 'high_count' = %d, 'low_count' = %d", high_count, low_count);		
+
+		// run time configuration
+
+		shard = 0;
+		shards = 1;
+		only_test = -1;
+		seed = SEED;
+		max_log2 = MAX_LOG2;
+		win_log2 = WIN_LOG2;
+		jitter_tests = JITTER_TESTS;
+		reset_tests = RESET_TESTS;
+		verbose = $test$plusargs("verbose");
+		if ($value$plusargs("shard=%d", shard)) ;
+		if ($value$plusargs("shards=%d", shards)) ;
+		if ($value$plusargs("test=%d", only_test)) ;
+		if ($value$plusargs("seed=%d", seed)) ;
+		if ($value$plusargs("max_log2=%d", max_log2)) ;
+		if ($value$plusargs("win_log2=%d", win_log2)) ;
+		if ($value$plusargs("jitter=%d", jitter_tests)) ;
+		if ($value$plusargs("resets=%d", reset_tests)) ;
+		if (max_log2 > 24) max_log2 = 24;
+		if (max_log2 < 2) max_log2 = 2;
+		if (win_log2 > 24) win_log2 = 24;
+		if (shards < 1) shards = 1;
+
+		num_tests = (2 * max_log2 - 2) * 6 + SAT_TESTS + jitter_tests + reset_tests + STUCK_TESTS +
+			GATE_TESTS + STATS_TESTS;
+
+		// initial inputs and reset
+
+		tests = 0;
+		checks = 0;
+		errors = 0;
+		latch_count = 0;
+		cur_test = -1;
+		last_seq = 4'd0;
+		last_gate_sel = 1'b0;
+		ob_reset = 1'b0;
+		ob_level = 1'b0;
+		ob_gate_sel = 1'b0;
+		hist_next = 0;
+		hist_count = 0;
+		g_expect = 0;
+		stats_toggle = 1'b0;
+
+		reset = 1'b1;
+		accum_k = 4'd0;
+		gate_sel = 1'b0;
+		stats_cmd = 32'b0;
+		gen_seed = seed;
+		set_wave(10, 20, 0);
+		wait_clocks(5);
+		reset = 1'b0;
+
+		for (t = 0; t < num_tests; t = t + 1) begin
+			if ((only_test < 0) ? ((t % shards) == shard) : (t == only_test))
+				run_test(t);
+		end
+
+		$display("hw_detect_tb: shard %0d/%0d seed %0d: %0d of %0d tests, %0d checks, %0d errors: %s",
+			shard, shards, seed, tests, num_tests, checks, errors, (errors == 0) ? "PASS" : "FAIL");
+		$finish;
 	end
 
 
-endmodule
\ No newline at end of file
+endmodule
@@ -0,0 +1,353 @@
+// hw_stats.v --> period and high time statistics of the PWM signal measured by hw_detect
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This module keeps statistics of every single period that hw_detect measures, so the
+// jitter and the outliers of the signal can be qualified at MHz rates without the CPU
+// looking at each period.  hw_detect pulses sample for one clock at the rising edge that
+// ends a period, with the high and low counts of that period (interval length - 1).
+// For the period (high + low + 2 clocks) and the high time (high + 1 clocks) the module
+// keeps the number of periods, the minimum, the maximum, the sum and the sum of squares.
+// A histogram in block RAM counts the deviations of the period from a reference period:
+// bin (period - ref) / 2^shift + 2^(HIST_BITS-1), with the deviations beyond either end
+// counted in the first and last bin.
+//
+// Everything is kept twice.  One set accumulates while the other (the snapshot) holds the
+// statistics of the last interval for the CPU to read.  Toggling bit 31 of cmd takes a
+// snapshot: the histogram bank of the old snapshot is cleared (2^HIST_BITS clocks), then
+// both sets swap in one clock and the new accumulating set starts from zero, so no period
+// is lost or counted twice and the snapshot is self-consistent.  busy is set from the
+// toggle until the periods that were in the pipeline at the swap are in the snapshot.
+//
+// cmd (from the CPU):
+//		[31]	 snapshot toggle
+//		[30]	 1 = load [28:24] (shift) and [23:0] (reference period in clocks) into the
+//				 configuration; it applies to the intervals that start after the next snapshot
+//		[9:0]	 when [30] = 0: the snapshot register (0 - 15) or, with [9] set, the histogram
+//				 bin ([HIST_BITS-1:0]) shown on data one clock later
+//
+// Snapshot registers (all counts in clocks):
+//		0	{busy, sum of squares overflowed, 1'b0, shift, reference period}
+//		1	periods							2	length of the interval
+//		3	{HIST_BITS, 8'b0, snapshot number}
+//		4	period min						5	period max
+//		6	period sum [31:0]				7	period sum [63:32]
+//		8	period sum of squares [31:0]	9	period sum of squares [63:32]
+//		10	high time min					11	high time max
+//		12	high time sum [31:0]			13	high time sum [63:32]
+//		14	high time sum of squares [31:0]	15	high time sum of squares [63:32]
+//
+// The period count, the interval length and the histogram bins saturate at 2^32 - 1 and
+// the sums of squares at 2^64 - 1 (which also sets the overflow bit).
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hw_stats #(
+
+	/******************************************************************/
+	/* Parameter declarations						                  */
+	/******************************************************************/
+
+	parameter integer	HIST_BITS = 8)				// 2^HIST_BITS histogram bins (at most 9)
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	(
+	input 					clock,			// 100MHz system clock
+	input 			 		reset,			// active-high reset signal from Nexys4
+	input					sample,			// a period ended (one clock)
+	input		[23:0]		high,			// high count of that period (high clocks - 1)
+	input		[23:0]		low,			// low count of that period (low clocks - 1)
+	input		[31:0]		cmd,			// command & register select --> GPIO output on Microblaze
+
+	output reg	[31:0]		data);			// selected snapshot register --> GPIO input on Microblaze
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	localparam	integer		BINS = 1 << HIST_BITS;
+	localparam	[7:0]		BIN_BITS = HIST_BITS;
+	localparam	[31:0]		SAT32 = 32'hFFFFFFFF;
+
+	// the two sets of statistics (index = set)
+
+	reg			[31:0]		n [0:1];			// periods
+	reg			[31:0]		clocks [0:1];		// length of the interval
+	reg			[25:0]		p_min [0:1];		// period
+	reg			[25:0]		p_max [0:1];
+	reg			[63:0]		p_sum [0:1];
+	reg			[63:0]		p_sq [0:1];
+	reg			[24:0]		h_min [0:1];		// high time
+	reg			[24:0]		h_max [0:1];
+	reg			[63:0]		h_sum [0:1];
+	reg			[63:0]		h_sq [0:1];
+	reg						sq_ovf [0:1];		// a sum of squares saturated
+	reg			[23:0]		set_ref [0:1];		// reference period of the histogram
+	reg			[4:0]		set_shift [0:1];	// histogram bin width 2^shift
+
+	reg						active;			// set that accumulates (the other one is the snapshot)
+	reg			[15:0]		snap_seq;		// snapshots taken
+	reg			[23:0]		cfg_ref;		// configuration for the next interval
+	reg			[4:0]		cfg_shift;
+	reg						prev_toggle;	// cmd[31] at the last clock
+
+	reg						busy;			// a snapshot is being taken
+	reg						clearing;		// clearing the histogram bank of the snapshot
+	reg			[HIST_BITS-1:0]	clear_addr;
+	reg			[1:0]		drain;			// clocks until the pipeline is empty after the swap
+
+	// pipeline: stage 1 updates the counts, min/max/sum and reads the histogram bin,
+	// stage 2 adds the squares and writes the bin back.  Two periods end at least two
+	// clocks apart, so a bin is never read before the count of the last period is written
+
+	reg						s1_valid;
+	reg						s1_set;
+	reg			[25:0]		s1_period;
+	reg			[24:0]		s1_high;
+	reg			[HIST_BITS-1:0]	s1_bin;
+
+	reg						s2_valid;
+	reg						s2_set;
+	reg			[51:0]		s2_p_sq;
+	reg			[49:0]		s2_h_sq;
+	reg			[HIST_BITS:0]	s2_addr;
+
+	// histogram: bank b is addresses {b, bin}.  Port A counts, port B is read by the CPU
+	// and written by the clear engine
+
+	reg			[31:0]		hist [0:(2*BINS)-1];
+	reg			[31:0]		hist_qa;
+	reg			[31:0]		hist_qb;
+
+	wire		[25:0]		period;			// period that just ended (clocks)
+	wire		[26:0]		dev;			// its deviation from the reference (signed)
+	wire		[26:0]		dev_scaled;
+	wire		[26:0]		bin_full;		// bin before limiting to the histogram
+	wire		[HIST_BITS-1:0]	bin;
+	wire		[64:0]		p_sq_next;		// sums of squares with carry
+	wire		[64:0]		h_sq_next;
+	wire					snap;			// cmd asks for a snapshot
+	wire					snapshot;		// the set that is not accumulating
+	wire		[HIST_BITS:0]	addr_b;		// port B address
+
+	integer					i;
+
+	/******************************************************************/
+	/* Deviation from the reference and histogram bin                 */
+	/******************************************************************/
+
+	assign period = high + low + 2'd2;
+	assign dev = {1'b0, period} - {3'b0, set_ref[active]};
+	assign dev_scaled = $signed(dev) >>> set_shift[active];
+	assign bin_full = dev_scaled + (BINS / 2);
+	assign bin = ($signed(bin_full) < 0) ? {HIST_BITS{1'b0}} :
+				 ($signed(bin_full) >= BINS) ? {HIST_BITS{1'b1}} : bin_full[HIST_BITS-1:0];
+
+	assign p_sq_next = p_sq[s2_set] + s2_p_sq;
+	assign h_sq_next = h_sq[s2_set] + s2_h_sq;
+
+	assign snap = (cmd[31] != prev_toggle);
+	assign snapshot = ~active;
+	assign addr_b = clearing ? {snapshot, clear_addr} : {snapshot, cmd[HIST_BITS-1:0]};
+
+	/******************************************************************/
+	/* Histogram block RAM							                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+		if (s2_valid)
+			hist[s2_addr] <= (hist_qa == SAT32) ? SAT32 : hist_qa + 1'b1;
+		hist_qa <= hist[{s1_set, s1_bin}];
+	end
+
+	always@(posedge clock) begin
+		if (clearing)
+			hist[addr_b] <= 32'b0;
+		hist_qb <= hist[addr_b];
+	end
+
+	/******************************************************************/
+	/* Pipeline and statistics						                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+
+			for (i = 0; i < 2; i = i + 1) begin
+				n[i] <= 32'b0;
+				clocks[i] <= 32'b0;
+				p_min[i] <= {26{1'b1}};
+				p_max[i] <= 26'b0;
+				p_sum[i] <= 64'b0;
+				p_sq[i] <= 64'b0;
+				h_min[i] <= {25{1'b1}};
+				h_max[i] <= 25'b0;
+				h_sum[i] <= 64'b0;
+				h_sq[i] <= 64'b0;
+				sq_ovf[i] <= 1'b0;
+				set_ref[i] <= 24'b0;
+				set_shift[i] <= 5'b0;
+			end
+
+			active <= 1'b0;
+			snap_seq <= 16'b0;
+			cfg_ref <= 24'b0;
+			cfg_shift <= 5'b0;
+			prev_toggle <= cmd[31];
+			busy <= 1'b0;
+			clearing <= 1'b0;
+			clear_addr <= {HIST_BITS{1'b0}};
+			drain <= 2'b0;
+			s1_valid <= 1'b0;
+			s2_valid <= 1'b0;
+
+		end
+
+		else begin
+
+			// configuration for the next interval
+
+			if (cmd[30]) begin
+				cfg_ref <= cmd[23:0];
+				cfg_shift <= cmd[28:24];
+			end
+
+			// stage 0 --> 1: the period that just ended
+
+			s1_valid <= sample;
+			s1_set <= active;
+			s1_period <= period;
+			s1_high <= high + 1'b1;
+			s1_bin <= bin;
+
+			// stage 1: counts, min/max/sum (the histogram bin is read)
+
+			if (s1_valid) begin
+				n[s1_set] <= (n[s1_set] == SAT32) ? SAT32 : n[s1_set] + 1'b1;
+				if (s1_period < p_min[s1_set])	p_min[s1_set] <= s1_period;
+				if (s1_period > p_max[s1_set])	p_max[s1_set] <= s1_period;
+				if (s1_high < h_min[s1_set])	h_min[s1_set] <= s1_high;
+				if (s1_high > h_max[s1_set])	h_max[s1_set] <= s1_high;
+				p_sum[s1_set] <= p_sum[s1_set] + s1_period;
+				h_sum[s1_set] <= h_sum[s1_set] + s1_high;
+			end
+
+			s2_valid <= s1_valid;
+			s2_set <= s1_set;
+			s2_p_sq <= s1_period * s1_period;
+			s2_h_sq <= s1_high * s1_high;
+			s2_addr <= {s1_set, s1_bin};
+
+			// stage 2: sums of squares (the histogram bin is written)
+
+			if (s2_valid) begin
+				p_sq[s2_set] <= p_sq_next[64] ? {64{1'b1}} : p_sq_next[63:0];
+				h_sq[s2_set] <= h_sq_next[64] ? {64{1'b1}} : h_sq_next[63:0];
+				if (p_sq_next[64] || h_sq_next[64])
+					sq_ovf[s2_set] <= 1'b1;
+			end
+
+			// length of the interval
+
+			if (clocks[active] != SAT32)
+				clocks[active] <= clocks[active] + 1'b1;
+
+			// snapshot: clear the histogram bank of the old snapshot, swap the sets, and
+			// wait until the periods in the pipeline have reached the new snapshot
+
+			prev_toggle <= cmd[31];
+
+			if (snap && !busy) begin
+				busy <= 1'b1;
+				clearing <= 1'b1;
+				clear_addr <= {HIST_BITS{1'b0}};
+			end
+
+			else if (clearing) begin
+
+				if (clear_addr == (BINS - 1)) begin
+
+					clearing <= 1'b0;
+					active <= snapshot;
+					snap_seq <= snap_seq + 1'b1;
+					drain <= 2'd2;
+
+					// the new accumulating set starts from zero with the configuration
+
+					n[snapshot] <= 32'b0;
+					clocks[snapshot] <= 32'b0;
+					p_min[snapshot] <= {26{1'b1}};
+					p_max[snapshot] <= 26'b0;
+					p_sum[snapshot] <= 64'b0;
+					p_sq[snapshot] <= 64'b0;
+					h_min[snapshot] <= {25{1'b1}};
+					h_max[snapshot] <= 25'b0;
+					h_sum[snapshot] <= 64'b0;
+					h_sq[snapshot] <= 64'b0;
+					sq_ovf[snapshot] <= 1'b0;
+					set_ref[snapshot] <= cfg_ref;
+					set_shift[snapshot] <= cfg_shift;
+
+				end
+
+				else begin
+					clear_addr <= clear_addr + 1'b1;
+				end
+
+			end
+
+			else if (busy) begin
+				if (drain == 2'd0)
+					busy <= 1'b0;
+				else
+					drain <= drain - 1'b1;
+			end
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Snapshot register read						                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (cmd[9]) begin
+			data <= hist_qb;
+		end
+
+		else begin
+
+			case (cmd[3:0])
+				4'd0:	data <= {busy, sq_ovf[snapshot], 1'b0, set_shift[snapshot], set_ref[snapshot]};
+				4'd1:	data <= n[snapshot];
+				4'd2:	data <= clocks[snapshot];
+				4'd3:	data <= {BIN_BITS, 8'b0, snap_seq};
+				4'd4:	data <= {6'b0, p_min[snapshot]};
+				4'd5:	data <= {6'b0, p_max[snapshot]};
+				4'd6:	data <= p_sum[snapshot][31:0];
+				4'd7:	data <= p_sum[snapshot][63:32];
+				4'd8:	data <= p_sq[snapshot][31:0];
+				4'd9:	data <= p_sq[snapshot][63:32];
+				4'd10:	data <= {7'b0, h_min[snapshot]};
+				4'd11:	data <= {7'b0, h_max[snapshot]};
+				4'd12:	data <= h_sum[snapshot][31:0];
+				4'd13:	data <= h_sum[snapshot][63:32];
+				4'd14:	data <= h_sq[snapshot][31:0];
+				default:	data <= h_sq[snapshot][63:32];
+			endcase
+
+		end
+
+	end
+
+endmodule
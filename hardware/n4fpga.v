@@ -9,7 +9,8 @@
 // 
 // This module provides the top level for ECE 544 Project #1.
 // It connects a Microblaze embedded system (EMBSYS) to a
-// hardware detect module (HWDET). It also passes the 100MHz clock
+// hardware detect module (HWDET) and its period statistics unit (read
+// through a third GPIO). It also passes the 100MHz clock
 // from EMBSYS --> HWDET and handles global reset. Lastly, it makes
 // connections from EMBSYS to the Nexys4 lights, switches, and buttons.
 //
@@ -97,11 +98,19 @@ module n4fpga (
     wire	[7:0]	    gpio_out;				// GPIO output port for EMBSYS
 
     wire                pwm_out;                // AXI Timer PWM --> GPIO input
+    wire                pwm_out_n;              // inverted PWM --> AXI Timer 1 falling edge capture
 
     // Connections between hw_detect <--> GPIO
 
-    wire    [31:0]      high_count;             // how long PWM was 'high'
-    wire    [31:0]      low_count;              // how long PWM was 'low'
+    wire    [31:0]      high_count;             // how long PWM was 'high' ({sequence, k, count})
+    wire    [31:0]      low_count;              // how long PWM was 'low' ({sequence, k, count})
+    wire    [3:0]       accum_k;                // hw_detect accumulates 2^accum_k periods per pair
+    wire                gate_sel;               // hw_detect outputs show the gated edge counter
+
+    // Connections between the hw_detect statistics unit <--> GPIO 2
+
+    wire    [31:0]      stats_cmd;              // statistics command & register select
+    wire    [31:0]      stats_data;             // selected statistics register
 
     /******************************************************************/
     /* Global Assignments                                             */
@@ -118,6 +127,11 @@ module n4fpga (
     wire   clk_20khz;
     assign clk_20khz = gpio_out[0];
 
+    // hw_detect accumulation exponent and counter select from the FIT interrupt routine
+
+    assign accum_k = gpio_out[7:4];
+    assign gate_sel = gpio_out[1];
+
     // PWM output on led[15]; Microblaze controls LEDs via Nexys4IO block
     // so we write '0' and OR with PWM output
     
@@ -141,6 +155,11 @@ module n4fpga (
 
     assign gpio_in = {7'b0000000, pwm_out};
 
+    // and time stamp its edges with AXI Timer 1 (capture on rising edges only, so the
+    // falling edges are captured from the inverted signal)
+
+    assign pwm_out_n = ~pwm_out;
+
     /******************************************************************/
     /* hw_detect instantiation                                        */
     /******************************************************************/
@@ -150,9 +169,13 @@ module n4fpga (
         .clock              (clk_100mhz),       // I [ 0 ] 100MHz system clock
         .reset              (sysreset),         // I [ 0 ] active-high reset signal from Nexys4
         .pwm                (pwm_out),          // I [ 0 ] PWM signal from AXI Timer in EMBSYS
+        .accum_k            (accum_k),          // I [3:0] accumulate 2^accum_k periods per pair (GPIO_0 Ch2 [7:4])
+        .gate_sel           (gate_sel),         // I [ 0 ] 1 = show the gated edge counter (GPIO_0 Ch2 [1])
+        .stats_cmd          (stats_cmd),        // I [31:0] statistics command & register select (GPIO_2 Ch1)
 
-        .high_count         (high_count),       // O [31:0] how long PWM was 'high' --> GPIO Ch1 on Microblaze
-        .low_count          (low_count));       // O [31:0] how long PWM was 'low' --> GPIO Ch2 on Microblaze
+        .high_count         (high_count),       // O [31:0] {sequence, k, how long PWM was 'high'} --> GPIO Ch1 on Microblaze
+        .low_count          (low_count),        // O [31:0] {sequence, k, how long PWM was 'low'} --> GPIO Ch2 on Microblaze
+        .stats_data         (stats_data));      // O [31:0] selected statistics register --> GPIO_2 Ch2 on Microblaze
     			
     /******************************************************************/
     /* EMBSYS instantiation                                           */
@@ -212,14 +235,22 @@ module n4fpga (
 
         // Connections with GPIO
 
-        .gpio_0_GPIO2_tri_o         (gpio_out),         // O [7:0] GPIO output port; AXI Timer 'clk_20khz' --> bit[0]
+        .gpio_0_GPIO2_tri_o         (gpio_out),         // O [7:0] GPIO output port; AXI Timer 'clk_20khz' --> bit[0], hw_detect 'accum_k' --> bits[7:4], 'gate_sel' --> bit[1]
         .gpio_0_GPIO_tri_i          (gpio_in),          // I [7:0] GPIO input port; AXI Timer 'pwm_out' --> bit[0]
         
         .gpio_1_GPIO_tri_i          (high_count),       // I [7:0] GPIO input port
         .gpio_1_GPIO2_tri_i         (low_count),        // I [7:0] GPIO input port
 
+        .gpio_2_GPIO_tri_o          (stats_cmd),        // O [31:0] GPIO output port; hw_detect statistics command & register select
+        .gpio_2_GPIO2_tri_i         (stats_data),       // I [31:0] GPIO input port; selected hw_detect statistics register
+
         // Connections with AXI Timer
 
-        .pwm0                       (pwm_out));         // O [ 0 ] AXI Timer's PWM output signal
+        .pwm0                       (pwm_out),          // O [ 0 ] AXI Timer's PWM output signal
+
+        // Connections with AXI Timer 1
+
+        .capturetrig0               (pwm_out),          // I [ 0 ] capture timer 0 at the rising edges of the PWM
+        .capturetrig1               (pwm_out_n));       // I [ 0 ] capture timer 1 at the falling edges of the PWM
 
 endmodule
\ No newline at end of file
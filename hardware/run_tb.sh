@@ -0,0 +1,176 @@
+#!/bin/bash
+#
+# run_tb.sh --> runs the hw_detect_tb.v regression split across the host cores
+#
+#
+# Author:	Rehan Iqbal
+# Organization: Portland State University
+#
+# Description:
+#
+# Builds hw_detect_tb.v with hw_detect.v and hw_stats.v once, with Verilator or Icarus
+# Verilog, and runs it as N shards in parallel (+shard=0..N-1 +shards=N, one per host core
+# by default).  Each shard runs every N-th test of the regression (see hw_detect_tb.v).
+# When all shards are done it prints the result and the wall-clock time of each shard and
+# the first errors of the shards that failed.  A shard that crashes or ends without its
+# summary line counts as failed.  The logs stay in the output directory.
+#
+# -f checks the testbench instead of the RTL: it builds a copy of hw_detect.v with a known
+# fault (the high count latched one too high) and the regression has to catch it.
+#
+# Usage: run_tb.sh [-s verilator|iverilog] [-j shards] [-o dir] [-f] [plusargs ...]
+#
+#		-s		simulator (default: verilator if it is installed, else iverilog)
+#		-j		number of shards (default: number of cores)
+#		-o		build & log directory (default: a new directory in /tmp)
+#		-f		inject the fault into hw_detect.v (the copy in the output directory)
+#		plusargs are passed to every shard, e.g. +seed=7 +jitter=200 +max_log2=22
+#
+# Exit status is 0 if every shard passed or, with -f, if the scoreboard of a shard reported
+# errors (a crash does not count as catching the fault).
+#
+####################################################################################################
+
+set -u
+
+cd "$(dirname "$0")" || exit 2
+
+sim=""
+shards=$(nproc 2>/dev/null || echo 1)
+out=""
+fault=0
+
+usage() {
+	echo "usage: run_tb.sh [-s verilator|iverilog] [-j shards] [-o dir] [-f] [plusargs ...]" >&2
+	exit 2
+}
+
+while getopts "s:j:o:fh" opt; do
+	case $opt in
+		s)	sim=$OPTARG ;;
+		j)	shards=$OPTARG ;;
+		o)	out=$OPTARG ;;
+		f)	fault=1 ;;
+		*)	usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ -z "$sim" ]; then
+	if command -v verilator > /dev/null 2>&1; then
+		sim=verilator
+	elif command -v iverilog > /dev/null 2>&1; then
+		sim=iverilog
+	else
+		echo "run_tb.sh: neither verilator nor iverilog is installed" >&2
+		exit 2
+	fi
+fi
+if ! [ "$shards" -ge 1 ] 2>/dev/null; then
+	usage
+fi
+if [ -z "$out" ]; then
+	out=$(mktemp -d /tmp/hw_detect_tb.XXXXXX) || exit 2
+fi
+mkdir -p "$out" || exit 2
+
+# build once
+
+sources="hw_detect_tb.v hw_detect.v hw_stats.v"
+
+if [ $fault -ne 0 ]; then
+	sed 's/high_latch <= high_sum\[24\] ? COUNT_MAX : high_sum\[23:0\];/high_latch <= high_sum[24] ? COUNT_MAX : high_sum[23:0] + 1'"'"'b1;/' \
+		hw_detect.v > "$out/hw_detect.v"
+	if cmp -s hw_detect.v "$out/hw_detect.v"; then
+		echo "run_tb.sh: the fault could not be injected (high_latch assignment not found)" >&2
+		exit 2
+	fi
+	sources="hw_detect_tb.v $out/hw_detect.v hw_stats.v"
+fi
+
+case $sim in
+	verilator)
+		verilator --binary --timing -O3 -Wno-fatal -Wno-lint --top-module hw_detect_tb \
+			--Mdir "$out/obj_dir" -o hw_detect_tb $sources > "$out/build.log" 2>&1
+		build_rc=$?
+		run=("$out/obj_dir/hw_detect_tb")
+		;;
+	iverilog)
+		iverilog -g2005 -s hw_detect_tb -o "$out/hw_detect_tb.vvp" $sources > "$out/build.log" 2>&1
+		build_rc=$?
+		run=(vvp -n "$out/hw_detect_tb.vvp")
+		;;
+	*)
+		usage
+		;;
+esac
+
+if [ $build_rc -ne 0 ]; then
+	echo "run_tb.sh: $sim build failed (see $out/build.log)" >&2
+	tail -20 "$out/build.log" >&2
+	exit 1
+fi
+
+# run the shards in parallel, each with its own log and wall-clock time
+
+echo "running $shards shards with $sim in $out$([ $fault -ne 0 ] && echo ", fault injected")"
+
+start=$(date +%s.%N)
+
+for ((s = 0; s < shards; s++)); do
+	(
+		t0=$(date +%s.%N)
+		"${run[@]}" +shard=$s +shards=$shards "$@" > "$out/shard$s.log" 2>&1
+		echo $? > "$out/shard$s.rc"
+		t1=$(date +%s.%N)
+		awk -v a="$t0" -v b="$t1" 'BEGIN { printf "%.1f\n", b - a }' > "$out/shard$s.time"
+	) &
+done
+wait
+
+total=$(awk -v a="$start" -v b="$(date +%s.%N)" 'BEGIN { printf "%.1f", b - a }')
+
+# collect the results
+
+failed=0
+caught=0						# shards whose scoreboard reported errors
+
+printf "%-6s %-6s %9s  %s\n" shard result seconds summary
+
+for ((s = 0; s < shards; s++)); do
+	summary=$(grep "^hw_detect_tb: shard" "$out/shard$s.log" | tail -1)
+	rc=$(cat "$out/shard$s.rc" 2>/dev/null || echo 1)
+	if [ "$rc" -eq 0 ] && [ "${summary##*: }" = "PASS" ]; then
+		result=PASS
+	else
+		result=FAIL
+		failed=$((failed + 1))
+		[ "${summary##*: }" = "FAIL" ] && caught=$((caught + 1))
+		[ -z "$summary" ] && summary="no summary (exit status $rc)"
+	fi
+	printf "%-6s %-6s %9s  %s\n" "$s" "$result" "$(cat "$out/shard$s.time")" "${summary#hw_detect_tb: }"
+done
+
+for ((s = 0; s < shards; s++)); do
+	if grep -q "ERROR" "$out/shard$s.log"; then
+		echo "--- shard $s ($out/shard$s.log)"
+		grep "ERROR" "$out/shard$s.log" | head -10
+	fi
+done
+
+if [ $fault -ne 0 ]; then
+	if [ $caught -ne 0 ]; then
+		echo "fault caught by $caught of $shards shards in $total s"
+		exit 0
+	fi
+	echo "fault NOT caught: $failed of $shards shards failed, none with scoreboard errors, in $total s"
+	exit 1
+fi
+
+if [ $failed -ne 0 ]; then
+	echo "$failed of $shards shards FAILED in $total s"
+	exit 1
+fi
+
+echo "all $shards shards passed in $total s"
+exit 0
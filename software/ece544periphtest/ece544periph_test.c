@@ -25,12 +25,16 @@
 * Ver   Who  Date     Changes
 * ----- ---- -------- -----------------------------------------------
 * 1.00a	rhk	12/22/14	First release of test program.  Builds on the nx4io_test program.
+* 1.00b	ri	10/16/26	usleep() waits on the counter of an axi_timer and reports its error.
+*						The delays are decimal microseconds (they were octal constants)
 * </pre>
 *
 * @note
 * The minimal hardware configuration for this test is a Microblaze-based system with at least 32KB of memory,
 * an instance of Nexys4IO, an instance of the PMod544IOR2,  and an instance of the Xilinx
-* UARTLite (used for xil_printf() console output)
+* UARTLite (used for xil_printf() console output).  If the system has an axi_timer, usleep()
+* uses timer 0 of axi_timer_0 as a free-running counter for its delays; without one it falls
+* back to an approximate delay loop
 *
 ******************************************************************************/
 
@@ -41,6 +45,8 @@
 #include "xstatus.h"
 #include "Nexys4IO.h"
 #include "PMod544IOR2.h"
+#include "xil_io.h"
+#include "xtmrctr.h"
 
 /************************** Constant Definitions ****************************/
 #define NX4IO_DEVICE_ID		XPAR_NEXYS4IO_0_DEVICE_ID
@@ -51,16 +57,39 @@
 #define PMD544IO_BASEADDR	XPAR_PMOD544IOR2_0_S00_AXI_BASEADDR
 #define PMD544IO_HIGHADDR	XPAR_PMOD544IOR2_0_S00_AXI_HIGHADDR
 
+// usleep() counts the clocks of timer 0 of axi_timer_0 if there is one.  Long delays
+// are waited out in chunks of USLEEP_CHUNK_CLOCKS so the 32-bit counter can wrap
+#ifdef XPAR_TMRCTR_0_DEVICE_ID
+#define USLEEP_USE_TIMER		1
+#define USLEEP_TMRCTR_DEVICE_ID	XPAR_TMRCTR_0_DEVICE_ID
+#define USLEEP_TMRCTR_BASEADDR	XPAR_TMRCTR_0_BASEADDR
+#define USLEEP_TMRCTR_NUMBER	0
+#define USLEEP_CLOCK_FREQ_HZ	XPAR_TMRCTR_0_CLOCK_FREQ_HZ
+#define USLEEP_CHUNK_CLOCKS		0x40000000
+#else
+#define USLEEP_USE_TIMER		0
+#endif
+
 /**************************** Type Definitions ******************************/
 
 /***************** Macros (Inline Functions) Definitions ********************/
+#if USLEEP_USE_TIMER
+// reads the free-running counter of the usleep() timer
+#define USLEEP_NOW()	Xil_In32(USLEEP_TMRCTR_BASEADDR + (USLEEP_TMRCTR_NUMBER * XTC_TIMER_COUNTER_OFFSET) + XTC_TCR_OFFSET)
+#endif
 
 /************************** Variable Definitions ****************************/
 unsigned long timeStamp = 0;
 
+#if USLEEP_USE_TIMER
+XTmrCtr		UsleepTimer;				// free-running counter for usleep()
+u32			usleepOverhead = 0;			// clocks of a usleep() call besides the delay
+#endif
+
 
 /************************** Function Prototypes *****************************/
 void usleep(u32 usecs);
+int do_init_usleep(void);
 
 int do_init_nx4io(u32 BaseAddress);
 int do_init_pmdio(u32 BaseAddress);
@@ -81,6 +110,13 @@ int main()
 	xil_printf("ECE 544 Nexys4 Peripheral Test Program R1.0\n");
 	xil_printf("By Roy Kravitz.  31-December 2014\n\n");
 
+	// start the timer of usleep() and report how accurate its delays are
+	sts = do_init_usleep();
+	if (sts == XST_FAILURE)
+	{
+		exit(1);
+	}
+
 	// initialize the Nexys4 driver and (some of)the devices
 	sts = do_init_nx4io(NX4IO_BASEADDR);
 	if (sts == XST_FAILURE)
@@ -134,13 +170,13 @@ int main()
 		{
 			// increment the timestamp and delay 100 msecs
 			timeStamp += 100;
-			usleep(00100000);
+			usleep(100000);
 		}
 	}
 
 	xil_printf("\nThat's All Folks!\n\n");
 	PMDIO_LCD_wrstring("That's All Folks");
-	usleep(05000000);
+	usleep(5000000);
 	NX410_SSEG_setAllDigits(SSEGHI, CC_BLANK, CC_B, CC_LCY, CC_E, DP_NONE);
 	NX410_SSEG_setAllDigits(SSEGLO, CC_B, CC_LCY, CC_E, CC_BLANK, DP_NONE);
 	PMDIO_LCD_clrd();
@@ -169,20 +205,20 @@ void RunTest1(void)
 	xil_printf("Starting Test 1...the LED test\n");
 	// test the LEDS (LD15..LD0) with some constant patterns
 	NX4IO_setLEDs(0x00005555);
-	usleep(02000000);
+	usleep(2000000);
 	NX4IO_setLEDs(0x0000AAAA);
-	usleep(02000000);
+	usleep(2000000);
 	NX4IO_setLEDs(0x0000FF00);
-	usleep(02000000);
+	usleep(2000000);
 	NX4IO_setLEDs(0x000000FF);
-	usleep(02000000);
+	usleep(2000000);
 
 	// shift a 1 through all of the leds
 	ledvalue = 0x0001;
 	do
 	{
 		NX4IO_setLEDs(ledvalue);
-		usleep(01000000);
+		usleep(1000000);
 		ledvalue = ledvalue << 1;
 	} while (ledvalue != 0);
 	return;
@@ -210,21 +246,21 @@ void RunTest2(void)
 	// are set to 0 but enable all three PWM channels
 	NX4IO_RGBLED_setChnlEn(RGB1, true, true, true);
 	NX4IO_RGBLED_setDutyCycle(RGB1, 0, 0, 16);
-	usleep(03000000);
+	usleep(3000000);
 
 	// For RGB2, only write a non-zero duty cycle to the green channel
 	NX4IO_RGBLED_setChnlEn(RGB2, true, true, true);
 	NX4IO_RGBLED_setDutyCycle(RGB2, 0, 32, 0);
-	usleep(03000000);
+	usleep(3000000);
 
 	// Next make RGB1 red. This time we'll only enable the red PWM channel
 	NX4IO_RGBLED_setChnlEn(RGB1, true, false, false);
 	NX4IO_RGBLED_setDutyCycle(RGB1, 64, 64, 64);
-	usleep(05000000);
+	usleep(5000000);
 
 	// Next make RGB2 BRIGHTpurple-ish by only changing the duty cycle
 	NX4IO_RGBLED_setDutyCycle(RGB2, 255, 255, 255);
-	usleep(03000000);
+	usleep(3000000);
 
 	// Finish by turning the both LEDs off
 	// We'll do this by disabling all of the channels without changing
@@ -257,13 +293,13 @@ void RunTest3(void)
 	NX4IO_SSEG_setDecPt(SSEGLO, DIGIT6, true);
 	NX4IO_SSEG_setDecPt(SSEGLO, DIGIT5, true);
 	NX4IO_SSEG_setDecPt(SSEGLO, DIGIT4, true);
-	usleep(05000000);
+	usleep(5000000);
 	NX4IO_SSEG_putU32Hex(0xDEADBEEF);
 	NX4IO_SSEG_setDecPt(SSEGLO, DIGIT3, true);
 	NX4IO_SSEG_setDecPt(SSEGLO, DIGIT2, true);
 	NX4IO_SSEG_setDecPt(SSEGLO, DIGIT1, true);
 	NX4IO_SSEG_setDecPt(SSEGLO, DIGIT0, true);
-	usleep(05000000);
+	usleep(5000000);
 	return;
 }
 
@@ -377,7 +413,7 @@ void RunTest4(void)
 	PMDIO_LCD_wrchar('F');
 	PMDIO_LCD_wrchar('s');
 	PMDIO_LCD_wrchar('w');
-	usleep(05000000);
+	usleep(5000000);
 
 	// Write one final string
 	PMDIO_LCD_clrd();
@@ -448,18 +484,44 @@ void RunTest5()
 /**
 * insert delay (in microseconds) between instructions.
 *
-* This function should be in libc but it seems to be missing.  This emulation implements
-* a delay loop with (really) approximate timing; not perfect but it gets the job done.
+* This function should be in libc but it seems to be missing.  With an axi_timer it
+* counts timer clocks from the moment it is called, minus the clocks the call itself
+* takes (measured by do_init_usleep()), so the delay is accurate to a clock or two plus
+* the time of one counter read.  Interrupts that arrive during the delay do not make it
+* longer, unless they take longer than the rest of it.
+*
+* Without an axi_timer it is a delay loop with (really) approximate timing.
 *
 * @param	usec is the requested delay in microseconds
 *
 * @return	*NONE*
 *
-* @note
-* This emulation assumes that the microblaze is running @ 100MHz and takes 15 clocks
-* per iteration - this is probably totally bogus but it's a start.
-*
 *****************************************************************************/
+#if USLEEP_USE_TIMER
+
+void usleep(u32 usec)
+{
+	u32 start, clocks;
+	u64 total;
+
+	start = USLEEP_NOW();
+	total = ((u64) usec * USLEEP_CLOCK_FREQ_HZ) / 1000000;
+	total = (total > usleepOverhead) ? total - usleepOverhead : 0;
+
+	// wait out the long delays in chunks, each measured from the end of the last one
+	while (total > USLEEP_CHUNK_CLOCKS)
+	{
+		while ((USLEEP_NOW() - start) < USLEEP_CHUNK_CLOCKS);
+		start += USLEEP_CHUNK_CLOCKS;
+		total -= USLEEP_CHUNK_CLOCKS;
+	}
+
+	clocks = (u32) total;
+	while ((USLEEP_NOW() - start) < clocks);
+	return;
+}
+
+#else
 
 static const u32	DELAY_1US_CONSTANT	= 15;	// constant for 1 microsecond delay
 
@@ -474,6 +536,100 @@ void usleep(u32 usec)
 	return;
 }
 
+#endif
+
+
+/****************************************************************************/
+/**
+* start the timer of usleep() and measure its error
+*
+* Starts the usleep() timer as a free-running up counter, measures the clocks a call of
+* usleep(0) takes (the shortest of several calls, less the cost of timing it) and subtracts
+* them from every delay from then on.  Then times delays from 1 usec to 100 msec and prints
+* the error of each on the console, in nsec and in parts per million of the delay.
+*
+* @param	*NONE*
+*
+* @return	XST_SUCCESS if initialization succeeds.  XST_FAILURE otherwise
+*
+* @note
+* Without an axi_timer there is nothing to measure the delay loop with, so this only
+* prints a warning that the delays are approximate
+*
+*****************************************************************************/
+int do_init_usleep(void)
+{
+#if USLEEP_USE_TIMER
+	static const u32 delays[] = {1, 10, 100, 1000, 10000, 100000};
+	u32 start, clocks, readClocks, expected, i;
+	s32 error, errorNs;
+	int sts;
+
+	// start the counter from 0, counting up and wrapping around
+	sts = XTmrCtr_Initialize(&UsleepTimer, USLEEP_TMRCTR_DEVICE_ID);
+	if (sts != XST_SUCCESS)
+	{
+		xil_printf("usleep: axi_timer initialization failed\n");
+		return XST_FAILURE;
+	}
+	XTmrCtr_SetOptions(&UsleepTimer, USLEEP_TMRCTR_NUMBER, XTC_AUTO_RELOAD_OPTION);
+	XTmrCtr_SetResetValue(&UsleepTimer, USLEEP_TMRCTR_NUMBER, 0);
+	XTmrCtr_Start(&UsleepTimer, USLEEP_TMRCTR_NUMBER);
+
+	start = USLEEP_NOW();
+	for (i = 0; (i < 1000) && (USLEEP_NOW() == start); i++);
+	if (USLEEP_NOW() == start)
+	{
+		xil_printf("usleep: the axi_timer is not counting\n");
+		return XST_FAILURE;
+	}
+
+	// the overhead is the shortest usleep(0) call, less the cost of timing it
+	readClocks = 0xFFFFFFFF;
+	usleepOverhead = 0xFFFFFFFF;
+	for (i = 0; i < 16; i++)
+	{
+		start = USLEEP_NOW();
+		clocks = USLEEP_NOW() - start;
+		if (clocks < readClocks)
+		{
+			readClocks = clocks;
+		}
+	}
+	for (i = 0; i < 16; i++)
+	{
+		start = USLEEP_NOW();
+		usleep(0);
+		clocks = USLEEP_NOW() - start;
+		if (clocks < usleepOverhead)
+		{
+			usleepOverhead = clocks;
+		}
+	}
+	usleepOverhead -= readClocks;
+
+	xil_printf("usleep: axi_timer @ %d Hz, %d clocks of call overhead subtracted\n",
+		USLEEP_CLOCK_FREQ_HZ, usleepOverhead);
+
+	// time the delays from the caller's side
+	for (i = 0; i < sizeof(delays) / sizeof(delays[0]); i++)
+	{
+		start = USLEEP_NOW();
+		usleep(delays[i]);
+		clocks = USLEEP_NOW() - start - readClocks;
+
+		expected = (u32) (((u64) delays[i] * USLEEP_CLOCK_FREQ_HZ) / 1000000);
+		error = (s32) (clocks - expected);
+		errorNs = (s32) (((s64) error * 1000000000) / USLEEP_CLOCK_FREQ_HZ);
+		xil_printf("usleep(%d): %d clocks, error %d ns (%d ppm)\n", delays[i], clocks,
+			errorNs, (s32) (((s64) error * 1000000) / (s32) expected));
+	}
+#else
+	xil_printf("usleep: no axi_timer, the delays are approximate\n");
+#endif
+	return XST_SUCCESS;
+}
+
 
 /****************************************************************************/
 /**
@@ -0,0 +1,667 @@
+/**
+*
+* @file hostsim.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements the core of the host simulation model: simulated time, the AXI bus
+* decoder, the interrupt controller (and the XIntc/microblaze_* functions that drive it) and
+* the simulation clock that advances time, fires the FIT interrupt and applies scripted inputs.
+*
+* Everything runs on the application's thread.  By default the simulation clock is
+* deterministic: simulated time only advances by the cost of the bus accesses the application
+* makes and by its wait loops (see hostsim_idle()), and at the end of every access the
+* model is brought up to the new time synchronously: at every quantum boundary the scripted
+* events are applied and the devices are polled, the FIT interrupt is raised for every FIT
+* period that has passed, and the pending interrupts are taken if MSR[IE] is set.  Interrupts
+* therefore preempt the application between two bus accesses, at points that only depend on
+* the program and the script, and two runs of the same binary give the same results (time
+* spent computing without bus accesses is not simulated).  A host timer only watches for an
+* application that spins without bus accesses or idle loops, which would stop simulated time,
+* and ends the run.
+*
+* Paced mode (opt-in, hostsim_clock_start() with ns_per_tick != 0) is the former clock: a
+* periodic host timer whose signal (SIGALRM) advances simulated time by one quantum and runs
+* the interrupt handlers that are due from signal context.  A bus access is atomic with
+* respect to it.  Where the interrupts land depends on the host, so results vary from run to
+* run.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of the host simulation model
+* 1.01a	ri	10/16/26	Count the bus clocks spent in each interrupt handler
+* 1.02a	ri	10/16/26	Measure the interrupt latency (raise to handler).  Clock ticks move
+*						simulated time to the tick time instead of adding a quantum to it
+* 1.03a	ri	10/16/26	Deterministic simulation clock driven by the bus accesses and idle
+*						loops; the host timer clock is opt-in (paced mode)
+* </pre>
+*
+******************************************************************************/
+
+/***************************** Include Files *********************************/
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hostsim.h"
+#include "xil_io.h"
+#include "xintc.h"
+#include "mb_interface.h"
+
+/************************** Constant Definitions *****************************/
+#define FIT_INTERRUPT_ID	XPAR_MICROBLAZE_0_AXI_INTC_FIT_TIMER_0_INTERRUPT_INTR
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	XInterruptHandler	handler;
+	void				*ref;
+	u64					count;			// number of times the handler was called
+	u64					overruns;		// interrupts raised while the previous one was still pending
+	u64					bus_cycles;		// bus clocks of the accesses made by the handler
+	u64					raised_at;		// simulated time the pending interrupt was raised
+	u64					lat_min;		// latency from raise to handler (clocks)
+	u64					lat_max;
+	u64					lat_sum;
+} hostsim_irq_t;
+
+/************************** Variable Definitions *****************************/
+static volatile u64			sim_cycles;					// simulated time in clocks
+static hostsim_bus_stats_t	bus_stats;
+
+static hostsim_device_t		devices[HOSTSIM_MAX_DEVICES];
+static int					num_devices;
+
+// interrupt controller and Microblaze MSR[IE]
+static hostsim_irq_t		irqs[HOSTSIM_MAX_IRQS];
+static volatile u32			irq_pending;
+static volatile u32			irq_enabled;
+static volatile sig_atomic_t	intc_started;
+static volatile sig_atomic_t	mb_ie;
+static volatile sig_atomic_t	in_model;				// application is inside the model (bus access)
+static volatile sig_atomic_t	in_isr;
+
+// simulation clock
+static timer_t				clock_timer;
+static volatile sig_atomic_t	clock_running;
+static volatile sig_atomic_t	clock_paced;			// paced by the host timer (opt-in)
+static volatile sig_atomic_t	ticks_pending;			// paced: ticks that arrived during a bus access
+static u64					tick_cycles;			// paced: simulated time of the last clock tick
+static u32					clock_quantum = 100;
+static u64					clock_limit;
+static u64					next_fit = HOSTSIM_FIT_PERIOD;
+static u64					next_tick;				// next quantum boundary (scripted events, device polls)
+static u64					watchdog_cycles;		// deterministic: simulated time at the last watchdog check
+
+static hostsim_event_t		events[HOSTSIM_MAX_EVENTS];
+static int					num_events;
+static int					next_event;
+
+/************************** Function Prototypes ******************************/
+static void		service(void);
+static void		irq_raise_at(int id, u64 at);
+static void		irq_take(void);
+static void		clock_signal(int sig);
+static void		watchdog_signal(int sig);
+
+/****************************************************************************/
+/**
+* Returns the simulated time in clocks
+*
+*****************************************************************************/
+u64 hostsim_now(void)
+{
+	return sim_cycles;
+}
+
+
+/****************************************************************************/
+/**
+* Advances simulated time by "cycles" clocks
+*
+*****************************************************************************/
+void hostsim_advance(u64 cycles)
+{
+	sim_cycles += cycles;
+}
+
+
+/****************************************************************************/
+/**
+* Waits until "cycles" clocks of simulated time have passed
+*
+* In paced mode the clock signal advances time; otherwise (deterministic clock or
+* benchmark mode) it is advanced directly and the model is brought up to date.
+*
+*****************************************************************************/
+void hostsim_wait_cycles(u64 cycles)
+{
+	u64 target = hostsim_now() + cycles;
+
+	if (!clock_paced)
+	{
+		hostsim_advance(cycles);
+		if (clock_running)
+		{
+			service();
+		}
+		return;
+	}
+	while (hostsim_now() < target)
+	{
+		// the clock signal advances time
+	}
+}
+
+
+/****************************************************************************/
+/**
+* One pass of a wait loop of the application (WAIT_FOR_INTERRUPT() or SPIN_WAIT(),
+* see idle.h)
+*
+* Nothing the loop can see changes before the next interrupt, which can only be raised
+* at a quantum boundary or a FIT period, so the deterministic clock skips simulated time
+* to the earlier of the two and brings the model up to date.  In paced mode and in
+* benchmark mode it does nothing.
+*
+*****************************************************************************/
+void hostsim_idle(void)
+{
+	u64 target;
+
+	if (!clock_running || clock_paced)
+	{
+		return;
+	}
+	target = (next_tick < next_fit) ? next_tick : next_fit;
+	if (target > hostsim_now())
+	{
+		hostsim_advance(target - hostsim_now());
+	}
+	service();
+}
+
+
+/****************************************************************************/
+/**
+* Adds a memory mapped device to the simulated AXI bus
+*
+*****************************************************************************/
+void hostsim_register_device(const char *name, u32 base, u32 size, hostsim_read_fn read,
+	hostsim_write_fn write, hostsim_poll_fn poll, void *ctx)
+{
+	hostsim_device_t *dev;
+
+	if (num_devices >= HOSTSIM_MAX_DEVICES)
+	{
+		fprintf(stderr, "hostsim: too many devices (%s)\n", name);
+		exit(2);
+	}
+	dev = &devices[num_devices++];
+	memset(dev, 0, sizeof(*dev));
+	dev->name = name;
+	dev->base = base;
+	dev->size = size;
+	dev->read = read;
+	dev->write = write;
+	dev->poll = poll;
+	dev->ctx = ctx;
+}
+
+
+static hostsim_device_t *bus_decode(UINTPTR Addr)
+{
+	int i;
+
+	for (i = 0; i < num_devices; i++)
+	{
+		if ((Addr >= devices[i].base) && (Addr - devices[i].base < devices[i].size))
+		{
+			return &devices[i];
+		}
+	}
+	fprintf(stderr, "hostsim: bus error at 0x%08lx\n", (unsigned long) Addr);
+	exit(2);
+}
+
+
+/****************************************************************************/
+/**
+* Bus accesses made by the application (through Xil_In32()/Xil_Out32())
+*
+* Each access costs simulated time and is counted.  Clock ticks and interrupts
+* that arrive during the access are serviced when it completes.
+*
+*****************************************************************************/
+u32 hostsim_bus_read(UINTPTR Addr)
+{
+	hostsim_device_t	*dev;
+	u32					value;
+
+	in_model = 1;
+	dev = bus_decode(Addr);
+	hostsim_advance(HOSTSIM_BUS_READ_CYCLES);
+	value = dev->read(dev->ctx, Addr - dev->base, hostsim_now());
+	dev->reads++;
+	bus_stats.reads++;
+	bus_stats.cycles += HOSTSIM_BUS_READ_CYCLES;
+	in_model = 0;
+
+	service();
+	return value;
+}
+
+void hostsim_bus_write(UINTPTR Addr, u32 Value)
+{
+	hostsim_device_t	*dev;
+
+	in_model = 1;
+	dev = bus_decode(Addr);
+	hostsim_advance(HOSTSIM_BUS_WRITE_CYCLES);
+	dev->write(dev->ctx, Addr - dev->base, Value, hostsim_now());
+	dev->writes++;
+	bus_stats.writes++;
+	bus_stats.cycles += HOSTSIM_BUS_WRITE_CYCLES;
+	in_model = 0;
+
+	service();
+}
+
+
+/****************************************************************************/
+/**
+* Returns the bus traffic counters
+*
+*****************************************************************************/
+void hostsim_get_bus_stats(hostsim_bus_stats_t *stats)
+{
+	*stats = bus_stats;
+}
+
+void hostsim_report_devices(FILE *fp)
+{
+	int i;
+
+	for (i = 0; i < num_devices; i++)
+	{
+		fprintf(fp, "hostsim:   %-12s 0x%08x  reads %10llu  writes %10llu\n", devices[i].name,
+			devices[i].base, (unsigned long long) devices[i].reads,
+			(unsigned long long) devices[i].writes);
+	}
+}
+
+
+/************************** INTERRUPT CONTROLLER ****************************/
+
+/****************************************************************************/
+/**
+* Raises interrupt "id".  Called by the device models
+*
+*****************************************************************************/
+void hostsim_irq_raise(int id)
+{
+	irq_raise_at(id, hostsim_now());
+}
+
+// raises interrupt "id" that became due at simulated time "at"
+static void irq_raise_at(int id, u64 at)
+{
+	if ((id < 0) || (id >= HOSTSIM_MAX_IRQS))
+	{
+		return;
+	}
+	if (irq_pending & (1u << id))
+	{
+		irqs[id].overruns++;
+	}
+	else
+	{
+		irqs[id].raised_at = at;
+	}
+	irq_pending |= (1u << id);
+}
+
+u64 hostsim_irq_count(int id)
+{
+	return irqs[id].count;
+}
+
+u64 hostsim_irq_overruns(int id)
+{
+	return irqs[id].overruns;
+}
+
+u64 hostsim_irq_cycles(int id)
+{
+	return irqs[id].bus_cycles;
+}
+
+// latency from raising interrupt "id" to calling its handler: min, mean and max (clocks)
+void hostsim_irq_latency(int id, u64 *min, double *mean, u64 *max)
+{
+	*min = (irqs[id].count == 0) ? 0 : irqs[id].lat_min;
+	*mean = (irqs[id].count == 0) ? 0.0 : (double) irqs[id].lat_sum / (double) irqs[id].count;
+	*max = irqs[id].lat_max;
+}
+
+
+// dispatch the pending interrupts with MSR[IE] cleared, lowest ID first
+static void irq_take(void)
+{
+	u32 pending;
+	u64 start, lat;
+	int id;
+
+	in_isr = 1;
+	while ((pending = irq_pending & irq_enabled) != 0)
+	{
+		for (id = 0; (pending & (1u << id)) == 0; id++)
+		{
+			// find the highest priority interrupt
+		}
+		irq_pending &= ~(1u << id);
+		lat = hostsim_now() - irqs[id].raised_at;
+		if ((irqs[id].count == 0) || (lat < irqs[id].lat_min))
+		{
+			irqs[id].lat_min = lat;
+		}
+		if (lat > irqs[id].lat_max)
+		{
+			irqs[id].lat_max = lat;
+		}
+		irqs[id].lat_sum += lat;
+		irqs[id].count++;
+		if (irqs[id].handler != NULL)
+		{
+			start = bus_stats.cycles;
+			irqs[id].handler(irqs[id].ref);
+			irqs[id].bus_cycles += bus_stats.cycles - start;
+		}
+	}
+	in_isr = 0;
+}
+
+
+void microblaze_enable_interrupts(void)
+{
+	mb_ie = 1;
+	service();
+}
+
+void microblaze_disable_interrupts(void)
+{
+	mb_ie = 0;
+}
+
+
+int XIntc_Initialize(XIntc *InstancePtr, u16 DeviceId)
+{
+	if (DeviceId != XPAR_INTC_0_DEVICE_ID)
+	{
+		return XST_DEVICE_NOT_FOUND;
+	}
+	if (InstancePtr->IsStarted == XIL_COMPONENT_IS_STARTED)
+	{
+		return XST_DEVICE_IS_STARTED;
+	}
+	InstancePtr->BaseAddress = XPAR_INTC_0_BASEADDR;
+	InstancePtr->IsStarted = 0;
+	InstancePtr->UnhandledInterrupts = 0;
+	InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+	irq_enabled = 0;
+	return XST_SUCCESS;
+}
+
+int XIntc_Start(XIntc *InstancePtr, u8 Mode)
+{
+	(void) Mode;
+	InstancePtr->IsStarted = XIL_COMPONENT_IS_STARTED;
+	intc_started = 1;
+	return XST_SUCCESS;
+}
+
+void XIntc_Stop(XIntc *InstancePtr)
+{
+	InstancePtr->IsStarted = 0;
+	intc_started = 0;
+}
+
+int XIntc_Connect(XIntc *InstancePtr, u8 Id, XInterruptHandler Handler, void *CallBackRef)
+{
+	(void) InstancePtr;
+	if (Id >= HOSTSIM_MAX_IRQS)
+	{
+		return XST_INVALID_PARAM;
+	}
+	irqs[Id].handler = Handler;
+	irqs[Id].ref = CallBackRef;
+	return XST_SUCCESS;
+}
+
+void XIntc_Disconnect(XIntc *InstancePtr, u8 Id)
+{
+	XIntc_Disable(InstancePtr, Id);
+	irqs[Id].handler = NULL;
+	irqs[Id].ref = NULL;
+}
+
+void XIntc_Enable(XIntc *InstancePtr, u8 Id)
+{
+	(void) InstancePtr;
+	irq_enabled |= (1u << Id);
+}
+
+void XIntc_Disable(XIntc *InstancePtr, u8 Id)
+{
+	(void) InstancePtr;
+	irq_enabled &= ~(1u << Id);
+}
+
+void XIntc_Acknowledge(XIntc *InstancePtr, u8 Id)
+{
+	(void) InstancePtr;
+	irq_pending &= ~(1u << Id);
+}
+
+
+/**************************** SIMULATION CLOCK ******************************/
+
+/****************************************************************************/
+/**
+* Brings the model up to the current simulated time
+*
+* In paced mode adds the clock ticks that arrived during bus accesses first.  At
+* a quantum boundary applies the scripted events and lets the devices raise
+* their interrupts, then fires the FIT interrupt for every FIT period that has
+* passed and takes the interrupts if the processor will accept them.  Runs on
+* the application thread at the end of a bus access or an idle loop pass, and
+* in paced mode from the clock signal.
+*
+*****************************************************************************/
+static void service(void)
+{
+	sig_atomic_t	ticks;
+	u64				now;
+	int				i;
+
+	in_model = 1;
+	if (clock_paced)
+	{
+		ticks = ticks_pending;
+		ticks_pending = 0;
+		tick_cycles += (u64) ticks * clock_quantum;
+		if (tick_cycles > hostsim_now())
+		{
+			hostsim_advance(tick_cycles - hostsim_now());
+		}
+	}
+	now = hostsim_now();
+
+	if (now >= next_tick)
+	{
+		next_tick += ((now - next_tick) / clock_quantum + 1) * clock_quantum;
+		while ((next_event < num_events) && (events[next_event].at <= now))
+		{
+			hostsim_boardio_apply(&events[next_event++]);
+		}
+		for (i = 0; i < num_devices; i++)
+		{
+			if (devices[i].poll != NULL)
+			{
+				devices[i].poll(devices[i].ctx, now);
+			}
+		}
+	}
+	while (now >= next_fit)
+	{
+		irq_raise_at(FIT_INTERRUPT_ID, next_fit);
+		next_fit += HOSTSIM_FIT_PERIOD;
+	}
+	in_model = 0;
+
+	if ((clock_limit != 0) && (now >= clock_limit) && clock_running)
+	{
+		fprintf(stderr, "hostsim: simulated time limit reached\n");
+		exit(2);
+	}
+	if (intc_started && mb_ie && !in_isr && (irq_pending & irq_enabled))
+	{
+		irq_take();
+	}
+}
+
+
+// the clock signal (paced mode) - one quantum of simulated time has passed
+static void clock_signal(int sig)
+{
+	(void) sig;
+	ticks_pending++;
+	if (!in_model)
+	{
+		service();
+	}
+}
+
+
+// the watchdog signal (deterministic clock) - simulated time must have moved since the
+// last one, or the application spins without bus accesses or idle loops and never will
+static void watchdog_signal(int sig)
+{
+	static const char	msg[] = "hostsim: simulated time stopped - the application loops without "
+							"bus accesses or WAIT_FOR_INTERRUPT()/SPIN_WAIT() (see idle.h)\n";
+
+	(void) sig;
+	if (sim_cycles == watchdog_cycles)
+	{
+		if (write(STDERR_FILENO, msg, sizeof(msg) - 1) < 0)
+		{
+			// nothing else to do
+		}
+		_exit(2);
+	}
+	watchdog_cycles = sim_cycles;
+}
+
+
+/****************************************************************************/
+/**
+* Initializes the model and registers the devices
+*
+*****************************************************************************/
+void hostsim_init(void)
+{
+	hostsim_tmrctr_init();
+	hostsim_gpio_init();
+	hostsim_hwdetect_init();
+	hostsim_boardio_init();
+	hostsim_uartlite_init();
+}
+
+
+/****************************************************************************/
+/**
+* Queues a scripted input event.  Events must be added in time order
+*
+*****************************************************************************/
+bool hostsim_add_event(u64 at, hostsim_event_kind_t kind, s32 value)
+{
+	if (num_events >= HOSTSIM_MAX_EVENTS)
+	{
+		return false;
+	}
+	events[num_events].at = at;
+	events[num_events].kind = kind;
+	events[num_events].value = value;
+	num_events++;
+	return true;
+}
+
+
+/****************************************************************************/
+/**
+* Starts the simulation clock
+*
+* @param	quantum is the number of clocks between the scripted event and device
+*			poll boundaries (and, in paced mode, that a tick advances)
+* @param	ns_per_tick is 0 for the deterministic clock, or the host time between
+*			ticks of the paced clock
+* @param	limit is the simulated time (in clocks) at which the simulation is aborted (0 = none)
+*
+*****************************************************************************/
+void hostsim_clock_start(u32 quantum, long ns_per_tick, u64 limit)
+{
+	struct sigaction	sa;
+	struct sigevent		sev;
+	struct itimerspec	its;
+
+	clock_quantum = (quantum == 0) ? HOSTSIM_FIT_PERIOD : quantum;
+	clock_limit = limit;
+	clock_paced = (ns_per_tick != 0);
+	next_tick = hostsim_now() + clock_quantum;
+	watchdog_cycles = hostsim_now();
+
+	// the deterministic clock only needs the host timer for its watchdog (every 5s)
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = clock_paced ? clock_signal : watchdog_signal;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGALRM, &sa, NULL);
+
+	memset(&sev, 0, sizeof(sev));
+	sev.sigev_notify = SIGEV_SIGNAL;
+	sev.sigev_signo = SIGALRM;
+	if (timer_create(CLOCK_MONOTONIC, &sev, &clock_timer) != 0)
+	{
+		perror("hostsim: timer_create");
+		exit(2);
+	}
+
+	its.it_value.tv_sec = clock_paced ? (ns_per_tick / 1000000000) : 5;
+	its.it_value.tv_nsec = clock_paced ? (ns_per_tick % 1000000000) : 0;
+	its.it_interval = its.it_value;
+	clock_running = 1;
+	timer_settime(clock_timer, 0, &its, NULL);
+
+	// start the clock at the current time
+	service();
+}
+
+void hostsim_clock_stop(void)
+{
+	struct itimerspec its;
+
+	if (!clock_running)
+	{
+		return;
+	}
+	memset(&its, 0, sizeof(its));
+	timer_settime(clock_timer, 0, &its, NULL);
+	timer_delete(clock_timer);
+	clock_running = 0;
+}
@@ -0,0 +1,170 @@
+/**
+*
+* @file hostsim.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions and function prototypes for the host simulation
+* model (hostsim).  hostsim lets testpwm.c and pwm_tmrctr.c run unmodified on a Linux build box.
+* The Xilinx BSP and custom peripheral headers in hostsim/include route every register access
+* through hostsim_bus_read()/hostsim_bus_write() to an in-memory model of the ECE 544 Project #1
+* embedded system:
+*
+*	o	simulated time in AXI clock cycles.  It is advanced by the cost of every bus access
+*		made by the application and skipped ahead by its wait loops (WAIT_FOR_INTERRUPT(), SPIN_WAIT()), so runs are
+*		deterministic.  A periodic host timer (paced mode, opt-in) can advance it instead;
+*		every tick moves it to the tick time if it is behind
+*	o	an axi_timer model that produces the PWM waveform from TCSR/TLR and a second
+*		axi_timer that captures its edges
+*	o	a hw_detect model that measures that waveform and drives GPIO_1
+*	o	axi_gpio, Nexys4IO, PMod544IOR2 (encoder + HD44780 LCD) and UART-Lite models
+*	o	an interrupt controller model.  The FIT interrupt fires every FIT_PERIOD cycles and
+*		preempts the application between two bus accesses (or, in paced mode, from the
+*		clock signal), just like the Microblaze interrupt
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of the host simulation model
+* </pre>
+*
+******************************************************************************/
+
+#ifndef HOSTSIM_H		/* prevent circular inclusions */
+#define HOSTSIM_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include "xil_types.h"
+#include "xparameters.h"
+
+/************************** Constant Definitions *****************************/
+#define HOSTSIM_CLOCK_FREQ_HZ		XPAR_CPU_CORE_CLOCK_FREQ_HZ
+#define HOSTSIM_FIT_FREQ_HZ			40000
+#define HOSTSIM_FIT_PERIOD			(HOSTSIM_CLOCK_FREQ_HZ / HOSTSIM_FIT_FREQ_HZ)
+
+// cost of one Microblaze M_AXI_DP access through the AXI-Lite crossbar (in clocks)
+#define HOSTSIM_BUS_READ_CYCLES		12
+#define HOSTSIM_BUS_WRITE_CYCLES	8
+
+// HD44780 execution times (in clocks)
+#define HOSTSIM_LCD_CHAR_CYCLES		3700		// 37us for most commands and data
+#define HOSTSIM_LCD_CLEAR_CYCLES	152000		// 1.52ms for clear display and return home
+
+#define HOSTSIM_MAX_DEVICES			16
+#define HOSTSIM_MAX_IRQS			32
+#define HOSTSIM_MAX_EVENTS			64
+
+#define HOSTSIM_LCD_ROWS			2
+#define HOSTSIM_LCD_COLS			16
+
+/**************************** Type Definitions *******************************/
+typedef u32 (*hostsim_read_fn)(void *ctx, u32 offset, u64 now);
+typedef void (*hostsim_write_fn)(void *ctx, u32 offset, u32 value, u64 now);
+typedef void (*hostsim_poll_fn)(void *ctx, u64 now);
+
+// Device models are only called from the application's thread, either for a bus access or
+// from the simulation clock (which never runs in the middle of a bus access), so they need
+// no locking.
+
+// a memory mapped device on the simulated AXI bus
+typedef struct {
+	const char			*name;			// device name used in reports
+	u32					base;			// base address
+	u32					size;			// size of the address window
+	hostsim_read_fn		read;			// register read handler
+	hostsim_write_fn	write;			// register write handler
+	hostsim_poll_fn		poll;			// called every quantum by the simulation clock (optional)
+	void				*ctx;			// device model
+	u64					reads;			// number of bus reads
+	u64					writes;			// number of bus writes
+} hostsim_device_t;
+
+// scripted input events applied by the simulation clock
+typedef enum {
+	HOSTSIM_EV_SWITCHES,				// set the Nexys4 slide switches
+	HOSTSIM_EV_BUTTONS,					// set the Nexys4 pushbuttons
+	HOSTSIM_EV_ROTARY,					// turn the encoder to an absolute detent position
+	HOSTSIM_EV_ROTBTN					// press (1) or release (0) the encoder pushbutton
+} hostsim_event_kind_t;
+
+typedef struct {
+	u64						at;			// simulated time (in clocks)
+	hostsim_event_kind_t	kind;
+	s32						value;
+} hostsim_event_t;
+
+// PWM waveform observer.  Called with the start time, period and high time (in clocks) of
+// every run of identical periods; period 0 means the PWM was stopped at that time
+typedef void (*hostsim_pwm_watch_fn)(void *ref, u64 t, u64 period, u64 high);
+
+// bus traffic counters
+typedef struct {
+	u64		reads;
+	u64		writes;
+	u64		cycles;						// clocks spent on the bus
+} hostsim_bus_stats_t;
+
+/************************** Function Prototypes ******************************/
+// simulated time
+u64		hostsim_now(void);
+void	hostsim_advance(u64 cycles);
+void	hostsim_wait_cycles(u64 cycles);
+void	hostsim_idle(void);
+
+// bus and devices
+void	hostsim_register_device(const char *name, u32 base, u32 size, hostsim_read_fn read,
+			hostsim_write_fn write, hostsim_poll_fn poll, void *ctx);
+void	hostsim_get_bus_stats(hostsim_bus_stats_t *stats);
+void	hostsim_report_devices(FILE *fp);
+
+// interrupt controller
+void	hostsim_irq_raise(int id);
+u64		hostsim_irq_count(int id);
+u64		hostsim_irq_overruns(int id);
+u64		hostsim_irq_cycles(int id);
+void	hostsim_irq_latency(int id, u64 *min, double *mean, u64 *max);
+
+// simulation clock
+void	hostsim_init(void);
+void	hostsim_clock_start(u32 quantum, long ns_per_tick, u64 limit);
+void	hostsim_clock_stop(void);
+bool	hostsim_add_event(u64 at, hostsim_event_kind_t kind, s32 value);
+
+// device models (hostsim_tmrctr.c, hostsim_gpio.c, hostsim_hwdetect.c, hostsim_boardio.c, hostsim_uartlite.c)
+void	hostsim_tmrctr_init(void);
+bool	hostsim_pwm_level(int dev, u64 now);
+void	hostsim_pwm_period(int dev, u64 now, u64 *high, u64 *low, u64 *rises);
+u64		hostsim_pwm_rises(int dev, u64 now, u64 t);
+void	hostsim_pwm_watch(int dev, hostsim_pwm_watch_fn fn, void *ref);
+
+void	hostsim_gpio_init(void);
+void	hostsim_hwdetect_init(void);
+u32		hostsim_hwdetect_read(int channel, u64 now);
+void	hostsim_hwdetect_control(u32 value, u64 now);
+u32		hostsim_hwstats_read(u64 now);
+void	hostsim_hwstats_control(u32 value, u64 now);
+
+void	hostsim_boardio_init(void);
+void	hostsim_boardio_apply(const hostsim_event_t *ev);
+void	hostsim_boardio_report(FILE *fp);
+const char *hostsim_lcd_line(int row);
+u64		hostsim_lcd_bytes(void);
+
+void	hostsim_uartlite_init(void);
+void	hostsim_uartlite_capture(FILE *fp);
+u64		hostsim_uartlite_bytes(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,513 @@
+/**
+*
+* @file hostsim_boardio.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements the host simulation models of the Nexys4IO and PMod544IOR2 custom
+* peripherals and the driver functions the applications call.  The drivers work through
+* register reads and writes so the bus traffic they generate is counted like every other
+* access.  The PmodCLP model follows the HD44780 timing: each command or character keeps
+* the controller busy for 37us (1.52ms for a clear) and the driver polls the busy flag
+* before every write, the same way the real driver does.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of the host simulation model
+* </pre>
+*
+******************************************************************************/
+
+/***************************** Include Files *********************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "hostsim.h"
+#include "Nexys4IO.h"
+#include "PMod544IOR2.h"
+
+/************************** Constant Definitions *****************************/
+#define BOARDIO_WINDOW		0x10000
+
+#define NX4IO_BASE			XPAR_NEXYS4IO_0_S00_AXI_BASEADDR
+#define PMDIO_BASE			XPAR_PMOD544IOR2_0_S00_AXI_BASEADDR
+
+#define LCD_CMD_CLEAR		0x01
+#define LCD_CMD_SET_DDRAM	0x80
+#define LCD_ROW2_ADDR		0x40
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	u16		sw;						// slide switches
+	u8		btns;					// pushbuttons
+	u32		leds;
+	u32		sseg[2];				// SSEGLO, SSEGHI digit registers
+	u32		rgb_data[2];
+	u32		rgb_cntrl[2];
+	u64		rgb_cntrl_writes;
+} hostsim_nx4io_t;
+
+typedef struct {
+	// PmodENC
+	s32		rot_pos;				// encoder position in detents
+	s32		rot_cnt;				// count register
+	u32		rot_cntrl;				// increment and no-negative flag
+	bool	rot_btn;
+
+	// PmodCLP
+	char	ddram[HOSTSIM_LCD_ROWS][HOSTSIM_LCD_COLS + 1];
+	u32		addr;					// DDRAM address counter
+	u64		busy_until;
+	u64		bytes;					// commands + characters written to the LCD
+	u64		overruns;				// writes while the LCD was busy
+} hostsim_pmdio_t;
+
+/************************** Variable Definitions *****************************/
+static hostsim_nx4io_t	nx4io;
+static hostsim_pmdio_t	pmdio;
+
+/******************************* NEXYS4IO ***********************************/
+
+static u32 nx4io_read(void *ctx, u32 offset, u64 now)
+{
+	hostsim_nx4io_t *nx = (hostsim_nx4io_t *) ctx;
+
+	(void) now;
+	switch (offset)
+	{
+		case NEXYS4IO_BTNSW_IN_OFFSET:		return ((u32) nx->btns << 16) | nx->sw;
+		case NEXYS4IO_LEDS_OFFSET:			return nx->leds;
+		case NEXYS4IO_DIGITS_LO_OFFSET:		return nx->sseg[SSEGLO];
+		case NEXYS4IO_DIGITS_HI_OFFSET:		return nx->sseg[SSEGHI];
+		case NEXYS4IO_RGB1_DATA_OFFSET:		return nx->rgb_data[RGB1];
+		case NEXYS4IO_RGB2_DATA_OFFSET:		return nx->rgb_data[RGB2];
+		case NEXYS4IO_RGB1_CNTRL_OFFSET:	return nx->rgb_cntrl[RGB1];
+		case NEXYS4IO_RGB2_CNTRL_OFFSET:	return nx->rgb_cntrl[RGB2];
+		default:							return 0;
+	}
+}
+
+static void nx4io_write(void *ctx, u32 offset, u32 value, u64 now)
+{
+	hostsim_nx4io_t *nx = (hostsim_nx4io_t *) ctx;
+
+	(void) now;
+	switch (offset)
+	{
+		case NEXYS4IO_LEDS_OFFSET:			nx->leds = value & 0xFFFF;					break;
+		case NEXYS4IO_DIGITS_LO_OFFSET:		nx->sseg[SSEGLO] = value & 0x0FFFFFFF;		break;
+		case NEXYS4IO_DIGITS_HI_OFFSET:		nx->sseg[SSEGHI] = value & 0x0FFFFFFF;		break;
+		case NEXYS4IO_RGB1_DATA_OFFSET:		nx->rgb_data[RGB1] = value & 0x00FFFFFF;	break;
+		case NEXYS4IO_RGB2_DATA_OFFSET:		nx->rgb_data[RGB2] = value & 0x00FFFFFF;	break;
+		case NEXYS4IO_RGB1_CNTRL_OFFSET:	nx->rgb_cntrl[RGB1] = value & 0x7;	nx->rgb_cntrl_writes++;	break;
+		case NEXYS4IO_RGB2_CNTRL_OFFSET:	nx->rgb_cntrl[RGB2] = value & 0x7;	nx->rgb_cntrl_writes++;	break;
+		default:																		break;
+	}
+}
+
+
+/******************************* PMOD544IOR2 ********************************/
+
+static void lcd_command(hostsim_pmdio_t *pm, u32 cmd, u64 now)
+{
+	if (cmd == LCD_CMD_CLEAR)
+	{
+		memset(pm->ddram, ' ', sizeof(pm->ddram));
+		pm->ddram[0][HOSTSIM_LCD_COLS] = '\0';
+		pm->ddram[1][HOSTSIM_LCD_COLS] = '\0';
+		pm->addr = 0;
+		pm->busy_until = now + HOSTSIM_LCD_CLEAR_CYCLES;
+	}
+	else
+	{
+		if (cmd & LCD_CMD_SET_DDRAM)
+		{
+			pm->addr = cmd & 0x7F;
+		}
+		pm->busy_until = now + HOSTSIM_LCD_CHAR_CYCLES;
+	}
+}
+
+static void lcd_data(hostsim_pmdio_t *pm, u32 ch, u64 now)
+{
+	u32 row = (pm->addr >= LCD_ROW2_ADDR) ? 1 : 0;
+	u32 col = pm->addr - (row * LCD_ROW2_ADDR);
+
+	if (col < HOSTSIM_LCD_COLS)
+	{
+		pm->ddram[row][col] = (char) ch;
+	}
+	pm->addr = (pm->addr + 1) & 0x7F;
+	pm->busy_until = now + HOSTSIM_LCD_CHAR_CYCLES;
+}
+
+static u32 pmdio_read(void *ctx, u32 offset, u64 now)
+{
+	hostsim_pmdio_t *pm = (hostsim_pmdio_t *) ctx;
+
+	switch (offset)
+	{
+		case PMDIO_ROTLCD_STS_OFFSET:
+			return (pm->rot_btn ? PMDIO_STS_ROTBTN_MASK : 0) |
+				((now < pm->busy_until) ? PMDIO_STS_LCDBUSY_MASK : 0);
+		case PMDIO_ROT_CNT_OFFSET:		return (u32) pm->rot_cnt;
+		case PMDIO_ROT_CNTRL_OFFSET:	return pm->rot_cntrl;
+		default:						return 0;
+	}
+}
+
+static void pmdio_write(void *ctx, u32 offset, u32 value, u64 now)
+{
+	hostsim_pmdio_t *pm = (hostsim_pmdio_t *) ctx;
+
+	switch (offset)
+	{
+		case PMDIO_ROT_CNTRL_OFFSET:
+			if (value & PMDIO_ROT_CLEAR_MASK)
+			{
+				pm->rot_cnt = 0;
+			}
+			pm->rot_cntrl = value & ~PMDIO_ROT_CLEAR_MASK;
+			break;
+
+		case PMDIO_LCD_CMD_OFFSET:
+		case PMDIO_LCD_DATA_OFFSET:
+			if (now < pm->busy_until)
+			{
+				pm->overruns++;
+			}
+			pm->bytes++;
+			if (offset == PMDIO_LCD_CMD_OFFSET)
+			{
+				lcd_command(pm, value, now);
+			}
+			else
+			{
+				lcd_data(pm, value, now);
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+
+/****************************************************************************/
+/**
+* Registers the Nexys4IO and PMod544IOR2 models on the bus
+*
+*****************************************************************************/
+void hostsim_boardio_init(void)
+{
+	memset(&nx4io, 0, sizeof(nx4io));
+	memset(&pmdio, 0, sizeof(pmdio));
+	lcd_command(&pmdio, LCD_CMD_CLEAR, 0);
+	pmdio.busy_until = 0;
+	pmdio.rot_cntrl = 1;
+
+	hostsim_register_device("nexys4io", NX4IO_BASE, BOARDIO_WINDOW, nx4io_read, nx4io_write,
+		NULL, &nx4io);
+	hostsim_register_device("pmod544ior2", PMDIO_BASE, BOARDIO_WINDOW, pmdio_read, pmdio_write,
+		NULL, &pmdio);
+}
+
+
+/****************************************************************************/
+/**
+* Applies a scripted input event.  Called by the simulation clock
+*
+*****************************************************************************/
+void hostsim_boardio_apply(const hostsim_event_t *ev)
+{
+	s32 incr = (s32) (pmdio.rot_cntrl & 0xFFFF);
+	s32 step;
+
+	switch (ev->kind)
+	{
+		case HOSTSIM_EV_SWITCHES:
+			nx4io.sw = (u16) ev->value;
+			break;
+
+		case HOSTSIM_EV_BUTTONS:
+			nx4io.btns = (u8) ev->value;
+			break;
+
+		case HOSTSIM_EV_ROTARY:
+			// the encoder counts one detent at a time
+			while (pmdio.rot_pos != ev->value)
+			{
+				step = (ev->value > pmdio.rot_pos) ? 1 : -1;
+				pmdio.rot_pos += step;
+				pmdio.rot_cnt += step * incr;
+				if ((pmdio.rot_cntrl & PMDIO_ROT_NONEG_MASK) && (pmdio.rot_cnt < 0))
+				{
+					pmdio.rot_cnt = 0;
+				}
+			}
+			break;
+
+		case HOSTSIM_EV_ROTBTN:
+			pmdio.rot_btn = (ev->value != 0);
+			break;
+	}
+}
+
+
+/****************************************************************************/
+/**
+* Reporting
+*
+*****************************************************************************/
+const char *hostsim_lcd_line(int row)
+{
+	return pmdio.ddram[row];
+}
+
+u64 hostsim_lcd_bytes(void)
+{
+	return pmdio.bytes;
+}
+
+static char sseg_char(u32 cc)
+{
+	static const char cc_chars[] = "0123456789AbCdEFyHLRlr ";
+
+	return (cc < sizeof(cc_chars) - 1) ? cc_chars[cc] : ' ';
+}
+
+void hostsim_boardio_report(FILE *fp)
+{
+	char	sseg[9];
+	int		d;
+
+	for (d = 0; d < 4; d++)
+	{
+		sseg[3 - d] = sseg_char((nx4io.sseg[SSEGHI] >> (5 * d)) & 0x1F);
+		sseg[7 - d] = sseg_char((nx4io.sseg[SSEGLO] >> (5 * d)) & 0x1F);
+	}
+	sseg[8] = '\0';
+
+	fprintf(fp, "hostsim: LCD   |%s|\n", pmdio.ddram[0]);
+	fprintf(fp, "hostsim:       |%s|\n", pmdio.ddram[1]);
+	fprintf(fp, "hostsim: LCD bytes %llu (%llu written while busy)\n",
+		(unsigned long long) pmdio.bytes, (unsigned long long) pmdio.overruns);
+	fprintf(fp, "hostsim: LEDs 0x%04x  SSEG [%s]  RGB1 enable writes %llu\n", nx4io.leds, sseg,
+		(unsigned long long) nx4io.rgb_cntrl_writes);
+}
+
+
+/***************************** NEXYS4IO DRIVER ******************************/
+
+int NX4IO_initialize(u32 BaseAddress)
+{
+	return (BaseAddress == NX4IO_BASE) ? XST_SUCCESS : XST_FAILURE;
+}
+
+u16 NX4IO_getSwitches(void)
+{
+	return (u16) (Xil_In32(NX4IO_BASE + NEXYS4IO_BTNSW_IN_OFFSET) & 0xFFFF);
+}
+
+u8 NX4IO_getBtns(void)
+{
+	return (u8) ((Xil_In32(NX4IO_BASE + NEXYS4IO_BTNSW_IN_OFFSET) >> 16) & 0x1F);
+}
+
+bool NX4IO_isPressed(u8 btn)
+{
+	return (NX4IO_getBtns() & btn) != 0;
+}
+
+void NX4IO_setLEDs(u32 ledvalue)
+{
+	Xil_Out32(NX4IO_BASE + NEXYS4IO_LEDS_OFFSET, ledvalue);
+}
+
+void NX4IO_RGBLED_setRGB_DATA(u8 RGBsel, u32 data)
+{
+	Xil_Out32(NX4IO_BASE + ((RGBsel == RGB1) ? NEXYS4IO_RGB1_DATA_OFFSET : NEXYS4IO_RGB2_DATA_OFFSET), data);
+}
+
+void NX4IO_RGBLED_setRGB_CNTRL(u8 RGBsel, u32 data)
+{
+	Xil_Out32(NX4IO_BASE + ((RGBsel == RGB1) ? NEXYS4IO_RGB1_CNTRL_OFFSET : NEXYS4IO_RGB2_CNTRL_OFFSET), data);
+}
+
+void NX4IO_RGBLED_setDutyCycle(u8 RGBsel, u8 red, u8 green, u8 blue)
+{
+	NX4IO_RGBLED_setRGB_DATA(RGBsel, ((u32) red << 16) | ((u32) green << 8) | blue);
+}
+
+void NX4IO_RGBLED_setChnlEn(u8 RGBsel, bool red, bool green, bool blue)
+{
+	NX4IO_RGBLED_setRGB_CNTRL(RGBsel, (red ? 0x4 : 0) | (green ? 0x2 : 0) | (blue ? 0x1 : 0));
+}
+
+u32 NX4IO_SSEG_getSSEG_DATA(u8 digits)
+{
+	return Xil_In32(NX4IO_BASE + ((digits == SSEGLO) ? NEXYS4IO_DIGITS_LO_OFFSET : NEXYS4IO_DIGITS_HI_OFFSET));
+}
+
+void NX4IO_SSEG_setSSEG_DATA(u8 digits, u32 data)
+{
+	Xil_Out32(NX4IO_BASE + ((digits == SSEGLO) ? NEXYS4IO_DIGITS_LO_OFFSET : NEXYS4IO_DIGITS_HI_OFFSET), data);
+}
+
+void NX4IO_SSEG_setDigit(u8 digits, u8 digit, u8 charcode)
+{
+	u8	bank = (digit >= DIGIT4) ? SSEGHI : SSEGLO;
+	u32	shift = 5 * (digit & 0x3);
+	u32	data;
+
+	(void) digits;
+	data = NX4IO_SSEG_getSSEG_DATA(bank) & ~(0x1Fu << shift);
+	NX4IO_SSEG_setSSEG_DATA(bank, data | ((u32) (charcode & 0x1F) << shift));
+}
+
+void NX4IO_SSEG_setDecPt(u8 digits, u8 decpt, bool on)
+{
+	u8	bank = (decpt >= DIGIT4) ? SSEGHI : SSEGLO;
+	u32	mask = 1u << (24 + (decpt & 0x3));
+	u32	data;
+
+	(void) digits;
+	data = NX4IO_SSEG_getSSEG_DATA(bank);
+	NX4IO_SSEG_setSSEG_DATA(bank, on ? (data | mask) : (data & ~mask));
+}
+
+void NX410_SSEG_setAllDigits(u8 digits, u8 dig3, u8 dig2, u8 dig1, u8 dig0, u8 decpts)
+{
+	NX4IO_SSEG_setSSEG_DATA(digits, (u32) (dig0 & 0x1F) | ((u32) (dig1 & 0x1F) << 5) |
+		((u32) (dig2 & 0x1F) << 10) | ((u32) (dig3 & 0x1F) << 15) | ((u32) (decpts & 0xF) << 24));
+}
+
+void NX4IO_SSEG_putU16Hex(u8 digits, u16 value)
+{
+	NX410_SSEG_setAllDigits(digits, (value >> 12) & 0xF, (value >> 8) & 0xF, (value >> 4) & 0xF,
+		value & 0xF, DP_NONE);
+}
+
+void NX4IO_SSEG_putU32Hex(u32 value)
+{
+	NX4IO_SSEG_putU16Hex(SSEGHI, (u16) (value >> 16));
+	NX4IO_SSEG_putU16Hex(SSEGLO, (u16) value);
+}
+
+void NX4IO_SSEG_putU32Dec(u32 value, bool blank)
+{
+	u8	dig[8];
+	int	i;
+
+	for (i = 0; i < 8; i++)
+	{
+		dig[i] = (blank && (value == 0) && (i > 0)) ? CC_BLANK : (u8) (value % 10);
+		value /= 10;
+	}
+	NX410_SSEG_setAllDigits(SSEGHI, dig[7], dig[6], dig[5], dig[4], DP_NONE);
+	NX410_SSEG_setAllDigits(SSEGLO, dig[3], dig[2], dig[1], dig[0], DP_NONE);
+}
+
+
+/**************************** PMOD544IOR2 DRIVER ****************************/
+
+static void lcd_wait(void)
+{
+	while (Xil_In32(PMDIO_BASE + PMDIO_ROTLCD_STS_OFFSET) & PMDIO_STS_LCDBUSY_MASK)
+	{
+		// wait for the HD44780 to finish the last command
+	}
+}
+
+int PMDIO_initialize(u32 BaseAddress)
+{
+	if (BaseAddress != PMDIO_BASE)
+	{
+		return XST_FAILURE;
+	}
+	PMDIO_LCD_clrd();
+	return XST_SUCCESS;
+}
+
+void PMDIO_ROT_init(int inc_dec_cnt, bool no_neg)
+{
+	Xil_Out32(PMDIO_BASE + PMDIO_ROT_CNTRL_OFFSET, (inc_dec_cnt & 0xFFFF) | (no_neg ? PMDIO_ROT_NONEG_MASK : 0));
+}
+
+void PMDIO_ROT_clear(void)
+{
+	u32 cntrl = Xil_In32(PMDIO_BASE + PMDIO_ROT_CNTRL_OFFSET);
+
+	Xil_Out32(PMDIO_BASE + PMDIO_ROT_CNTRL_OFFSET, cntrl | PMDIO_ROT_CLEAR_MASK);
+}
+
+void PMDIO_ROT_readRotcnt(int *RotaryCnt)
+{
+	*RotaryCnt = (int) Xil_In32(PMDIO_BASE + PMDIO_ROT_CNT_OFFSET);
+}
+
+bool PMDIO_ROT_isBtnPressed(void)
+{
+	return (Xil_In32(PMDIO_BASE + PMDIO_ROTLCD_STS_OFFSET) & PMDIO_STS_ROTBTN_MASK) != 0;
+}
+
+bool PMDIO_ROT_isSwOn(void)
+{
+	return (Xil_In32(PMDIO_BASE + PMDIO_ROTLCD_STS_OFFSET) & PMDIO_STS_ROTSW_MASK) != 0;
+}
+
+void PMDIO_LCD_clrd(void)
+{
+	lcd_wait();
+	Xil_Out32(PMDIO_BASE + PMDIO_LCD_CMD_OFFSET, LCD_CMD_CLEAR);
+}
+
+void PMDIO_LCD_setcursor(u32 row, u32 col)
+{
+	lcd_wait();
+	Xil_Out32(PMDIO_BASE + PMDIO_LCD_CMD_OFFSET,
+		LCD_CMD_SET_DDRAM | (((row <= 1) ? 0 : LCD_ROW2_ADDR) + (col & 0x3F)));
+}
+
+void PMDIO_LCD_wrchar(char ch)
+{
+	lcd_wait();
+	Xil_Out32(PMDIO_BASE + PMDIO_LCD_DATA_OFFSET, (u8) ch);
+}
+
+void PMDIO_LCD_wrstring(char *s)
+{
+	while (*s != '\0')
+	{
+		PMDIO_LCD_wrchar(*s++);
+	}
+}
+
+void PMDIO_LCD_putnum(s32 num, s32 radix)
+{
+	char	buf[34];
+	char	*p = &buf[sizeof(buf) - 1];
+	bool	neg = (num < 0) && (radix == 10);
+	u32		n = neg ? (u32) -num : (u32) num;
+
+	*p = '\0';
+	do
+	{
+		*--p = "0123456789ABCDEF"[n % (u32) radix];
+		n /= (u32) radix;
+	} while (n != 0);
+	if (neg)
+	{
+		*--p = '-';
+	}
+	PMDIO_LCD_wrstring(p);
+}
+
+void PMDIO_LCD_puthex(u32 num)
+{
+	PMDIO_LCD_putnum((s32) num, 16);
+}
@@ -0,0 +1,268 @@
+/**
+*
+* @file hostsim_gpio.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements the host simulation model of the three axi_gpio instances in the
+* ECE 544 Project #1 system and the subset of the Xilinx gpio driver used by the
+* applications.  The inputs are wired the same way as in n4fpga.v:
+*
+*	o	GPIO_0 channel 1 bit[0] = pwm0 from the axi_timer (fed back for software detection)
+*	o	GPIO_0 channel 2 bit[0] = clkfit output (not connected to anything in the model)
+*	o	GPIO_0 channel 2 bits[7:4] = hw_detect accumulation exponent, bit[1] = hw_detect gate_sel
+*	o	GPIO_1 channel 1 = hw_detect high_count
+*	o	GPIO_1 channel 2 = hw_detect low_count
+*	o	GPIO_2 channel 1 = hw_detect stats_cmd (output), channel 2 = hw_detect stats_data
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of the host simulation model
+* 1.01a	ri	10/16/26	GPIO_0 outputs drive the hw_detect control inputs
+* 1.02a	ri	10/16/26	GPIO_2 for the hw_detect statistics unit
+* </pre>
+*
+******************************************************************************/
+
+/***************************** Include Files *********************************/
+#include <string.h>
+
+#include "hostsim.h"
+#include "xgpio.h"
+
+/************************** Constant Definitions *****************************/
+#define NUM_GPIOS		XPAR_XGPIO_NUM_INSTANCES
+#define GPIO_WINDOW		0x10000
+
+/**************************** Type Definitions *******************************/
+typedef u32 (*gpio_input_fn)(int channel, u64 now);
+typedef void (*gpio_output_fn)(int channel, u32 value, u64 now);
+
+typedef struct {
+	u32				data[2];		// output latches
+	u32				tri[2];			// direction (1 = input)
+	u32				gie;			// global interrupt enable
+	u32				ier;			// interrupt enables
+	u32				isr;			// interrupt status
+	u32				last_in[2];		// inputs at the last poll (for change interrupts)
+	gpio_input_fn	input;			// hardware driving the inputs
+	gpio_output_fn	output;			// hardware driven by the outputs (optional)
+	int				irq_id;
+} hostsim_gpio_t;
+
+/************************** Variable Definitions *****************************/
+static hostsim_gpio_t	gpios[NUM_GPIOS];
+static const u32		gpio_base[NUM_GPIOS] = { XPAR_AXI_GPIO_0_BASEADDR, XPAR_AXI_GPIO_1_BASEADDR,
+							XPAR_AXI_GPIO_2_BASEADDR };
+
+/****************************************************************************/
+/**
+* Hardware connected to the GPIO inputs
+*
+*****************************************************************************/
+static u32 gpio0_input(int channel, u64 now)
+{
+	return (channel == 1) ? (u32) hostsim_pwm_level(0, now) : 0;
+}
+
+static u32 gpio1_input(int channel, u64 now)
+{
+	return hostsim_hwdetect_read(channel, now);
+}
+
+static u32 gpio2_input(int channel, u64 now)
+{
+	return (channel == 2) ? hostsim_hwstats_read(now) : 0;
+}
+
+static void gpio0_output(int channel, u32 value, u64 now)
+{
+	if (channel == 2)
+	{
+		hostsim_hwdetect_control(value, now);
+	}
+}
+
+static void gpio2_output(int channel, u32 value, u64 now)
+{
+	if (channel == 1)
+	{
+		hostsim_hwstats_control(value, now);
+	}
+}
+
+
+static u32 gpio_data(hostsim_gpio_t *gp, int ch, u64 now)
+{
+	u32 in = (gp->input != NULL) ? gp->input(ch + 1, now) : 0;
+
+	return (in & gp->tri[ch]) | (gp->data[ch] & ~gp->tri[ch]);
+}
+
+
+/****************************************************************************/
+/**
+* Register read/write handlers
+*
+*****************************************************************************/
+static u32 gpio_read(void *ctx, u32 offset, u64 now)
+{
+	hostsim_gpio_t *gp = (hostsim_gpio_t *) ctx;
+
+	switch (offset)
+	{
+		case XGPIO_DATA_OFFSET:		return gpio_data(gp, 0, now);
+		case XGPIO_TRI_OFFSET:		return gp->tri[0];
+		case XGPIO_DATA2_OFFSET:	return gpio_data(gp, 1, now);
+		case XGPIO_TRI2_OFFSET:		return gp->tri[1];
+		case XGPIO_GIE_OFFSET:		return gp->gie;
+		case XGPIO_ISR_OFFSET:		return gp->isr;
+		case XGPIO_IER_OFFSET:		return gp->ier;
+		default:					return 0;
+	}
+}
+
+static void gpio_write(void *ctx, u32 offset, u32 value, u64 now)
+{
+	hostsim_gpio_t *gp = (hostsim_gpio_t *) ctx;
+
+	switch (offset)
+	{
+		case XGPIO_DATA_OFFSET:		gp->data[0] = value;	break;
+		case XGPIO_TRI_OFFSET:		gp->tri[0] = value;		break;
+		case XGPIO_DATA2_OFFSET:	gp->data[1] = value;	break;
+		case XGPIO_TRI2_OFFSET:		gp->tri[1] = value;		break;
+		case XGPIO_GIE_OFFSET:		gp->gie = value;		break;
+		case XGPIO_ISR_OFFSET:		gp->isr &= ~value;		break;	// toggle on write (clear)
+		case XGPIO_IER_OFFSET:		gp->ier = value;		break;
+		default:											break;
+	}
+	if ((gp->output != NULL) && (offset <= XGPIO_TRI2_OFFSET))
+	{
+		gp->output(1, gp->data[0] & ~gp->tri[0], now);
+		gp->output(2, gp->data[1] & ~gp->tri[1], now);
+	}
+}
+
+
+// input change interrupts - called by the simulation clock every quantum
+static void gpio_poll(void *ctx, u64 now)
+{
+	hostsim_gpio_t	*gp = (hostsim_gpio_t *) ctx;
+	u32				in;
+	int				ch;
+
+	for (ch = 0; ch < 2; ch++)
+	{
+		in = gpio_data(gp, ch, now);
+		if (in != gp->last_in[ch])
+		{
+			gp->isr |= (gp->ier & (1u << ch));
+			gp->last_in[ch] = in;
+		}
+	}
+	if ((gp->gie & XGPIO_GIE_GINTR_ENABLE_MASK) && gp->isr)
+	{
+		hostsim_irq_raise(gp->irq_id);
+	}
+}
+
+
+void hostsim_gpio_init(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_GPIOS; i++)
+	{
+		memset(&gpios[i], 0, sizeof(gpios[i]));
+		gpios[i].tri[0] = 0xFFFFFFFF;
+		gpios[i].tri[1] = 0xFFFFFFFF;
+		gpios[i].irq_id = -1;
+	}
+	gpios[0].input = gpio0_input;
+	gpios[1].input = gpio1_input;
+	gpios[2].input = gpio2_input;
+	gpios[0].output = gpio0_output;
+	gpios[2].output = gpio2_output;
+
+	for (i = 0; i < NUM_GPIOS; i++)
+	{
+		hostsim_register_device("axi_gpio", gpio_base[i], GPIO_WINDOW, gpio_read, gpio_write,
+			gpio_poll, &gpios[i]);
+	}
+}
+
+
+/****************************** GPIO DRIVER *********************************/
+
+int XGpio_Initialize(XGpio *InstancePtr, u16 DeviceId)
+{
+	if (DeviceId >= NUM_GPIOS)
+	{
+		return XST_DEVICE_NOT_FOUND;
+	}
+	InstancePtr->BaseAddress = gpio_base[DeviceId];
+	InstancePtr->InterruptPresent = (gpios[DeviceId].irq_id >= 0);
+	InstancePtr->IsDual = 1;
+	InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+	return XST_SUCCESS;
+}
+
+void XGpio_SetDataDirection(XGpio *InstancePtr, unsigned Channel, u32 DirectionMask)
+{
+	XGpio_WriteReg(InstancePtr->BaseAddress, ((Channel - 1) * XGPIO_CHAN_OFFSET) + XGPIO_TRI_OFFSET,
+		DirectionMask);
+}
+
+u32 XGpio_GetDataDirection(XGpio *InstancePtr, unsigned Channel)
+{
+	return XGpio_ReadReg(InstancePtr->BaseAddress, ((Channel - 1) * XGPIO_CHAN_OFFSET) + XGPIO_TRI_OFFSET);
+}
+
+u32 XGpio_DiscreteRead(XGpio *InstancePtr, unsigned Channel)
+{
+	return XGpio_ReadReg(InstancePtr->BaseAddress, ((Channel - 1) * XGPIO_CHAN_OFFSET) + XGPIO_DATA_OFFSET);
+}
+
+void XGpio_DiscreteWrite(XGpio *InstancePtr, unsigned Channel, u32 Mask)
+{
+	XGpio_WriteReg(InstancePtr->BaseAddress, ((Channel - 1) * XGPIO_CHAN_OFFSET) + XGPIO_DATA_OFFSET, Mask);
+}
+
+void XGpio_InterruptGlobalEnable(XGpio *InstancePtr)
+{
+	XGpio_WriteReg(InstancePtr->BaseAddress, XGPIO_GIE_OFFSET, XGPIO_GIE_GINTR_ENABLE_MASK);
+}
+
+void XGpio_InterruptGlobalDisable(XGpio *InstancePtr)
+{
+	XGpio_WriteReg(InstancePtr->BaseAddress, XGPIO_GIE_OFFSET, 0);
+}
+
+void XGpio_InterruptEnable(XGpio *InstancePtr, u32 Mask)
+{
+	u32 ier = XGpio_ReadReg(InstancePtr->BaseAddress, XGPIO_IER_OFFSET);
+
+	XGpio_WriteReg(InstancePtr->BaseAddress, XGPIO_IER_OFFSET, ier | Mask);
+}
+
+void XGpio_InterruptDisable(XGpio *InstancePtr, u32 Mask)
+{
+	u32 ier = XGpio_ReadReg(InstancePtr->BaseAddress, XGPIO_IER_OFFSET);
+
+	XGpio_WriteReg(InstancePtr->BaseAddress, XGPIO_IER_OFFSET, ier & ~Mask);
+}
+
+void XGpio_InterruptClear(XGpio *InstancePtr, u32 Mask)
+{
+	XGpio_WriteReg(InstancePtr->BaseAddress, XGPIO_ISR_OFFSET, Mask);
+}
+
+u32 XGpio_InterruptGetStatus(XGpio *InstancePtr)
+{
+	return XGpio_ReadReg(InstancePtr->BaseAddress, XGPIO_ISR_OFFSET);
+}
@@ -0,0 +1,332 @@
+/**
+*
+* @file hostsim_hwdetect.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements the host simulation model of hw_detect.v.  The RTL restarts its
+* counter at every edge of pwm and stores the count when the level changes, so an interval
+* that lasts N clocks is reported as N - 1.  The counts of 2^k periods (k comes from GPIO_0
+* channel 2 bits[7:4]) are added up and latched as a pair at the rising edge that ends the
+* last of them, tagged with a 4-bit sequence number in bits [31:28] and k in bits [27:24].
+* The first rising edge after reset only starts the measurement and a change of k restarts
+* the accumulation.  The model gets the interval lengths and the number of rising edges
+* from the axi_timer PWM waveform instead of counting clock by clock, and reports 2^k times
+* the counts of the last period.  That is exact while the PWM parameters do not change; a
+* window that spans a change is reported with the new counts.
+*
+* The gated counter counts the rising edges in back-to-back gates of HWDET_GATE_CLOCKS
+* clocks that start at reset (simulated time 0).  It is shown on both channels while
+* gate_sel (GPIO_0 channel 2 bit[1]) is set.
+*
+* The statistics unit (hw_stats.v) is driven by GPIO_2 channel 1 and read on GPIO_2
+* channel 2.  The model adds the periods that ended since the last access with the lengths
+* of the current period, so like the pair it is exact while the PWM parameters do not
+* change.  A snapshot takes effect at once (busy is never set).
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of the host simulation model
+* 1.01a	ri	10/16/26	Coherent high/low pair with a sequence number
+* 1.02a	ri	10/16/26	Accumulation of 2^k periods per pair
+* 1.03a	ri	10/16/26	Gated edge counter
+* 1.04a	ri	10/16/26	Statistics unit
+* </pre>
+*
+******************************************************************************/
+
+/***************************** Include Files *********************************/
+#include <string.h>
+
+#include "hostsim.h"
+
+/************************** Constant Definitions *****************************/
+#define HWDET_PWM_TIMER		0			// hw_detect measures pwm0 of axi_timer 0
+
+#define HWDET_SEQ_SHIFT		28
+#define HWDET_K_SHIFT		24
+#define HWDET_COUNT_MAX		0x00FFFFFF	// counts saturate
+#define HWDET_GATE_CLOCKS	(HOSTSIM_CLOCK_FREQ_HZ / 10)	// GATE_HZ = 10
+
+#define HWSTATS_HIST_BITS	8
+#define HWSTATS_BINS		(1 << HWSTATS_HIST_BITS)
+#define HWSTATS_SAT32		0xFFFFFFFFULL
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	u32		k;							// accumulation exponent
+	u64		periods;					// complete periods when k was last changed
+	u64		latches;					// pairs latched before k was last changed
+	u32		held[2];					// pair latched before k was last changed
+	bool	gate_sel;					// outputs show the gated counter
+	u64		gates;						// gates completed at the last gated read
+	u64		gate_rises;					// rising edges up to the end of that gate
+	u32		gate_edges;					// rising edges in that gate
+} hostsim_hwdetect_t;
+
+// one set of statistics of hw_stats.v
+typedef struct {
+	u64		n;							// periods
+	u64		start;						// time the interval started
+	u64		clocks;						// length of the interval (snapshot only)
+	u64		p_min, p_max, p_sum, p_sq;	// period
+	u64		h_min, h_max, h_sum, h_sq;	// high time
+	bool	ovf;						// a sum of squares saturated
+	u32		ref;						// reference period of the histogram
+	u32		shift;						// histogram bin width 2^shift
+	u64		hist[HWSTATS_BINS];
+} hostsim_hwstats_set_t;
+
+typedef struct {
+	u32						cmd;		// GPIO_2 channel 1
+	u32						cfg_ref;	// configuration for the next interval
+	u32						cfg_shift;
+	u32						seq;		// snapshots taken
+	u64						rises;		// rising edges counted so far
+	hostsim_hwstats_set_t	live;
+	hostsim_hwstats_set_t	snap;
+} hostsim_hwstats_t;
+
+/************************** Variable Definitions *****************************/
+static hostsim_hwdetect_t	hwdet;
+static hostsim_hwstats_t	hwstats;
+
+/****************************************************************************/
+/**
+* Initializes the hw_detect model (hw_detect is not on the bus, GPIO_1 reads it)
+*
+*****************************************************************************/
+void hostsim_hwdetect_init(void)
+{
+	memset(&hwdet, 0, sizeof(hwdet));
+	memset(&hwstats, 0, sizeof(hwstats));
+	hwstats.live.p_min = HWSTATS_SAT32 >> 6;
+	hwstats.live.h_min = HWSTATS_SAT32 >> 7;
+	hwstats.snap = hwstats.live;
+}
+
+
+/****************************************************************************/
+/**
+* Computes the latched pair at "now".  Returns the number of pairs latched since reset
+*
+*****************************************************************************/
+static u64 hwdet_latched(u64 now, u32 counts[2])
+{
+	u64 high, low, rises, periods, windows, count;
+	int i;
+
+	hostsim_pwm_period(HWDET_PWM_TIMER, now, &high, &low, &rises);
+	periods = (rises < 2) ? 0 : rises - 1;		// the first rising edge only starts the measurement
+	windows = (periods - hwdet.periods) >> hwdet.k;
+	if (windows == 0)
+	{
+		counts[0] = hwdet.held[0];
+		counts[1] = hwdet.held[1];
+		return hwdet.latches;
+	}
+
+	for (i = 0; i < 2; i++)
+	{
+		count = (i == 0) ? high : low;
+		count = (count == 0) ? 0 : (count - 1) << hwdet.k;
+		if (count > HWDET_COUNT_MAX)
+		{
+			count = HWDET_COUNT_MAX;
+		}
+		counts[i] = ((u32) hwdet.k << HWDET_K_SHIFT) | (u32) count;
+	}
+	return hwdet.latches + windows;
+}
+
+
+/****************************************************************************/
+/**
+* Returns the value on the hw_detect output that feeds GPIO_1 "channel"
+*
+* Channel 1 is {sequence, k, high_count} and channel 2 is {sequence, k, low_count}, or
+* {gate sequence, 0, edges} and {gate sequence, 0, HWDET_GATE_CLOCKS} while gate_sel is set.
+*
+*****************************************************************************/
+u32 hostsim_hwdetect_read(int channel, u64 now)
+{
+	u32 counts[2];
+	u64 latches, gates, rises;
+	u32 seq;
+
+	// the edges at the end of a gate are counted at the first read after it (GPIO_1 is
+	// read every FIT interrupt), so the end of the gate is almost always in the current
+	// PWM segment and hostsim_pwm_rises() is exact
+	gates = now / HWDET_GATE_CLOCKS;
+	if (gates != hwdet.gates)
+	{
+		rises = hostsim_pwm_rises(HWDET_PWM_TIMER, now, gates * HWDET_GATE_CLOCKS);
+		if (gates != hwdet.gates + 1)
+		{
+			hwdet.gate_rises = hostsim_pwm_rises(HWDET_PWM_TIMER, now, (gates - 1) * HWDET_GATE_CLOCKS);
+		}
+		hwdet.gate_edges = (u32) (rises - hwdet.gate_rises);
+		hwdet.gate_rises = rises;
+		hwdet.gates = gates;
+	}
+
+	if (hwdet.gate_sel)
+	{
+		if (gates == 0)			// no complete gate yet
+		{
+			return 0;
+		}
+		seq = (u32) ((gates - 1) % 15) + 1;
+		return (seq << HWDET_SEQ_SHIFT) | ((channel == 1) ? hwdet.gate_edges : HWDET_GATE_CLOCKS);
+	}
+
+	latches = hwdet_latched(now, counts);
+	if (latches == 0)			// no complete period yet
+	{
+		return 0;
+	}
+	seq = (u32) ((latches - 1) % 15) + 1;
+	return (seq << HWDET_SEQ_SHIFT) | counts[(channel == 1) ? 0 : 1];
+}
+
+
+/****************************************************************************/
+/**
+* Applies the hw_detect control inputs driven by GPIO_0 channel 2: the accumulation
+* exponent (bits[7:4]) and gate_sel (bit[1]).  A new k keeps the pair latched so far and
+* restarts the accumulation
+*
+*****************************************************************************/
+void hostsim_hwdetect_control(u32 value, u64 now)
+{
+	u64 high, low, rises;
+	u32 k = (value >> 4) & 0x0F;
+
+	hwdet.gate_sel = (value & 0x02) != 0;
+	if (k == hwdet.k)
+	{
+		return;
+	}
+	hwdet.latches = hwdet_latched(now, hwdet.held);
+	hostsim_pwm_period(HWDET_PWM_TIMER, now, &high, &low, &rises);
+	hwdet.periods = (rises < 2) ? 0 : rises - 1;
+	hwdet.k = k;
+}
+
+
+/****************************************************************************/
+/**
+* Adds the periods that ended since the last call to the accumulating set of the
+* statistics unit
+*
+*****************************************************************************/
+static void hwstats_update(u64 now)
+{
+	hostsim_hwstats_set_t	*st = &hwstats.live;
+	u64						high, low, rises, n, period, hi;
+	s64						bin;
+
+	hostsim_pwm_period(HWDET_PWM_TIMER, now, &high, &low, &rises);
+	n = (hwstats.rises == 0) ? 0 : rises - hwstats.rises;	// the first rising edge only starts
+	if (rises != 0)
+	{
+		hwstats.rises = rises;
+	}
+	if ((n == 0) || (high == 0) || (low == 0))
+	{
+		return;
+	}
+
+	period = high + low;
+	hi = high;
+	st->n += n;
+	st->p_min = (period < st->p_min) ? period : st->p_min;
+	st->p_max = (period > st->p_max) ? period : st->p_max;
+	st->h_min = (hi < st->h_min) ? hi : st->h_min;
+	st->h_max = (hi > st->h_max) ? hi : st->h_max;
+	st->p_sum += n * period;
+	st->h_sum += n * hi;
+	st->p_sq += n * period * period;
+	st->h_sq += n * hi * hi;
+
+	bin = (((s64) period - st->ref) >> st->shift) + (HWSTATS_BINS / 2);
+	bin = (bin < 0) ? 0 : ((bin >= HWSTATS_BINS) ? HWSTATS_BINS - 1 : bin);
+	st->hist[bin] += n;
+}
+
+
+/****************************************************************************/
+/**
+* Applies a write of GPIO_2 channel 1 (the statistics command): bit[30] loads the
+* configuration, a change of bit[31] takes a snapshot
+*
+*****************************************************************************/
+void hostsim_hwstats_control(u32 value, u64 now)
+{
+	u32 toggled = (value ^ hwstats.cmd) & 0x80000000;
+
+	hwstats.cmd = value;
+	if (value & 0x40000000)
+	{
+		hwstats.cfg_ref = value & 0x00FFFFFF;
+		hwstats.cfg_shift = (value >> 24) & 0x1F;
+	}
+	if (toggled)
+	{
+		hwstats_update(now);
+		hwstats.snap = hwstats.live;
+		hwstats.snap.clocks = now - hwstats.live.start;
+		memset(&hwstats.live, 0, sizeof(hwstats.live));
+		hwstats.live.start = now;
+		hwstats.live.p_min = HWSTATS_SAT32 >> 6;
+		hwstats.live.h_min = HWSTATS_SAT32 >> 7;
+		hwstats.live.ref = hwstats.cfg_ref;
+		hwstats.live.shift = hwstats.cfg_shift;
+		hwstats.seq++;
+	}
+}
+
+
+/****************************************************************************/
+/**
+* Returns the snapshot register (or histogram bin) selected by the last command, the
+* value on GPIO_2 channel 2
+*
+*****************************************************************************/
+u32 hostsim_hwstats_read(u64 now)
+{
+	hostsim_hwstats_set_t	*st = &hwstats.snap;
+	u32						sel = hwstats.cmd;
+
+	hwstats_update(now);
+
+	if (sel & 0x200)
+	{
+		return (u32) ((st->hist[sel & (HWSTATS_BINS - 1)] > HWSTATS_SAT32) ? HWSTATS_SAT32 :
+			st->hist[sel & (HWSTATS_BINS - 1)]);
+	}
+
+	switch (sel & 0x0F)
+	{
+		case 0:		return (st->ovf ? 0x40000000 : 0) | (st->shift << 24) | st->ref;
+		case 1:		return (u32) ((st->n > HWSTATS_SAT32) ? HWSTATS_SAT32 : st->n);
+		case 2:		return (u32) ((st->clocks > HWSTATS_SAT32) ? HWSTATS_SAT32 : st->clocks);
+		case 3:		return (HWSTATS_HIST_BITS << 24) | (hwstats.seq & 0xFFFF);
+		case 4:		return (u32) st->p_min;
+		case 5:		return (u32) st->p_max;
+		case 6:		return (u32) st->p_sum;
+		case 7:		return (u32) (st->p_sum >> 32);
+		case 8:		return (u32) st->p_sq;
+		case 9:		return (u32) (st->p_sq >> 32);
+		case 10:	return (u32) st->h_min;
+		case 11:	return (u32) st->h_max;
+		case 12:	return (u32) st->h_sum;
+		case 13:	return (u32) (st->h_sum >> 32);
+		case 14:	return (u32) st->h_sq;
+		default:	return (u32) (st->h_sq >> 32);
+	}
+}
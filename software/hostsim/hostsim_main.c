@@ -0,0 +1,821 @@
+/**
+*
+* @file hostsim_main.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements the host simulation harness for testpwm.  It has two modes:
+*
+*	o	run (default) - runs the whole testpwm application headless.  The simulation clock
+*		fires the FIT interrupt at 40KHz of simulated time and applies a script of switch, encoder
+*		and button events.  The clock is deterministic (driven by the application's bus
+*		accesses, see hostsim.c), so runs are reproducible; -r ns_per_tick paces it with a
+*		host timer instead (not reproducible).  At the end of the run the LCD, LEDs, seven segment display and
+*		the bus traffic counters and the bus clocks spent in the FIT interrupt handler are
+*		printed.  Exit status is the application's.
+*	o	bench (-b) - calls FIT_Handler() (alone and with FIT_BottomHalf()), PWM_SetParams(),
+*		PWM_GetParams(), calc_freq(), calc_duty() and update_lcd() directly and reports the
+*		cost of each call: host time,
+*		cycles and instructions, and the bus reads/writes the call makes on the target along
+*		with the clocks those accesses take (HOSTSIM_BUS_*_CYCLES each).
+*	o	pwm check (-p) - compares PWM_CalcCounts()/PWM_CalcParams() with the original floating
+*		point PWM_SetParams()/PWM_GetParams() arithmetic for every PWM_FREQ_* preset and 0-100%
+*		duty cycle: TLR values, frequency and duty cycle read back, an exact check of the
+*		counts, and the cost of each version.  Exit status is 1 if the integer counts are not
+*		exact.
+*	o	glitch measurement (-g) - makes random frequency/duty cycle changes the way testpwm's
+*		main loop does (set, read back, update both LCD lines), once with PWM_SetParams() and
+*		PWM_Start() and once with PWM_UpdateParams(), and reports the disturbance of the PWM
+*		output around each change: the worst deviation of any period (high time + period) from
+*		both the old and the new waveform, and the truncated pulses and gaps.  Exit status is 1
+*		if PWM_UpdateParams() produced a truncated pulse or a gap.
+*
+* Build (from software/):
+*	gcc -O2 -Wall -Ihostsim -Ihostsim/include -Itestpwm -Dmain=testpwm_main \
+*		-o hostsim/testpwm_sim testpwm/[a-z]*.c hostsim/hostsim*.c -lm -lrt
+*
+* testpwm.c's main() is renamed to testpwm_main() by the -D on the command line; this file
+* undefines "main" so it provides the real one.
+*
+* Usage: testpwm_sim [-b iterations] [-p iterations] [-g updates] [-t run_ms] [-l limit_ms] [-q quantum] [-r ns_per_tick]
+*                    [-u capture_file] [-e ms:sw=hex] [-e ms:btn=hex] [-e ms:rot=detents]
+*                    [-e ms:rotbtn=0|1]
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of the host simulation harness
+* 1.01a	ri	10/16/26	Report FIT handler bus clocks, bench FIT_BottomHalf()
+* 1.02a	ri	10/16/26	Report FIT latency and bus access rate
+* 1.03a	ri	10/16/26	Deterministic simulation clock by default, -r opts into host pacing
+* </pre>
+*
+******************************************************************************/
+
+#undef main
+
+/***************************** Include Files *********************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "hostsim.h"
+#include "xtmrctr.h"
+#include "pwm_tmrctr.h"
+#include "testpwm.h"
+
+/************************** Constant Definitions *****************************/
+#define MSEC_CYCLES(ms)			((u64) (ms) * (HOSTSIM_CLOCK_FREQ_HZ / 1000))
+
+#define DEFAULT_RUN_MSEC		4000		// press the encoder button after this long
+#define DEFAULT_NS_PER_TICK		0			// host time per simulation clock tick, 0 = deterministic clock
+#define DEFAULT_BENCH_ITER		100000
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	const char	*name;
+	void		(*fn)(u32 i);
+	u32			divisor;				// run iterations / divisor calls (for slow functions)
+} bench_t;
+
+/************************** Variable Definitions *****************************/
+static int		perf_fd = -1;
+static bool		run_mode;
+
+/*************************** testpwm.c internals ****************************/
+extern PWM_Instance	PWMTimerInst;
+extern volatile unsigned int	fit_ring_head;
+extern volatile unsigned int	fit_ring_tail;
+
+int				testpwm_main(void);			// testpwm.c's main() (see above)
+
+/************************** Function Prototypes ******************************/
+static void		usage(void);
+static bool		parse_event(const char *arg);
+static void		report(void);
+static int		bench(u32 iterations);
+static int		pwm_check(u32 iterations);
+static int		glitch(u32 updates);
+
+/************************** MAIN PROGRAM ************************************/
+int main(int argc, char *argv[])
+{
+	u32		bench_iter = 0;
+	u32		check_iter = 0;
+	u32		glitch_updates = 0;
+	u32		run_ms = DEFAULT_RUN_MSEC;
+	u32		limit_ms = 0;
+	u32		quantum = HOSTSIM_FIT_PERIOD;
+	long	ns_per_tick = DEFAULT_NS_PER_TICK;
+	bool	have_events = false;
+	FILE	*capture;
+	int		opt;
+
+	hostsim_init();
+
+	while ((opt = getopt(argc, argv, "b:p:g:t:l:q:r:u:e:h")) != -1)
+	{
+		switch (opt)
+		{
+			case 'b':	bench_iter = (u32) strtoul(optarg, NULL, 0);	break;
+			case 'p':	check_iter = (u32) strtoul(optarg, NULL, 0);	break;
+			case 'g':	glitch_updates = (u32) strtoul(optarg, NULL, 0);	break;
+			case 't':	run_ms = (u32) strtoul(optarg, NULL, 0);		break;
+			case 'l':	limit_ms = (u32) strtoul(optarg, NULL, 0);		break;
+			case 'q':	quantum = (u32) strtoul(optarg, NULL, 0);		break;
+			case 'r':	ns_per_tick = strtol(optarg, NULL, 0);			break;
+
+			case 'u':
+				capture = fopen(optarg, "wb");
+				if (capture == NULL)
+				{
+					perror(optarg);
+					return 2;
+				}
+				hostsim_uartlite_capture(capture);
+				break;
+
+			case 'e':
+				if (!parse_event(optarg))
+				{
+					usage();
+					return 2;
+				}
+				have_events = true;
+				break;
+
+			default:
+				usage();
+				return 2;
+		}
+	}
+
+	if (bench_iter != 0)
+	{
+		return bench(bench_iter);
+	}
+	if (check_iter != 0)
+	{
+		return pwm_check(check_iter);
+	}
+	if (glitch_updates != 0)
+	{
+		return glitch(glitch_updates);
+	}
+
+	// default script: 1KHz with hw detect, change the duty cycle, then go to 500KHz
+	if (!have_events)
+	{
+		hostsim_add_event(MSEC_CYCLES(2500), HOSTSIM_EV_SWITCHES, 0x09);
+		hostsim_add_event(MSEC_CYCLES(3000), HOSTSIM_EV_ROTARY, 5);
+		hostsim_add_event(MSEC_CYCLES(3500), HOSTSIM_EV_SWITCHES, 0x0D);
+	}
+	hostsim_add_event(MSEC_CYCLES(run_ms), HOSTSIM_EV_ROTBTN, 1);
+	hostsim_add_event(MSEC_CYCLES(run_ms + 100), HOSTSIM_EV_ROTBTN, 0);
+
+	run_mode = true;
+	atexit(report);
+	hostsim_clock_start(quantum, ns_per_tick, MSEC_CYCLES(limit_ms));
+	return testpwm_main();
+}
+
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: testpwm_sim [-b iterations] [-p iterations] [-g updates] [-t run_ms] [-l limit_ms] [-q quantum] [-r ns_per_tick]\n"
+		"                   [-u capture_file] [-e ms:sw=hex] [-e ms:btn=hex] [-e ms:rot=detents]\n"
+		"                   [-e ms:rotbtn=0|1]\n");
+}
+
+
+// parses a scripted input event "ms:kind=value"
+static bool parse_event(const char *arg)
+{
+	char	kind[16];
+	u32		ms;
+	char	value[32];
+
+	if (sscanf(arg, "%u:%15[a-z]=%31s", &ms, kind, value) != 3)
+	{
+		return false;
+	}
+	if (strcmp(kind, "sw") == 0)
+	{
+		return hostsim_add_event(MSEC_CYCLES(ms), HOSTSIM_EV_SWITCHES, (s32) strtol(value, NULL, 16));
+	}
+	if (strcmp(kind, "btn") == 0)
+	{
+		return hostsim_add_event(MSEC_CYCLES(ms), HOSTSIM_EV_BUTTONS, (s32) strtol(value, NULL, 16));
+	}
+	if (strcmp(kind, "rot") == 0)
+	{
+		return hostsim_add_event(MSEC_CYCLES(ms), HOSTSIM_EV_ROTARY, (s32) strtol(value, NULL, 0));
+	}
+	if (strcmp(kind, "rotbtn") == 0)
+	{
+		return hostsim_add_event(MSEC_CYCLES(ms), HOSTSIM_EV_ROTBTN, (s32) strtol(value, NULL, 0));
+	}
+	return false;
+}
+
+
+// end of run report (atexit)
+static void report(void)
+{
+	hostsim_bus_stats_t	bus;
+	u64					now;
+	u64					fits;
+	u64					lat_min, lat_max;
+	double				lat_mean;
+	int					fit = XPAR_MICROBLAZE_0_AXI_INTC_FIT_TIMER_0_INTERRUPT_INTR;
+
+	if (!run_mode)
+	{
+		return;
+	}
+	hostsim_clock_stop();
+	fflush(stdout);
+
+	now = hostsim_now();
+	hostsim_get_bus_stats(&bus);
+	fprintf(stderr, "\nhostsim: simulated time %.3f s, FIT interrupts %llu (%llu overruns)\n",
+		(double) now / HOSTSIM_CLOCK_FREQ_HZ, (unsigned long long) hostsim_irq_count(fit),
+		(unsigned long long) hostsim_irq_overruns(fit));
+	fprintf(stderr, "hostsim: bus reads %llu  writes %llu  (%.1f%% of simulated clocks)\n",
+		(unsigned long long) bus.reads, (unsigned long long) bus.writes,
+		(now == 0) ? 0.0 : 100.0 * (double) bus.cycles / (double) now);
+	fits = hostsim_irq_count(fit);
+	fprintf(stderr, "hostsim: FIT handler bus clocks %.1f per interrupt  (%.2f%% of simulated clocks)\n",
+		(fits == 0) ? 0.0 : (double) hostsim_irq_cycles(fit) / (double) fits,
+		(now == 0) ? 0.0 : 100.0 * (double) hostsim_irq_cycles(fit) / (double) now);
+	hostsim_irq_latency(fit, &lat_min, &lat_mean, &lat_max);
+	fprintf(stderr, "hostsim: FIT latency clocks min %llu  mean %.1f  max %llu  (jitter %llu)\n",
+		(unsigned long long) lat_min, lat_mean, (unsigned long long) lat_max,
+		(unsigned long long) (lat_max - lat_min));
+	fprintf(stderr, "hostsim: bus accesses %.0f per msec\n",
+		(now == 0) ? 0.0 : (double) (bus.reads + bus.writes) * (HOSTSIM_CLOCK_FREQ_HZ / 1000) / (double) now);
+	hostsim_report_devices(stderr);
+	hostsim_boardio_report(stderr);
+}
+
+
+/******************************* BENCHMARKS *********************************/
+
+static void perf_open(void)
+{
+	struct perf_event_attr pe;
+
+	memset(&pe, 0, sizeof(pe));
+	pe.type = PERF_TYPE_HARDWARE;
+	pe.size = sizeof(pe);
+	pe.config = PERF_COUNT_HW_INSTRUCTIONS;
+	pe.disabled = 1;
+	pe.exclude_kernel = 1;
+	pe.exclude_hv = 1;
+	perf_fd = (int) syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+}
+
+static u64 perf_read(void)
+{
+	u64 count = 0;
+
+	if ((perf_fd < 0) || (read(perf_fd, &count, sizeof(count)) != sizeof(count)))
+	{
+		return 0;
+	}
+	return count;
+}
+
+static u64 host_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64) ts.tv_sec * 1000000000ULL + (u64) ts.tv_nsec;
+#endif
+}
+
+static u64 host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64) ts.tv_sec * 1000000000ULL + (u64) ts.tv_nsec;
+}
+
+
+// PWM_FREQ_* presets from testpwm.c
+static const u32 bench_freqs[] = { 10, 100, 1000, 5000, 10000, 50000, 100000, 200000, 500000,
+	1000000, 2000000, 5000000, 10000000 };
+#define NUM_BENCH_FREQS		(sizeof(bench_freqs) / sizeof(bench_freqs[0]))
+
+static void bench_fit(u32 i)
+{
+	(void) i;
+	fit_ring_tail = fit_ring_head;			// nothing takes the samples - keep the ring from filling
+	hostsim_advance(HOSTSIM_FIT_PERIOD);
+	FIT_Handler();
+}
+
+// one FIT interrupt and the deferred work it leaves (the millisecond work every 40th call)
+static void bench_fit_deferred(u32 i)
+{
+	(void) i;
+	hostsim_advance(HOSTSIM_FIT_PERIOD);
+	FIT_Handler();
+	FIT_BottomHalf();
+}
+
+static void bench_setparams(u32 i)
+{
+	PWM_SetParams(&PWMTimerInst, bench_freqs[i % NUM_BENCH_FREQS], i % 101);
+}
+
+static void bench_getparams(u32 i)
+{
+	u32 freq, duty;
+
+	(void) i;
+	PWM_GetParams(&PWMTimerInst, &freq, &duty);
+}
+
+static volatile unsigned int bench_sink;
+
+static void bench_calc_freq(u32 i)
+{
+	bench_sink += calc_freq(i & 0xFFFF, (i >> 3) & 0xFFFF, (i >> 1) & 0x0F, i & 1);
+}
+
+static void bench_calc_duty(u32 i)
+{
+	bench_sink += calc_duty(i & 0xFFFF, (i >> 3) & 0xFFFF, (i >> 1) & 0x0F);
+}
+
+static void bench_update_lcd(u32 i)
+{
+	update_lcd((u64) bench_freqs[i % NUM_BENCH_FREQS] * 1000, (i % 100) * 100, 1 + (i & 1));
+}
+
+static const bench_t benches[] = {
+	{ "FIT_Handler",	bench_fit,			1 },
+	{ "FIT+BottomHalf",	bench_fit_deferred,	1 },
+	{ "PWM_SetParams",	bench_setparams,	1 },
+	{ "PWM_GetParams",	bench_getparams,	1 },
+	{ "calc_freq",		bench_calc_freq,	1 },
+	{ "calc_duty",		bench_calc_duty,	1 },
+	{ "update_lcd",		bench_update_lcd,	100 },
+};
+
+
+static int bench(u32 iterations)
+{
+	hostsim_bus_stats_t	b0, b1;
+	u64					ns, cyc, insn;
+	u32					n, i;
+	size_t				k;
+
+	if (do_init() != XST_SUCCESS)
+	{
+		fprintf(stderr, "hostsim: do_init() failed\n");
+		return 1;
+	}
+	PWM_SetParams(&PWMTimerInst, 1000, 50);
+	PWM_Start(&PWMTimerInst);
+	perf_open();
+
+	printf("%-16s %9s %12s %12s %12s %10s %10s %10s\n", "function", "calls", "host ns", "host cyc",
+		"host insn", "bus rd", "bus wr", "bus clk");
+	for (k = 0; k < sizeof(benches) / sizeof(benches[0]); k++)
+	{
+		n = iterations / benches[k].divisor;
+		if (n == 0)
+		{
+			n = 1;
+		}
+
+		hostsim_get_bus_stats(&b0);
+		if (perf_fd >= 0)
+		{
+			ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+		ns = host_ns();
+		cyc = host_cycles();
+		for (i = 0; i < n; i++)
+		{
+			benches[k].fn(i);
+		}
+		cyc = host_cycles() - cyc;
+		ns = host_ns() - ns;
+		if (perf_fd >= 0)
+		{
+			ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+		}
+		insn = perf_read();
+		hostsim_get_bus_stats(&b1);
+
+		printf("%-16s %9u %12.1f %12.1f ", benches[k].name, n, (double) ns / n, (double) cyc / n);
+		if (perf_fd >= 0)
+		{
+			printf("%12.1f ", (double) insn / n);
+		}
+		else
+		{
+			printf("%12s ", "n/a");
+		}
+		printf("%10.2f %10.2f %10.1f\n", (double) (b1.reads - b0.reads) / n,
+			(double) (b1.writes - b0.writes) / n, (double) (b1.cycles - b0.cycles) / n);
+	}
+	return 0;
+}
+
+
+/*************************** PWM PARAMETER CHECK ****************************/
+
+// the original floating point PWM_SetParams() arithmetic
+static int ref_calc_counts(u32 clkfreq, u32 freq, u32 dutyfactor, u32 *tlr0, u32 *tlr1)
+{
+	float	clock_frequency = (float) clkfreq;
+	float	timer_clock_period,
+			pwm_period,
+			pwm_dc,
+			t0,
+			t1;
+
+	timer_clock_period = 1.0 / clock_frequency;
+	pwm_period = 1.0 / freq;
+	t0 = (pwm_period / timer_clock_period) - 2;
+
+	pwm_dc = dutyfactor / 100.00;
+	t1 = ((pwm_period * pwm_dc) / timer_clock_period) - 2;
+	if (t1 < 0)
+	{
+		t1 = 0.0;
+	}
+	if (dutyfactor > 100)
+	{
+		return XST_INVALID_PARAM;
+	}
+	if ((t0 > 4294967295.00) || (t1 > 4294967295.00))
+	{
+		return XST_INVALID_PARAM;
+	}
+	*tlr0 = (u32) t0;
+	*tlr1 = (u32) t1;
+	return XST_SUCCESS;
+}
+
+// the original floating point PWM_GetParams() arithmetic
+static void ref_calc_params(u32 clkfreq, u32 tlr0, u32 tlr1, u32 *freq, u32 *dutyfactor)
+{
+	float	clock_frequency = (float) clkfreq;
+	float	timer_clock_period,
+			pwm_period,
+			pwm_dc;
+
+	timer_clock_period = 1.0 / clock_frequency;
+	pwm_period = ((float) tlr0 + 2) * timer_clock_period;
+	pwm_dc = (float) tlr1 / (float) tlr0;
+	*freq = lroundf(1.00 / pwm_period);
+	*dutyfactor = lroundf(pwm_dc * 100.00);
+}
+
+// true if tlr0/tlr1 are exactly trunc(clk / freq) - 2 and max(0, trunc(clk * duty / (100 * freq)) - 2)
+static bool counts_exact(u32 clkfreq, u32 freq, u32 dutyfactor, u32 tlr0, u32 tlr1)
+{
+	u64 p = (u64) tlr0 + 2;
+	u64 h = (u64) tlr1 + 2;
+	u64 num = (u64) clkfreq * dutyfactor;
+	u64 den = (u64) freq * 100;
+
+	if ((p * freq > clkfreq) || ((p + 1) * freq <= clkfreq))
+	{
+		return false;
+	}
+	if (tlr1 == 0)
+	{
+		return num < 3 * den;
+	}
+	return (h * den <= num) && ((h + 1) * den > num);
+}
+
+static volatile u32 check_sink;
+
+static int pwm_check(u32 iterations)
+{
+	u32		clk = XPAR_CPU_M_AXI_DP_FREQ_HZ;			// as passed to PWM_Initialize() by testpwm.c
+	u32		t0 = 0, t1 = 0, r0 = 0, r1 = 0, f, d, rf, rd;
+	u32		tlr_diff = 0, get_diff = 0, not_exact = 0, cases = 0;
+	int		sts, rsts;
+	u64		ns, cyc;
+	double	ns_int[2], ns_ref[2], cyc_int[2], cyc_ref[2];
+	u32		i, n, k;
+	size_t	fi;
+
+	// bit-exactness over every preset and duty cycle
+	for (fi = 0; fi < NUM_BENCH_FREQS; fi++)
+	{
+		for (d = 0; d <= 100; d++)
+		{
+			cases++;
+			sts = PWM_CalcCounts(clk, bench_freqs[fi], d, &t0, &t1);
+			rsts = ref_calc_counts(clk, bench_freqs[fi], d, &r0, &r1);
+			if ((sts != rsts) || ((sts == XST_SUCCESS) && ((t0 != r0) || (t1 != r1))))
+			{
+				if (tlr_diff++ < 10)
+				{
+					printf("TLR differ: freq %u duty %u  int %d %u/%u  float %d %u/%u\n", bench_freqs[fi],
+						d, sts, t0, t1, rsts, r0, r1);
+				}
+			}
+			if (sts != XST_SUCCESS)
+			{
+				continue;
+			}
+			if (!counts_exact(clk, bench_freqs[fi], d, t0, t1))
+			{
+				not_exact++;
+				printf("NOT EXACT: freq %u duty %u  tlr0 %u tlr1 %u\n", bench_freqs[fi], d, t0, t1);
+			}
+
+			PWM_CalcParams(clk, t0, t1, &f, &rd);
+			ref_calc_params(clk, t0, t1, &rf, &k);
+			if ((f != rf) || (rd != k))
+			{
+				if (get_diff++ < 10)
+				{
+					printf("params differ: tlr0 %u tlr1 %u  int %u Hz %u%%  float %u Hz %u%%\n", t0, t1, f,
+						rd, rf, k);
+				}
+			}
+		}
+	}
+	printf("%u cases: %u TLR differences from float, %u param differences from float, %u not exact\n\n",
+		cases, tlr_diff, get_diff, not_exact);
+
+	// cost per call
+	for (k = 0; k < 2; k++)
+	{
+		n = iterations;
+		ns = host_ns();
+		cyc = host_cycles();
+		for (i = 0; i < n; i++)
+		{
+			if (k == 0)
+			{
+				PWM_CalcCounts(clk, bench_freqs[i % NUM_BENCH_FREQS], i % 101, &t0, &t1);
+			}
+			else
+			{
+				PWM_CalcParams(clk, i, i >> 1, &f, &d);
+				t0 = f;
+				t1 = d;
+			}
+			check_sink += t0 + t1;
+		}
+		cyc_int[k] = (double) (host_cycles() - cyc) / n;
+		ns_int[k] = (double) (host_ns() - ns) / n;
+
+		ns = host_ns();
+		cyc = host_cycles();
+		for (i = 0; i < n; i++)
+		{
+			if (k == 0)
+			{
+				ref_calc_counts(clk, bench_freqs[i % NUM_BENCH_FREQS], i % 101, &t0, &t1);
+			}
+			else
+			{
+				ref_calc_params(clk, i, i >> 1, &f, &d);
+				t0 = f;
+				t1 = d;
+			}
+			check_sink += t0 + t1;
+		}
+		cyc_ref[k] = (double) (host_cycles() - cyc) / n;
+		ns_ref[k] = (double) (host_ns() - ns) / n;
+	}
+	printf("%-16s %12s %12s %12s %12s\n", "per call", "int ns", "int cyc", "float ns", "float cyc");
+	printf("%-16s %12.1f %12.1f %12.1f %12.1f\n", "counts (Set)", ns_int[0], cyc_int[0], ns_ref[0], cyc_ref[0]);
+	printf("%-16s %12.1f %12.1f %12.1f %12.1f\n", "params (Get)", ns_int[1], cyc_int[1], ns_ref[1], cyc_ref[1]);
+	printf("(the host has an FPU - on a Microblaze without one the float version is soft-float)\n");
+
+	return (not_exact == 0) ? 0 : 1;
+}
+
+
+/*************************** GLITCH MEASUREMENT *****************************/
+
+#define GLITCH_MAX_SEGS		64
+
+typedef struct {
+	u64		t;
+	u64		period;						// 0 = PWM stopped
+	u64		high;
+} glitch_seg_t;
+
+typedef struct {
+	u32		updates;
+	u32		disturbed;					// updates with at least one period that is neither old nor new
+	u64		worst;						// worst deviation of a period (clocks)
+	double	sum_worst;
+	u32		truncated;					// pulses shorter than both the old and new high time
+	u32		stretched;					// pulses longer than both the old and new high time
+	u32		gaps;						// periods longer than both the old and new period
+	u64		max_gap;					// longest period (clocks) beyond the longer of old and new
+} glitch_stats_t;
+
+static glitch_seg_t		glitch_segs[GLITCH_MAX_SEGS];
+static int				glitch_nsegs;
+
+// testpwm.c's switch selectable frequencies
+static const u32 glitch_freqs[] = { 100, 1000, 10000, 50000, 100000, 500000, 1000000, 5000000 };
+#define NUM_GLITCH_FREQS	(sizeof(glitch_freqs) / sizeof(glitch_freqs[0]))
+
+static void glitch_watch(void *ref, u64 t, u64 period, u64 high)
+{
+	(void) ref;
+	if (glitch_nsegs < GLITCH_MAX_SEGS)
+	{
+		glitch_segs[glitch_nsegs].t = t;
+		glitch_segs[glitch_nsegs].period = period;
+		glitch_segs[glitch_nsegs].high = high;
+		glitch_nsegs++;
+	}
+}
+
+static u64 absdiff(u64 a, u64 b)
+{
+	return (a > b) ? a - b : b - a;
+}
+
+// rebuilds the waveform from the segments and checks every period from "from" to "to"
+static void glitch_analyze(glitch_stats_t *st, u64 from, u64 to, u64 p_old, u64 h_old, u64 p_new, u64 h_new)
+{
+	u64		rise, fall, end, prev_rise = 0, prev_high = 0, p, dev, worst = 0;
+	bool	have_prev = false;
+	int		i;
+
+	for (i = 0; i < glitch_nsegs; i++)
+	{
+		if (glitch_segs[i].period == 0)
+		{
+			continue;
+		}
+		end = (i + 1 < glitch_nsegs) ? glitch_segs[i + 1].t : to;
+		for (rise = glitch_segs[i].t; (rise < end) && (rise < to); rise += glitch_segs[i].period)
+		{
+			fall = rise + glitch_segs[i].high;
+			if ((i + 1 < glitch_nsegs) && (glitch_segs[i + 1].period == 0) && (fall > end))
+			{
+				fall = end;				// stopped while high
+			}
+			if (have_prev && (prev_rise >= from))
+			{
+				p = rise - prev_rise;
+				dev = absdiff(prev_high, h_old) + absdiff(p, p_old);
+				if (absdiff(prev_high, h_new) + absdiff(p, p_new) < dev)
+				{
+					dev = absdiff(prev_high, h_new) + absdiff(p, p_new);
+				}
+				if (dev > worst)
+				{
+					worst = dev;
+				}
+				if ((prev_high < h_old) && (prev_high < h_new))
+				{
+					st->truncated++;
+				}
+				if ((prev_high > h_old) && (prev_high > h_new))
+				{
+					st->stretched++;
+				}
+				if ((p > p_old) && (p > p_new))
+				{
+					st->gaps++;
+					if (p - ((p_old > p_new) ? p_old : p_new) > st->max_gap)
+					{
+						st->max_gap = p - ((p_old > p_new) ? p_old : p_new);
+					}
+				}
+			}
+			prev_rise = rise;
+			prev_high = fall - rise;
+			have_prev = true;
+		}
+	}
+
+	st->updates++;
+	st->sum_worst += (double) worst;
+	if (worst != 0)
+	{
+		st->disturbed++;
+	}
+	if (worst > st->worst)
+	{
+		st->worst = worst;
+	}
+}
+
+static void glitch_print(const char *name, const glitch_stats_t *st)
+{
+	printf("%-18s %8u %10u %12.1f %12.1f %10u %10u %10u %12.1f\n", name, st->updates, st->disturbed,
+		(double) st->worst * 1e6 / HOSTSIM_CLOCK_FREQ_HZ,
+		st->sum_worst / st->updates * 1e6 / HOSTSIM_CLOCK_FREQ_HZ, st->truncated, st->stretched,
+		st->gaps, (double) st->max_gap * 1e6 / HOSTSIM_CLOCK_FREQ_HZ);
+}
+
+static int glitch(u32 updates)
+{
+	glitch_stats_t	st[2];
+	u32				clk = XPAR_CPU_M_AXI_DP_FREQ_HZ;
+	u32				seed = 1, freq, duty, f, d, tlr0, tlr1, i, m;
+	u64				p_old, h_old, p_new, h_new, t_upd;
+
+	if (do_init() != XST_SUCCESS)
+	{
+		fprintf(stderr, "hostsim: do_init() failed\n");
+		return 1;
+	}
+	memset(st, 0, sizeof(st));
+
+	for (m = 0; m < 2; m++)
+	{
+		PWM_SetParams(&PWMTimerInst, 1000, 50);
+		glitch_nsegs = 0;
+		hostsim_pwm_watch(0, glitch_watch, NULL);
+		PWM_Start(&PWMTimerInst);
+		p_old = 100000;
+		h_old = 50000;
+
+		for (i = 0; i < updates; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			freq = glitch_freqs[(seed >> 16) % NUM_GLITCH_FREQS];
+			seed = seed * 1103515245 + 12345;
+			duty = 1 + (seed >> 16) % 99;
+			PWM_CalcCounts(clk, freq, duty, &tlr0, &tlr1);
+			p_new = (u64) tlr0 + 2;
+			h_new = (u64) tlr1 + 2;
+
+			// let the old waveform run for a few periods and start at a random phase
+			seed = seed * 1103515245 + 12345;
+			hostsim_advance(3 * p_old + (seed >> 8) % p_old);
+			XTmrCtr_GetTimerCounterReg(PWMTimerInst.TmrCtr.BaseAddress, PWM_PERIOD_TIMER);
+			if (glitch_nsegs > 0)
+			{
+				glitch_segs[0] = glitch_segs[glitch_nsegs - 1];
+				glitch_nsegs = 1;
+			}
+			t_upd = hostsim_now();
+
+			// the update, as in testpwm's main loop
+			if (m == 0)
+			{
+				PWM_SetParams(&PWMTimerInst, freq, duty);
+			}
+			else
+			{
+				PWM_UpdateParams(&PWMTimerInst, freq, duty);
+			}
+			PWM_GetParams(&PWMTimerInst, &f, &d);
+			update_lcd(f, d, 1);
+			update_lcd(f, d, 2);
+			if (m == 0)
+			{
+				PWM_Start(&PWMTimerInst);
+			}
+
+			// let the new waveform settle and check every period from one old period before the update
+			hostsim_advance(3 * p_new);
+			XTmrCtr_GetTimerCounterReg(PWMTimerInst.TmrCtr.BaseAddress, PWM_PERIOD_TIMER);
+			glitch_analyze(&st[m], (t_upd > p_old) ? t_upd - p_old : 0, hostsim_now(), p_old, h_old,
+				p_new, h_new);
+
+			p_old = p_new;
+			h_old = h_new;
+		}
+		hostsim_pwm_watch(0, NULL, NULL);
+		PWM_Stop(&PWMTimerInst);
+	}
+
+	printf("%-18s %8s %10s %12s %12s %10s %10s %10s %12s\n", "update", "updates", "disturbed", "worst us",
+		"mean us", "truncated", "stretched", "gaps", "max gap us");
+	glitch_print("SetParams+Start", &st[0]);
+	glitch_print("UpdateParams", &st[1]);
+
+	return ((st[1].truncated == 0) && (st[1].gaps == 0)) ? 0 : 1;
+}
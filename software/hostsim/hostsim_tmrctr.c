@@ -0,0 +1,813 @@
+/**
+*
+* @file hostsim_tmrctr.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements the host simulation model of the axi_timer and the subset of the
+* Xilinx tmrctr driver used by the ECE 544 applications.
+*
+* The counters are not stepped clock by clock.  Each timer/counter keeps the value it had at
+* a reference time and the counter value is computed from simulated time when it is read.
+* In PWM mode the output waveform is described by a "segment": the time of a period
+* boundary plus the period (TLR0 + 2) and high time (TLR1 + 2) latched at that boundary.
+* Writes to TLR0/TLR1 while the PWM is running take effect at the next period boundary, the
+* way the auto-reload does on the hardware, so a pair of TLR writes that straddles a
+* boundary produces one period with the new TLR0 and the old TLR1.
+*
+* axi_timer_1 has pwm0 of axi_timer_0 on capturetrig0 and its inverse on capturetrig1.  In
+* capture mode its load registers get the counter value at the PWM edges, which are found
+* from the segment of axi_timer_0 when the registers are read or the timer is polled.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of the host simulation model
+* 1.01a	ri	10/16/26	hostsim_pwm_rises() for the hw_detect gated counter
+* 1.02a	ri	10/16/26	Second timer with external capture of the PWM edges
+* </pre>
+*
+******************************************************************************/
+
+/***************************** Include Files *********************************/
+#include <string.h>
+
+#include "hostsim.h"
+#include "xtmrctr.h"
+
+/************************** Constant Definitions *****************************/
+#define NUM_TIMERS			XPAR_XTMRCTR_NUM_INSTANCES
+#define TMR_WINDOW			0x10000
+
+#define TCSR_WRITE_MASK		0x000007FF
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	u32		tcsr[XTC_DEVICE_TIMER_COUNT];		// control/status registers
+	u32		tlr[XTC_DEVICE_TIMER_COUNT];		// load registers
+	u32		tcr_ref[XTC_DEVICE_TIMER_COUNT];	// counter value at t_ref
+	u64		t_ref[XTC_DEVICE_TIMER_COUNT];		// reference time for the counter value
+	u64		t_poll[XTC_DEVICE_TIMER_COUNT];		// last time the interrupt was checked
+	bool	held[XTC_DEVICE_TIMER_COUNT];		// counter reached terminal count without auto reload
+	int		irq_id;
+
+	// PWM waveform
+	bool	pwm_on;				// PWM output is running
+	u64		seg_start;			// period boundary that started the segment
+	u64		seg_adv;			// time the segment was last brought up to date
+	u64		seg_rise;			// rising edge that started the first high time of the segment
+	u64		seg_p;				// period (clocks) latched at seg_start
+	u64		seg_h;				// high time (clocks) latched at seg_start
+	u64		hist_high;			// last complete high time before seg_start (0 = none)
+	u64		hist_low;			// last complete low time before seg_start (0 = none)
+	u64		last_fall;			// last falling edge before seg_start
+	bool	ever_fell;
+	u64		seg_rises;			// rising edges up to and including seg_start
+	u64		stop_high;			// last complete period when the PWM was stopped
+	u64		stop_low;
+	u64		stop_rises;
+	u64		last_rise;			// last rising edge before the PWM was stopped
+	bool	ever_rose;
+
+	// capture mode
+	int		cap_src;			// timer whose pwm0 drives capturetrig0 (and ~pwm0 capturetrig1), -1 = none
+	u64		cap_edge[XTC_DEVICE_TIMER_COUNT];	// time of the last captured edge
+	bool	cap_seen[XTC_DEVICE_TIMER_COUNT];	// an edge has been captured
+
+	hostsim_pwm_watch_fn	watch;	// waveform observer (optional)
+	void					*watch_ref;
+} hostsim_tmr_t;
+
+/************************** Variable Definitions *****************************/
+static hostsim_tmr_t		timers[NUM_TIMERS];
+static const u32			timer_base[NUM_TIMERS] = { XPAR_TMRCTR_0_BASEADDR, XPAR_TMRCTR_1_BASEADDR };
+static const int			timer_irq[NUM_TIMERS] = { XPAR_MICROBLAZE_0_AXI_INTC_AXI_TIMER_0_INTERRUPT_INTR,
+													  XPAR_MICROBLAZE_0_AXI_INTC_AXI_TIMER_1_INTERRUPT_INTR };
+static const int			timer_cap_src[NUM_TIMERS] = { -1, 0 };		// axi_timer_1 captures pwm0 of axi_timer_0
+
+/****************************************************************************/
+/**
+* Counter value of a timer/counter that is not in PWM mode
+*
+*****************************************************************************/
+static u32 tmr_count(hostsim_tmr_t *tm, int n, u64 now)
+{
+	u32 csr = tm->tcsr[n];
+	u64 elapsed, span;
+
+	if (!(csr & XTC_CSR_ENABLE_TMR_MASK) || tm->held[n])
+	{
+		return tm->tcr_ref[n];
+	}
+	elapsed = now - tm->t_ref[n];
+	if (csr & XTC_CSR_DOWN_COUNT_MASK)
+	{
+		if (elapsed <= tm->tcr_ref[n])
+		{
+			return tm->tcr_ref[n] - (u32) elapsed;
+		}
+		if (!(csr & XTC_CSR_AUTO_RELOAD_MASK))
+		{
+			return 0;
+		}
+		span = (u64) tm->tlr[n] + 1;
+		return tm->tlr[n] - (u32) ((elapsed - tm->tcr_ref[n] - 1) % span);
+	}
+	if (elapsed <= 0xFFFFFFFFULL - tm->tcr_ref[n])
+	{
+		return tm->tcr_ref[n] + (u32) elapsed;
+	}
+	if (!(csr & XTC_CSR_AUTO_RELOAD_MASK))
+	{
+		return 0xFFFFFFFF;
+	}
+	span = 0x100000000ULL - tm->tlr[n];
+	return tm->tlr[n] + (u32) ((elapsed - (0xFFFFFFFFULL - tm->tcr_ref[n]) - 1) % span);
+}
+
+
+// number of terminal counts between the reference time and "now" (generate mode)
+static u64 tmr_tc_count(hostsim_tmr_t *tm, int n, u64 now)
+{
+	u64 elapsed = now - tm->t_ref[n];
+	u64 first, span;
+
+	if (tm->tcsr[n] & XTC_CSR_DOWN_COUNT_MASK)
+	{
+		first = (u64) tm->tcr_ref[n] + 1;
+		span = (u64) tm->tlr[n] + 1;
+	}
+	else
+	{
+		first = 0x100000000ULL - tm->tcr_ref[n];
+		span = 0x100000000ULL - tm->tlr[n];
+	}
+	return (elapsed < first) ? 0 : 1 + (elapsed - first) / span;
+}
+
+
+static bool pwm_enabled(hostsim_tmr_t *tm)
+{
+	u32 mask = XTC_CSR_ENABLE_PWM_MASK | XTC_CSR_ENABLE_TMR_MASK;
+
+	return ((tm->tcsr[0] & mask) == mask) && ((tm->tcsr[1] & mask) == mask);
+}
+
+
+/****************************************************************************/
+/**
+* Evaluates the PWM waveform at time "now"
+*
+* Returns the output level and the lengths (in clocks) of the most recent complete
+* high and low times.  The segment must be up to date (pwm_advance()).
+*
+*****************************************************************************/
+static bool pwm_eval(hostsim_tmr_t *tm, u64 now, u64 *high, u64 *low)
+{
+	u64 ph, k, phase;
+
+	*high = tm->hist_high;
+	*low = tm->hist_low;
+	if (!tm->pwm_on)
+	{
+		return false;
+	}
+	if (tm->seg_h >= tm->seg_p)		// TLR1 >= TLR0 - the output never goes low
+	{
+		return true;
+	}
+
+	ph = now - tm->seg_start;
+	k = ph / tm->seg_p;
+	phase = ph % tm->seg_p;
+
+	if (ph >= tm->seg_h)			// at least one falling edge in this segment
+	{
+		if ((k == 0) || ((k == 1) && (phase < tm->seg_h)))
+		{
+			*high = tm->seg_h + (tm->seg_start - tm->seg_rise);
+		}
+		else
+		{
+			*high = tm->seg_h;
+		}
+	}
+	if (ph >= tm->seg_p)			// at least one complete low time
+	{
+		*low = tm->seg_p - tm->seg_h;
+	}
+	return (phase < tm->seg_h);
+}
+
+
+// time of the most recent falling edge at or before "now" (segment must have one)
+static u64 pwm_last_fall(hostsim_tmr_t *tm, u64 now)
+{
+	u64 ph = now - tm->seg_start;
+	u64 k = ph / tm->seg_p;
+
+	if ((ph % tm->seg_p) < tm->seg_h)
+	{
+		k--;
+	}
+	return tm->seg_start + k * tm->seg_p + tm->seg_h;
+}
+
+
+/****************************************************************************/
+/**
+* Returns the high and low times of the last complete period (the one that ended at the
+* most recent rising edge) and the number of rising edges since the model was reset.
+* The segment must be up to date (pwm_advance()).
+*
+*****************************************************************************/
+static void pwm_period(hostsim_tmr_t *tm, u64 now, u64 *high, u64 *low, u64 *rises)
+{
+	u64 k;
+
+	if (!tm->pwm_on)
+	{
+		*high = tm->stop_high;
+		*low = tm->stop_low;
+		*rises = tm->stop_rises;
+		return;
+	}
+	if (tm->seg_h >= tm->seg_p)		// the output never goes low
+	{
+		pwm_eval(tm, tm->seg_start, high, low);
+		*rises = tm->seg_rises;
+		return;
+	}
+	k = (now - tm->seg_start) / tm->seg_p;
+	pwm_eval(tm, tm->seg_start + k * tm->seg_p, high, low);
+	*rises = tm->seg_rises + k;
+}
+
+
+// time of the most recent rising (or falling) edge at or before "now".  Returns false if
+// there has been none.  The segment must be up to date (pwm_advance()).
+static bool pwm_last_edge(hostsim_tmr_t *tm, u64 now, bool rising, u64 *t)
+{
+	u64 ph, k;
+
+	if (!tm->pwm_on)
+	{
+		*t = rising ? tm->last_rise : tm->last_fall;
+		return rising ? tm->ever_rose : tm->ever_fell;
+	}
+	ph = now - tm->seg_start;
+	if (rising)
+	{
+		k = (tm->seg_h >= tm->seg_p) ? 0 : ph / tm->seg_p;
+		*t = (k == 0) ? tm->seg_rise : tm->seg_start + k * tm->seg_p;
+		return true;
+	}
+	if ((tm->seg_h < tm->seg_p) && (ph >= tm->seg_h))
+	{
+		*t = pwm_last_fall(tm, now);
+		return true;
+	}
+	*t = tm->last_fall;
+	return tm->ever_fell;
+}
+
+
+/****************************************************************************/
+/**
+* Brings the PWM segment up to date
+*
+* TLR0/TLR1 have not changed since seg_adv, so the first period boundary after
+* seg_adv latches the current load registers.  If they differ from the segment,
+* a new segment starts at that boundary.
+*
+*****************************************************************************/
+static void pwm_advance(hostsim_tmr_t *tm, u64 now)
+{
+	u64 p_new, h_new, b, high, low;
+
+	if (!tm->pwm_on || (now <= tm->seg_adv))
+	{
+		return;
+	}
+
+	p_new = (u64) tm->tlr[0] + 2;
+	h_new = (u64) tm->tlr[1] + 2;
+	if ((p_new != tm->seg_p) || (h_new != tm->seg_h))
+	{
+		b = tm->seg_start + ((tm->seg_adv - tm->seg_start) / tm->seg_p + 1) * tm->seg_p;
+		if (b <= now)
+		{
+			pwm_eval(tm, b, &high, &low);
+			if (tm->seg_h < tm->seg_p)
+			{
+				tm->last_fall = b - (tm->seg_p - tm->seg_h);
+				tm->ever_fell = true;
+				tm->seg_rise = b;
+				tm->seg_rises += (b - tm->seg_start) / tm->seg_p;
+			}
+			tm->hist_high = high;
+			tm->hist_low = low;
+			tm->seg_start = b;
+			tm->seg_p = p_new;
+			tm->seg_h = h_new;
+			if (tm->watch != NULL)
+			{
+				tm->watch(tm->watch_ref, b, p_new, h_new);
+			}
+		}
+	}
+	tm->seg_adv = now;
+}
+
+
+static void pwm_start(hostsim_tmr_t *tm, u64 now)
+{
+	if (tm->ever_fell)
+	{
+		tm->hist_low = now - tm->last_fall;
+	}
+	tm->pwm_on = true;
+	tm->seg_rises = tm->stop_rises + 1;
+	tm->seg_start = now;
+	tm->seg_adv = now;
+	tm->seg_rise = now;
+	tm->seg_p = (u64) tm->tlr[0] + 2;
+	tm->seg_h = (u64) tm->tlr[1] + 2;
+	if (tm->watch != NULL)
+	{
+		tm->watch(tm->watch_ref, now, tm->seg_p, tm->seg_h);
+	}
+}
+
+
+static void pwm_stop(hostsim_tmr_t *tm, u64 now)
+{
+	u64 high, low, k;
+
+	pwm_period(tm, now, &tm->stop_high, &tm->stop_low, &tm->stop_rises);
+	if (pwm_eval(tm, now, &high, &low))
+	{
+		// stopped while high - the output falls now and the high time is truncated
+		if (tm->seg_h >= tm->seg_p)
+		{
+			high = now - tm->seg_rise;
+		}
+		else
+		{
+			k = (now - tm->seg_start) / tm->seg_p;
+			high = now - ((k == 0) ? tm->seg_rise : tm->seg_start + k * tm->seg_p);
+		}
+		tm->last_fall = now;
+	}
+	else
+	{
+		tm->last_fall = pwm_last_fall(tm, now);
+	}
+	tm->ever_fell = true;
+	tm->ever_rose = pwm_last_edge(tm, now, true, &tm->last_rise);
+	tm->hist_high = high;
+	tm->hist_low = low;
+	tm->pwm_on = false;
+	if (tm->watch != NULL)
+	{
+		tm->watch(tm->watch_ref, now, 0, 0);
+	}
+}
+
+
+/****************************************************************************/
+/**
+* Capture mode.  capturetrig0 is pwm0 of timer cap_src and capturetrig1 is its inverse,
+* so timer 0 captures the rising edges and timer 1 the falling edges.  The load register
+* gets the counter value at the most recent edge (with ARHT = 0 it is only written while
+* TINT is clear, but it gets the most recent edge rather than the first one after TINT was
+* cleared).  Returns true if a new edge was captured.  The counter does not roll over
+* (about 43 seconds at 100MHz).
+*
+*****************************************************************************/
+static bool cap_update(hostsim_tmr_t *tm, int n, u64 now)
+{
+	u32				mask = XTC_CSR_CAPTURE_MODE_MASK | XTC_CSR_EXT_CAPTURE_MASK | XTC_CSR_ENABLE_TMR_MASK;
+	hostsim_tmr_t	*src;
+	u64				e;
+
+	if ((tm->cap_src < 0) || ((tm->tcsr[n] & mask) != mask))
+	{
+		return false;
+	}
+	src = &timers[tm->cap_src];
+	pwm_advance(src, now);
+	if (!pwm_last_edge(src, now, (n == 0), &e) || (e < tm->t_ref[n]) ||
+		(tm->cap_seen[n] && (e <= tm->cap_edge[n])))
+	{
+		return false;
+	}
+
+	tm->cap_seen[n] = true;
+	tm->cap_edge[n] = e;
+	if ((tm->tcsr[n] & XTC_CSR_AUTO_RELOAD_MASK) || !(tm->tcsr[n] & XTC_CSR_INT_OCCURED_MASK))
+	{
+		tm->tlr[n] = tmr_count(tm, n, e);
+	}
+	tm->tcsr[n] |= XTC_CSR_INT_OCCURED_MASK;
+	return true;
+}
+
+
+/****************************************************************************/
+/**
+* Register read/write handlers
+*
+*****************************************************************************/
+static u32 tmr_read(void *ctx, u32 offset, u64 now)
+{
+	hostsim_tmr_t	*tm = (hostsim_tmr_t *) ctx;
+	int				n = (offset / XTC_TIMER_COUNTER_OFFSET) & 1;
+	u64				phase, latched;
+
+	pwm_advance(tm, now);
+	switch (offset % XTC_TIMER_COUNTER_OFFSET)
+	{
+		case XTC_TCSR_OFFSET:
+			cap_update(tm, n, now);
+			return tm->tcsr[n];
+
+		case XTC_TLR_OFFSET:
+			cap_update(tm, n, now);
+			return tm->tlr[n];
+
+		case XTC_TCR_OFFSET:
+			if (tm->pwm_on)
+			{
+				phase = (now - tm->seg_start) % tm->seg_p;
+				latched = (n == 0) ? tm->seg_p - 2 : tm->seg_h - 2;
+				return (phase <= latched) ? (u32) (latched - phase) : 0;
+			}
+			return tmr_count(tm, n, now);
+
+		default:
+			return 0;
+	}
+}
+
+static void tmr_write(void *ctx, u32 offset, u32 value, u64 now)
+{
+	hostsim_tmr_t	*tm = (hostsim_tmr_t *) ctx;
+	int				n = (offset / XTC_TIMER_COUNTER_OFFSET) & 1;
+	bool			was_pwm;
+	u32				old, csr;
+	int				i;
+
+	pwm_advance(tm, now);
+	was_pwm = tm->pwm_on;
+
+	switch (offset % XTC_TIMER_COUNTER_OFFSET)
+	{
+		case XTC_TCSR_OFFSET:
+			old = tm->tcsr[n];
+			csr = value & TCSR_WRITE_MASK & ~XTC_CSR_INT_OCCURED_MASK;
+			if (!(value & XTC_CSR_INT_OCCURED_MASK))		// TINT is write 1 to clear
+			{
+				csr |= old & XTC_CSR_INT_OCCURED_MASK;
+			}
+
+			// freeze or restart the counter reference when the enable changes
+			if ((old & XTC_CSR_ENABLE_TMR_MASK) != (csr & XTC_CSR_ENABLE_TMR_MASK))
+			{
+				tm->tcr_ref[n] = tmr_count(tm, n, now);
+				tm->t_ref[n] = now;
+				tm->t_poll[n] = now;
+				tm->held[n] = false;
+			}
+			if (csr & XTC_CSR_LOAD_MASK)
+			{
+				tm->tcr_ref[n] = tm->tlr[n];
+				tm->t_ref[n] = now;
+				tm->held[n] = false;
+			}
+			tm->tcsr[n] = csr;
+
+			// ENALL is mirrored in both TCSRs.  Setting it enables both timers,
+			// clearing it has no effect on the enables
+			if ((csr & XTC_CSR_ENABLE_ALL_MASK) && !(old & XTC_CSR_ENABLE_ALL_MASK))
+			{
+				for (i = 0; i < XTC_DEVICE_TIMER_COUNT; i++)
+				{
+					if (!(tm->tcsr[i] & XTC_CSR_ENABLE_TMR_MASK) || (i == n))
+					{
+						tm->tcr_ref[i] = (i == n) ? tm->tcr_ref[i] : tmr_count(tm, i, now);
+						tm->t_ref[i] = now;
+						tm->t_poll[i] = now;
+						tm->held[i] = false;
+					}
+					tm->tcsr[i] |= XTC_CSR_ENABLE_ALL_MASK | XTC_CSR_ENABLE_TMR_MASK;
+				}
+			}
+			else if (!(csr & XTC_CSR_ENABLE_ALL_MASK))
+			{
+				tm->tcsr[n ^ 1] &= ~XTC_CSR_ENABLE_ALL_MASK;
+			}
+
+			// disabling a timer clears ENALL, so ENALL can enable the timers again after
+			// PWM_Stop()/XTmrCtr_Stop() cleared ENT
+			if (!(tm->tcsr[n] & XTC_CSR_ENABLE_TMR_MASK))
+			{
+				tm->tcsr[0] &= ~XTC_CSR_ENABLE_ALL_MASK;
+				tm->tcsr[1] &= ~XTC_CSR_ENABLE_ALL_MASK;
+			}
+			break;
+
+		case XTC_TLR_OFFSET:
+			tm->tlr[n] = value;
+			break;
+
+		default:
+			break;
+	}
+
+	if (!was_pwm && pwm_enabled(tm))
+	{
+		pwm_start(tm, now);
+	}
+	else if (was_pwm && !pwm_enabled(tm))
+	{
+		pwm_stop(tm, now);
+	}
+}
+
+
+/****************************************************************************/
+/**
+* Interrupt generation - called by the simulation clock every quantum
+*
+*****************************************************************************/
+static void tmr_poll(void *ctx, u64 now)
+{
+	hostsim_tmr_t	*tm = (hostsim_tmr_t *) ctx;
+	u64				b;
+	u32				csr;
+	bool			fired;
+	int				n;
+
+	pwm_advance(tm, now);
+	for (n = 0; n < XTC_DEVICE_TIMER_COUNT; n++)
+	{
+		csr = tm->tcsr[n];
+		fired = false;
+
+		if (!(csr & XTC_CSR_ENABLE_TMR_MASK) || tm->held[n])
+		{
+			tm->t_poll[n] = now;
+			continue;
+		}
+
+		if (tm->pwm_on)
+		{
+			// PWM mode - timer 0 reaches terminal count once per period
+			if (n == 0)
+			{
+				b = tm->seg_start + ((tm->t_poll[n] - tm->seg_start) / tm->seg_p + 1) * tm->seg_p;
+				fired = (tm->t_poll[n] >= tm->seg_start) && (b <= now);
+			}
+		}
+		else if (!(csr & XTC_CSR_CAPTURE_MODE_MASK))
+		{
+			// generate mode - has the counter reached terminal count since the last poll?
+			if (csr & XTC_CSR_AUTO_RELOAD_MASK)
+			{
+				fired = tmr_tc_count(tm, n, now) > tmr_tc_count(tm, n, tm->t_poll[n]);
+			}
+			else if (tmr_tc_count(tm, n, now) > 0)
+			{
+				tm->tcr_ref[n] = (csr & XTC_CSR_DOWN_COUNT_MASK) ? 0 : 0xFFFFFFFF;
+				tm->held[n] = true;
+				fired = true;
+			}
+		}
+		else
+		{
+			// capture mode - the interrupt is asserted as long as TINT is set
+			cap_update(tm, n, now);
+			fired = (tm->tcsr[n] & XTC_CSR_INT_OCCURED_MASK) != 0;
+		}
+		tm->t_poll[n] = now;
+
+		if (fired)
+		{
+			tm->tcsr[n] |= XTC_CSR_INT_OCCURED_MASK;
+			if (csr & XTC_CSR_ENABLE_INT_MASK)
+			{
+				hostsim_irq_raise(tm->irq_id);
+			}
+		}
+	}
+}
+
+
+/****************************************************************************/
+/**
+* Registers the timers on the bus
+*
+*****************************************************************************/
+void hostsim_tmrctr_init(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_TIMERS; i++)
+	{
+		memset(&timers[i], 0, sizeof(timers[i]));
+		timers[i].irq_id = timer_irq[i];
+		timers[i].cap_src = timer_cap_src[i];
+		hostsim_register_device("axi_timer", timer_base[i], TMR_WINDOW, tmr_read, tmr_write,
+			tmr_poll, &timers[i]);
+	}
+}
+
+
+/****************************************************************************/
+/**
+* Waveform queries used by the models of the hardware connected to pwm0
+* (GPIO_0 channel 1 and hw_detect).
+*
+*****************************************************************************/
+bool hostsim_pwm_level(int dev, u64 now)
+{
+	u64 high, low;
+
+	pwm_advance(&timers[dev], now);
+	return pwm_eval(&timers[dev], now, &high, &low);
+}
+
+void hostsim_pwm_period(int dev, u64 now, u64 *high, u64 *low, u64 *rises)
+{
+	pwm_advance(&timers[dev], now);
+	pwm_period(&timers[dev], now, high, low, rises);
+}
+
+// rising edges up to time t (t <= now).  Exact if t is in the current segment, otherwise
+// the edges since the start of the segment are counted up to t
+u64 hostsim_pwm_rises(int dev, u64 now, u64 t)
+{
+	hostsim_tmr_t	*tm = &timers[dev];
+	u64				high, low, rises;
+
+	pwm_advance(tm, now);
+	pwm_period(tm, (t < tm->seg_start) ? tm->seg_start : t, &high, &low, &rises);
+	return rises;
+}
+
+void hostsim_pwm_watch(int dev, hostsim_pwm_watch_fn fn, void *ref)
+{
+	pwm_advance(&timers[dev], hostsim_now());
+	timers[dev].watch = fn;
+	timers[dev].watch_ref = ref;
+}
+
+
+/***************************** TMRCTR DRIVER ********************************/
+
+int XTmrCtr_Initialize(XTmrCtr *InstancePtr, u16 DeviceId)
+{
+	int n;
+
+	if (DeviceId >= NUM_TIMERS)
+	{
+		return XST_DEVICE_NOT_FOUND;
+	}
+	if ((InstancePtr->IsStartedTmrCtr0 == XIL_COMPONENT_IS_STARTED) ||
+		(InstancePtr->IsStartedTmrCtr1 == XIL_COMPONENT_IS_STARTED))
+	{
+		return XST_DEVICE_IS_STARTED;
+	}
+
+	InstancePtr->BaseAddress = timer_base[DeviceId];
+	InstancePtr->Handler = NULL;
+	InstancePtr->CallBackRef = NULL;
+
+	// clear the registers and any pending interrupts, same as the Xilinx driver
+	for (n = 0; n < XTC_DEVICE_TIMER_COUNT; n++)
+	{
+		XTmrCtr_WriteReg(InstancePtr->BaseAddress, n, XTC_TCSR_OFFSET, 0);
+		XTmrCtr_WriteReg(InstancePtr->BaseAddress, n, XTC_TLR_OFFSET, 0);
+		XTmrCtr_WriteReg(InstancePtr->BaseAddress, n, XTC_TCSR_OFFSET,
+			XTC_CSR_INT_OCCURED_MASK | XTC_CSR_LOAD_MASK);
+		XTmrCtr_WriteReg(InstancePtr->BaseAddress, n, XTC_TCSR_OFFSET, 0);
+	}
+	InstancePtr->IsStartedTmrCtr0 = 0;
+	InstancePtr->IsStartedTmrCtr1 = 0;
+	InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+	return XST_SUCCESS;
+}
+
+void XTmrCtr_Start(XTmrCtr *InstancePtr, u8 TmrCtrNumber)
+{
+	u32 csr;
+
+	// load the counter from TLR then enable it, same as the Xilinx driver
+	csr = XTmrCtr_ReadReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET);
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET, XTC_CSR_LOAD_MASK);
+	XTmrCtr_WriteReg(InstancePtr->BaseAddress, TmrCtrNumber, XTC_TCSR_OFFSET, csr | XTC_CSR_ENABLE_TMR_MASK);
+	if (TmrCtrNumber == 0)
+	{
+		InstancePtr->IsStartedTmrCtr0 = XIL_COMPONENT_IS_STARTED;
+	}
+	else
+	{
+		InstancePtr->IsStartedTmrCtr1 = XIL_COMPONENT_IS_STARTED;
+	}
+}
+
+void XTmrCtr_Stop(XTmrCtr *InstancePtr, u8 TmrCtrNumber)
+{
+	XTmrCtr_Disable(InstancePtr->BaseAddress, TmrCtrNumber);
+	if (TmrCtrNumber == 0)
+	{
+		InstancePtr->IsStartedTmrCtr0 = 0;
+	}
+	else
+	{
+		InstancePtr->IsStartedTmrCtr1 = 0;
+	}
+}
+
+u32 XTmrCtr_GetValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber)
+{
+	return XTmrCtr_GetTimerCounterReg(InstancePtr->BaseAddress, TmrCtrNumber);
+}
+
+void XTmrCtr_SetResetValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber, u32 ResetValue)
+{
+	XTmrCtr_SetLoadReg(InstancePtr->BaseAddress, TmrCtrNumber, ResetValue);
+}
+
+u32 XTmrCtr_GetCaptureValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber)
+{
+	return XTmrCtr_GetLoadReg(InstancePtr->BaseAddress, TmrCtrNumber);
+}
+
+void XTmrCtr_Reset(XTmrCtr *InstancePtr, u8 TmrCtrNumber)
+{
+	u32 csr = XTmrCtr_GetControlStatusReg(InstancePtr->BaseAddress, TmrCtrNumber);
+
+	XTmrCtr_SetControlStatusReg(InstancePtr->BaseAddress, TmrCtrNumber, csr | XTC_CSR_LOAD_MASK);
+	XTmrCtr_SetControlStatusReg(InstancePtr->BaseAddress, TmrCtrNumber, csr);
+}
+
+void XTmrCtr_SetOptions(XTmrCtr *InstancePtr, u8 TmrCtrNumber, u32 Options)
+{
+	u32 csr = 0;
+
+	if (Options & XTC_ENABLE_ALL_OPTION)	csr |= XTC_CSR_ENABLE_ALL_MASK;
+	if (Options & XTC_DOWN_COUNT_OPTION)	csr |= XTC_CSR_DOWN_COUNT_MASK;
+	if (Options & XTC_CAPTURE_MODE_OPTION)	csr |= XTC_CSR_CAPTURE_MODE_MASK | XTC_CSR_EXT_CAPTURE_MASK;
+	if (Options & XTC_INT_MODE_OPTION)		csr |= XTC_CSR_ENABLE_INT_MASK;
+	if (Options & XTC_AUTO_RELOAD_OPTION)	csr |= XTC_CSR_AUTO_RELOAD_MASK;
+	if (Options & XTC_EXT_COMPARE_OPTION)	csr |= XTC_CSR_EXT_GENERATE_MASK;
+
+	XTmrCtr_SetControlStatusReg(InstancePtr->BaseAddress, TmrCtrNumber, csr);
+}
+
+u32 XTmrCtr_GetOptions(XTmrCtr *InstancePtr, u8 TmrCtrNumber)
+{
+	u32 csr = XTmrCtr_GetControlStatusReg(InstancePtr->BaseAddress, TmrCtrNumber);
+	u32 options = 0;
+
+	if (csr & XTC_CSR_ENABLE_ALL_MASK)		options |= XTC_ENABLE_ALL_OPTION;
+	if (csr & XTC_CSR_DOWN_COUNT_MASK)		options |= XTC_DOWN_COUNT_OPTION;
+	if (csr & XTC_CSR_CAPTURE_MODE_MASK)	options |= XTC_CAPTURE_MODE_OPTION;
+	if (csr & XTC_CSR_ENABLE_INT_MASK)		options |= XTC_INT_MODE_OPTION;
+	if (csr & XTC_CSR_AUTO_RELOAD_MASK)		options |= XTC_AUTO_RELOAD_OPTION;
+	if (csr & XTC_CSR_EXT_GENERATE_MASK)	options |= XTC_EXT_COMPARE_OPTION;
+	return options;
+}
+
+void XTmrCtr_SetHandler(XTmrCtr *InstancePtr, XTmrCtr_Handler FuncPtr, void *CallBackRef)
+{
+	InstancePtr->Handler = FuncPtr;
+	InstancePtr->CallBackRef = CallBackRef;
+}
+
+void XTmrCtr_InterruptHandler(void *InstancePtr)
+{
+	XTmrCtr	*tmr = (XTmrCtr *) InstancePtr;
+	u32		csr;
+	u8		n;
+
+	for (n = 0; n < XTC_DEVICE_TIMER_COUNT; n++)
+	{
+		csr = XTmrCtr_GetControlStatusReg(tmr->BaseAddress, n);
+		if ((csr & XTC_CSR_ENABLE_INT_MASK) && (csr & XTC_CSR_INT_OCCURED_MASK))
+		{
+			if (tmr->Handler != NULL)
+			{
+				tmr->Handler(tmr->CallBackRef, n);
+			}
+			// the handler may have changed the TCSR - re-read it before acknowledging
+			csr = XTmrCtr_GetControlStatusReg(tmr->BaseAddress, n);
+			XTmrCtr_SetControlStatusReg(tmr->BaseAddress, n, csr | XTC_CSR_INT_OCCURED_MASK);
+		}
+	}
+}
@@ -0,0 +1,201 @@
+/**
+*
+* @file hostsim_uartlite.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements the host simulation model of the axi_uartlite (stdout, 19200 baud)
+* and xil_printf().  Characters written to the 16 entry transmit FIFO leave at the line
+* rate, so a long xil_printf() blocks the caller for the same simulated time it would on
+* the board.  Transmitted bytes go to the host stdout or to a capture file.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of the host simulation model
+* 1.01a	ri	10/16/26	outbyte() is weak so the application can replace it
+* </pre>
+*
+******************************************************************************/
+
+/***************************** Include Files *********************************/
+#include <stdarg.h>
+#include <string.h>
+
+#include "hostsim.h"
+#include "xuartlite_l.h"
+#include "xil_printf.h"
+
+/************************** Constant Definitions *****************************/
+#define UART_WINDOW			0x10000
+#define UART_CHAR_CYCLES	(HOSTSIM_CLOCK_FREQ_HZ / (XPAR_UARTLITE_0_BAUDRATE / 10))	// 8N1
+#define UART_IRQ_ID			XPAR_MICROBLAZE_0_AXI_INTC_AXI_UARTLITE_0_INTERRUPT_INTR
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	u8		fifo[XUL_FIFO_SIZE];	// transmit FIFO
+	int		head;
+	int		count;
+	u64		next_done;				// time the character in the shift register is done
+	u32		ctrl;
+	u64		sent;					// characters transmitted
+	FILE	*out;
+} hostsim_uart_t;
+
+/************************** Variable Definitions *****************************/
+static hostsim_uart_t	uart;
+
+/****************************************************************************/
+/**
+* Moves characters out of the transmit FIFO at the line rate
+*
+* Returns true if the FIFO went empty
+*
+*****************************************************************************/
+static bool uart_drain(hostsim_uart_t *up, u64 now)
+{
+	bool emptied = false;
+
+	while ((up->count > 0) && (now >= up->next_done))
+	{
+		fputc(up->fifo[up->head], up->out);
+		up->head = (up->head + 1) % XUL_FIFO_SIZE;
+		up->count--;
+		up->sent++;
+		up->next_done += UART_CHAR_CYCLES;
+		emptied = (up->count == 0);
+	}
+	return emptied;
+}
+
+
+static u32 uart_read(void *ctx, u32 offset, u64 now)
+{
+	hostsim_uart_t	*up = (hostsim_uart_t *) ctx;
+	u32				sts = 0;
+
+	uart_drain(up, now);
+	if (offset != XUL_STATUS_REG_OFFSET)
+	{
+		return 0;
+	}
+	if (up->count == 0)				sts |= XUL_SR_TX_FIFO_EMPTY;
+	if (up->count == XUL_FIFO_SIZE)	sts |= XUL_SR_TX_FIFO_FULL;
+	if (up->ctrl & XUL_CR_ENABLE_INTR)	sts |= XUL_SR_INTR_ENABLED;
+	return sts;
+}
+
+static void uart_write(void *ctx, u32 offset, u32 value, u64 now)
+{
+	hostsim_uart_t *up = (hostsim_uart_t *) ctx;
+
+	uart_drain(up, now);
+	switch (offset)
+	{
+		case XUL_TX_FIFO_OFFSET:
+			if (up->count == XUL_FIFO_SIZE)		// overrun - the byte is lost
+			{
+				break;
+			}
+			if (up->count == 0)
+			{
+				up->next_done = now + UART_CHAR_CYCLES;
+			}
+			up->fifo[(up->head + up->count) % XUL_FIFO_SIZE] = (u8) value;
+			up->count++;
+			break;
+
+		case XUL_CONTROL_REG_OFFSET:
+			if (value & XUL_CR_FIFO_TX_RESET)
+			{
+				up->count = 0;
+			}
+			up->ctrl = value & XUL_CR_ENABLE_INTR;
+			break;
+
+		default:
+			break;
+	}
+}
+
+// transmit FIFO empty interrupt - called by the simulation clock every quantum
+static void uart_poll(void *ctx, u64 now)
+{
+	hostsim_uart_t *up = (hostsim_uart_t *) ctx;
+
+	if (uart_drain(up, now) && (up->ctrl & XUL_CR_ENABLE_INTR))
+	{
+		hostsim_irq_raise(UART_IRQ_ID);
+	}
+}
+
+
+void hostsim_uartlite_init(void)
+{
+	memset(&uart, 0, sizeof(uart));
+	uart.out = stdout;
+	hostsim_register_device("axi_uartlite", XPAR_UARTLITE_0_BASEADDR, UART_WINDOW, uart_read,
+		uart_write, uart_poll, &uart);
+}
+
+/****************************************************************************/
+/**
+* Sends the transmitted bytes to "fp" instead of stdout
+*
+*****************************************************************************/
+void hostsim_uartlite_capture(FILE *fp)
+{
+	uart.out = fp;
+}
+
+u64 hostsim_uartlite_bytes(void)
+{
+	return uart.sent;
+}
+
+
+/*************************** UART-LITE DRIVER *******************************/
+
+void XUartLite_SendByte(UINTPTR BaseAddress, u8 Data)
+{
+	while (XUartLite_IsTransmitFull(BaseAddress))
+	{
+		// wait for room in the FIFO
+	}
+	XUartLite_WriteReg(BaseAddress, XUL_TX_FIFO_OFFSET, Data);
+}
+
+u8 XUartLite_RecvByte(UINTPTR BaseAddress)
+{
+	while (XUartLite_IsReceiveEmpty(BaseAddress))
+	{
+		// the model never receives anything - this would hang on the board, too
+	}
+	return (u8) XUartLite_ReadReg(BaseAddress, XUL_RX_FIFO_OFFSET);
+}
+
+
+// weak, like the BSP outbyte() an application can replace it (telem.c does)
+__attribute__((weak)) void outbyte(char c)
+{
+	XUartLite_SendByte(XPAR_UARTLITE_0_BASEADDR, (u8) c);
+}
+
+void xil_printf(const char *ctrl1, ...)
+{
+	char	buf[256];
+	va_list	args;
+	int		i;
+
+	va_start(args, ctrl1);
+	vsnprintf(buf, sizeof(buf), ctrl1, args);
+	va_end(args);
+
+	for (i = 0; buf[i] != '\0'; i++)
+	{
+		outbyte(buf[i]);
+	}
+}
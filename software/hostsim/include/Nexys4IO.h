@@ -0,0 +1,116 @@
+/**
+*
+* @file Nexys4IO.h
+*
+* Host simulation stand-in for the Nexys4IO custom peripheral driver.  The
+* register layout below is the one used by the hostsim Nexys4IO model; the API
+* matches the driver used on the target.
+*
+******************************************************************************/
+
+#ifndef NEXYS4IO_H		/* prevent circular inclusions */
+#define NEXYS4IO_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xstatus.h"
+
+/************************** Constant Definitions *****************************/
+#define NEXYS4IO_BTNSW_IN_OFFSET	0x00	// [20:16] buttons, [15:0] switches
+#define NEXYS4IO_LEDS_OFFSET		0x04
+#define NEXYS4IO_DIGITS_LO_OFFSET	0x08
+#define NEXYS4IO_DIGITS_HI_OFFSET	0x0C
+#define NEXYS4IO_RGB1_DATA_OFFSET	0x10
+#define NEXYS4IO_RGB2_DATA_OFFSET	0x14
+#define NEXYS4IO_RGB1_CNTRL_OFFSET	0x18
+#define NEXYS4IO_RGB2_CNTRL_OFFSET	0x1C
+
+#define NEXYS4IO_SSEG_DECPTS_MASK	0x0F000000
+
+// buttons
+#define BTNR						0x01
+#define BTNL						0x02
+#define BTND						0x04
+#define BTNU						0x08
+#define BTNC						0x10
+
+// RGB LEDs
+#define RGB1						0
+#define RGB2						1
+
+// seven segment display banks and digits
+#define SSEGLO						0
+#define SSEGHI						1
+
+#define DIGIT0						0
+#define DIGIT1						1
+#define DIGIT2						2
+#define DIGIT3						3
+#define DIGIT4						4
+#define DIGIT5						5
+#define DIGIT6						6
+#define DIGIT7						7
+
+// decimal points
+#define DP_NONE						0x00
+#define DP_ALL						0x0F
+
+// character codes
+#define CC_0						0x00
+#define CC_1						0x01
+#define CC_2						0x02
+#define CC_3						0x03
+#define CC_4						0x04
+#define CC_5						0x05
+#define CC_6						0x06
+#define CC_7						0x07
+#define CC_8						0x08
+#define CC_9						0x09
+#define CC_A						0x0A
+#define CC_B						0x0B
+#define CC_C						0x0C
+#define CC_D						0x0D
+#define CC_E						0x0E
+#define CC_F						0x0F
+#define CC_LCY						0x10
+#define CC_H						0x11
+#define CC_L						0x12
+#define CC_R						0x13
+#define CC_LCL						0x14
+#define CC_LCR						0x15
+#define CC_SPACE1					0x16
+#define CC_BLANK					0x1C
+
+/************************** Function Prototypes ******************************/
+int		NX4IO_initialize(u32 BaseAddress);
+
+u16		NX4IO_getSwitches(void);
+u8		NX4IO_getBtns(void);
+bool	NX4IO_isPressed(u8 btn);
+
+void	NX4IO_setLEDs(u32 ledvalue);
+
+void	NX4IO_RGBLED_setRGB_DATA(u8 RGBsel, u32 data);
+void	NX4IO_RGBLED_setRGB_CNTRL(u8 RGBsel, u32 data);
+void	NX4IO_RGBLED_setDutyCycle(u8 RGBsel, u8 red, u8 green, u8 blue);
+void	NX4IO_RGBLED_setChnlEn(u8 RGBsel, bool red, bool green, bool blue);
+
+u32		NX4IO_SSEG_getSSEG_DATA(u8 digits);
+void	NX4IO_SSEG_setSSEG_DATA(u8 digits, u32 data);
+void	NX4IO_SSEG_setDigit(u8 digits, u8 digit, u8 charcode);
+void	NX4IO_SSEG_setDecPt(u8 digits, u8 decpt, bool on);
+void	NX410_SSEG_setAllDigits(u8 digits, u8 dig3, u8 dig2, u8 dig1, u8 dig0, u8 decpts);
+void	NX4IO_SSEG_putU16Hex(u8 digits, u16 value);
+void	NX4IO_SSEG_putU32Hex(u32 value);
+void	NX4IO_SSEG_putU32Dec(u32 value, bool blank);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,58 @@
+/**
+*
+* @file PMod544IOR2.h
+*
+* Host simulation stand-in for the PMod544IOR2 custom peripheral driver
+* (PmodENC rotary encoder and PmodCLP 2x16 character LCD).  The register layout
+* below is the one used by the hostsim PMod544IOR2 model; the API matches the
+* driver used on the target.
+*
+******************************************************************************/
+
+#ifndef PMOD544IOR2_H	/* prevent circular inclusions */
+#define PMOD544IOR2_H	/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xstatus.h"
+
+/************************** Constant Definitions *****************************/
+#define PMDIO_ROTLCD_STS_OFFSET		0x00	// [8] LCD busy, [1] rotary switch, [0] rotary button
+#define PMDIO_ROT_CNT_OFFSET		0x04
+#define PMDIO_ROT_CNTRL_OFFSET		0x08	// [31] no negative, [15:0] increment
+#define PMDIO_LCD_CMD_OFFSET		0x0C
+#define PMDIO_LCD_DATA_OFFSET		0x10
+
+#define PMDIO_STS_ROTBTN_MASK		0x00000001
+#define PMDIO_STS_ROTSW_MASK		0x00000002
+#define PMDIO_STS_LCDBUSY_MASK		0x00000100
+
+#define PMDIO_ROT_CLEAR_MASK		0x40000000
+#define PMDIO_ROT_NONEG_MASK		0x80000000
+
+/************************** Function Prototypes ******************************/
+int		PMDIO_initialize(u32 BaseAddress);
+
+void	PMDIO_ROT_init(int inc_dec_cnt, bool no_neg);
+void	PMDIO_ROT_clear(void);
+void	PMDIO_ROT_readRotcnt(int *RotaryCnt);
+bool	PMDIO_ROT_isBtnPressed(void);
+bool	PMDIO_ROT_isSwOn(void);
+
+void	PMDIO_LCD_clrd(void);
+void	PMDIO_LCD_setcursor(u32 row, u32 col);
+void	PMDIO_LCD_wrchar(char ch);
+void	PMDIO_LCD_wrstring(char *s);
+void	PMDIO_LCD_putnum(s32 num, s32 radix);
+void	PMDIO_LCD_puthex(u32 num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
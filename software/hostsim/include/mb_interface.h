@@ -0,0 +1,34 @@
+/**
+*
+* @file mb_interface.h
+*
+* Host simulation stand-in for the Microblaze processor interface functions.
+* The interrupt enable is the MSR[IE] bit of the simulated processor; the
+* hostsim interrupt controller model only delivers interrupts while it is set.
+* WAIT_FOR_INTERRUPT() and SPIN_WAIT() (see idle.h) stand for one pass of a wait loop
+* of the application and let the deterministic simulation clock skip to the next
+* interrupt (hostsim_idle()).
+*
+******************************************************************************/
+
+#ifndef MB_INTERFACE_H	/* prevent circular inclusions */
+#define MB_INTERFACE_H	/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************** Function Prototypes ******************************/
+void microblaze_enable_interrupts(void);
+void microblaze_disable_interrupts(void);
+void hostsim_idle(void);
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#define WAIT_FOR_INTERRUPT()	hostsim_idle()
+#define SPIN_WAIT()				hostsim_idle()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,66 @@
+/**
+*
+* @file xgpio.h
+*
+* Host simulation stand-in for the Xilinx axi_gpio driver.  The data and
+* direction registers are modelled by hostsim; input bits are driven by the
+* simulated hardware connected to each channel.
+*
+******************************************************************************/
+
+#ifndef XGPIO_H			/* prevent circular inclusions */
+#define XGPIO_H			/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xstatus.h"
+
+/************************** Constant Definitions *****************************/
+#define XGPIO_DATA_OFFSET		0x0
+#define XGPIO_TRI_OFFSET		0x4
+#define XGPIO_DATA2_OFFSET		0x8
+#define XGPIO_TRI2_OFFSET		0xC
+#define XGPIO_GIE_OFFSET		0x11C
+#define XGPIO_ISR_OFFSET		0x120
+#define XGPIO_IER_OFFSET		0x128
+
+#define XGPIO_CHAN_OFFSET		8
+
+#define XGPIO_GIE_GINTR_ENABLE_MASK	0x80000000
+#define XGPIO_IR_CH1_MASK		0x1
+#define XGPIO_IR_CH2_MASK		0x2
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	UINTPTR	BaseAddress;		// device base address
+	u32		IsReady;			// device is initialized and ready
+	int		InterruptPresent;	// are interrupts supported in h/w
+	int		IsDual;				// are 2 channels supported in h/w
+} XGpio;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#define XGpio_ReadReg(BaseAddress, RegOffset)				Xil_In32((BaseAddress) + (RegOffset))
+#define XGpio_WriteReg(BaseAddress, RegOffset, Data)		Xil_Out32((BaseAddress) + (RegOffset), (u32) (Data))
+
+/************************** Function Prototypes ******************************/
+int		XGpio_Initialize(XGpio *InstancePtr, u16 DeviceId);
+void	XGpio_SetDataDirection(XGpio *InstancePtr, unsigned Channel, u32 DirectionMask);
+u32		XGpio_GetDataDirection(XGpio *InstancePtr, unsigned Channel);
+u32		XGpio_DiscreteRead(XGpio *InstancePtr, unsigned Channel);
+void	XGpio_DiscreteWrite(XGpio *InstancePtr, unsigned Channel, u32 Mask);
+void	XGpio_InterruptGlobalEnable(XGpio *InstancePtr);
+void	XGpio_InterruptGlobalDisable(XGpio *InstancePtr);
+void	XGpio_InterruptEnable(XGpio *InstancePtr, u32 Mask);
+void	XGpio_InterruptDisable(XGpio *InstancePtr, u32 Mask);
+void	XGpio_InterruptClear(XGpio *InstancePtr, u32 Mask);
+u32		XGpio_InterruptGetStatus(XGpio *InstancePtr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,18 @@
+/**
+*
+* @file xil_cache.h
+*
+* Host simulation stand-in for the Xilinx cache control functions.  The host
+* has no caches to manage so all of the functions are empty.
+*
+******************************************************************************/
+
+#ifndef XIL_CACHE_H		/* prevent circular inclusions */
+#define XIL_CACHE_H		/* by using protection macros */
+
+#define Xil_ICacheEnable()
+#define Xil_DCacheEnable()
+#define Xil_ICacheDisable()
+#define Xil_DCacheDisable()
+
+#endif /* end of protection macro */
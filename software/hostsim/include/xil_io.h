@@ -0,0 +1,33 @@
+/**
+*
+* @file xil_io.h
+*
+* Host simulation stand-in for the Xilinx standalone BSP register access
+* functions.  Every access is routed to the hostsim bus model so that register
+* reads and writes hit the simulated peripherals and are counted.
+*
+******************************************************************************/
+
+#ifndef XIL_IO_H		/* prevent circular inclusions */
+#define XIL_IO_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "xil_types.h"
+#include "xil_printf.h"
+
+/************************** Function Prototypes ******************************/
+u32		hostsim_bus_read(UINTPTR Addr);
+void	hostsim_bus_write(UINTPTR Addr, u32 Value);
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#define Xil_In32(Addr)			hostsim_bus_read((UINTPTR) (Addr))
+#define Xil_Out32(Addr, Value)	hostsim_bus_write((UINTPTR) (Addr), (u32) (Value))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
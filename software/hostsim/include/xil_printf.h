@@ -0,0 +1,25 @@
+/**
+*
+* @file xil_printf.h
+*
+* Host simulation stand-in for the Xilinx lightweight printf.  Output goes to
+* the host stdout.
+*
+******************************************************************************/
+
+#ifndef XIL_PRINTF_H	/* prevent circular inclusions */
+#define XIL_PRINTF_H	/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************** Function Prototypes ******************************/
+void xil_printf(const char *ctrl1, ...);
+void outbyte(char c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,46 @@
+/**
+*
+* @file xil_types.h
+*
+* Host simulation stand-in for the Xilinx standalone BSP basic types.  Only the
+* types and constants used by the ECE 544 applications are provided.
+*
+******************************************************************************/
+
+#ifndef XIL_TYPES_H		/* prevent circular inclusions */
+#define XIL_TYPES_H		/* by using protection macros */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/************************** Constant Definitions *****************************/
+#ifndef TRUE
+#define TRUE		1U
+#endif
+
+#ifndef FALSE
+#define FALSE		0U
+#endif
+
+#ifndef NULL
+#define NULL		0U
+#endif
+
+#define XIL_COMPONENT_IS_READY		0x11111111U
+#define XIL_COMPONENT_IS_STARTED	0x22222222U
+
+/**************************** Type Definitions *******************************/
+typedef uint8_t		u8;
+typedef uint16_t	u16;
+typedef uint32_t	u32;
+typedef uint64_t	u64;
+
+typedef int8_t		s8;
+typedef int16_t		s16;
+typedef int32_t		s32;
+typedef int64_t		s64;
+
+typedef uintptr_t	UINTPTR;
+typedef intptr_t	INTPTR;
+
+#endif /* end of protection macro */
@@ -0,0 +1,50 @@
+/**
+*
+* @file xintc.h
+*
+* Host simulation stand-in for the Xilinx axi_intc driver.  Handlers connected
+* here are dispatched by the hostsim interrupt model, which preempts the
+* application thread the same way the Microblaze interrupt does.
+*
+******************************************************************************/
+
+#ifndef XINTC_H			/* prevent circular inclusions */
+#define XINTC_H			/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xparameters.h"
+
+/************************** Constant Definitions *****************************/
+#define XIN_SIMULATION_MODE		1
+#define XIN_REAL_MODE			2
+
+/**************************** Type Definitions *******************************/
+typedef void (*XInterruptHandler) (void *InstancePtr);
+
+typedef struct {
+	UINTPTR	BaseAddress;		// base address of registers
+	u32		IsReady;			// device is initialized and ready
+	u32		IsStarted;			// device has been started
+	u32		UnhandledInterrupts;	// intc statistics
+} XIntc;
+
+/************************** Function Prototypes ******************************/
+int		XIntc_Initialize(XIntc *InstancePtr, u16 DeviceId);
+int		XIntc_Start(XIntc *InstancePtr, u8 Mode);
+void	XIntc_Stop(XIntc *InstancePtr);
+int		XIntc_Connect(XIntc *InstancePtr, u8 Id, XInterruptHandler Handler, void *CallBackRef);
+void	XIntc_Disconnect(XIntc *InstancePtr, u8 Id);
+void	XIntc_Enable(XIntc *InstancePtr, u8 Id);
+void	XIntc_Disable(XIntc *InstancePtr, u8 Id);
+void	XIntc_Acknowledge(XIntc *InstancePtr, u8 Id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,87 @@
+/**
+*
+* @file xparameters.h
+*
+* Host simulation stand-in for the BSP generated xparameters.h.  The device IDs,
+* base addresses and clock frequencies describe the ECE 544 Project #1 embedded
+* system (Microblaze @ 100MHz, 40KHz FIT, two axi_timers, three axi_gpio's,
+* Nexys4IO, PMod544IOR2 and a UART-Lite).  The hostsim bus model decodes the
+* same addresses.
+*
+******************************************************************************/
+
+#ifndef XPARAMETERS_H	/* prevent circular inclusions */
+#define XPARAMETERS_H	/* by using protection macros */
+
+/* Microblaze */
+#define XPAR_CPU_CORE_CLOCK_FREQ_HZ							100000000
+#define XPAR_CPU_M_AXI_DP_FREQ_HZ							100000000
+#define XPAR_MICROBLAZE_USE_ICACHE							0
+#define XPAR_MICROBLAZE_USE_DCACHE							0
+
+/* AXI GPIO 0 - PWM feedback (channel 1) and FIT clock (channel 2) */
+#define XPAR_AXI_GPIO_0_DEVICE_ID							0
+#define XPAR_AXI_GPIO_0_BASEADDR							0x40000000
+#define XPAR_AXI_GPIO_0_HIGHADDR							0x4000FFFF
+#define XPAR_AXI_GPIO_0_INTERRUPT_PRESENT					0
+#define XPAR_AXI_GPIO_0_IS_DUAL								1
+
+/* AXI GPIO 1 - hw_detect high count (channel 1) and low count (channel 2) */
+#define XPAR_AXI_GPIO_1_DEVICE_ID							1
+#define XPAR_AXI_GPIO_1_BASEADDR							0x40010000
+#define XPAR_AXI_GPIO_1_HIGHADDR							0x4001FFFF
+#define XPAR_AXI_GPIO_1_INTERRUPT_PRESENT					0
+#define XPAR_AXI_GPIO_1_IS_DUAL								1
+
+/* AXI GPIO 2 - hw_detect statistics command (channel 1) and register (channel 2) */
+#define XPAR_AXI_GPIO_2_DEVICE_ID							2
+#define XPAR_AXI_GPIO_2_BASEADDR							0x40020000
+#define XPAR_AXI_GPIO_2_HIGHADDR							0x4002FFFF
+#define XPAR_AXI_GPIO_2_INTERRUPT_PRESENT					0
+#define XPAR_AXI_GPIO_2_IS_DUAL								1
+
+#define XPAR_XGPIO_NUM_INSTANCES							3
+
+/* UART-Lite */
+#define XPAR_UARTLITE_0_DEVICE_ID							0
+#define XPAR_UARTLITE_0_BASEADDR							0x40600000
+#define XPAR_UARTLITE_0_HIGHADDR							0x4060FFFF
+#define XPAR_UARTLITE_0_BAUDRATE							19200
+#define STDOUT_BASEADDRESS									0x40600000
+
+/* Interrupt controller */
+#define XPAR_INTC_0_DEVICE_ID								0
+#define XPAR_INTC_0_BASEADDR								0x41200000
+#define XPAR_INTC_0_HIGHADDR								0x4120FFFF
+#define XPAR_INTC_MAX_NUM_INTR_INPUTS						4
+
+#define XPAR_MICROBLAZE_0_AXI_INTC_FIT_TIMER_0_INTERRUPT_INTR	0
+#define XPAR_MICROBLAZE_0_AXI_INTC_AXI_TIMER_0_INTERRUPT_INTR	1
+#define XPAR_MICROBLAZE_0_AXI_INTC_AXI_UARTLITE_0_INTERRUPT_INTR	2
+#define XPAR_MICROBLAZE_0_AXI_INTC_AXI_TIMER_1_INTERRUPT_INTR	3
+
+/* AXI timer 0 - PWM generator */
+#define XPAR_TMRCTR_0_DEVICE_ID								0
+#define XPAR_TMRCTR_0_BASEADDR								0x41C00000
+#define XPAR_TMRCTR_0_HIGHADDR								0x41C0FFFF
+#define XPAR_TMRCTR_0_CLOCK_FREQ_HZ							100000000
+
+/* AXI timer 1 - PWM edge capture (capturetrig0 = pwm0, capturetrig1 = ~pwm0) */
+#define XPAR_TMRCTR_1_DEVICE_ID								1
+#define XPAR_TMRCTR_1_BASEADDR								0x41C10000
+#define XPAR_TMRCTR_1_HIGHADDR								0x41C1FFFF
+#define XPAR_TMRCTR_1_CLOCK_FREQ_HZ							100000000
+
+#define XPAR_XTMRCTR_NUM_INSTANCES							2
+
+/* Nexys4IO */
+#define XPAR_NEXYS4IO_0_DEVICE_ID							0
+#define XPAR_NEXYS4IO_0_S00_AXI_BASEADDR					0x44A00000
+#define XPAR_NEXYS4IO_0_S00_AXI_HIGHADDR					0x44A0FFFF
+
+/* PMod544IOR2 */
+#define XPAR_PMOD544IOR2_0_DEVICE_ID						0
+#define XPAR_PMOD544IOR2_0_S00_AXI_BASEADDR					0x44A10000
+#define XPAR_PMOD544IOR2_0_S00_AXI_HIGHADDR					0x44A1FFFF
+
+#endif /* end of protection macro */
@@ -0,0 +1,32 @@
+/**
+*
+* @file xstatus.h
+*
+* Host simulation stand-in for the Xilinx standalone BSP status codes.  The
+* values match the BSP so status codes printed by the applications are the same
+* on the host and on the target.
+*
+******************************************************************************/
+
+#ifndef XSTATUS_H		/* prevent circular inclusions */
+#define XSTATUS_H		/* by using protection macros */
+
+#include "xil_types.h"
+
+/************************** Constant Definitions *****************************/
+#define XST_SUCCESS					0L
+#define XST_FAILURE					1L
+#define XST_DEVICE_NOT_FOUND		2L
+#define XST_DEVICE_BLOCK_NOT_FOUND	3L
+#define XST_INVALID_VERSION			4L
+#define XST_DEVICE_IS_STARTED		5L
+#define XST_DEVICE_IS_STOPPED		6L
+#define XST_NO_DATA					13L
+#define XST_INVALID_PARAM			15L
+#define XST_NO_CALLBACK				18L
+#define XST_DEVICE_BUSY				21L
+
+/**************************** Type Definitions *******************************/
+typedef s32 XStatus;
+
+#endif /* end of protection macro */
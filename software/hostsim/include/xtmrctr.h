@@ -0,0 +1,128 @@
+/**
+*
+* @file xtmrctr.h
+*
+* Host simulation stand-in for the Xilinx axi_timer (tmrctr) driver.  The low
+* level register macros are the same as in xtmrctr_l.h and go through
+* Xil_In32()/Xil_Out32() to the hostsim timer model.  The high level functions
+* are the subset used by the ECE 544 applications.
+*
+******************************************************************************/
+
+#ifndef XTMRCTR_H		/* prevent circular inclusions */
+#define XTMRCTR_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xstatus.h"
+
+/************************** Constant Definitions *****************************/
+#define XTC_DEVICE_TIMER_COUNT		2
+#define XTC_TIMER_COUNTER_OFFSET	16
+
+/* register offsets within a timer/counter */
+#define XTC_TCSR_OFFSET				0
+#define XTC_TLR_OFFSET				4
+#define XTC_TCR_OFFSET				8
+
+/* control/status register bits */
+#define XTC_CSR_ENABLE_ALL_MASK		0x00000400
+#define XTC_CSR_ENABLE_PWM_MASK		0x00000200
+#define XTC_CSR_INT_OCCURED_MASK	0x00000100
+#define XTC_CSR_ENABLE_TMR_MASK		0x00000080
+#define XTC_CSR_ENABLE_INT_MASK		0x00000040
+#define XTC_CSR_LOAD_MASK			0x00000020
+#define XTC_CSR_AUTO_RELOAD_MASK	0x00000010
+#define XTC_CSR_EXT_CAPTURE_MASK	0x00000008
+#define XTC_CSR_EXT_GENERATE_MASK	0x00000004
+#define XTC_CSR_DOWN_COUNT_MASK		0x00000002
+#define XTC_CSR_CAPTURE_MODE_MASK	0x00000001
+
+/* options for XTmrCtr_SetOptions() */
+#define XTC_CASCADE_MODE_OPTION		0x00000080UL
+#define XTC_ENABLE_ALL_OPTION		0x00000040UL
+#define XTC_DOWN_COUNT_OPTION		0x00000020UL
+#define XTC_CAPTURE_MODE_OPTION		0x00000010UL
+#define XTC_INT_MODE_OPTION			0x00000008UL
+#define XTC_AUTO_RELOAD_OPTION		0x00000004UL
+#define XTC_EXT_COMPARE_OPTION		0x00000002UL
+
+/**************************** Type Definitions *******************************/
+typedef void (*XTmrCtr_Handler) (void *CallBackRef, u8 TmrCtrNumber);
+
+typedef struct {
+	UINTPTR			BaseAddress;		// base address of the registers
+	u32				IsReady;			// device is initialized and ready
+	u32				IsStartedTmrCtr0;	// timer counter 0 has been started
+	u32				IsStartedTmrCtr1;	// timer counter 1 has been started
+	XTmrCtr_Handler	Handler;			// callback function
+	void			*CallBackRef;		// callback reference for handler
+} XTmrCtr;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#define XTmrCtr_ReadReg(BaseAddress, TmrCtrNumber, RegOffset)					\
+	Xil_In32((BaseAddress) + ((TmrCtrNumber) * XTC_TIMER_COUNTER_OFFSET) + (RegOffset))
+
+#define XTmrCtr_WriteReg(BaseAddress, TmrCtrNumber, RegOffset, ValueToWrite)	\
+	Xil_Out32((BaseAddress) + ((TmrCtrNumber) * XTC_TIMER_COUNTER_OFFSET) + (RegOffset), (ValueToWrite))
+
+#define XTmrCtr_SetControlStatusReg(BaseAddress, TmrCtrNumber, RegisterValue)	\
+	XTmrCtr_WriteReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET, (RegisterValue))
+
+#define XTmrCtr_GetControlStatusReg(BaseAddress, TmrCtrNumber)					\
+	XTmrCtr_ReadReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET)
+
+#define XTmrCtr_GetTimerCounterReg(BaseAddress, TmrCtrNumber)					\
+	XTmrCtr_ReadReg((BaseAddress), (TmrCtrNumber), XTC_TCR_OFFSET)
+
+#define XTmrCtr_SetLoadReg(BaseAddress, TmrCtrNumber, RegisterValue)			\
+	XTmrCtr_WriteReg((BaseAddress), (TmrCtrNumber), XTC_TLR_OFFSET, (RegisterValue))
+
+#define XTmrCtr_GetLoadReg(BaseAddress, TmrCtrNumber)							\
+	XTmrCtr_ReadReg((BaseAddress), (TmrCtrNumber), XTC_TLR_OFFSET)
+
+#define XTmrCtr_Enable(BaseAddress, TmrCtrNumber)								\
+	XTmrCtr_WriteReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET,			\
+		(XTmrCtr_ReadReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET) | XTC_CSR_ENABLE_TMR_MASK))
+
+#define XTmrCtr_Disable(BaseAddress, TmrCtrNumber)								\
+	XTmrCtr_WriteReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET,			\
+		(XTmrCtr_ReadReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET) & ~XTC_CSR_ENABLE_TMR_MASK))
+
+#define XTmrCtr_EnableIntr(BaseAddress, TmrCtrNumber)							\
+	XTmrCtr_WriteReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET,			\
+		(XTmrCtr_ReadReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET) | XTC_CSR_ENABLE_INT_MASK))
+
+#define XTmrCtr_DisableIntr(BaseAddress, TmrCtrNumber)							\
+	XTmrCtr_WriteReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET,			\
+		(XTmrCtr_ReadReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET) & ~XTC_CSR_ENABLE_INT_MASK))
+
+#define XTmrCtr_LoadTimerCounterReg(BaseAddress, TmrCtrNumber)					\
+	XTmrCtr_WriteReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET,			\
+		(XTmrCtr_ReadReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET) | XTC_CSR_LOAD_MASK))
+
+#define XTmrCtr_HasEventOccurred(BaseAddress, TmrCtrNumber)					\
+	((XTmrCtr_ReadReg((BaseAddress), (TmrCtrNumber), XTC_TCSR_OFFSET) & XTC_CSR_INT_OCCURED_MASK) == XTC_CSR_INT_OCCURED_MASK)
+
+/************************** Function Prototypes ******************************/
+int		XTmrCtr_Initialize(XTmrCtr *InstancePtr, u16 DeviceId);
+void	XTmrCtr_Start(XTmrCtr *InstancePtr, u8 TmrCtrNumber);
+void	XTmrCtr_Stop(XTmrCtr *InstancePtr, u8 TmrCtrNumber);
+u32		XTmrCtr_GetValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber);
+void	XTmrCtr_SetResetValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber, u32 ResetValue);
+u32		XTmrCtr_GetCaptureValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber);
+void	XTmrCtr_Reset(XTmrCtr *InstancePtr, u8 TmrCtrNumber);
+void	XTmrCtr_SetOptions(XTmrCtr *InstancePtr, u8 TmrCtrNumber, u32 Options);
+u32		XTmrCtr_GetOptions(XTmrCtr *InstancePtr, u8 TmrCtrNumber);
+void	XTmrCtr_SetHandler(XTmrCtr *InstancePtr, XTmrCtr_Handler FuncPtr, void *CallBackRef);
+void	XTmrCtr_InterruptHandler(void *InstancePtr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,64 @@
+/**
+*
+* @file xuartlite_l.h
+*
+* Host simulation stand-in for the Xilinx UART-Lite low level driver.  The
+* register layout and macros match the BSP; accesses go to the hostsim
+* UART-Lite model.
+*
+******************************************************************************/
+
+#ifndef XUARTLITE_L_H	/* prevent circular inclusions */
+#define XUARTLITE_L_H	/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "xil_types.h"
+#include "xil_io.h"
+
+/************************** Constant Definitions *****************************/
+#define XUL_RX_FIFO_OFFSET			0
+#define XUL_TX_FIFO_OFFSET			4
+#define XUL_STATUS_REG_OFFSET		8
+#define XUL_CONTROL_REG_OFFSET		12
+
+#define XUL_CR_ENABLE_INTR			0x10
+#define XUL_CR_FIFO_RX_RESET		0x02
+#define XUL_CR_FIFO_TX_RESET		0x01
+
+#define XUL_SR_PARITY_ERROR			0x80
+#define XUL_SR_FRAMING_ERROR		0x40
+#define XUL_SR_OVERRUN_ERROR		0x20
+#define XUL_SR_INTR_ENABLED			0x10
+#define XUL_SR_TX_FIFO_FULL			0x08
+#define XUL_SR_TX_FIFO_EMPTY		0x04
+#define XUL_SR_RX_FIFO_FULL			0x02
+#define XUL_SR_RX_FIFO_VALID_DATA	0x01
+
+#define XUL_FIFO_SIZE				16
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#define XUartLite_ReadReg(BaseAddress, RegOffset)			Xil_In32((BaseAddress) + (RegOffset))
+#define XUartLite_WriteReg(BaseAddress, RegOffset, Data)	Xil_Out32((BaseAddress) + (RegOffset), (u32) (Data))
+
+#define XUartLite_GetStatusReg(BaseAddress)					XUartLite_ReadReg((BaseAddress), XUL_STATUS_REG_OFFSET)
+#define XUartLite_IsTransmitFull(BaseAddress)				\
+	((XUartLite_GetStatusReg((BaseAddress)) & XUL_SR_TX_FIFO_FULL) == XUL_SR_TX_FIFO_FULL)
+#define XUartLite_IsReceiveEmpty(BaseAddress)				\
+	((XUartLite_GetStatusReg((BaseAddress)) & XUL_SR_RX_FIFO_VALID_DATA) != XUL_SR_RX_FIFO_VALID_DATA)
+#define XUartLite_EnableIntr(BaseAddress)					\
+	XUartLite_WriteReg((BaseAddress), XUL_CONTROL_REG_OFFSET, XUL_CR_ENABLE_INTR)
+#define XUartLite_DisableIntr(BaseAddress)					\
+	XUartLite_WriteReg((BaseAddress), XUL_CONTROL_REG_OFFSET, 0)
+
+/************************** Function Prototypes ******************************/
+void	XUartLite_SendByte(UINTPTR BaseAddress, u8 Data);
+u8		XUartLite_RecvByte(UINTPTR BaseAddress);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,937 @@
+/**
+*
+* @file telemdec.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file implements telemdec, the host decoder for the testpwm telemetry stream (see
+* testpwm/telem.h).  It reads the stream from a serial device or pty (put in raw mode at the
+* given baud rate), from a captured file or from stdin, finds the frames, checks their CRCs
+* and keeps running statistics for every (set frequency, set duty cycle) bucket:
+*
+*	o	the frequency and duty cycle computed from the raw hw_detect counts and from the raw
+*		software detect counts of every record: mean, standard deviation, minimum and maximum.
+*		Saturated hw_detect counts (TELEM_FLAG_SATURATED, the PWM is below the range of
+*		hw_detect) are no reading; they are counted and left out of the hw statistics
+*	o	the error of the frequency versus the setpoint (mean and worst, in ppm) and of the
+*		duty cycle (mean, in percentage points)
+*
+* The statistics are updated one record at a time (Welford's method) and the buckets are a
+* fixed size table, so memory use does not grow with the length of the capture.  Bytes that
+* are not part of a frame are the console text; -t copies them to stderr.  A frame with a
+* bad CRC is counted and the search for the next sync starts again right after the bad
+* frame's sync.  A gap in the record sequence numbers counts as lost records.
+*
+* The summary (CSV, or JSON with -j) is written to stdout at the end of the input or when
+* telemdec is interrupted (SIGINT/SIGTERM), the stream counters to stderr.
+*
+*	o	synthetic (-S records) - generates a capture of "records" records with known setpoints
+*		and counts (all PWM_FREQ_* presets, several duty cycles), console text between the
+*		frames, corrupted frames and skipped sequence numbers.  The capture is written to the
+*		-w file, or decoded right away, and the decoder counters are checked against what was
+*		generated.  Exit status is 1 if they do not match.
+*
+* Build (from software/):
+*	gcc -O2 -Wall -Ihostsim/include -Itestpwm -DTELEM_ENABLE=0 \
+*		-o telemdec/telemdec telemdec/telemdec.c testpwm/telem.c -lm
+*
+* Usage: telemdec [-b baud] [-c sw_clock_hz] [-k settle_records] [-j] [-t] [input]
+*        telemdec -S records [-w capture_file] [-j]
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of the telemetry decoder
+* 1.01a	ri	10/16/26	Record type 0x02 (detected frequency to 0.001 Hz, duty cycle in 0.01%)
+* 1.02a	ri	10/16/26	Leave saturated hw_detect counts (TELEM_FLAG_SATURATED) out of the statistics
+* </pre>
+*
+******************************************************************************/
+
+/***************************** Include Files *********************************/
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "xil_types.h"
+#include "telem.h"
+
+/************************** Constant Definitions *****************************/
+#define HW_CLOCK_FREQ_HZ		100000000		// hw_detect counts AXI clocks
+#define DEFAULT_SW_CLOCK_HZ		100000000		// SWDET capture timer (40000 for the polling build)
+#define DEFAULT_BAUD			19200
+#define DEFAULT_SETTLE			1				// records skipped after a setpoint change
+
+#define MAX_BUCKETS				1024			// (set frequency, set duty cycle) buckets, power of 2
+#define MAX_FRAME				(TELEM_HEADER_SIZE + 255 + TELEM_CRC_SIZE)
+
+#define DET_HW					0
+#define DET_SW					1
+#define NUM_DET					2
+
+// synthetic capture
+#define SYN_HOLD_RECORDS		50				// records per setpoint
+#define SYN_CORRUPT_EVERY		97				// every 97th frame gets a flipped payload bit
+#define SYN_SKIP_EVERY			89				// every 89th sequence number is not sent
+#define SYN_TEXT_EVERY			10				// a line of console text every 10 records
+
+/**************************** Type Definitions *******************************/
+// running statistics of one quantity
+typedef struct {
+	u64		n;
+	double	mean;
+	double	m2;							// sum of squared differences from the mean
+	double	min;
+	double	max;
+} stat_t;
+
+typedef struct {
+	bool	used;
+	u32		set_freq;
+	u32		set_duty;
+	u64		records;
+	stat_t	freq[NUM_DET];				// detected frequency (Hz)
+	stat_t	duty[NUM_DET];				// detected duty cycle (%)
+	stat_t	freq_err[NUM_DET];			// frequency error (ppm)
+	stat_t	duty_err[NUM_DET];			// duty cycle error (percentage points)
+} bucket_t;
+
+typedef enum {
+	DEC_HUNT,							// looking for TELEM_SYNC0
+	DEC_SYNC1,
+	DEC_BODY							// length, type, payload and CRC
+} dec_state_t;
+
+typedef struct {
+	dec_state_t	state;
+	u8			frame[MAX_FRAME];
+	u32			pos;					// bytes of the frame received
+	u32			size;					// size of the frame (once the length is in)
+
+	u64			bytes;					// bytes read
+	u64			text_bytes;				// bytes outside frames
+	u64			discarded;				// bytes of bad frames
+	u64			frames;					// frames with a good CRC
+	u64			crc_errors;
+	u64			unknown;				// good frames of an unknown type or length
+	u64			lost;					// records missing from the sequence
+	u64			board_drops;			// records the board says it dropped
+	u64			settling;				// records skipped after a setpoint change
+	u64			no_bucket;				// records that did not fit in the bucket table
+	u64			saturated;				// records with saturated hw_detect counts
+	bool		have_seq;
+	u32			last_seq;
+	u32			last_freq;
+	u32			last_duty;
+	u32			settle_left;
+	u32			rescan;					// nesting of dec_frame() searching a bad frame again
+	bool		held_bad;				// the TELEM_SYNC0 held in DEC_SYNC1 is from a bad frame
+	bool		echo_text;
+} decoder_t;
+
+/************************** Variable Definitions *****************************/
+static bucket_t					buckets[MAX_BUCKETS];
+static double					sw_clock_hz = DEFAULT_SW_CLOCK_HZ;
+static u32						settle_records = DEFAULT_SETTLE;
+static volatile sig_atomic_t	stop;
+
+/************************** Function Prototypes ******************************/
+static void		usage(void);
+static int		open_input(const char *path, long baud);
+static void		on_signal(int sig);
+static void		stat_add(stat_t *sp, double x);
+static double	stat_std(const stat_t *sp);
+static bucket_t	*find_bucket(u32 set_freq, u32 set_duty);
+static void		dec_feed(decoder_t *dp, u8 byte);
+static void		dec_frame(decoder_t *dp);
+static void		dec_record(decoder_t *dp, const TELEM_Record *rp);
+static void		report_csv(FILE *fp);
+static void		report_json(FILE *fp, const decoder_t *dp);
+static void		report_stream(FILE *fp, const decoder_t *dp);
+static int		synthetic(u32 records, const char *path, bool json);
+
+/************************** MAIN PROGRAM ************************************/
+int main(int argc, char *argv[])
+{
+	decoder_t	dec;
+	long		baud = DEFAULT_BAUD;
+	u32			syn_records = 0;
+	const char	*syn_path = NULL;
+	bool		json = false;
+	u8			buf[4096];
+	struct sigaction	sa;
+	ssize_t		n, i;
+	int			fd, opt;
+
+	memset(&dec, 0, sizeof(dec));
+
+	while ((opt = getopt(argc, argv, "b:c:k:jtS:w:h")) != -1)
+	{
+		switch (opt)
+		{
+			case 'b':	baud = strtol(optarg, NULL, 0);						break;
+			case 'c':	sw_clock_hz = strtod(optarg, NULL);					break;
+			case 'k':	settle_records = (u32) strtoul(optarg, NULL, 0);	break;
+			case 'j':	json = true;										break;
+			case 't':	dec.echo_text = true;								break;
+			case 'S':	syn_records = (u32) strtoul(optarg, NULL, 0);		break;
+			case 'w':	syn_path = optarg;									break;
+
+			default:
+				usage();
+				return 2;
+		}
+	}
+
+	if (syn_records != 0)
+	{
+		return synthetic(syn_records, syn_path, json);
+	}
+	if (optind < argc - 1)
+	{
+		usage();
+		return 2;
+	}
+
+	fd = open_input((optind < argc) ? argv[optind] : NULL, baud);
+	if (fd < 0)
+	{
+		return 2;
+	}
+
+	// no SA_RESTART, so the signal also ends a read() that is waiting on a serial device
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = on_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	while (!stop)
+	{
+		n = read(fd, buf, sizeof(buf));
+		if (n == 0)
+		{
+			break;
+		}
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			if (errno == EIO)
+			{
+				break;					// the other end of the pty closed
+			}
+			perror("read");
+			break;
+		}
+		for (i = 0; i < n; i++)
+		{
+			dec_feed(&dec, buf[i]);
+		}
+	}
+	close(fd);
+
+	if (json)
+	{
+		report_json(stdout, &dec);
+	}
+	else
+	{
+		report_csv(stdout);
+	}
+	report_stream(stderr, &dec);
+	return 0;
+}
+
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: telemdec [-b baud] [-c sw_clock_hz] [-k settle_records] [-j] [-t] [input]\n"
+		"       telemdec -S records [-w capture_file] [-j]\n"
+		"  input is a serial device, a pty or a capture file (stdin if none)\n");
+}
+
+
+/****************************************************************************/
+/**
+* Opens the input.  A terminal (serial device or pty) is put in raw mode at "baud"
+*
+* Returns the file descriptor or -1
+*
+*****************************************************************************/
+static int open_input(const char *path, long baud)
+{
+	static const struct { long baud; speed_t speed; } speeds[] = {
+		{ 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+		{ 115200, B115200 }, { 230400, B230400 }, { 460800, B460800 }, { 921600, B921600 }
+	};
+	struct termios	tio;
+	size_t			i;
+	int				fd;
+
+	if (path == NULL)
+	{
+		return STDIN_FILENO;
+	}
+
+	fd = open(path, O_RDONLY | O_NOCTTY);
+	if (fd < 0)
+	{
+		perror(path);
+		return -1;
+	}
+	if (!isatty(fd))
+	{
+		return fd;
+	}
+
+	for (i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++)
+	{
+		if (speeds[i].baud == baud)
+		{
+			break;
+		}
+	}
+	if (i == sizeof(speeds) / sizeof(speeds[0]))
+	{
+		fprintf(stderr, "telemdec: unsupported baud rate %ld\n", baud);
+		close(fd);
+		return -1;
+	}
+
+	if (tcgetattr(fd, &tio) != 0)
+	{
+		perror(path);
+		close(fd);
+		return -1;
+	}
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, speeds[i].speed);
+	cfsetospeed(&tio, speeds[i].speed);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN] = 1;
+	tio.c_cc[VTIME] = 0;
+	if (tcsetattr(fd, TCSANOW, &tio) != 0)
+	{
+		perror(path);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+
+static void on_signal(int sig)
+{
+	(void) sig;
+	stop = 1;
+}
+
+
+/******************************* STATISTICS *********************************/
+
+static void stat_add(stat_t *sp, double x)
+{
+	double	delta;
+
+	if (sp->n == 0)
+	{
+		sp->min = x;
+		sp->max = x;
+	}
+	if (x < sp->min)
+	{
+		sp->min = x;
+	}
+	if (x > sp->max)
+	{
+		sp->max = x;
+	}
+
+	sp->n++;
+	delta = x - sp->mean;
+	sp->mean += delta / (double) sp->n;
+	sp->m2 += delta * (x - sp->mean);
+}
+
+
+static double stat_std(const stat_t *sp)
+{
+	return (sp->n > 1) ? sqrt(sp->m2 / (double) (sp->n - 1)) : 0.0;
+}
+
+
+/****************************************************************************/
+/**
+* Returns the bucket of a setpoint, adding it if it is new
+*
+* Returns NULL if the table is full
+*
+*****************************************************************************/
+static bucket_t *find_bucket(u32 set_freq, u32 set_duty)
+{
+	u32		h = ((set_freq * 2654435761u) ^ set_duty) & (MAX_BUCKETS - 1);
+	u32		i;
+
+	for (i = 0; i < MAX_BUCKETS; i++)
+	{
+		bucket_t *bp = &buckets[(h + i) & (MAX_BUCKETS - 1)];
+
+		if (!bp->used)
+		{
+			bp->used = true;
+			bp->set_freq = set_freq;
+			bp->set_duty = set_duty;
+			return bp;
+		}
+		if ((bp->set_freq == set_freq) && (bp->set_duty == set_duty))
+		{
+			return bp;
+		}
+	}
+	return NULL;
+}
+
+
+/******************************** DECODER ***********************************/
+
+/****************************************************************************/
+/**
+* Adds one byte of the stream
+*
+*****************************************************************************/
+static void dec_feed(decoder_t *dp, u8 byte)
+{
+	dp->bytes++;
+
+	switch (dp->state)
+	{
+		case DEC_HUNT:
+			if (byte == TELEM_SYNC0)
+			{
+				dp->frame[0] = byte;
+				dp->pos = 1;
+				dp->state = DEC_SYNC1;
+				dp->held_bad = false;
+				return;
+			}
+			break;
+
+		case DEC_SYNC1:
+			if (byte == TELEM_SYNC1)
+			{
+				dp->frame[1] = byte;
+				dp->pos = 2;
+				dp->state = DEC_BODY;
+				return;
+			}
+			// the TELEM_SYNC0 was text after all
+			dp->state = DEC_HUNT;
+			if (dp->held_bad)
+			{
+				dp->discarded++;
+			}
+			else
+			{
+				dp->text_bytes++;
+				if (dp->echo_text && (dp->rescan == 0))
+				{
+					fputc(TELEM_SYNC0, stderr);
+				}
+			}
+			if (byte == TELEM_SYNC0)
+			{
+				dp->state = DEC_SYNC1;
+				dp->held_bad = false;
+				return;
+			}
+			break;
+
+		case DEC_BODY:
+			dp->frame[dp->pos++] = byte;
+			if (dp->pos == 3)
+			{
+				dp->size = TELEM_HEADER_SIZE + byte + TELEM_CRC_SIZE;
+			}
+			if ((dp->pos > 3) && (dp->pos == dp->size))
+			{
+				dec_frame(dp);
+			}
+			return;
+	}
+
+	// not part of a frame - console text
+	dp->text_bytes++;
+	if (dp->echo_text && (dp->rescan == 0))
+	{
+		fputc(byte, stderr);
+	}
+}
+
+
+/****************************************************************************/
+/**
+* Checks a complete frame and hands its record on
+*
+* After a bad CRC the bytes that followed the sync are searched again, so a real
+* frame that starts inside the bad one is not lost.  The bytes of the bad frame that
+* are not part of another frame are counted as discarded, not as text.
+*
+*****************************************************************************/
+static void dec_frame(decoder_t *dp)
+{
+	u8				copy[MAX_FRAME];
+	TELEM_Record	rec;
+	u32				*wp = (u32 *) &rec;
+	u32				len = dp->size - TELEM_HEADER_SIZE - TELEM_CRC_SIZE;
+	u16				crc;
+	u32				i, size;
+	u64				text;
+
+	dp->state = DEC_HUNT;
+	crc = TELEM_Crc16(0xFFFF, &dp->frame[2], TELEM_HEADER_SIZE - 2 + len);
+
+	if (crc != (dp->frame[dp->size - 2] | (dp->frame[dp->size - 1] << 8)))
+	{
+		dp->crc_errors++;
+		size = dp->size;
+		memcpy(copy, dp->frame, size);
+		dp->bytes -= size - 1;
+		text = dp->text_bytes;
+		dp->rescan++;
+		for (i = 1; i < size; i++)
+		{
+			dec_feed(dp, copy[i]);
+		}
+		dp->rescan--;
+		dp->discarded += (dp->text_bytes - text) + 1;	// + 1 for the TELEM_SYNC0
+		dp->text_bytes = text;
+		if (dp->state == DEC_SYNC1)
+		{
+			dp->held_bad = true;
+		}
+		return;
+	}
+
+	dp->frames++;
+	if ((dp->frame[3] != TELEM_TYPE_RECORD) || (len != TELEM_RECORD_SIZE))
+	{
+		dp->unknown++;
+		return;
+	}
+
+	for (i = 0; i < TELEM_RECORD_WORDS; i++)
+	{
+		const u8 *p = &dp->frame[TELEM_HEADER_SIZE + (4 * i)];
+
+		wp[i] = (u32) p[0] | ((u32) p[1] << 8) | ((u32) p[2] << 16) | ((u32) p[3] << 24);
+	}
+	dec_record(dp, &rec);
+}
+
+
+/****************************************************************************/
+/**
+* Adds a record to the statistics of its setpoint
+*
+*****************************************************************************/
+static void dec_record(decoder_t *dp, const TELEM_Record *rp)
+{
+	bucket_t	*bp;
+	double		f[NUM_DET], d[NUM_DET];
+	bool		valid[NUM_DET];
+	double		sum;
+	int			det;
+
+	if (dp->have_seq && (rp->Seq != dp->last_seq + 1))
+	{
+		dp->lost += (u32) (rp->Seq - dp->last_seq - 1);
+	}
+	dp->have_seq = true;
+	dp->last_seq = rp->Seq;
+	dp->board_drops = rp->Drops;
+
+	// the first records after a setpoint change can still hold counts of the old one
+	if ((rp->SetFreq != dp->last_freq) || (rp->SetDuty != dp->last_duty))
+	{
+		dp->last_freq = rp->SetFreq;
+		dp->last_duty = rp->SetDuty;
+		dp->settle_left = settle_records;
+	}
+	if (dp->settle_left != 0)
+	{
+		dp->settle_left--;
+		dp->settling++;
+		return;
+	}
+
+	bp = find_bucket(rp->SetFreq, rp->SetDuty);
+	if (bp == NULL)
+	{
+		dp->no_bucket++;
+		return;
+	}
+	bp->records++;
+	if (rp->Flags & TELEM_FLAG_SATURATED)
+	{
+		dp->saturated++;
+	}
+
+	// same arithmetic as calc_freq()/calc_duty() in testpwm.c
+	sum = (double) rp->HwHigh + rp->HwLow + (2.0 * (1u << rp->HwK));
+	valid[DET_HW] = (rp->HwK <= 15) && ((rp->HwHigh | rp->HwLow) != 0) &&
+		((rp->Flags & TELEM_FLAG_SATURATED) == 0);
+	f[DET_HW] = HW_CLOCK_FREQ_HZ * (double) (1u << (rp->HwK & 15)) / sum;
+	d[DET_HW] = 100.0 * ((double) rp->HwHigh + (1u << (rp->HwK & 15))) / sum;
+
+	sum = (double) rp->SwHigh + rp->SwLow + 2.0;
+	valid[DET_SW] = ((rp->SwHigh | rp->SwLow) != 0);
+	f[DET_SW] = sw_clock_hz / sum;
+	d[DET_SW] = 100.0 * ((double) rp->SwHigh + 1.0) / sum;
+
+	for (det = 0; det < NUM_DET; det++)
+	{
+		if (!valid[det])
+		{
+			continue;
+		}
+		stat_add(&bp->freq[det], f[det]);
+		stat_add(&bp->duty[det], d[det]);
+		if (rp->SetFreq != 0)
+		{
+			stat_add(&bp->freq_err[det], 1e6 * (f[det] - rp->SetFreq) / rp->SetFreq);
+		}
+		stat_add(&bp->duty_err[det], d[det] - rp->SetDuty);
+	}
+}
+
+
+/******************************** REPORTS ***********************************/
+
+static int bucket_order(const void *a, const void *b)
+{
+	const bucket_t *ap = *(const bucket_t * const *) a;
+	const bucket_t *bp = *(const bucket_t * const *) b;
+
+	if (ap->set_freq != bp->set_freq)
+	{
+		return (ap->set_freq < bp->set_freq) ? -1 : 1;
+	}
+	return (ap->set_duty < bp->set_duty) ? -1 : (ap->set_duty > bp->set_duty);
+}
+
+
+// the used buckets sorted by setpoint
+static u32 sorted_buckets(bucket_t **list)
+{
+	u32		i, n = 0;
+
+	for (i = 0; i < MAX_BUCKETS; i++)
+	{
+		if (buckets[i].used)
+		{
+			list[n++] = &buckets[i];
+		}
+	}
+	qsort(list, n, sizeof(list[0]), bucket_order);
+	return n;
+}
+
+
+static void report_csv(FILE *fp)
+{
+	static const char	*det_name[NUM_DET] = { "hw", "sw" };
+	bucket_t			*list[MAX_BUCKETS];
+	u32					i, n;
+	int					det;
+
+	fprintf(fp, "set_freq,set_duty,detector,samples,freq_mean,freq_std,freq_min,freq_max,"
+		"freq_err_ppm_mean,freq_err_ppm_worst,duty_mean,duty_std,duty_min,duty_max,duty_err_mean\n");
+
+	n = sorted_buckets(list);
+	for (i = 0; i < n; i++)
+	{
+		for (det = 0; det < NUM_DET; det++)
+		{
+			const bucket_t	*bp = list[i];
+			double			worst = fmax(fabs(bp->freq_err[det].min), fabs(bp->freq_err[det].max));
+
+			if (bp->freq[det].n == 0)
+			{
+				continue;
+			}
+			fprintf(fp, "%u,%u,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+				bp->set_freq, bp->set_duty, det_name[det], (unsigned long long) bp->freq[det].n,
+				bp->freq[det].mean, stat_std(&bp->freq[det]), bp->freq[det].min, bp->freq[det].max,
+				bp->freq_err[det].mean, worst,
+				bp->duty[det].mean, stat_std(&bp->duty[det]), bp->duty[det].min, bp->duty[det].max,
+				bp->duty_err[det].mean);
+		}
+	}
+}
+
+
+static void report_json_stat(FILE *fp, const char *name, const stat_t *sp, const char *sep)
+{
+	fprintf(fp, "\"%s\": {\"mean\": %.3f, \"std\": %.3f, \"min\": %.3f, \"max\": %.3f}%s",
+		name, sp->mean, stat_std(sp), sp->min, sp->max, sep);
+}
+
+
+static void report_json(FILE *fp, const decoder_t *dp)
+{
+	static const char	*det_name[NUM_DET] = { "hw", "sw" };
+	bucket_t			*list[MAX_BUCKETS];
+	u32					i, n;
+	int					det;
+
+	fprintf(fp, "{\n  \"stream\": {\"bytes\": %llu, \"frames\": %llu, \"crc_errors\": %llu, "
+		"\"unknown\": %llu, \"lost\": %llu, \"board_drops\": %llu, \"text_bytes\": %llu, "
+		"\"discarded\": %llu, \"hw_saturated\": %llu},\n",
+		(unsigned long long) dp->bytes, (unsigned long long) dp->frames,
+		(unsigned long long) dp->crc_errors, (unsigned long long) dp->unknown,
+		(unsigned long long) dp->lost, (unsigned long long) dp->board_drops,
+		(unsigned long long) dp->text_bytes, (unsigned long long) dp->discarded,
+		(unsigned long long) dp->saturated);
+	fprintf(fp, "  \"buckets\": [");
+
+	n = sorted_buckets(list);
+	for (i = 0; i < n; i++)
+	{
+		const bucket_t *bp = list[i];
+
+		fprintf(fp, "%s\n    {\"set_freq\": %u, \"set_duty\": %u, \"records\": %llu",
+			(i == 0) ? "" : ",", bp->set_freq, bp->set_duty, (unsigned long long) bp->records);
+		for (det = 0; det < NUM_DET; det++)
+		{
+			if (bp->freq[det].n == 0)
+			{
+				continue;
+			}
+			fprintf(fp, ",\n      \"%s\": {\"samples\": %llu, ", det_name[det],
+				(unsigned long long) bp->freq[det].n);
+			report_json_stat(fp, "freq", &bp->freq[det], ", ");
+			report_json_stat(fp, "freq_err_ppm", &bp->freq_err[det], ", ");
+			report_json_stat(fp, "duty", &bp->duty[det], ", ");
+			report_json_stat(fp, "duty_err", &bp->duty_err[det], "}");
+		}
+		fprintf(fp, "}");
+	}
+	fprintf(fp, "\n  ]\n}\n");
+}
+
+
+static void report_stream(FILE *fp, const decoder_t *dp)
+{
+	fprintf(fp, "telemdec: %llu bytes, %llu frames, %llu CRC errors, %llu unknown, %llu records lost, "
+		"%llu dropped by the board, %llu text bytes, %llu discarded, %llu settling, %llu without a bucket, "
+		"%llu hw saturated\n",
+		(unsigned long long) dp->bytes, (unsigned long long) dp->frames,
+		(unsigned long long) dp->crc_errors, (unsigned long long) dp->unknown,
+		(unsigned long long) dp->lost, (unsigned long long) dp->board_drops,
+		(unsigned long long) dp->text_bytes, (unsigned long long) dp->discarded,
+		(unsigned long long) dp->settling,
+		(unsigned long long) dp->no_bucket, (unsigned long long) dp->saturated);
+}
+
+
+/******************************* SYNTHETIC **********************************/
+
+// deterministic noise of -1, 0 or +1 count
+static int syn_noise(u32 *seed)
+{
+	*seed = (*seed * 1103515245u) + 12345u;
+	return (int) ((*seed >> 16) % 3) - 1;
+}
+
+
+/****************************************************************************/
+/**
+* Builds one frame the way TELEM_SendRecord() does
+*
+*****************************************************************************/
+static u32 syn_frame(u8 *frame, const TELEM_Record *rp)
+{
+	const u32	*wp = (const u32 *) rp;
+	u16			crc;
+	u32			i;
+
+	frame[0] = TELEM_SYNC0;
+	frame[1] = TELEM_SYNC1;
+	frame[2] = TELEM_RECORD_SIZE;
+	frame[3] = TELEM_TYPE_RECORD;
+	for (i = 0; i < TELEM_RECORD_WORDS; i++)
+	{
+		frame[TELEM_HEADER_SIZE + (4 * i)] = (u8) wp[i];
+		frame[TELEM_HEADER_SIZE + (4 * i) + 1] = (u8) (wp[i] >> 8);
+		frame[TELEM_HEADER_SIZE + (4 * i) + 2] = (u8) (wp[i] >> 16);
+		frame[TELEM_HEADER_SIZE + (4 * i) + 3] = (u8) (wp[i] >> 24);
+	}
+	crc = TELEM_Crc16(0xFFFF, &frame[2], TELEM_HEADER_SIZE - 2 + TELEM_RECORD_SIZE);
+	frame[TELEM_HEADER_SIZE + TELEM_RECORD_SIZE] = (u8) crc;
+	frame[TELEM_HEADER_SIZE + TELEM_RECORD_SIZE + 1] = (u8) (crc >> 8);
+	return TELEM_FRAME_SIZE;
+}
+
+
+/****************************************************************************/
+/**
+* Generates a synthetic capture and checks the decoder against it
+*
+* Every SYN_HOLD_RECORDS records move to the next setpoint (the PWM_FREQ_* presets times
+* 10, 25, 50 and 90% duty cycle).  The counts are what hw_detect (with the accumulation
+* exponent testpwm would pick) and the SWDET capture timer would measure, +/- 1 count.
+*
+*****************************************************************************/
+static int synthetic(u32 records, const char *path, bool json)
+{
+	static const u32	freqs[] = { 100, 1000, 10000, 50000, 100000, 500000, 1000000, 5000000 };
+	static const u32	duties[] = { 10, 25, 50, 90 };
+	const u32			num_set = (sizeof(freqs) / sizeof(freqs[0])) * (sizeof(duties) / sizeof(duties[0]));
+	decoder_t			dec;
+	TELEM_Record		rec;
+	u8					frame[TELEM_FRAME_SIZE];
+	char				text[64];
+	u32					seed = 1;
+	u32					r, set, k, period, high, len, i;
+	u64					corrupted = 0, skipped = 0, text_bytes = 0, sent = 0;
+	u64					settling = 0;
+	u32					last_set = 0xFFFFFFFF;
+	struct timespec		t0, t1;
+	double				secs;
+	FILE				*fp = NULL;
+	bool				ok;
+
+	memset(&dec, 0, sizeof(dec));
+	if (path != NULL)
+	{
+		fp = fopen(path, "wb");
+		if (fp == NULL)
+		{
+			perror(path);
+			return 2;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (r = 0; r < records; r++)
+	{
+		set = (r / SYN_HOLD_RECORDS) % num_set;
+
+		memset(&rec, 0, sizeof(rec));
+		rec.Timestamp = 2000 + (100 * r);
+		rec.Seq = r;
+		rec.SetFreq = freqs[set / (sizeof(duties) / sizeof(duties[0]))];
+		rec.SetDuty = duties[set % (sizeof(duties) / sizeof(duties[0]))];
+		period = HW_CLOCK_FREQ_HZ / rec.SetFreq;
+		high = (period * rec.SetDuty) / 100;
+
+		// accumulate about 2^20 clocks like HWDET_SelectAccum()
+		for (k = 0; (k < 15) && ((period << (k + 1)) <= (1u << 20)); k++)
+		{
+			// find k
+		}
+		rec.HwK = k;
+		rec.HwHigh = ((high - 1) << k) + syn_noise(&seed);
+		rec.HwLow = ((period - high - 1) << k) + syn_noise(&seed);
+		rec.SwHigh = (u32) ((double) high * DEFAULT_SW_CLOCK_HZ / HW_CLOCK_FREQ_HZ) - 1 + syn_noise(&seed);
+		rec.SwLow = (u32) ((double) (period - high) * DEFAULT_SW_CLOCK_HZ / HW_CLOCK_FREQ_HZ) - 1 + syn_noise(&seed);
+		rec.DetFreq = rec.SetFreq;
+		rec.DetFreqMilli = 0;
+		rec.DetDuty = rec.SetDuty * 100;
+		rec.Flags = TELEM_FLAG_HW;
+
+		if (set != last_set)
+		{
+			settling += DEFAULT_SETTLE;
+			last_set = set;
+		}
+
+		if ((r % SYN_SKIP_EVERY) == SYN_SKIP_EVERY - 1)
+		{
+			skipped++;
+			continue;
+		}
+
+		if ((r % SYN_TEXT_EVERY) == 0)
+		{
+			len = (u32) snprintf(text, sizeof(text), "D: %u Hz, %u%%\n", rec.SetFreq, rec.SetDuty);
+			text_bytes += len;
+			if (fp != NULL)
+			{
+				fwrite(text, 1, len, fp);
+			}
+			else
+			{
+				for (i = 0; i < len; i++)
+				{
+					dec_feed(&dec, (u8) text[i]);
+				}
+			}
+		}
+
+		len = syn_frame(frame, &rec);
+		if ((r % SYN_CORRUPT_EVERY) == SYN_CORRUPT_EVERY - 1)
+		{
+			frame[TELEM_HEADER_SIZE + (r % TELEM_RECORD_SIZE)] ^= (u8) (1 << (r % 8));
+			corrupted++;
+		}
+		sent++;
+
+		if (fp != NULL)
+		{
+			fwrite(frame, 1, len, fp);
+		}
+		else
+		{
+			for (i = 0; i < len; i++)
+			{
+				dec_feed(&dec, frame[i]);
+			}
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	if (fp != NULL)
+	{
+		fclose(fp);
+		fprintf(stderr, "telemdec: wrote %u records (%llu skipped, %llu corrupted) to %s\n", records,
+			(unsigned long long) skipped, (unsigned long long) corrupted, path);
+		return 0;
+	}
+
+	if (json)
+	{
+		report_json(stdout, &dec);
+	}
+	else
+	{
+		report_csv(stdout);
+	}
+	report_stream(stderr, &dec);
+
+	// a corrupted frame is lost to the sequence as well; a setpoint whose first record was
+	// skipped or corrupted settles on a later one, so only bound the settling count
+	secs = (double) (t1.tv_sec - t0.tv_sec) + ((double) (t1.tv_nsec - t0.tv_nsec) * 1e-9);
+	ok = (dec.frames == sent - corrupted) && (dec.crc_errors == corrupted) &&
+		 (dec.text_bytes == text_bytes) && (dec.unknown == 0) && (dec.no_bucket == 0) &&
+		 (dec.settling <= settling);
+	fprintf(stderr, "telemdec: synthetic %u records: expected %llu frames, %llu CRC errors, %llu text bytes"
+		" - %s (%.1f MB/s)\n", records, (unsigned long long) (sent - corrupted),
+		(unsigned long long) corrupted, (unsigned long long) text_bytes, ok ? "ok" : "FAILED",
+		(double) dec.bytes / secs / 1e6);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,459 @@
+/**
+*
+* @file calib.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides the detector calibration (see calib.h).  While a characterization
+* run adds readings, the error of every reading is added to the accumulators of its
+* detector and range: the count, sum, sum of squares, minimum and maximum of the frequency
+* error (ppm) and of the duty cycle error (0.01%).  That is all CALIB_Derive() needs for the
+* mean error of each range and CALIB_Report() for the error before and after the correction,
+* so the run can be any length without storing the readings.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Frequencies in mHz.  CALIB_Freq() multiplies by a binary fraction
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include <stdbool.h>
+#include "calib.h"
+#include "xil_printf.h"
+
+/************************** Constant Definitions *****************************/
+#define CALIB_MAX_ERR			10000000		// errors are limited to +/- 10^7 (ppm or 0.01%)
+#define CALIB_FRAC_BITS			24				// CALIB_Freq() multiplies by calib_mult / 2^24
+
+/**************************** Type Definitions *******************************/
+// the errors of the readings of one detector and range
+typedef struct {
+	u32		N;
+	s64		Sum;
+	u64		SumSq;
+	s32		Min;
+	s32		Max;
+} CALIB_Acc;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#define CALIB_ABS(x)			(((x) < 0) ? -(x) : (x))
+
+/************************** Function Prototypes ******************************/
+static void calib_acc_add(CALIB_Acc *AccPtr, s32 Err);
+static void calib_acc_print(const CALIB_Acc *AccPtr, s32 Shift, s32 ScalePpm);
+static s32 calib_div_round(s64 Num, s64 Den);
+static u32 calib_sqrt(u64 x);
+static void calib_load_mult(void);
+
+/************************** Variable Definitions *****************************/
+// upper bounds of the ranges in mHz (half a decade above 10 Hz, 100 Hz, ...)
+static const u64		calib_bounds[CALIB_NUM_RANGES - 1] = { 31623ULL, 316228ULL, 3162278ULL, 31622777ULL,
+							316227766ULL, 3162277660ULL };
+static const char * const	calib_range_names[CALIB_NUM_RANGES] = { "10", "100", "1K", "10K", "100K", "1M", "10M" };
+static const char * const	calib_det_names[CALIB_NUM_DETECTORS] = { "hw", "sw" };
+
+static const CALIB_Table	calib_default = CALIB_DEFAULT_TABLE;
+static CALIB_Table			calib_table;
+static s32					calib_mult[CALIB_NUM_DETECTORS][CALIB_NUM_RANGES];	// FreqPpm * 2^24 / 10^6
+
+static CALIB_Acc		calib_freq_acc[CALIB_NUM_DETECTORS][CALIB_NUM_RANGES];
+static CALIB_Acc		calib_duty_acc[CALIB_NUM_DETECTORS][CALIB_NUM_RANGES];
+static bool				calib_derived[CALIB_NUM_DETECTORS][CALIB_NUM_RANGES];	// entry derived from this run
+
+/*****************************************************************************/
+/**
+*
+* calib_acc_add() - Adds an error to an accumulator
+*
+* @return	None
+*
+******************************************************************************/
+static void calib_acc_add(CALIB_Acc *AccPtr, s32 Err)
+{
+	if ((AccPtr->N == 0) || (Err < AccPtr->Min))
+	{
+		AccPtr->Min = Err;
+	}
+	if ((AccPtr->N == 0) || (Err > AccPtr->Max))
+	{
+		AccPtr->Max = Err;
+	}
+	AccPtr->N++;
+	AccPtr->Sum += Err;
+	AccPtr->SumSq += (u64) ((s64) Err * Err);
+}
+
+
+/*****************************************************************************/
+/**
+*
+* calib_acc_print() - Prints the mean, RMS and worst error of an accumulator after every
+* error e is changed to Shift + e * ScalePpm / 10^6
+*
+* A frequency correction c (ppm) changes an error e (ppm) to c + e * (10^6 + c) / 10^6, a duty
+* cycle offset c changes it to c + e.
+*
+* @return	None
+*
+******************************************************************************/
+static void calib_acc_print(const CALIB_Acc *AccPtr, s32 Shift, s32 ScalePpm)
+{
+	s64		mean, var, sd;
+	s64		lo, hi;
+
+	// mean and standard deviation of the errors, then of the changed errors
+	mean = calib_div_round(AccPtr->Sum, AccPtr->N);
+	var = (s64) (AccPtr->SumSq / AccPtr->N) - (mean * mean);
+	sd = calib_sqrt((var < 0) ? 0 : (u64) var);
+
+	mean = Shift + calib_div_round(mean * ScalePpm, 1000000);
+	sd = calib_div_round(sd * ScalePpm, 1000000);
+	lo = Shift + calib_div_round((s64) AccPtr->Min * ScalePpm, 1000000);
+	hi = Shift + calib_div_round((s64) AccPtr->Max * ScalePpm, 1000000);
+
+	xil_printf(" %8d %8d %8d", (s32) mean, calib_sqrt((u64) ((sd * sd) + (mean * mean))),
+		(s32) ((CALIB_ABS(lo) > CALIB_ABS(hi)) ? CALIB_ABS(lo) : CALIB_ABS(hi)));
+}
+
+
+/*****************************************************************************/
+/**
+*
+* calib_div_round() - Divides, rounding to the nearest integer (halves away from 0)
+*
+* @return	Num / Den
+*
+******************************************************************************/
+static s32 calib_div_round(s64 Num, s64 Den)
+{
+	if (Num < 0)
+	{
+		return (s32) -((-Num + (Den / 2)) / Den);
+	}
+	return (s32) ((Num + (Den / 2)) / Den);
+}
+
+
+/*****************************************************************************/
+/**
+*
+* calib_sqrt() - Integer square root
+*
+* @return	The largest integer whose square is not larger than x
+*
+******************************************************************************/
+static u32 calib_sqrt(u64 x)
+{
+	u64		root = 0;
+	u64		bit = 1ULL << 62;
+
+	while (bit > x)
+	{
+		bit >>= 2;
+	}
+	while (bit != 0)
+	{
+		if (x >= root + bit)
+		{
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (u32) root;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* calib_load_mult() - Turns the frequency corrections of the table into binary fractions
+*
+* @return	None
+*
+******************************************************************************/
+static void calib_load_mult(void)
+{
+	u32		d, r;
+
+	for (d = 0; d < CALIB_NUM_DETECTORS; d++)
+	{
+		for (r = 0; r < CALIB_NUM_RANGES; r++)
+		{
+			calib_mult[d][r] = calib_div_round((s64) calib_table.Entry[d][r].FreqPpm << CALIB_FRAC_BITS, 1000000);
+		}
+	}
+}
+
+/*****************************************************************************/
+/**
+* Loads a calibration table
+*
+* @param	TablePtr is the table to load, or NULL for CALIB_DEFAULT_TABLE
+*
+* @return	None
+*
+******************************************************************************/
+void CALIB_Initialize(const CALIB_Table *TablePtr)
+{
+	calib_table = (TablePtr != NULL) ? *TablePtr : calib_default;
+	calib_load_mult();
+}
+
+
+/*****************************************************************************/
+/**
+* Returns a copy of the calibration table in use
+*
+* @param	TablePtr is a pointer to the copy
+*
+* @return	None
+*
+******************************************************************************/
+void CALIB_GetTable(CALIB_Table *TablePtr)
+{
+	*TablePtr = calib_table;
+}
+
+
+/*****************************************************************************/
+/**
+* Returns the range of a frequency
+*
+* @param	Freq is the frequency (mHz)
+*
+* @return	The range (0 = around 10 Hz ... CALIB_NUM_RANGES - 1 = around 10 MHz)
+*
+******************************************************************************/
+u32 CALIB_Range(u64 Freq)
+{
+	u32		r;
+
+	for (r = 0; (r < CALIB_NUM_RANGES - 1) && (Freq >= calib_bounds[r]); r++)
+	{
+		// find the range
+	}
+	return r;
+}
+
+
+/*****************************************************************************/
+/**
+* Corrects a detected frequency
+*
+* @param	Det is the detector (CALIB_DET_*)
+* @param	Freq is the frequency it detected (mHz, below 2^36)
+*
+* @return	The corrected frequency (mHz, rounded)
+*
+******************************************************************************/
+u64 CALIB_Freq(u32 Det, u64 Freq)
+{
+	s64		mult = calib_mult[Det][CALIB_Range(Freq)];
+
+	// |mult| <= 2^24, so the product fits in 61 bits
+	return Freq + (u64) ((((s64) Freq * mult) + (1 << (CALIB_FRAC_BITS - 1))) >> CALIB_FRAC_BITS);
+}
+
+
+/*****************************************************************************/
+/**
+* Corrects a detected duty cycle
+*
+* @param	Det is the detector (CALIB_DET_*)
+* @param	Freq is the frequency it detected (mHz), which selects the range
+* @param	Duty is the duty cycle it detected (0.01%)
+*
+* @return	The corrected duty cycle (0.01%, 0 to 10000)
+*
+******************************************************************************/
+u32 CALIB_Duty(u32 Det, u64 Freq, u32 Duty)
+{
+	s32		duty = (s32) Duty + calib_table.Entry[Det][CALIB_Range(Freq)].DutyOffset;
+
+	return (duty < 0) ? 0 : ((duty > 10000) ? 10000 : (u32) duty);
+}
+
+
+/*****************************************************************************/
+/**
+* Starts a characterization run
+*
+* @return	None
+*
+******************************************************************************/
+void CALIB_Begin(void)
+{
+	u32		d, r;
+
+	for (d = 0; d < CALIB_NUM_DETECTORS; d++)
+	{
+		for (r = 0; r < CALIB_NUM_RANGES; r++)
+		{
+			calib_freq_acc[d][r].N = 0;
+			calib_freq_acc[d][r].Sum = 0;
+			calib_freq_acc[d][r].SumSq = 0;
+			calib_duty_acc[d][r].N = 0;
+			calib_duty_acc[d][r].Sum = 0;
+			calib_duty_acc[d][r].SumSq = 0;
+		}
+	}
+}
+
+
+/*****************************************************************************/
+/**
+* Adds an uncorrected reading to the characterization run
+*
+* @param	Det is the detector (CALIB_DET_*)
+* @param	RefFreq is the frequency of the signal (Hz), which selects the range
+* @param	RefDuty is the duty cycle of the signal (0.01%)
+* @param	Freq is the frequency the detector read (mHz)
+* @param	Duty is the duty cycle the detector read (0.01%)
+*
+* @return	None
+*
+******************************************************************************/
+void CALIB_AddReading(u32 Det, u32 RefFreq, u32 RefDuty, u64 Freq, u32 Duty)
+{
+	u32		r = CALIB_Range((u64) RefFreq * 1000);
+	s64		err;
+
+	if ((Det >= CALIB_NUM_DETECTORS) || (RefFreq == 0))
+	{
+		return;
+	}
+
+	// ppm of RefFreq = (Freq - 1000 * RefFreq) / (1000 * RefFreq) * 10^6
+	err = (((s64) Freq - ((s64) RefFreq * 1000)) * 1000) / RefFreq;
+	err = (err > CALIB_MAX_ERR) ? CALIB_MAX_ERR : ((err < -CALIB_MAX_ERR) ? -CALIB_MAX_ERR : err);
+	calib_acc_add(&calib_freq_acc[Det][r], (s32) err);
+
+	calib_acc_add(&calib_duty_acc[Det][r], (s32) Duty - (s32) RefDuty);
+}
+
+
+/*****************************************************************************/
+/**
+* Derives the calibration table from the characterization run
+*
+* The entry of every range with at least CALIB_MIN_READINGS readings is replaced by the
+* correction that cancels the mean error of the readings.  The other entries are kept, and
+* so are the entries of ranges whose mean error is larger than CALIB_MAX_FREQ_PPM or
+* CALIB_MAX_DUTY: an error that large is not a bias but a detector that cannot follow the
+* signal.
+*
+* @return
+*
+*   - XST_SUCCESS if at least one entry was derived
+*   - XST_NO_DATA if no range had enough readings
+*
+******************************************************************************/
+int CALIB_Derive(void)
+{
+	CALIB_Entry		*ep;
+	s32				err, duty;
+	u32				d, r;
+	int				sts = XST_NO_DATA;
+
+	for (d = 0; d < CALIB_NUM_DETECTORS; d++)
+	{
+		for (r = 0; r < CALIB_NUM_RANGES; r++)
+		{
+			calib_derived[d][r] = false;
+			if (calib_freq_acc[d][r].N < CALIB_MIN_READINGS)
+			{
+				continue;
+			}
+
+			err = calib_div_round(calib_freq_acc[d][r].Sum, calib_freq_acc[d][r].N);
+			duty = calib_div_round(calib_duty_acc[d][r].Sum, calib_duty_acc[d][r].N);
+			if ((CALIB_ABS(err) > CALIB_MAX_FREQ_PPM) || (CALIB_ABS(duty) > CALIB_MAX_DUTY))
+			{
+				continue;
+			}
+
+			// readings that are (1 + err) too high need a factor of 1 / (1 + err)
+			ep = &calib_table.Entry[d][r];
+			ep->FreqPpm = calib_div_round(-(s64) err * 1000000, 1000000 + (s64) err);
+			ep->DutyOffset = (s16) -duty;
+
+			ep->Readings = (calib_freq_acc[d][r].N > 0xFFFF) ? 0xFFFF : (u16) calib_freq_acc[d][r].N;
+			calib_derived[d][r] = true;
+			sts = XST_SUCCESS;
+		}
+	}
+	calib_load_mult();
+	return sts;
+}
+
+
+/*****************************************************************************/
+/**
+* Prints the residual error of the characterization run and the calibration table
+*
+* For every detector and range with readings: the mean, RMS and worst error of the readings
+* before and after the correction in the table, for the frequency (ppm) and the duty cycle
+* (0.01%).  The errors after the correction are worked out from the accumulated ones, so
+* the readings need not be taken again.  A '*' marks the ranges whose entry was not
+* derived from this run (too few readings or too large an error).
+*
+* @return	None
+*
+******************************************************************************/
+void CALIB_Report(void)
+{
+	const CALIB_Entry	*ep;
+	u32					d, r;
+
+	xil_printf("CAL det range   readings |  freq (ppm) before: mean      rms    worst |"
+		"  after: mean      rms    worst |  duty (0.01pct) before: mean      rms    worst |"
+		"  after: mean      rms    worst\n");
+
+	for (d = 0; d < CALIB_NUM_DETECTORS; d++)
+	{
+		for (r = 0; r < CALIB_NUM_RANGES; r++)
+		{
+			if (calib_freq_acc[d][r].N == 0)
+			{
+				continue;
+			}
+			ep = &calib_table.Entry[d][r];
+
+			xil_printf("CAL %s  %4sHz %10d |                   ", calib_det_names[d], calib_range_names[r],
+				calib_freq_acc[d][r].N);
+			calib_acc_print(&calib_freq_acc[d][r], 0, 1000000);
+			xil_printf(" |        ");
+			calib_acc_print(&calib_freq_acc[d][r], ep->FreqPpm, 1000000 + ep->FreqPpm);
+			xil_printf(" |                       ");
+			calib_acc_print(&calib_duty_acc[d][r], 0, 1000000);
+			xil_printf(" |        ");
+			calib_acc_print(&calib_duty_acc[d][r], ep->DutyOffset, 1000000);
+			xil_printf("%s\n", calib_derived[d][r] ? "" : " *");
+		}
+	}
+
+	// the table as an initializer for calib.h
+	xil_printf("CAL #define CALIB_DEFAULT_TABLE {");
+	for (d = 0; d < CALIB_NUM_DETECTORS; d++)
+	{
+		xil_printf("%s {", (d == 0) ? " {" : ",");
+		for (r = 0; r < CALIB_NUM_RANGES; r++)
+		{
+			ep = &calib_table.Entry[d][r];
+			xil_printf("%s { %d, %d, %d }", (r == 0) ? "" : ",", ep->FreqPpm, ep->DutyOffset, ep->Readings);
+		}
+		xil_printf(" }");
+	}
+	xil_printf(" } }\n");
+}
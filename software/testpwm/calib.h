@@ -0,0 +1,94 @@
+/**
+*
+* @file calib.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions and function prototypes for calib.c.
+* calib.c corrects the systematic error of the frequency and duty cycle detectors.  The
+* correction is a table with one entry per detector and frequency range (a decade around
+* 10 Hz, 100 Hz, ... 10 MHz).  Each entry holds a frequency correction in ppm and a duty
+* cycle offset in hundredths of a percent.  CALIB_Freq() and CALIB_Duty() apply it to the
+* frequency in mHz and the duty cycle in 0.01% from meas.c with integer math only and no
+* division (the ppm are turned into binary fractions when the table is loaded).
+*
+* The table is derived from a characterization run (the sweep in testpwm.c): the
+* application calls CALIB_Begin(), adds every reading with the reference frequency and duty
+* cycle it should have shown (CALIB_AddReading()), then calls CALIB_Derive().  The
+* correction of a range is the mean error of its readings, so after calibration the
+* remaining error is the scatter of the readings.  CALIB_Report() prints the error of the
+* readings before and after the correction and the table as a CALIB_DEFAULT_TABLE
+* initializer, so a table measured on a board can be compiled in.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Frequencies in mHz.  CALIB_Freq() multiplies by a binary fraction
+* </pre>
+*
+******************************************************************************/
+
+#ifndef CALIB_H		/* prevent circular inclusions */
+#define CALIB_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "xil_types.h"
+#include "xstatus.h"
+
+/************************** Constant Definitions *****************************/
+#define CALIB_DET_HW			0				// hw_detect (period counts)
+#define CALIB_DET_SW			1				// software detect
+#define CALIB_NUM_DETECTORS		2
+
+#define CALIB_NUM_RANGES		7				// decades around 10 Hz ... 10 MHz
+#define CALIB_MIN_READINGS		4				// fewer readings leave the entry of a range as it was
+#define CALIB_MAX_FREQ_PPM		100000			// larger mean errors are not corrected (10%)
+#define CALIB_MAX_DUTY			1000			// larger mean duty cycle errors are not corrected (10%)
+
+// the table compiled in (no correction).  Replace it with the initializer printed by
+// CALIB_Report() to use a table measured on the board
+#ifndef CALIB_DEFAULT_TABLE
+#define CALIB_DEFAULT_TABLE		{ { { { 0, 0, 0 } } } }
+#endif
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	s32		FreqPpm;					// added to the frequency (ppm of the frequency)
+	s16		DutyOffset;					// added to the duty cycle (0.01%)
+	u16		Readings;					// readings the entry was derived from (0 = no correction)
+} CALIB_Entry;
+
+typedef struct {
+	CALIB_Entry	Entry[CALIB_NUM_DETECTORS][CALIB_NUM_RANGES];
+} CALIB_Table;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+void CALIB_Initialize(const CALIB_Table *TablePtr);
+void CALIB_GetTable(CALIB_Table *TablePtr);
+u32 CALIB_Range(u64 Freq);
+u64 CALIB_Freq(u32 Det, u64 Freq);
+u32 CALIB_Duty(u32 Det, u64 Freq, u32 Duty);
+
+void CALIB_Begin(void);
+void CALIB_AddReading(u32 Det, u32 RefFreq, u32 RefDuty, u64 Freq, u32 Duty);
+int CALIB_Derive(void);
+void CALIB_Report(void);
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,214 @@
+/**
+*
+* @file hwdet.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides an API for reading the high & low counts measured by hw_detect.v.
+* The counts are read through the two input channels of an axi_gpio, one register read
+* each.  hw_detect can latch a new pair between the two reads, so the sequence numbers
+* that hw_detect puts in both channels are compared and the channels are read again if
+* they differ.  The accumulation exponent k that hw_detect is running with is written by the
+* application (it shares a GPIO output with other signals), HWDET_SelectAccum() only chooses
+* it from the last pair.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Accumulation of 2^k periods per pair, HWDET_Sample
+* 1.02a	ri	10/16/26	Gated edge counter, HWDET_ReadGate()
+* 1.03a	ri	10/16/26	Document the 24-bit range of the counts, HWDET_IsSaturated()
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include "hwdet.h"
+
+
+/************************** Constant Definitions *****************************/
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+static int hwdet_read_pair(XGpio *InstancePtr, u32 reg[2]);
+
+/************************** Variable Definitions *****************************/
+
+/*****************************************************************************/
+/**
+*
+* hwdet_read_pair() - Read both channels until their sequence numbers match
+*
+* Reads channel 1 and channel 2 and checks that both carry the same sequence number.  If
+* they do not, hw_detect latched a new pair between the two reads and the channel that
+* was read first is read again, so the new read and the previous one (of the other
+* channel) form the next pair to check.  Up to HWDET_MAX_RETRIES extra reads are made.
+*
+* @param    InstancePtr is a pointer to the GPIO instance hw_detect is connected to.
+* @param    reg is the matching pair (channel 1, channel 2)
+*
+* @return	XST_SUCCESS if a matching pair was read, XST_FAILURE if not
+*
+******************************************************************************/
+static int hwdet_read_pair(XGpio *InstancePtr, u32 reg[2])
+{
+	int		chan,				// index (0 = channel 1, 1 = channel 2) of the channel read last
+			tries;
+
+	reg[0] = XGpio_DiscreteRead(InstancePtr, HWDET_HIGH_CHANNEL);
+	chan = 0;
+
+	for (tries = 0; tries <= HWDET_MAX_RETRIES; tries++)
+	{
+		// read the other channel and compare it with the previous read
+		chan ^= 1;
+		reg[chan] = XGpio_DiscreteRead(InstancePtr, (chan == 0) ? HWDET_HIGH_CHANNEL : HWDET_LOW_CHANNEL);
+
+		if (HWDET_GetSeq(reg[0]) == HWDET_GetSeq(reg[1]))
+		{
+			return XST_SUCCESS;
+		}
+	}
+	return XST_FAILURE;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* HWDET_Read() - Read a high & low count pair from the same PWM period(s)
+*
+* Reads the high count (channel 1) and the low count (channel 2) and checks that both
+* carry the same sequence number, reading again if hw_detect latched a new pair between
+* the two reads (see hwdet_read_pair()).
+*
+* @param    InstancePtr is a pointer to the GPIO instance hw_detect is connected to.
+* @param    SamplePtr is a pointer to the pair.  High and Low hold the counts of 2^K
+*			periods, Seq changes every time hw_detect latches a new pair
+*
+* @return
+*
+*   - XST_SUCCESS if a matching pair was read
+*   - XST_NO_DATA if hw_detect has not measured a complete period since reset.  The
+*	  counts are 0
+*   - XST_FAILURE if no two reads in a row matched (the PWM period is about as short as a
+*	  GPIO read).  The sample is not changed
+*
+* @note
+* The 4-bit sequence number wraps every 15 pairs, so a mismatch is detected as long as
+* hw_detect latches fewer than 15 pairs between two reads (one read of the GPIO is a
+* few bus clocks).  Call with interrupts disabled if that cannot be guaranteed.
+* gate_sel must be low.  Counts of intervals longer than the range of hw_detect are
+* HWDET_COUNT_MAX (see HWDET_IsSaturated()); the pair is returned as it is.
+*
+******************************************************************************/
+int HWDET_Read(XGpio *InstancePtr, HWDET_Sample *SamplePtr)
+{
+	u32		reg[2];				// matching values of the two channels
+
+	if (hwdet_read_pair(InstancePtr, reg) != XST_SUCCESS)
+	{
+		return XST_FAILURE;
+	}
+
+	SamplePtr->High = HWDET_GetCount(reg[0]);
+	SamplePtr->Low = HWDET_GetCount(reg[1]);
+	SamplePtr->K = HWDET_GetK(reg[0]);
+	SamplePtr->Seq = HWDET_GetSeq(reg[0]);
+	return (SamplePtr->Seq == 0) ? XST_NO_DATA : XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* HWDET_ReadGate() - Read the gated edge counter
+*
+* Reads the number of rising edges in the last gate (channel 1) and the gate length
+* (channel 2) the same way HWDET_Read() reads a pair.  The frequency is
+* Edges * clock frequency / Clocks, within one edge.
+*
+* @param    InstancePtr is a pointer to the GPIO instance hw_detect is connected to.
+* @param    GatePtr is a pointer to the result
+*
+* @return
+*
+*   - XST_SUCCESS if a matching pair was read
+*   - XST_NO_DATA if no gate has completed since reset
+*   - XST_FAILURE if no two reads in a row matched.  The result is not changed
+*
+* @note
+* gate_sel must be high (set by the application through its GPIO output).
+*
+******************************************************************************/
+int HWDET_ReadGate(XGpio *InstancePtr, HWDET_Gate *GatePtr)
+{
+	u32		reg[2];				// matching values of the two channels
+
+	if (hwdet_read_pair(InstancePtr, reg) != XST_SUCCESS)
+	{
+		return XST_FAILURE;
+	}
+
+	GatePtr->Edges = HWDET_GetCount(reg[0]);
+	GatePtr->Clocks = HWDET_GetCount(reg[1]);
+	GatePtr->Seq = HWDET_GetSeq(reg[0]);
+	return (GatePtr->Seq == 0) ? XST_NO_DATA : XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* HWDET_SelectAccum() - Choose the accumulation exponent for the next pairs
+*
+* Chooses the largest k (up to HWDET_K_MAX) for which 2^k periods of the PWM signal
+* measured by SamplePtr last no longer than HWDET_ACCUM_TARGET clocks.  This keeps the
+* time between two pairs close to the target at any PWM frequency while giving the most
+* counts (the best resolution) per pair.  The k the pair was measured with is kept as long
+* as its window is between 1/4 and 2 times the target, so a frequency near a boundary does
+* not make k (and the accumulation, which restarts when k changes) flip back and forth.
+*
+* @param    SamplePtr is a pointer to the last pair read by HWDET_Read()
+*
+* @return	the accumulation exponent to give hw_detect
+*
+* @note
+* A saturated count gives k = 0.  If k is too large for a new, much lower frequency the
+* window takes too long to complete; the caller should go back to k = 0 if no new pair
+* arrives within HWDET_ACCUM_TIMEOUT_MS.
+*
+******************************************************************************/
+u32 HWDET_SelectAccum(const HWDET_Sample *SamplePtr)
+{
+	u32		window;				// clocks in the 2^K periods of the pair
+	u32		period;				// clocks in one period
+	u32		k;
+
+	if (HWDET_IsSaturated(SamplePtr->High, SamplePtr->Low))
+	{
+		return 0;
+	}
+
+	window = SamplePtr->High + SamplePtr->Low + (2UL << SamplePtr->K);
+	if ((window > (HWDET_ACCUM_TARGET / 4)) && (window <= (HWDET_ACCUM_TARGET * 2)))
+	{
+		return SamplePtr->K;
+	}
+
+	period = window >> SamplePtr->K;
+	k = 0;
+	while ((k < HWDET_K_MAX) && ((period << (k + 1)) <= HWDET_ACCUM_TARGET))
+	{
+		k++;
+	}
+	return k;
+}
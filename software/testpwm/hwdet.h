@@ -0,0 +1,101 @@
+/**
+*
+* @file hwdet.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions and function prototypes for hwdet.c.
+* hwdet.c reads the high & low counts measured by hw_detect.v through the two input
+* channels of an axi_gpio.  hw_detect latches both counts of a PWM period at the same time
+* and tags them with a 4-bit sequence number, so a pair whose sequence numbers match comes
+* from one period.  hw_detect can also add up the counts of 2^k consecutive periods before
+* it latches them (k is set by software), which gives more precise results at high PWM
+* frequencies.  A second engine in hw_detect counts the rising edges in a fixed gate time;
+* it is read through the same channels while the application selects it (gate_sel).
+*
+* Range: the sequence number and k share the channels with the counts, which leaves 24
+* bits for each count.  An interval longer than 2^24 clocks (167.8 msec at 100MHz)
+* saturates at HWDET_COUNT_MAX, so the pairs measure every duty cycle down to 5.97Hz and
+* a 50% duty cycle down to 2.99Hz.  A saturated pair (HWDET_IsSaturated()) only says that
+* the PWM is slower than that; use the software detector below the range.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Accumulation of 2^k periods per pair, HWDET_Sample
+* 1.02a	ri	10/16/26	Gated edge counter, HWDET_ReadGate()
+* 1.03a	ri	10/16/26	Document the 24-bit range of the counts, HWDET_IsSaturated()
+* </pre>
+*
+******************************************************************************/
+
+#ifndef HWDET_H		/* prevent circular inclusions */
+#define HWDET_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xgpio.h"
+
+/************************** Constant Definitions *****************************/
+#define HWDET_HIGH_CHANNEL		1				// GPIO channel with {sequence, k, high count}
+#define HWDET_LOW_CHANNEL		2				// GPIO channel with {sequence, k, low count}
+
+#define HWDET_SEQ_SHIFT			28
+#define HWDET_SEQ_MASK			0xF0000000		// sequence number (0 = no complete period yet)
+#define HWDET_K_SHIFT			24
+#define HWDET_K_MASK			0x0F000000		// accumulation exponent the pair was measured with
+#define HWDET_COUNT_MASK		0x00FFFFFF		// count (sum of interval length - 1, saturates)
+#define HWDET_COUNT_MAX			0x00FFFFFF		// saturated count: the interval was longer than the range
+
+#define HWDET_K_MAX				15				// hw_detect accumulates at most 2^15 periods
+#define HWDET_ACCUM_TARGET		(1UL << 20)		// clocks per accumulation window HWDET_SelectAccum aims for
+#define HWDET_ACCUM_TIMEOUT_MS	50				// go back to k = 0 if no pair arrives for this long
+
+#define HWDET_MAX_RETRIES		8				// extra reads after a sequence mismatch before giving up
+
+/**************************** Type Definitions *******************************/
+// a high & low count pair.  Each period adds (interval length - 1) to the counts, so a pair
+// that covers 2^K periods with a high time of N clocks has High = 2^K * (N - 1)
+typedef struct {
+	u32		High;						// high counts of 2^K periods
+	u32		Low;						// low counts of 2^K periods
+	u32		K;							// accumulation exponent
+	u32		Seq;						// sequence number (changes with every new pair)
+} HWDET_Sample;
+
+// the gated counter (read while hw_detect's gate_sel input is set)
+typedef struct {
+	u32		Edges;						// rising edges in the last gate
+	u32		Clocks;						// gate length (clocks)
+	u32		Seq;						// sequence number (changes at the end of every gate)
+} HWDET_Gate;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#define HWDET_GetSeq(RegValue)		(((RegValue) & HWDET_SEQ_MASK) >> HWDET_SEQ_SHIFT)
+#define HWDET_GetK(RegValue)		(((RegValue) & HWDET_K_MASK) >> HWDET_K_SHIFT)
+#define HWDET_GetCount(RegValue)	((RegValue) & HWDET_COUNT_MASK)
+
+// the high or low count of a pair saturated: the PWM is below the range of hw_detect
+#define HWDET_IsSaturated(High, Low)	(((High) == HWDET_COUNT_MAX) || ((Low) == HWDET_COUNT_MAX))
+
+/************************** Function Prototypes ******************************/
+int HWDET_Read(XGpio *InstancePtr, HWDET_Sample *SamplePtr);
+u32 HWDET_SelectAccum(const HWDET_Sample *SamplePtr);
+int HWDET_ReadGate(XGpio *InstancePtr, HWDET_Gate *GatePtr);
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
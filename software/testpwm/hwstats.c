@@ -0,0 +1,357 @@
+/**
+*
+* @file hwstats.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides an API for the statistics unit of hw_detect.v (see hwstats.h).  Every
+* register is read by writing its number to the command channel and reading the data
+* channel.  The snapshot registers do not change until the next snapshot, so the 64-bit
+* sums can be read a word at a time.  The bit that takes a snapshot is toggled, so every
+* command write keeps it as it was last written.  A snapshot is complete when the snapshot
+* number has advanced and busy is clear: busy is only set a few clocks after the toggle.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Wait for the snapshot number to advance, check the histogram
+*						bins against the bins the unit has
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include "hwstats.h"
+
+
+/************************** Constant Definitions *****************************/
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+static u32 hwstats_read_reg(HWSTATS_Instance *InstancePtr, u32 Select);
+static void hwstats_read_moments(HWSTATS_Instance *InstancePtr, u32 Reg, HWSTATS_Moments *MomPtr);
+static u64 hwstats_sqrt(u64 x);
+
+/************************** Variable Definitions *****************************/
+
+/*****************************************************************************/
+/**
+*
+* hwstats_read_reg() - Selects a snapshot register or histogram bin and reads it
+*
+* @return	the register
+*
+******************************************************************************/
+static u32 hwstats_read_reg(HWSTATS_Instance *InstancePtr, u32 Select)
+{
+	InstancePtr->Cmd = (InstancePtr->Cmd & HWSTATS_CMD_SNAP) | Select;
+	XGpio_DiscreteWrite(InstancePtr->GpioPtr, HWSTATS_CMD_CHANNEL, InstancePtr->Cmd);
+	return XGpio_DiscreteRead(InstancePtr->GpioPtr, HWSTATS_DATA_CHANNEL);
+}
+
+
+/*****************************************************************************/
+/**
+*
+* hwstats_read_moments() - Reads the six registers of a length from register Reg on
+*
+* @return	None
+*
+******************************************************************************/
+static void hwstats_read_moments(HWSTATS_Instance *InstancePtr, u32 Reg, HWSTATS_Moments *MomPtr)
+{
+	u32		lo;
+
+	MomPtr->Min = hwstats_read_reg(InstancePtr, Reg);
+	MomPtr->Max = hwstats_read_reg(InstancePtr, Reg + 1);
+	lo = hwstats_read_reg(InstancePtr, Reg + 2);
+	MomPtr->Sum = ((u64) hwstats_read_reg(InstancePtr, Reg + 3) << 32) | lo;
+	lo = hwstats_read_reg(InstancePtr, Reg + 4);
+	MomPtr->SumSq = ((u64) hwstats_read_reg(InstancePtr, Reg + 5) << 32) | lo;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* hwstats_sqrt() - Integer square root (rounded down)
+*
+* @return	floor(sqrt(x))
+*
+******************************************************************************/
+static u64 hwstats_sqrt(u64 x)
+{
+	u64		root = 0;
+	u64		bit = 1ULL << 62;
+
+	while (bit > x)
+	{
+		bit >>= 2;
+	}
+	while (bit != 0)
+	{
+		if (x >= root + bit)
+		{
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* HWSTATS_Initialize() - Initializes the statistics unit driver
+*
+* Makes channel 1 of the GPIO an output, reads the number of histogram bins of the unit
+* and selects the status register.
+*
+* @param    InstancePtr is a pointer to the driver instance
+* @param    GpioPtr is a pointer to the initialized GPIO instance the unit is connected to
+*
+* @return	XST_SUCCESS
+*
+******************************************************************************/
+int HWSTATS_Initialize(HWSTATS_Instance *InstancePtr, XGpio *GpioPtr)
+{
+	u32		bits;
+
+	InstancePtr->GpioPtr = GpioPtr;
+	InstancePtr->Cmd = HWSTATS_REG_STATUS;
+
+	XGpio_SetDataDirection(GpioPtr, HWSTATS_CMD_CHANNEL, 0x00000000);
+	XGpio_SetDataDirection(GpioPtr, HWSTATS_DATA_CHANNEL, 0xFFFFFFFF);
+	bits = hwstats_read_reg(InstancePtr, HWSTATS_REG_INFO) >> 24;
+	InstancePtr->Bins = (bits <= HWSTATS_MAX_HIST_BITS) ? (1UL << bits) : 0;
+
+	InstancePtr->Cmd = HWSTATS_REG_STATUS;
+	XGpio_DiscreteWrite(GpioPtr, HWSTATS_CMD_CHANNEL, InstancePtr->Cmd);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* HWSTATS_Configure() - Sets up the histogram of the period deviations
+*
+* The histogram counts a period of P clocks in bin (P - RefClocks) / 2^Shift + Bins / 2,
+* or in the first or last bin if that is outside the histogram.  The configuration applies
+* from the next snapshot on.
+*
+* @param    InstancePtr is a pointer to the driver instance
+* @param    RefClocks is the reference period (clocks)
+* @param    Shift is log2 of the bin width (clocks)
+*
+* @return	XST_SUCCESS, or XST_INVALID_PARAM if RefClocks or Shift does not fit
+*
+******************************************************************************/
+int HWSTATS_Configure(HWSTATS_Instance *InstancePtr, u32 RefClocks, u32 Shift)
+{
+	if ((RefClocks > HWSTATS_CMD_REF_MASK) || (Shift > HWSTATS_MAX_SHIFT))
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	InstancePtr->Cmd = (InstancePtr->Cmd & HWSTATS_CMD_SNAP) | HWSTATS_CMD_CONFIG |
+		(Shift << HWSTATS_CMD_SHIFT_SHIFT) | RefClocks;
+	XGpio_DiscreteWrite(InstancePtr->GpioPtr, HWSTATS_CMD_CHANNEL, InstancePtr->Cmd);
+
+	// stop loading the configuration
+	InstancePtr->Cmd = (InstancePtr->Cmd & HWSTATS_CMD_SNAP) | HWSTATS_REG_STATUS;
+	XGpio_DiscreteWrite(InstancePtr->GpioPtr, HWSTATS_CMD_CHANNEL, InstancePtr->Cmd);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* HWSTATS_TakeSnapshot() - Reads and clears the statistics
+*
+* Takes a snapshot, waits until it is complete (the snapshot number has advanced and busy
+* is clear) and reads it.  The statistics cover the
+* interval from the previous snapshot to this one and the next interval starts from zero
+* at the same clock.  The histogram of the interval can be read with HWSTATS_ReadHist()
+* until the next snapshot.
+*
+* @param    InstancePtr is a pointer to the driver instance
+* @param    SnapPtr is a pointer to the result
+*
+* @return
+*
+*   - XST_SUCCESS if the snapshot was read
+*   - XST_DEVICE_BUSY if the snapshot did not complete (the unit is missing or held in
+*	  reset).  The result is not changed
+*
+******************************************************************************/
+int HWSTATS_TakeSnapshot(HWSTATS_Instance *InstancePtr, HWSTATS_Snapshot *SnapPtr)
+{
+	u32		status, info, seq;
+	int		polls;
+
+	// busy is only set a few clocks after the toggle, so a status read right after it can
+	// still show the unit idle.  The snapshot number advances when the sets swap, then busy
+	// clears once the pipeline has drained into the snapshot: wait for both
+
+	seq = hwstats_read_reg(InstancePtr, HWSTATS_REG_INFO) & 0xFFFF;
+
+	InstancePtr->Cmd = ((InstancePtr->Cmd & HWSTATS_CMD_SNAP) ^ HWSTATS_CMD_SNAP) | HWSTATS_REG_INFO;
+	XGpio_DiscreteWrite(InstancePtr->GpioPtr, HWSTATS_CMD_CHANNEL, InstancePtr->Cmd);
+
+	for (polls = 0; polls < HWSTATS_BUSY_POLLS; polls++)
+	{
+		info = XGpio_DiscreteRead(InstancePtr->GpioPtr, HWSTATS_DATA_CHANNEL);
+		if ((info & 0xFFFF) != seq)
+		{
+			break;
+		}
+	}
+
+	for (status = HWSTATS_STATUS_BUSY; polls < HWSTATS_BUSY_POLLS; polls++)
+	{
+		status = hwstats_read_reg(InstancePtr, HWSTATS_REG_STATUS);
+		if ((status & HWSTATS_STATUS_BUSY) == 0)
+		{
+			break;
+		}
+	}
+	if (polls >= HWSTATS_BUSY_POLLS)
+	{
+		return XST_DEVICE_BUSY;
+	}
+
+	SnapPtr->Seq = info & 0xFFFF;
+	SnapPtr->Bins = InstancePtr->Bins;
+	SnapPtr->Ref = status & HWSTATS_CMD_REF_MASK;
+	SnapPtr->Shift = (status & HWSTATS_CMD_SHIFT_MASK) >> HWSTATS_CMD_SHIFT_SHIFT;
+	SnapPtr->Overflow = (status & HWSTATS_STATUS_OVF) ? 1 : 0;
+	SnapPtr->Periods = hwstats_read_reg(InstancePtr, HWSTATS_REG_PERIODS);
+	SnapPtr->Clocks = hwstats_read_reg(InstancePtr, HWSTATS_REG_CLOCKS);
+	hwstats_read_moments(InstancePtr, HWSTATS_REG_PERIOD, &SnapPtr->Period);
+	hwstats_read_moments(InstancePtr, HWSTATS_REG_HIGH, &SnapPtr->High);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* HWSTATS_ReadHist() - Reads histogram bins of the last snapshot
+*
+* The unit only decodes the bin number modulo its number of bins (Bins of the snapshot), so
+* bins beyond it would read other bins again and are refused.
+*
+* @param    InstancePtr is a pointer to the driver instance
+* @param    First is the first bin to read
+* @param    Count is the number of bins to read
+* @param    BinPtr is a pointer to Count words for the bins
+*
+* @return	XST_SUCCESS, or XST_INVALID_PARAM if the bins are outside the histogram
+*
+******************************************************************************/
+int HWSTATS_ReadHist(HWSTATS_Instance *InstancePtr, u32 First, u32 Count, u32 *BinPtr)
+{
+	u32		i;
+
+	if ((First > InstancePtr->Bins) || (Count > InstancePtr->Bins - First))
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	for (i = 0; i < Count; i++)
+	{
+		BinPtr[i] = hwstats_read_reg(InstancePtr, HWSTATS_CMD_HIST | (First + i));
+	}
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* HWSTATS_MeanMilli() - Mean of a length
+*
+* @param    MomPtr is a pointer to the moments of the length
+* @param    N is the number of lengths (Periods of the snapshot)
+*
+* @return	the mean in thousandths of a clock, rounded (0 if N is 0)
+*
+******************************************************************************/
+u64 HWSTATS_MeanMilli(const HWSTATS_Moments *MomPtr, u32 N)
+{
+	u64		mean, rem;
+
+	if (N == 0)
+	{
+		return 0;
+	}
+
+	mean = MomPtr->Sum / N;
+	rem = MomPtr->Sum - (mean * N);
+	return (mean * 1000) + (((rem * 1000) + (N / 2)) / N);
+}
+
+
+/*****************************************************************************/
+/**
+*
+* HWSTATS_StdMilli() - Standard deviation of a length
+*
+* The sum of the squared deviations from the whole part m of the mean,
+* SumSq - 2 * m * Sum + N * m^2, is small for a stable signal even when SumSq and Sum^2
+* are not, and the wraparound of 64-bit arithmetic cancels out, so it is exact whenever
+* the result fits in 64 bits.  The fraction f / N of the mean is then taken off
+* (- f^2 / N).
+*
+* @param    MomPtr is a pointer to the moments of the length
+* @param    N is the number of lengths (Periods of the snapshot)
+*
+* @return	the (population) standard deviation in thousandths of a clock, rounded down
+*			(0 if N is 0, 0xFFFFFFFF if it does not fit)
+*
+* @note
+* The result is meaningless if the Overflow flag of the snapshot is set.
+*
+******************************************************************************/
+u32 HWSTATS_StdMilli(const HWSTATS_Moments *MomPtr, u32 N)
+{
+	u64		m, f, dev2, var, rem, root;
+
+	if (N == 0)
+	{
+		return 0;
+	}
+
+	m = MomPtr->Sum / N;
+	f = MomPtr->Sum - (m * N);
+	dev2 = MomPtr->SumSq - (2 * m * MomPtr->Sum) + ((u64) N * m * m);
+	dev2 -= (f * f) / N;
+
+	// variance in millionths of a clock^2
+	var = dev2 / N;
+	rem = dev2 - (var * N);
+	if (var > (0xFFFFFFFFFFFFFFFFULL / 1000000) - 1)
+	{
+		return 0xFFFFFFFF;
+	}
+	var = (var * 1000000) + ((rem * 1000000) / N);
+
+	root = hwstats_sqrt(var);
+	return (root > 0xFFFFFFFF) ? 0xFFFFFFFF : (u32) root;
+}
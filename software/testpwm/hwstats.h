@@ -0,0 +1,113 @@
+/**
+*
+* @file hwstats.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions and function prototypes for hwstats.c.
+* hwstats.c reads the statistics unit of hw_detect.v (hw_stats.v) through an axi_gpio:
+* channel 1 (output) carries the command and the register select, channel 2 (input) the
+* selected register.  The unit keeps the number, min, max, sum and sum of squares of the
+* length of every PWM period and of its high time, and a histogram of the deviation of the
+* period from a reference period.  It keeps two sets: a snapshot swaps them in one clock,
+* so the statistics of an interval are read and cleared atomically while the next interval
+* is already being counted.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	The instance keeps the number of histogram bins of the unit
+* </pre>
+*
+******************************************************************************/
+
+#ifndef HWSTATS_H		/* prevent circular inclusions */
+#define HWSTATS_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xgpio.h"
+
+/************************** Constant Definitions *****************************/
+#define HWSTATS_CMD_CHANNEL		1				// GPIO channel with the command (output)
+#define HWSTATS_DATA_CHANNEL	2				// GPIO channel with the selected register (input)
+
+// command bits
+#define HWSTATS_CMD_SNAP		0x80000000		// a change of this bit takes a snapshot
+#define HWSTATS_CMD_CONFIG		0x40000000		// load the shift and the reference period
+#define HWSTATS_CMD_HIST		0x00000200		// select a histogram bin instead of a register
+#define HWSTATS_CMD_SHIFT_SHIFT	24
+#define HWSTATS_CMD_SHIFT_MASK	0x1F000000		// histogram bin width 2^shift (clocks)
+#define HWSTATS_CMD_REF_MASK	0x00FFFFFF		// reference period (clocks)
+
+// snapshot registers
+#define HWSTATS_REG_STATUS		0				// {busy, overflow, 0, shift, reference period}
+#define HWSTATS_REG_PERIODS		1
+#define HWSTATS_REG_CLOCKS		2				// length of the interval
+#define HWSTATS_REG_INFO		3				// {histogram bits, 0, snapshot number}
+#define HWSTATS_REG_PERIOD		4				// min, max, sum lo/hi, sum of squares lo/hi
+#define HWSTATS_REG_HIGH		10				// same for the high time
+
+#define HWSTATS_STATUS_BUSY		0x80000000		// a snapshot is being taken
+#define HWSTATS_STATUS_OVF		0x40000000		// a sum of squares saturated
+
+#define HWSTATS_MAX_SHIFT		31
+#define HWSTATS_MAX_HIST_BITS	9
+#define HWSTATS_MAX_BINS		(1 << HWSTATS_MAX_HIST_BITS)
+#define HWSTATS_BUSY_POLLS		256				// status reads before a snapshot times out
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	XGpio	*GpioPtr;					// GPIO instance the unit is connected to
+	u32		Cmd;						// last command written
+	u32		Bins;						// histogram bins of the unit (2^HIST_BITS, 0 if not supported)
+} HWSTATS_Instance;
+
+// min, max, sum and sum of squares of a length (clocks)
+typedef struct {
+	u32		Min;
+	u32		Max;
+	u64		Sum;
+	u64		SumSq;
+} HWSTATS_Moments;
+
+// the statistics of one interval
+typedef struct {
+	u32				Seq;				// snapshot number
+	u32				Periods;			// periods that ended in the interval
+	u32				Clocks;				// length of the interval (saturates)
+	u32				Ref;				// reference period of the histogram (clocks)
+	u32				Shift;				// histogram bin width 2^Shift (clocks)
+	u32				Bins;				// histogram bins (the reference period is Bins / 2)
+	u32				Overflow;			// 1 = a sum of squares saturated
+	HWSTATS_Moments	Period;
+	HWSTATS_Moments	High;
+} HWSTATS_Snapshot;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+int HWSTATS_Initialize(HWSTATS_Instance *InstancePtr, XGpio *GpioPtr);
+int HWSTATS_Configure(HWSTATS_Instance *InstancePtr, u32 RefClocks, u32 Shift);
+int HWSTATS_TakeSnapshot(HWSTATS_Instance *InstancePtr, HWSTATS_Snapshot *SnapPtr);
+int HWSTATS_ReadHist(HWSTATS_Instance *InstancePtr, u32 First, u32 Count, u32 *BinPtr);
+u64 HWSTATS_MeanMilli(const HWSTATS_Moments *MomPtr, u32 N);
+u32 HWSTATS_StdMilli(const HWSTATS_Moments *MomPtr, u32 N);
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,51 @@
+/**
+*
+* @file idle.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the macros the application's wait loops use between two checks of
+* the condition they wait for:
+*
+*	o	WAIT_FOR_INTERRUPT() in a loop that waits for an interrupt handler to set a flag
+*		or make room (main_wake, the telemetry transmit ring)
+*	o	SPIN_WAIT() in a loop that polls and does not wait for an interrupt (the main
+*		loop and delay_msecs() without MAIN_LOOP_EVENT_DRIVEN)
+*
+* On the target WAIT_FOR_INTERRUPT() is the MicroBlaze sleep instruction (mbar 16): the
+* core stops until an interrupt arrives, then takes it and goes on with the loop.  It must
+* not be used with interrupts disabled.  The sleep instruction needs a MicroBlaze v9.x
+* core that implements it; older cores execute mbar 16 as a no-op and the loop spins.
+* SPIN_WAIT() expands to nothing, so the polling loops spin.  The host simulation model
+* defines both in its mb_interface.h as hostsim_idle(), which lets its deterministic
+* clock skip to the next interrupt (a loop that makes no bus accesses would otherwise
+* stop simulated time).  mbar() keeps its BSP meaning (memory barrier).
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release
+* 1.01a	ri	10/16/26	WAIT_FOR_INTERRUPT() sleeps until the next interrupt
+* </pre>
+*
+******************************************************************************/
+
+#ifndef IDLE_H		/* prevent circular inclusions */
+#define IDLE_H		/* by using protection macros */
+
+/***************************** Include Files *********************************/
+#include "mb_interface.h"
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#ifndef WAIT_FOR_INTERRUPT
+#define WAIT_FOR_INTERRUPT()	__asm__ __volatile__ ("mbar\t16" : : : "memory")	// sleep
+#endif
+
+#ifndef SPIN_WAIT
+#define SPIN_WAIT()											// spin
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,369 @@
+/**
+*
+* @file lcdfb.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides a shadow framebuffer for the PmodCLP LCD (see lcdfb.h).  Two copies
+* of the display are kept: the framebuffer the application draws into and the contents
+* the display will have once the queue is sent.  The queue is a ring of display positions
+* and characters.  The position of the HD44780 cursor is tracked as well (it moves right
+* after every character), so a run of queued characters only needs one cursor move.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Queue the changes, LCDFB_Drain() sends them without waiting
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include "lcdfb.h"
+#include "xil_io.h"
+#include "PMod544IOR2.h"
+
+/************************** Constant Definitions *****************************/
+#define LCDFB_NO_POS			0xFF			// the LCD cursor is not on the display
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	u8		Pos;						// display position (row * LCDFB_COLS + col)
+	char	Ch;							// character
+} LCDFB_Entry;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+static u32 lcdfb_queue_changes(void);
+
+/************************** Variable Definitions *****************************/
+static char			lcdfb_buf[LCDFB_ROWS][LCDFB_COLS];		// what the application drew
+static char			lcdfb_shown[LCDFB_ROWS][LCDFB_COLS];	// what the display shows once the queue is sent
+static u32			lcdfb_row, lcdfb_col;					// framebuffer cursor
+static u32			lcdfb_lcd_pos;							// LCD cursor (LCDFB_NO_POS if off the display)
+static bool			lcdfb_dirty;							// changes did not fit in the queue
+static UINTPTR		lcdfb_sts_addr;							// PMod544IOR2 status register
+
+static LCDFB_Entry	lcdfb_queue[LCDFB_QUEUE_SIZE];
+static u32			lcdfb_head, lcdfb_tail;					// next entry to fill, next entry to send
+
+static LCDFB_Stats	lcdfb_stats;
+
+/*****************************************************************************/
+/**
+*
+* lcdfb_queue_changes() - Queue the characters that differ from the display
+*
+* A character for a position that is already queued replaces the queued one.  When
+* the queue is full the remaining changes are left for LCDFB_Drain() to queue later.
+*
+* @return	The number of characters queued or replaced
+*
+******************************************************************************/
+static u32 lcdfb_queue_changes(void)
+{
+	u32		r, c, i;
+	u32		pos;
+	u32		chars = 0;
+
+	lcdfb_dirty = false;
+	for (r = 0; r < LCDFB_ROWS; r++)
+	{
+		for (c = 0; c < LCDFB_COLS; c++)
+		{
+			if (lcdfb_buf[r][c] == lcdfb_shown[r][c])
+			{
+				continue;
+			}
+
+			// replace a stale character that has not been sent yet
+			pos = (r * LCDFB_COLS) + c;
+			for (i = lcdfb_tail; i != lcdfb_head; i++)
+			{
+				if (lcdfb_queue[i & (LCDFB_QUEUE_SIZE - 1)].Pos == pos)
+				{
+					break;
+				}
+			}
+
+			if (i != lcdfb_head)
+			{
+				lcdfb_queue[i & (LCDFB_QUEUE_SIZE - 1)].Ch = lcdfb_buf[r][c];
+				lcdfb_stats.Replaced++;
+			}
+			else if ((lcdfb_head - lcdfb_tail) < LCDFB_QUEUE_SIZE)
+			{
+				lcdfb_queue[lcdfb_head & (LCDFB_QUEUE_SIZE - 1)].Pos = pos;
+				lcdfb_queue[lcdfb_head & (LCDFB_QUEUE_SIZE - 1)].Ch = lcdfb_buf[r][c];
+				lcdfb_head++;
+			}
+			else
+			{
+				lcdfb_dirty = true;
+				continue;
+			}
+
+			lcdfb_shown[r][c] = lcdfb_buf[r][c];
+			chars++;
+		}
+	}
+	return chars;
+}
+
+/*****************************************************************************/
+/**
+* Initializes the framebuffer and clears the display
+*
+* @param	BaseAddress is the base address of the PMod544IOR2 (PMDIO_initialize()
+*			must have been called)
+*
+* @return	None
+*
+******************************************************************************/
+void LCDFB_Initialize(u32 BaseAddress)
+{
+	u32		r, c;
+
+	for (r = 0; r < LCDFB_ROWS; r++)
+	{
+		for (c = 0; c < LCDFB_COLS; c++)
+		{
+			lcdfb_buf[r][c] = ' ';
+			lcdfb_shown[r][c] = ' ';
+		}
+	}
+	lcdfb_row = 0;
+	lcdfb_col = 0;
+	lcdfb_head = 0;
+	lcdfb_tail = 0;
+	lcdfb_dirty = false;
+	lcdfb_sts_addr = BaseAddress + PMDIO_ROTLCD_STS_OFFSET;
+
+	// clear display also returns the cursor home
+	PMDIO_LCD_clrd();
+	lcdfb_lcd_pos = 0;
+
+	lcdfb_stats.Flushes = 0;
+	lcdfb_stats.LastChars = 0;
+	lcdfb_stats.Bytes = 1;					// the clear display command
+	lcdfb_stats.Replaced = 0;
+	lcdfb_stats.Overflows = 0;
+}
+
+
+/*****************************************************************************/
+/**
+* Fills the framebuffer with blanks and moves its cursor to the first position
+*
+* @return	None
+*
+******************************************************************************/
+void LCDFB_Clear(void)
+{
+	u32		r, c;
+
+	for (r = 0; r < LCDFB_ROWS; r++)
+	{
+		for (c = 0; c < LCDFB_COLS; c++)
+		{
+			lcdfb_buf[r][c] = ' ';
+		}
+	}
+	lcdfb_row = 0;
+	lcdfb_col = 0;
+}
+
+
+/*****************************************************************************/
+/**
+* Moves the framebuffer cursor
+*
+* @param	row is the line (1 or 2, like PMDIO_LCD_setcursor())
+* @param	col is the column (0 to 15)
+*
+* @return	None
+*
+******************************************************************************/
+void LCDFB_SetCursor(u32 row, u32 col)
+{
+	lcdfb_row = (row <= 1) ? 0 : 1;
+	lcdfb_col = col;
+}
+
+
+/*****************************************************************************/
+/**
+* Writes a character into the framebuffer at the cursor and moves the cursor right
+*
+* Characters past the end of the line are dropped.
+*
+* @param	ch is the character
+*
+* @return	None
+*
+******************************************************************************/
+void LCDFB_WrChar(char ch)
+{
+	if (lcdfb_col < LCDFB_COLS)
+	{
+		lcdfb_buf[lcdfb_row][lcdfb_col] = ch;
+	}
+	lcdfb_col++;
+}
+
+
+/*****************************************************************************/
+/**
+* Writes a string into the framebuffer at the cursor
+*
+* @param	s is the string
+*
+* @return	None
+*
+******************************************************************************/
+void LCDFB_WrString(const char *s)
+{
+	while (*s != '\0')
+	{
+		LCDFB_WrChar(*s++);
+	}
+}
+
+
+/*****************************************************************************/
+/**
+* Writes a number into the framebuffer at the cursor
+*
+* @param	num is the number
+* @param	radix is the base (2 to 16).  Negative numbers get a '-' in base 10 only
+*
+* @return	None
+*
+******************************************************************************/
+void LCDFB_PutNum(s32 num, s32 radix)
+{
+	char	buf[34];
+	char	*p = &buf[sizeof(buf) - 1];
+	bool	neg = (num < 0) && (radix == 10);
+	u32		n = neg ? (u32) -num : (u32) num;
+
+	*p = '\0';
+	do
+	{
+		*--p = "0123456789ABCDEF"[n % (u32) radix];
+		n /= (u32) radix;
+	} while (n != 0);
+	if (neg)
+	{
+		*--p = '-';
+	}
+	LCDFB_WrString(p);
+}
+
+
+/*****************************************************************************/
+/**
+* Queues the characters that changed since the last flush
+*
+* Returns without waiting for the LCD.  The characters are sent by LCDFB_Drain().
+*
+* @return	The number of characters queued (including the ones that replaced a
+*			queued character)
+*
+******************************************************************************/
+u32 LCDFB_Flush(void)
+{
+	lcdfb_stats.Flushes++;
+	lcdfb_stats.LastChars = lcdfb_queue_changes();
+	if (lcdfb_dirty)
+	{
+		lcdfb_stats.Overflows++;
+	}
+	return lcdfb_stats.LastChars;
+}
+
+
+/*****************************************************************************/
+/**
+* Sends the next byte of the queue to the LCD if it is not busy
+*
+* Sends either the cursor move to the next queued character or the character itself.
+* When the queue is empty the changes that did not fit in it are queued.
+*
+* @return	None
+*
+* @note
+* The LCD is busy for about 37us after every byte, so calling this every millisecond
+* sends a line of the display in at most 17ms without the caller ever waiting.
+*
+******************************************************************************/
+void LCDFB_Drain(void)
+{
+	LCDFB_Entry		*ep;
+
+	if ((lcdfb_head == lcdfb_tail) && (!lcdfb_dirty || (lcdfb_queue_changes() == 0)))
+	{
+		return;
+	}
+
+	if (Xil_In32(lcdfb_sts_addr) & PMDIO_STS_LCDBUSY_MASK)
+	{
+		return;
+	}
+
+	ep = &lcdfb_queue[lcdfb_tail & (LCDFB_QUEUE_SIZE - 1)];
+	if (ep->Pos != lcdfb_lcd_pos)
+	{
+		PMDIO_LCD_setcursor((ep->Pos / LCDFB_COLS) + 1, ep->Pos % LCDFB_COLS);
+		lcdfb_lcd_pos = ep->Pos;
+	}
+	else
+	{
+		PMDIO_LCD_wrchar(ep->Ch);
+		lcdfb_tail++;
+
+		// the HD44780 cursor does not wrap to the next line
+		lcdfb_lcd_pos = (((ep->Pos + 1) % LCDFB_COLS) == 0) ? LCDFB_NO_POS : ep->Pos + 1;
+	}
+	lcdfb_stats.Bytes++;
+}
+
+
+/*****************************************************************************/
+/**
+* Sends everything that is queued, waiting for the LCD
+*
+* @return	None
+*
+* @note
+* Blocks for up to a few milliseconds.  Use it where waiting does not matter (e.g.
+* before the application exits).
+*
+******************************************************************************/
+void LCDFB_Sync(void)
+{
+	while ((lcdfb_head != lcdfb_tail) || lcdfb_dirty)
+	{
+		LCDFB_Drain();
+	}
+}
+
+
+/*****************************************************************************/
+/**
+* Returns a copy of the LCD traffic counters
+*
+* @param	StatsPtr is a pointer to the copy
+*
+* @return	None
+*
+******************************************************************************/
+void LCDFB_GetStats(LCDFB_Stats *StatsPtr)
+{
+	*StatsPtr = lcdfb_stats;
+}
@@ -0,0 +1,86 @@
+/**
+*
+* @file lcdfb.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions and function prototypes for lcdfb.c.
+* lcdfb.c keeps a 2x16 shadow framebuffer of the PmodCLP LCD in memory.  The application
+* draws into the framebuffer with the same kind of calls as the PMDIO_LCD_* functions
+* (LCDFB_SetCursor, LCDFB_WrString, LCDFB_PutNum, ...), which only change memory, and
+* then calls LCDFB_Flush().  LCDFB_Flush() compares the framebuffer with the display and
+* queues only the characters that differ.  It does not wait for the LCD.
+*
+* The queue is sent to the LCD by LCDFB_Drain(), which the application calls periodically
+* (e.g. every millisecond from the FIT).  LCDFB_Drain() never waits either: it sends one
+* cursor move or one character if the LCD is not busy and returns.  The cursor is only
+* moved when the next queued character is not where the HD44780 cursor already is.
+*
+* The queue holds one entry per display position.  A character queued for a position
+* that is still waiting to be sent replaces the stale one, so the LCD always catches up
+* with the newest frame.  If the queue is full the rest of the frame is queued as it
+* drains.
+*
+* Once LCDFB_Initialize() has been called the display must only be written through lcdfb,
+* and all lcdfb functions must be called from the same context (e.g. the main loop).
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Queue the changes, LCDFB_Drain() sends them without waiting
+* </pre>
+*
+******************************************************************************/
+
+#ifndef LCDFB_H		/* prevent circular inclusions */
+#define LCDFB_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "xil_types.h"
+
+/************************** Constant Definitions *****************************/
+#define LCDFB_ROWS				2
+#define LCDFB_COLS				16
+
+#define LCDFB_QUEUE_SIZE		16				// queued characters (power of 2, at most LCDFB_ROWS * LCDFB_COLS)
+
+/**************************** Type Definitions *******************************/
+// LCD traffic (a byte is one command or one character sent to the LCD)
+typedef struct {
+	u32		Flushes;					// LCDFB_Flush() calls
+	u32		LastChars;					// characters queued by the last LCDFB_Flush()
+	u32		Bytes;						// bytes sent since LCDFB_Initialize()
+	u32		Replaced;					// queued characters replaced before they were sent
+	u32		Overflows;					// flushes that did not fit in the queue
+} LCDFB_Stats;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+void LCDFB_Initialize(u32 BaseAddress);
+void LCDFB_Clear(void);
+void LCDFB_SetCursor(u32 row, u32 col);
+void LCDFB_WrChar(char ch);
+void LCDFB_WrString(const char *s);
+void LCDFB_PutNum(s32 num, s32 radix);
+u32 LCDFB_Flush(void);
+void LCDFB_Drain(void);
+void LCDFB_Sync(void);
+void LCDFB_GetStats(LCDFB_Stats *StatsPtr);
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
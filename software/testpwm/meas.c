@@ -0,0 +1,175 @@
+/**
+*
+* @file meas.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides the fixed-point frequency and duty cycle calculations (see meas.h).
+*
+* The detector counts every interval as (clocks - 1), so one period of high and low counts
+* is (high + low + 2) clocks, and 2^k periods are (high + low + 2^(k+1)) clocks:
+*
+*		frequency (mHz)  = clock * 1000 * 2^k / (high + low + 2^(k+1))
+*		duty cycle (0.01%) = 10000 * (high + 2^k) / (high + low + 2^(k+1))
+*
+* With counts below 2^32 and k <= 15 the numerators are below 2^58 and 2^46.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include "meas.h"
+
+/************************** Constant Definitions *****************************/
+
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+static u64 meas_divrem(u64 Num, u64 Den, u64 *RemPtr);
+
+/************************** Variable Definitions *****************************/
+
+
+/*****************************************************************************/
+/**
+*
+* meas_divrem() - Divides with shifts and subtractions
+*
+* The divisor is shifted up until it lines up with the dividend and then subtracted
+* bit by bit, so both loops run once per bit of the quotient.  Den must not be 0.
+*
+* @return	Num / Den (truncated), the remainder in *RemPtr
+*
+******************************************************************************/
+static u64 meas_divrem(u64 Num, u64 Den, u64 *RemPtr)
+{
+	u64		q = 0;
+	u64		bit = 1;
+
+	// Den <= Num / 2 means Den * 2 <= Num, and Den * 2 cannot overflow
+	while (Den <= (Num >> 1))
+	{
+		Den <<= 1;
+		bit <<= 1;
+	}
+	while (bit != 0)
+	{
+		if (Num >= Den)
+		{
+			Num -= Den;
+			q |= bit;
+		}
+		Den >>= 1;
+		bit >>= 1;
+	}
+	*RemPtr = Num;
+	return q;
+}
+
+/*****************************************************************************/
+/**
+* Divides, rounding to the nearest integer (halves up)
+*
+* @param	Num is the dividend
+* @param	Den is the divisor
+*
+* @return	Num / Den rounded, or 0xFFFFFFFFFFFFFFFF if Den is 0
+*
+******************************************************************************/
+u64 MEAS_DivRound(u64 Num, u64 Den)
+{
+	u64		q, rem;
+
+	if (Den == 0)
+	{
+		return ~0ULL;
+	}
+
+	// round up if the remainder is at least half the divisor (2 * rem could overflow)
+	q = meas_divrem(Num, Den, &rem);
+	return (rem >= (Den - rem)) ? q + 1 : q;
+}
+
+
+/*****************************************************************************/
+/**
+* Calculates the frequency from high and low counts
+*
+* @param	ClkFreq is the frequency of the clock that was counted (Hz)
+* @param	High is the high count (the sum of (high clocks - 1) over 2^K periods)
+* @param	Low is the low count (the sum of (low clocks - 1) over 2^K periods)
+* @param	K is the accumulation exponent (0 for single periods, at most MEAS_MAX_K)
+*
+* @return	The frequency in mHz, rounded
+*
+******************************************************************************/
+u64 MEAS_FreqMilliHz(u32 ClkFreq, u32 High, u32 Low, u32 K)
+{
+	u64		sum;
+
+	K &= MEAS_MAX_K;
+	sum = (u64) High + Low + (2ULL << K);
+	return MEAS_DivRound(((u64) ClkFreq * MEAS_FREQ_SCALE) << K, sum);
+}
+
+
+/*****************************************************************************/
+/**
+* Calculates the duty cycle from high and low counts
+*
+* @param	High is the high count (the sum of (high clocks - 1) over 2^K periods)
+* @param	Low is the low count (the sum of (low clocks - 1) over 2^K periods)
+* @param	K is the accumulation exponent (0 for single periods, at most MEAS_MAX_K)
+*
+* @return	The duty cycle in 0.01% (0 to 10000), rounded
+*
+******************************************************************************/
+u32 MEAS_DutyHundredths(u32 High, u32 Low, u32 K)
+{
+	u64		sum;
+
+	K &= MEAS_MAX_K;
+	sum = (u64) High + Low + (2ULL << K);
+	return (u32) MEAS_DivRound(((u64) High + (1ULL << K)) * MEAS_DUTY_SCALE, sum);
+}
+
+
+/*****************************************************************************/
+/**
+* Calculates the frequency from the rising edges counted in a gate
+*
+* @param	ClkFreq is the frequency of the clock that timed the gate (Hz)
+* @param	Edges is the number of rising edges in the gate
+* @param	Clocks is the length of the gate in clocks
+*
+* @return	The frequency in mHz, rounded (0 if Clocks is 0)
+*
+* @note
+* Edges * ClkFreq * 1000 can need more than 64 bits, so the whole Hz and the remainder
+* are divided separately.
+*
+******************************************************************************/
+u64 MEAS_GateFreqMilliHz(u32 ClkFreq, u32 Edges, u32 Clocks)
+{
+	u64		hz, rem;
+
+	if (Clocks == 0)
+	{
+		return 0;
+	}
+
+	hz = meas_divrem((u64) Edges * ClkFreq, Clocks, &rem);
+	return (hz * MEAS_FREQ_SCALE) + MEAS_DivRound(rem * MEAS_FREQ_SCALE, Clocks);
+}
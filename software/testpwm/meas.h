@@ -0,0 +1,61 @@
+/**
+*
+* @file meas.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions and function prototypes for meas.c.
+* meas.c turns the counts of the frequency detectors into a frequency in mHz and a duty
+* cycle in hundredths of a percent, both rounded to the nearest unit (halves up).
+*
+* The counts can be anything up to 2^32 - 1 (and the accumulation exponent up to
+* MEAS_MAX_K): every intermediate result fits in 64 bits.  The divisions are done by
+* MEAS_DivRound(), a shift-and-subtract division whose loop runs once per bit of the
+* quotient, so there is no 64-bit libgcc division (which is a 64-step loop on a
+* Microblaze without a hardware divider) on the measurement path.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* </pre>
+*
+******************************************************************************/
+
+#ifndef MEAS_H		/* prevent circular inclusions */
+#define MEAS_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "xil_types.h"
+
+/************************** Constant Definitions *****************************/
+#define MEAS_FREQ_SCALE			1000			// frequencies are in mHz
+#define MEAS_DUTY_SCALE			10000			// duty cycles are in 0.01% (10000 = 100%)
+#define MEAS_MAX_K				15				// largest accumulation exponent
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+u64 MEAS_DivRound(u64 Num, u64 Den);
+u64 MEAS_FreqMilliHz(u32 ClkFreq, u32 High, u32 Low, u32 K);
+u32 MEAS_DutyHundredths(u32 High, u32 Low, u32 K);
+u64 MEAS_GateFreqMilliHz(u32 ClkFreq, u32 Edges, u32 Clocks);
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
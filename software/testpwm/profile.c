@@ -0,0 +1,285 @@
+/**
+*
+* @file profile.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides a profiler for timing regions of code with a free-running up counter
+* of an axi_timer (see profile.h).  The counter is read directly (one bus read at the
+* start and one at the end of a region) and the time is added to the statistics of the
+* region.  The cost of the two reads themselves is measured by PROFILE_Initialize() and
+* subtracted from every time.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Added PROFILE_GetOverhead()
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include "profile.h"
+
+#if PROFILE_ENABLE
+
+#include "xil_printf.h"
+#include "mb_interface.h"
+
+/************************** Constant Definitions *****************************/
+#define PROFILE_CAL_RUNS		8				// empty regions timed to measure the overhead
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+static void profile_clear(void);
+
+/************************** Variable Definitions *****************************/
+UINTPTR						profile_counter_addr;			// timer counter register read by PROFILE_Now()
+
+static PROFILE_Stats		profile_stats[PROFILE_MAX_REGIONS];
+static const char * const	*profile_names;
+static u32					profile_num_regions = 0;
+static u32					profile_overhead;				// clocks of an empty region
+static u32					profile_clock_freq;
+
+/*****************************************************************************/
+/**
+*
+* profile_clear() - Clear the statistics of all regions
+*
+* @return	None
+*
+******************************************************************************/
+static void profile_clear(void)
+{
+	u32		r, b;
+
+	for (r = 0; r < PROFILE_MAX_REGIONS; r++)
+	{
+		profile_stats[r].Count = 0;
+		profile_stats[r].Min = 0xFFFFFFFF;
+		profile_stats[r].Max = 0;
+		profile_stats[r].Sum = 0;
+		for (b = 0; b < PROFILE_HIST_BUCKETS; b++)
+		{
+			profile_stats[r].Hist[b] = 0;
+		}
+	}
+}
+
+
+/*****************************************************************************/
+/**
+* Initializes the profiler
+*
+* Uses the counter of a timer that the application has started counting up and
+* never reloads (e.g. an axi_timer in capture mode), measures the cost of timing
+* an empty region and clears the statistics.
+*
+* @param    TimerBaseAddress is the base address of the axi_timer
+* @param	TmrCtrNumber is the timer (0 or 1) whose counter is read
+* @param	clkfreq is the input clock frequency for the timer
+* @param	Names is an array of NumRegions region names used by PROFILE_Dump()
+* @param	NumRegions is the number of regions (at most PROFILE_MAX_REGIONS)
+*
+* @return
+*
+*   - XST_SUCCESS if the profiler was initialized
+*   - XST_INVALID_PARAM if there are too many regions
+*   - XST_FAILURE if the counter is not counting
+*
+******************************************************************************/
+int PROFILE_Initialize(u32 TimerBaseAddress, u8 TmrCtrNumber, u32 clkfreq,
+		const char * const *Names, u32 NumRegions)
+{
+	u32		start, clocks;
+	int		i;
+
+	if (NumRegions > PROFILE_MAX_REGIONS)
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	profile_counter_addr = TimerBaseAddress + (TmrCtrNumber * XTC_TIMER_COUNTER_OFFSET) + XTC_TCR_OFFSET;
+	profile_names = Names;
+	profile_num_regions = NumRegions;
+	profile_clock_freq = clkfreq;
+
+	// the overhead is the shortest time of an empty region
+	profile_overhead = 0xFFFFFFFF;
+	for (i = 0; i < PROFILE_CAL_RUNS; i++)
+	{
+		start = PROFILE_Now();
+		clocks = PROFILE_Now() - start;
+		if (clocks < profile_overhead)
+		{
+			profile_overhead = clocks;
+		}
+	}
+	if (profile_overhead == 0)
+	{
+		return XST_FAILURE;
+	}
+
+	profile_clear();
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+* Adds a time to the statistics of a region
+*
+* Called by PROFILE_END().  The overhead of timing the region is subtracted.
+*
+* @param    Region is the number of the region
+* @param	Clocks is the time from PROFILE_BEGIN() to PROFILE_END() in timer clocks
+*
+* @return	None
+*
+******************************************************************************/
+void PROFILE_Record(u32 Region, u32 Clocks)
+{
+	PROFILE_Stats	*sp;
+	u32				bucket;
+	u32				t;
+
+	if (Region >= profile_num_regions)
+	{
+		return;
+	}
+	sp = &profile_stats[Region];
+	Clocks = (Clocks > profile_overhead) ? Clocks - profile_overhead : 0;
+
+	sp->Count++;
+	sp->Sum += Clocks;
+	if (Clocks < sp->Min)
+	{
+		sp->Min = Clocks;
+	}
+	if (Clocks > sp->Max)
+	{
+		sp->Max = Clocks;
+	}
+
+	// bucket = number of significant bits above PROFILE_HIST_SHIFT - 1
+	bucket = 0;
+	for (t = Clocks >> (PROFILE_HIST_SHIFT - 1); (t > 1) && (bucket < (PROFILE_HIST_BUCKETS - 1)); t >>= 1)
+	{
+		bucket++;
+	}
+	sp->Hist[bucket]++;
+}
+
+
+/*****************************************************************************/
+/**
+* Returns a copy of the statistics of a region
+*
+* The copy is made with interrupts disabled, so it is consistent even for a region
+* timed by an interrupt handler.  Interrupts are enabled again when it returns.
+*
+* @param    Region is the number of the region
+* @param	StatsPtr is a pointer to the copy
+*
+* @return	None
+*
+******************************************************************************/
+void PROFILE_GetStats(u32 Region, PROFILE_Stats *StatsPtr)
+{
+	if (Region >= profile_num_regions)
+	{
+		return;
+	}
+
+	microblaze_disable_interrupts();
+	*StatsPtr = profile_stats[Region];
+	microblaze_enable_interrupts();
+}
+
+
+/*****************************************************************************/
+/**
+* Returns the overhead of timing a region
+*
+* This is the time between two back-to-back PROFILE_Now() reads, measured by
+* PROFILE_Initialize() and subtracted from every region.  Code that does its own
+* timing with PROFILE_Now() subtracts it the same way.
+*
+* @return	The overhead in timer clocks
+*
+******************************************************************************/
+u32 PROFILE_GetOverhead(void)
+{
+	return profile_overhead;
+}
+
+
+/*****************************************************************************/
+/**
+* Clears the statistics of all regions
+*
+* Interrupts are disabled while the statistics are cleared and enabled again when it
+* returns.
+*
+* @return	None
+*
+******************************************************************************/
+void PROFILE_Reset(void)
+{
+	microblaze_disable_interrupts();
+	profile_clear();
+	microblaze_enable_interrupts();
+}
+
+
+/*****************************************************************************/
+/**
+* Prints the statistics of all regions on the console
+*
+* One line per region with the number of runs and the minimum, mean and maximum
+* time in timer clocks, followed by a line with the histogram (runs per bucket,
+* bucket n >= 1 holds the times from 2^(n+3) to 2^(n+4) - 1 clocks).  Regions that
+* never ran are skipped.
+*
+* @return	None
+*
+* @note
+* At 19200 baud every line takes tens of milliseconds to send, so call it when
+* timing does not matter (e.g. on a button press).
+*
+******************************************************************************/
+void PROFILE_Dump(void)
+{
+	PROFILE_Stats	stats;
+	u32				r, b;
+
+	xil_printf("PROF clock %d Hz, overhead %d clocks (subtracted)\n", profile_clock_freq, profile_overhead);
+	xil_printf("PROF region                count        min       mean        max\n");
+	for (r = 0; r < profile_num_regions; r++)
+	{
+		PROFILE_GetStats(r, &stats);
+		if (stats.Count == 0)
+		{
+			continue;
+		}
+		xil_printf("PROF %-16s %10d %10d %10d %10d\n", profile_names[r], stats.Count, stats.Min,
+			(u32) (stats.Sum / stats.Count), stats.Max);
+		xil_printf("PROF %-16s", "  histogram");
+		for (b = 0; b < PROFILE_HIST_BUCKETS; b++)
+		{
+			xil_printf(" %d", stats.Hist[b]);
+		}
+		xil_printf("\n");
+	}
+}
+
+#endif /* PROFILE_ENABLE */
@@ -0,0 +1,103 @@
+/**
+*
+* @file profile.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions, macros and function prototypes for
+* profile.c.  profile.c times regions of code (interrupt handlers, functions, single
+* driver calls) with a free-running up counter of an axi_timer and keeps the number of
+* runs, the minimum, maximum and mean time and a histogram of the times of each region.
+* The statistics are printed on the console with PROFILE_Dump().
+*
+* A region is timed by PROFILE_BEGIN(Region) and PROFILE_END(Region) in the same block,
+* or by PROFILE_CALL(Region, call) for a single call.  Regions are numbered from 0 by the
+* application, which gives their names to PROFILE_Initialize().  One region must only be
+* timed from one context (e.g. only from an interrupt handler or only from the main loop).
+*
+* Profiling costs two timer reads and a few instructions per region.  Set PROFILE_ENABLE
+* to 0 (e.g. -DPROFILE_ENABLE=0) to compile it out completely: the macros expand to the
+* code they time and profile.c is empty.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Added PROFILE_GetOverhead()
+* </pre>
+*
+******************************************************************************/
+
+#ifndef PROFILE_H		/* prevent circular inclusions */
+#define PROFILE_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xtmrctr.h"
+
+/************************** Constant Definitions *****************************/
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE			1				// 0 = compile the profiler out
+#endif
+
+#define PROFILE_MAX_REGIONS		16
+#define PROFILE_HIST_BUCKETS	16				// bucket 0 < 16 clocks, bucket n = [2^(n+3), 2^(n+4)), last >= 2^18
+#define PROFILE_HIST_SHIFT		4				// log2 of the upper bound of bucket 0
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	u32		Count;							// times the region was timed
+	u32		Min;							// shortest time (clocks)
+	u32		Max;							// longest time (clocks)
+	u64		Sum;							// sum of the times (clocks)
+	u32		Hist[PROFILE_HIST_BUCKETS];		// times per power-of-2 bucket
+} PROFILE_Stats;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#if PROFILE_ENABLE
+
+#define PROFILE_BEGIN(Region)		u32 profile_start_##Region = PROFILE_Now()
+#define PROFILE_END(Region)			PROFILE_Record((Region), PROFILE_Now() - profile_start_##Region)
+#define PROFILE_CALL(Region, Call)	do { PROFILE_BEGIN(Region); Call; PROFILE_END(Region); } while (0)
+
+// reads the free-running counter (one bus read)
+#define PROFILE_Now()				Xil_In32(profile_counter_addr)
+
+#else
+
+#define PROFILE_BEGIN(Region)
+#define PROFILE_END(Region)
+#define PROFILE_CALL(Region, Call)	do { Call; } while (0)
+
+#endif
+
+/************************** Function Prototypes ******************************/
+#if PROFILE_ENABLE
+int PROFILE_Initialize(u32 TimerBaseAddress, u8 TmrCtrNumber, u32 clkfreq,
+		const char * const *Names, u32 NumRegions);
+void PROFILE_Record(u32 Region, u32 Clocks);
+void PROFILE_GetStats(u32 Region, PROFILE_Stats *StatsPtr);
+u32 PROFILE_GetOverhead(void);
+void PROFILE_Reset(void);
+void PROFILE_Dump(void);
+#endif
+
+/************************** Variable Definitions *****************************/
+#if PROFILE_ENABLE
+extern UINTPTR profile_counter_addr;				// address of the timer counter register (TCR)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
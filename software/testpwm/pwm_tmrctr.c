@@ -15,6 +15,12 @@
 * Ver   Who  Date     Changes
 * ----- ---- -------- -----------------------------------------------
 * 1.00a	rhk	12/20/14	First release of driver
+* 1.01a	ri	10/16/26	Integer PWM_SetParams()/PWM_GetParams().  Added PWM_CalcCounts() and PWM_CalcParams()
+* 1.02a	ri	10/16/26	Added PWM_UpdateParams().  PWM_GetParams() no longer stops the timers
+* 2.00a	ri	10/16/26	Per-instance PWM_Instance (clock, cached load registers, state) replaces the
+*						global clock_frequency.  Added PWM_SetParamsMulti() and PWM_StartMulti()
+* 2.01a	ri	10/16/26	PWM_CalcParams() duty cycle from the high time and period (TLR + 2) like
+*						PWM_CalcCounts()
 * </pre>
 *
 ******************************************************************************/
@@ -34,16 +40,16 @@
 
 
 /************************** Variable Definitions *****************************/
-float clock_frequency;		// clock frequency for the timer.  Usually the AXI bus clock
 
 /*****************************************************************************/
 /**
 * Initializes a  timer/counter instance/driver for PWM use. 
 *
-* Initialize fields of the XTmrCtr structure and set the control bits for PWM usage.
-* Uses both high level and low level tmrctr driver functions
+* Initialize fields of the PWM_Instance structure and set the control bits for PWM usage.
+* Uses both high level and low level tmrctr driver functions.  Each instance keeps its own
+* timer clock frequency, so timers with different clocks can be used at the same time
 *
-* @param    InstancePtr is a pointer to the XTmrCtr instance to be used for PWM.
+* @param    InstancePtr is a pointer to the PWM instance to be initialized.
 * @param    DeviceId is the unique id of the device controlled by this XTmrCtr
 *           component.  Passing in a device id associates the generic XTmrCtr
 *           component to a specific device, as chosen by the caller or
@@ -59,7 +65,7 @@ float clock_frequency;		// clock frequency for the timer.  Usually the AXI bus c
 *   - XST_DEVICE_NOT_FOUND if the device doesn't exist
 *
 ******************************************************************************/
-int PWM_Initialize(XTmrCtr *InstancePtr, u16 DeviceId, bool EnableInterrupts, u32 clkfreq)
+int PWM_Initialize(PWM_Instance *InstancePtr, u16 DeviceId, bool EnableInterrupts, u32 clkfreq)
 {
     int StatusReg;
     u32		PWM_BaseAddress;
@@ -67,7 +73,7 @@ int PWM_Initialize(XTmrCtr *InstancePtr, u16 DeviceId, bool EnableInterrupts, u3
     
     // Initialize the timer/counter instance
     // This clears  both timer registers and any pending interrupts
-    StatusReg = XTmrCtr_Initialize(InstancePtr, DeviceId);
+    StatusReg = XTmrCtr_Initialize(&InstancePtr->TmrCtr, DeviceId);
     if (StatusReg != XST_SUCCESS) // failed to initialize.  Return the reason
     {
 	    return StatusReg;
@@ -75,7 +81,7 @@ int PWM_Initialize(XTmrCtr *InstancePtr, u16 DeviceId, bool EnableInterrupts, u3
 
     // successfully initialized the timer/ctr instance
 	// initialize timer to PWM mode with interrupts enabled (or not)
-	PWM_BaseAddress = InstancePtr->BaseAddress;
+	PWM_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
 	if (EnableInterrupts)
 	{
 		ctlbits = XTC_CSR_ENABLE_PWM_MASK | XTC_CSR_EXT_GENERATE_MASK  | XTC_CSR_AUTO_RELOAD_MASK | XTC_CSR_DOWN_COUNT_MASK | XTC_CSR_ENABLE_INT_MASK;
@@ -87,8 +93,11 @@ int PWM_Initialize(XTmrCtr *InstancePtr, u16 DeviceId, bool EnableInterrupts, u3
 	XTmrCtr_SetControlStatusReg(PWM_BaseAddress, PWM_PERIOD_TIMER, ctlbits);
 	XTmrCtr_SetControlStatusReg(PWM_BaseAddress, PWM_DUTY_TIMER, ctlbits);
 
-	// save the timer clock frequency
-	clock_frequency = (float) clkfreq;
+	// save the timer clock frequency.  The load registers were cleared by XTmrCtr_Initialize()
+	InstancePtr->ClockFreq = clkfreq;
+	InstancePtr->Tlr0 = 0;
+	InstancePtr->Tlr1 = 0;
+	InstancePtr->IsRunning = false;
 
 	return XST_SUCCESS;
 }
@@ -112,18 +121,18 @@ int PWM_Initialize(XTmrCtr *InstancePtr, u16 DeviceId, bool EnableInterrupts, u3
 *   - XST_FAILURE if the PWM instance is not initialized
 *
 ******************************************************************************/
-int PWM_Start(XTmrCtr *InstancePtr)
+int PWM_Start(PWM_Instance *InstancePtr)
 {
 	u32		ctlbits;
     u32		PWM_BaseAddress;
 
-    if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that timer instance is initialized
+    if (InstancePtr->TmrCtr.IsReady != XIL_COMPONENT_IS_READY) // check that timer instance is initialized
     {
 	    return XST_FAILURE;
     }
 	
     // instance was initialized - reset (load TLRx) the timers 
-    PWM_BaseAddress = InstancePtr->BaseAddress;
+    PWM_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
     XTmrCtr_LoadTimerCounterReg(PWM_BaseAddress, PWM_PERIOD_TIMER);
 	ctlbits = XTmrCtr_GetControlStatusReg(PWM_BaseAddress, PWM_PERIOD_TIMER) & 0xFFFFFFDF;  // clear load bits
 	XTmrCtr_SetControlStatusReg(PWM_BaseAddress, PWM_PERIOD_TIMER, ctlbits);
@@ -136,6 +145,7 @@ int PWM_Start(XTmrCtr *InstancePtr)
 	ctlbits = XTmrCtr_GetControlStatusReg(PWM_BaseAddress, PWM_PERIOD_TIMER);
 	ctlbits |= XTC_CSR_ENABLE_ALL_MASK;
 	XTmrCtr_SetControlStatusReg(PWM_BaseAddress, PWM_PERIOD_TIMER, ctlbits);
+	InstancePtr->IsRunning = true;
 	return XST_SUCCESS;								
 }
 
@@ -156,19 +166,20 @@ int PWM_Start(XTmrCtr *InstancePtr)
 *   - XST_FAILURE if the PWM instance is not initialized
 *
 ******************************************************************************/
-int PWM_Stop(XTmrCtr *InstancePtr)
+int PWM_Stop(PWM_Instance *InstancePtr)
 {
     u32		PWM_BaseAddress;
 
-    if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+    if (InstancePtr->TmrCtr.IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
     {
 	    return XST_FAILURE;
     }
 	
     // instance was initialized - stop the timers
-    PWM_BaseAddress = InstancePtr->BaseAddress;
+    PWM_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
 	XTmrCtr_Disable(PWM_BaseAddress, PWM_PERIOD_TIMER);
 	XTmrCtr_Disable(PWM_BaseAddress, PWM_DUTY_TIMER);
+	InstancePtr->IsRunning = false;
 	return XST_SUCCESS;
 }
 
@@ -180,7 +191,7 @@ int PWM_Stop(XTmrCtr *InstancePtr)
 *
 * Sets the frequency and duty cycle for the PWM.  Stops the PWM timers but does not
 * restart them.  Assumes that the PWM timer instance has been initialized and that the 
-* timer is running at "clock_frequency" Hz (which was passed in during initialization)
+* timer is running at the clock frequency that was passed in during initialization
 *
 * @param    InstancePtr is a pointer to the PWM instance to be worked on.
 * @param    PWM frequency (in Hz).
@@ -193,52 +204,129 @@ int PWM_Stop(XTmrCtr *InstancePtr)
 *	- XST_INVALID_PARAM if one or both of the parameters is invalid
 *
 * @note
-* Formulas for calculating counts (PWM counters are configured as down counters):
-* 	TLR0 (PWM period count) = (PWM_PERIOD / TIMER_CLOCK_PERIOD) - 2
-* 	TLR1 (PWM duty cycle count) = MAX( 0, (((PWM_PERIOD * (DUTY CYCLE / 100)) / TIMER_CLOCK_PERIOD) - 2) )
+* The counts are calculated by PWM_CalcCounts()
 * 
 ******************************************************************************/
-int PWM_SetParams(XTmrCtr *InstancePtr, u32 freq, u32 dutyfactor)
+int PWM_SetParams(PWM_Instance *InstancePtr, u32 freq, u32 dutyfactor)
 {
 	u32		PWM_BaseAddress;
-	float	timer_clock_period,	
-			pwm_period,
-			pwm_dc,
-			tlr0,
+	u32		tlr0,
 			tlr1;
+	int		sts;
      	
-    if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+    if (InstancePtr->TmrCtr.IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
     {
 	    return XST_FAILURE;
     }
     	   
-    // calculate the PWM period and high time
-	timer_clock_period = 1.0 / clock_frequency;
-	pwm_period = 1.0 / freq;
-	tlr0 = (pwm_period / timer_clock_period) - 2;
-	
-	pwm_dc = dutyfactor / 100.00;
-	tlr1 = ((pwm_period * pwm_dc) / timer_clock_period) - 2;
-	if (tlr1 < 0)   // duty cycle cannot be less than 0%
+    // calculate the PWM period and high time and check that they are valid
+	sts = PWM_CalcCounts(InstancePtr->ClockFreq, freq, dutyfactor, &tlr0, &tlr1);
+	if (sts != XST_SUCCESS)
 	{
-		tlr1 = 0.0;
+		return sts;
 	}
+	   
+	// period and duty cycle are within range of timer - stop timer and write values to load registers   
+    PWM_Stop(InstancePtr);
+    PWM_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
+    XTmrCtr_SetLoadReg(PWM_BaseAddress, PWM_PERIOD_TIMER, tlr0);
+  	XTmrCtr_SetLoadReg(PWM_BaseAddress, PWM_DUTY_TIMER, tlr1);
+	InstancePtr->Tlr0 = tlr0;
+	InstancePtr->Tlr1 = tlr1;
+	return XST_SUCCESS;
+}
 
-	// check to see if parameters are valid
-    if (dutyfactor > 100)  // cannot have a duty cylce > 100%
+
+/*****************************************************************************/
+/**
+*
+* PWM_UpdateParams() - Change the PWM parameters without stopping the PWM
+*
+* Sets the frequency and duty cycle for the PWM.  If the PWM is running the new period
+* and high time take effect at a period boundary and the output keeps running: every
+* pulse is a complete pulse of either the old or the new parameters.  If the PWM is not
+* running the load registers are written, same as PWM_SetParams().  Assumes that the PWM
+* timer instance has been initialized and that the timer is running at the clock frequency
+* that was passed in during initialization
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+* @param    PWM frequency (in Hz).
+* @param	PWM high time (in pct of PWM period - 0 to 100)
+*
+* @return
+*
+*   - XST_SUCCESS if the PWM parameters were loaded
+*   - XST_FAILURE if the PWM instance is not initialized
+*	- XST_INVALID_PARAM if one or both of the parameters is invalid
+*
+* @note
+* The timers reload TLR0/TLR1 at the end of every period, so writing them while the PWM
+* is running changes the next period.  The two writes are made early enough in a period
+* that the boundary cannot fall between them: if fewer than PWM_UPDATE_MARGIN clocks are
+* left (TCR0 + 2), the update waits for the next period.  If a boundary does fall between
+* them anyway (an interrupt, or a period shorter than 2 * PWM_UPDATE_MARGIN) the registers
+* are written in the order that makes the period in between valid: TLR1 first if the new
+* high time fits in the old period, otherwise TLR0 first (a longer period always fits the
+* old high time).
+* 
+******************************************************************************/
+int PWM_UpdateParams(PWM_Instance *InstancePtr, u32 freq, u32 dutyfactor)
+{
+	u32		PWM_BaseAddress;
+	u32		tlr0,
+			tlr1,
+			tcr,
+			prev;
+	int		sts;
+
+    if (InstancePtr->TmrCtr.IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
     {
-	   return XST_INVALID_PARAM;
+	    return XST_FAILURE;
+    }
+
+    // calculate the PWM period and high time and check that they are valid
+	sts = PWM_CalcCounts(InstancePtr->ClockFreq, freq, dutyfactor, &tlr0, &tlr1);
+	if (sts != XST_SUCCESS)
+	{
+		return sts;
 	}
-	if ((tlr0 > PWM_MAXCNT) || (tlr1 > PWM_MAXCNT))  // period or high time is too big for the timer/counter registers
+
+    PWM_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
+    if (!InstancePtr->IsRunning)
+    {
+		// PWM is not running - write the load registers
+		XTmrCtr_SetLoadReg(PWM_BaseAddress, PWM_PERIOD_TIMER, tlr0);
+		XTmrCtr_SetLoadReg(PWM_BaseAddress, PWM_DUTY_TIMER, tlr1);
+		InstancePtr->Tlr0 = tlr0;
+		InstancePtr->Tlr1 = tlr1;
+		return XST_SUCCESS;
+    }
+
+	// wait for the next period if the current one is about to end.  The period timer counts
+	// down so it reloads when its count goes up
+	tcr = XTmrCtr_GetTimerCounterReg(PWM_BaseAddress, PWM_PERIOD_TIMER);
+	if ((tcr < PWM_UPDATE_MARGIN) && (InstancePtr->Tlr0 >= (2 * PWM_UPDATE_MARGIN)))
 	{
-		return XST_INVALID_PARAM;
+		do
+		{
+			prev = tcr;
+			tcr = XTmrCtr_GetTimerCounterReg(PWM_BaseAddress, PWM_PERIOD_TIMER);
+		} while (tcr <= prev);
 	}
-	   
-	// period and duty cycle are within range of timer - stop timer and write values to load registers   
-    PWM_Stop(InstancePtr);
-    PWM_BaseAddress = InstancePtr->BaseAddress;
-    XTmrCtr_SetLoadReg(PWM_BaseAddress, PWM_PERIOD_TIMER, (u32) tlr0);
-  	XTmrCtr_SetLoadReg(PWM_BaseAddress, PWM_DUTY_TIMER, (u32) tlr1);
+
+	// write the load registers in the order that keeps the period in between valid
+	if (tlr1 <= InstancePtr->Tlr0)
+	{
+		XTmrCtr_SetLoadReg(PWM_BaseAddress, PWM_DUTY_TIMER, tlr1);
+		XTmrCtr_SetLoadReg(PWM_BaseAddress, PWM_PERIOD_TIMER, tlr0);
+	}
+	else
+	{
+		XTmrCtr_SetLoadReg(PWM_BaseAddress, PWM_PERIOD_TIMER, tlr0);
+		XTmrCtr_SetLoadReg(PWM_BaseAddress, PWM_DUTY_TIMER, tlr1);
+	}
+	InstancePtr->Tlr0 = tlr0;
+	InstancePtr->Tlr1 = tlr1;
 	return XST_SUCCESS;
 }
 
@@ -248,9 +336,10 @@ int PWM_SetParams(XTmrCtr *InstancePtr, u32 freq, u32 dutyfactor)
 *
 * PWM_GetParams() - Get the PWM parameters
 *
-* Returns the frequency (Hz) and duty cycle (%) for the PWM.  Stops the PWM timers but does not
-* restart them.  Assumes that the PWM timer instance has been initialized and that the
-* timer is running at the PLB bus frequency (PLB_CLOCK_FREQ_HZ) as defined in pwm_tmrctr.h 
+* Returns the frequency (Hz) and duty cycle (%) for the PWM.  Does not stop the PWM
+* timers.  The values are calculated from the load register values cached in the instance
+* so no registers are read.  Assumes that the PWM timer instance has been initialized and that the
+* timer is running at the clock frequency that was passed in during initialization
 *
 * @param    InstancePtr is a pointer to the PWM instance to be worked on.
 * @param    pointer to PWM frequency (in Hz).
@@ -263,48 +352,236 @@ int PWM_SetParams(XTmrCtr *InstancePtr, u32 freq, u32 dutyfactor)
 *	- XST_INVALID_PARAM if one or both of the parameters is invalid
 *
 * @note
-*
-* Formulas for calculating counts (PWM counters are configured as down counters):
-*		TIMER_CLOCK_PERIOD = 1 / TIMER_CLOCK_FREQ
-*		PWM_PERIOD = (TLR0 + 2) x (1 / TIMER_CLOCK_FREQ)
-*		PWM_HIGH_TIME = (TLR1 + 2) x (1 / TIMER_CLOCK_FREQ)
+* The frequency and duty cycle are calculated by PWM_CalcParams()
 *
 ******************************************************************************/
-int PWM_GetParams(XTmrCtr *InstancePtr, u32 *freq, u32 *dutyfactor)
+int PWM_GetParams(PWM_Instance *InstancePtr, u32 *freq, u32 *dutyfactor)
 {
-	u32		PWM_BaseAddress;
-	float	timer_clock_period,	
-			pwm_period,
-			pwm_dc,
-			tlr0,
-			tlr1;
-			
-	u32		tlr;
-     	
-    if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+    if (InstancePtr->TmrCtr.IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
     {
 	    return XST_FAILURE;
     }
     
-    // first stop the PWM timers and get Base Address of timer registers   
-	PWM_Stop(InstancePtr);
-	PWM_BaseAddress = InstancePtr->BaseAddress;
-
-	// next read the load registers to get the period and high time 
- 	tlr = XTmrCtr_GetLoadReg(PWM_BaseAddress, PWM_PERIOD_TIMER);
- 	tlr0 = (float) tlr; 
- 	tlr = XTmrCtr_GetLoadReg(PWM_BaseAddress, PWM_DUTY_TIMER);
- 	tlr1 = (float) tlr;  	   
-
-    // calculate the PWM period and high time
-	timer_clock_period = 1.0 / clock_frequency;
-	pwm_period = (tlr0 + 2) * timer_clock_period;
-	pwm_dc = tlr1 / tlr0;
-	
-	// round the values and return them
-	*freq = lroundf(1.00 / pwm_period);
-	*dutyfactor = lroundf(pwm_dc * 100.00);
+    // calculate the PWM frequency and duty cycle from the period and high time
+	PWM_CalcParams(InstancePtr->ClockFreq, InstancePtr->Tlr0, InstancePtr->Tlr1, freq, dutyfactor);
 	return XST_SUCCESS;
 }
-        	
-    	
+
+
+/*****************************************************************************/
+/**
+*
+* PWM_SetParamsMulti() - Set the PWM parameters of several PWM instances
+*
+* Sets the frequency and duty cycle of "NumChannels" PWM instances.  All of the parameters
+* are checked before any timer is touched, so either all of the instances are changed or
+* none of them is.  Stops the PWM timers but does not restart them (see PWM_StartMulti())
+*
+* @param    Channels is an array of PWM instances and their new parameters
+* @param	NumChannels is the number of entries in Channels
+*
+* @return
+*
+*   - XST_SUCCESS if the PWM parameters were loaded
+*   - XST_FAILURE if a PWM instance is not initialized
+*	- XST_INVALID_PARAM if a parameter is invalid
+*
+******************************************************************************/
+int PWM_SetParamsMulti(const PWM_Channel *Channels, u32 NumChannels)
+{
+	u32		tlr0,
+			tlr1;
+	u32		i;
+	int		sts;
+
+	// check everything first
+	for (i = 0; i < NumChannels; i++)
+	{
+		if (Channels[i].InstancePtr->TmrCtr.IsReady != XIL_COMPONENT_IS_READY)
+		{
+			return XST_FAILURE;
+		}
+		sts = PWM_CalcCounts(Channels[i].InstancePtr->ClockFreq, Channels[i].Freq,
+			Channels[i].DutyFactor, &tlr0, &tlr1);
+		if (sts != XST_SUCCESS)
+		{
+			return sts;
+		}
+	}
+
+	// then stop the timers and write the load registers
+	for (i = 0; i < NumChannels; i++)
+	{
+		PWM_SetParams(Channels[i].InstancePtr, Channels[i].Freq, Channels[i].DutyFactor);
+	}
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWM_StartMulti() - Start several PWM instances together
+*
+* Starts "NumChannels" PWM instances so that their outputs start with as little skew as
+* possible.  The counters of every instance are loaded first and the TCSR values that
+* start them are calculated ahead of time.  The instances are then started with one
+* register write each, back to back, so the outputs are skewed by one bus write per
+* instance.  Assumes that the load registers have been set (PWM_SetParamsMulti())
+*
+* @param    Channels is an array of PWM instances.  Freq and DutyFactor are not used
+* @param	NumChannels is the number of entries in Channels (at most PWM_MAX_CHANNELS)
+*
+* @return
+*
+*   - XST_SUCCESS if the PWM timers were started
+*   - XST_FAILURE if a PWM instance is not initialized
+*	- XST_INVALID_PARAM if there are too many channels
+*
+* @note
+* Interrupts are not disabled.  Disable them around the call if an interrupt between the
+* start writes would add too much skew
+*
+******************************************************************************/
+int PWM_StartMulti(const PWM_Channel *Channels, u32 NumChannels)
+{
+	u32		base[PWM_MAX_CHANNELS];
+	u32		start[PWM_MAX_CHANNELS];
+	u32		ctlbits;
+	u32		i;
+
+	if (NumChannels > PWM_MAX_CHANNELS)
+	{
+		return XST_INVALID_PARAM;
+	}
+	for (i = 0; i < NumChannels; i++)
+	{
+		if (Channels[i].InstancePtr->TmrCtr.IsReady != XIL_COMPONENT_IS_READY)
+		{
+			return XST_FAILURE;
+		}
+	}
+
+	// load the counters (TLRx) of every instance and get the TCSR values that start them
+	for (i = 0; i < NumChannels; i++)
+	{
+		base[i] = Channels[i].InstancePtr->TmrCtr.BaseAddress;
+		XTmrCtr_LoadTimerCounterReg(base[i], PWM_PERIOD_TIMER);
+		ctlbits = XTmrCtr_GetControlStatusReg(base[i], PWM_PERIOD_TIMER) & ~XTC_CSR_LOAD_MASK;
+		XTmrCtr_SetControlStatusReg(base[i], PWM_PERIOD_TIMER, ctlbits);
+
+		XTmrCtr_LoadTimerCounterReg(base[i], PWM_DUTY_TIMER);
+		ctlbits = XTmrCtr_GetControlStatusReg(base[i], PWM_DUTY_TIMER) & ~XTC_CSR_LOAD_MASK;
+		XTmrCtr_SetControlStatusReg(base[i], PWM_DUTY_TIMER, ctlbits);
+
+		start[i] = XTmrCtr_GetControlStatusReg(base[i], PWM_PERIOD_TIMER) | XTC_CSR_ENABLE_ALL_MASK;
+	}
+
+	// and start them - ENABLE-ALL starts both timers of an instance with one write
+	for (i = 0; i < NumChannels; i++)
+	{
+		XTmrCtr_SetControlStatusReg(base[i], PWM_PERIOD_TIMER, start[i]);
+	}
+	for (i = 0; i < NumChannels; i++)
+	{
+		Channels[i].InstancePtr->IsRunning = true;
+	}
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWM_CalcCounts() - Calculate the load register values for a PWM frequency and duty cycle
+*
+* Integer only (no floating point), so it is cheap on a Microblaze without an FPU.  The
+* counts are the exact values of the formulas below, truncated toward zero.
+*
+* @param    clkfreq is the timer clock frequency (in Hz)
+* @param    PWM frequency (in Hz).
+* @param	PWM high time (in pct of PWM period - 0 to 100)
+* @param	pointer to the period count (TLR0)
+* @param	pointer to the duty cycle count (TLR1)
+*
+* @return
+*
+*   - XST_SUCCESS if the counts were calculated
+*	- XST_INVALID_PARAM if one or both of the parameters is invalid
+*
+* @note
+* Formulas for calculating counts (PWM counters are configured as down counters):
+* 	TLR0 (PWM period count) = (PWM_PERIOD / TIMER_CLOCK_PERIOD) - 2
+* 	TLR1 (PWM duty cycle count) = MAX( 0, (((PWM_PERIOD * (DUTY CYCLE / 100)) / TIMER_CLOCK_PERIOD) - 2) )
+*
+* which are evaluated as TLR0 = (clkfreq / freq) - 2 and TLR1 = ((clkfreq * dutyfactor) / (100 * freq)) - 2
+* with 64-bit intermediates.  A frequency of 0 or above clkfreq / 2 cannot be generated and is rejected.
+* 
+******************************************************************************/
+int PWM_CalcCounts(u32 clkfreq, u32 freq, u32 dutyfactor, u32 *tlr0, u32 *tlr1)
+{
+	u64		period,
+			high;
+
+	// check to see if parameters are valid
+	if (dutyfactor > 100)  // cannot have a duty cylce > 100%
+	{
+		return XST_INVALID_PARAM;
+	}
+	if (freq == 0)
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	// calculate the PWM period and high time (in timer clocks)
+	period = clkfreq / freq;
+	high = ((u64) clkfreq * dutyfactor) / ((u64) freq * 100);
+	if (period < 2)  // the shortest PWM period is 2 timer clocks
+	{
+		return XST_INVALID_PARAM;
+	}
+	if (high < 2)   // duty cycle cannot be less than 0%
+	{
+		high = 2;
+	}
+	if (((period - 2) > PWM_MAXCNT) || ((high - 2) > PWM_MAXCNT))  // period or high time is too big for the timer/counter registers
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	*tlr0 = (u32) (period - 2);
+	*tlr1 = (u32) (high - 2);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWM_CalcParams() - Calculate the PWM frequency and duty cycle from the load register values
+*
+* Integer only (no floating point), so it is cheap on a Microblaze without an FPU.  Both
+* results are rounded to the nearest integer (halves are rounded up).
+*
+* @param    clkfreq is the timer clock frequency (in Hz)
+* @param	period count (TLR0)
+* @param	duty cycle count (TLR1)
+* @param    pointer to PWM frequency (in Hz).
+* @param	pointer to PWM high time (in pct of PWM period - 0 to 100)
+*
+* @return	*NONE*
+*
+* @note
+* Formulas:
+*		PWM_FREQ = TIMER_CLOCK_FREQ / (TLR0 + 2)
+*		DUTY CYCLE = ((TLR1 + 2) / (TLR0 + 2)) * 100
+*
+******************************************************************************/
+void PWM_CalcParams(u32 clkfreq, u32 tlr0, u32 tlr1, u32 *freq, u32 *dutyfactor)
+{
+	u64		period;
+
+	period = (u64) tlr0 + 2;
+	*freq = (u32) (((u64) clkfreq + (period / 2)) / period);
+	*dutyfactor = (u32) (((((u64) tlr1 + 2) * 100) + (period / 2)) / period);
+}
@@ -16,6 +16,10 @@
 * Ver   Who  Date     Changes
 * ----- ---- -------- -----------------------------------------------
 * 1.00a	rhk	12/20/14	First release of driver for Vivado/Nexys4
+* 1.01a	ri	10/16/26	Integer PWM_MAXCNT.  Added PWM_CalcCounts() and PWM_CalcParams()
+* 1.02a	ri	10/16/26	Added PWM_UpdateParams()
+* 2.00a	ri	10/16/26	Added PWM_Instance and PWM_Channel.  The API takes a PWM_Instance.
+*						Added PWM_SetParamsMulti() and PWM_StartMulti()
 * </pre>
 *
 ******************************************************************************/
@@ -37,23 +41,53 @@ extern "C" {
 
 /************************** Constant Definitions *****************************/
 #define PWM_TIMER_WIDTH		32
-#define PWM_MAXCNT			4294967295.00
+#define PWM_MAXCNT			4294967295UL
 
 #define PWM_PERIOD_TIMER	0
 #define PWM_DUTY_TIMER		1
 
+#define PWM_MAX_CHANNELS	16		// most PWM instances PWM_StartMulti() can start together
+
+#define PWM_UPDATE_MARGIN	64		// timer clocks left in a period that PWM_UpdateParams() needs for its TLR writes
+
 /**************************** Type Definitions *******************************/
+/**
+ * A PWM instance.  One per axi_timer used for PWM.  The instance keeps the timer clock
+ * frequency and the load register values so several timers (with different clocks) can
+ * be used at the same time
+ */
+typedef struct {
+	XTmrCtr	TmrCtr;			// timer/counter instance
+	u32		ClockFreq;		// timer clock frequency (Hz).  Usually the AXI bus clock
+	u32		Tlr0;			// period count last written to TLR0
+	u32		Tlr1;			// duty cycle count last written to TLR1
+	bool	IsRunning;		// PWM timers are enabled
+} PWM_Instance;
+
+/**
+ * A PWM instance and its parameters for PWM_SetParamsMulti() and PWM_StartMulti()
+ */
+typedef struct {
+	PWM_Instance	*InstancePtr;
+	u32				Freq;			// PWM frequency (Hz)
+	u32				DutyFactor;		// PWM high time (pct of PWM period - 0 to 100)
+} PWM_Channel;
 
 
 /***************** Macros (Inline Functions) Definitions *********************/
 
 
 /************************** Function Prototypes ******************************/
-int PWM_Initialize(XTmrCtr *InstancePtr, u16 DeviceId, bool EnableInterrupts, u32 clkfreq);
-int PWM_Start(XTmrCtr *InstancePtr);
-int PWM_Stop(XTmrCtr *InstancePtr);
-int PWM_SetParams(XTmrCtr *InstancePtr, u32 freq, u32 dutyfactor);
-int PWM_GetParams(XTmrCtr *InstancePtr, u32 *freq, u32 *dutyfactor);
+int PWM_Initialize(PWM_Instance *InstancePtr, u16 DeviceId, bool EnableInterrupts, u32 clkfreq);
+int PWM_Start(PWM_Instance *InstancePtr);
+int PWM_Stop(PWM_Instance *InstancePtr);
+int PWM_SetParams(PWM_Instance *InstancePtr, u32 freq, u32 dutyfactor);
+int PWM_UpdateParams(PWM_Instance *InstancePtr, u32 freq, u32 dutyfactor);
+int PWM_GetParams(PWM_Instance *InstancePtr, u32 *freq, u32 *dutyfactor);
+int PWM_SetParamsMulti(const PWM_Channel *Channels, u32 NumChannels);
+int PWM_StartMulti(const PWM_Channel *Channels, u32 NumChannels);
+int PWM_CalcCounts(u32 clkfreq, u32 freq, u32 dutyfactor, u32 *tlr0, u32 *tlr1);
+void PWM_CalcParams(u32 clkfreq, u32 tlr0, u32 tlr1, u32 *freq, u32 *dutyfactor);
 
 /************************** Variable Definitions *****************************/
 
@@ -0,0 +1,331 @@
+/**
+*
+* @file sched.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides a cooperative scheduler of run-to-completion tasks for the main loop
+* (see sched.h).  The tasks are kept in a list sorted by priority, so picking the next task
+* is a walk to the first one that is ready; there are only a handful of tasks.  The
+* software timer of a periodic task only marks it ready, the handler itself runs from
+* SCHED_Run().
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include "sched.h"
+#include "xil_printf.h"
+
+
+/************************** Constant Definitions *****************************/
+
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#if PROFILE_ENABLE
+#define SCHED_CLOCKS()			PROFILE_Now()
+#else
+#define SCHED_CLOCKS()			0
+#endif
+
+#define SCHED_NOW()				((u32) *sched_timestamp)
+
+/************************** Function Prototypes ******************************/
+static void sched_release_timer(void *CallbackRef);
+static SCHED_Task *sched_next(void);
+
+/************************** Variable Definitions *****************************/
+static volatile unsigned long	*sched_timestamp;		// msec timestamp of the FIT interrupt handler
+static SCHED_Hook				sched_background;		// called before each task (may be NULL)
+static SCHED_Task				*sched_tasks;			// the tasks, highest priority first
+
+
+/*****************************************************************************/
+/**
+*
+* sched_release_timer() - Releases a periodic task (handler of its software timer)
+*
+* @return	None
+*
+******************************************************************************/
+static void sched_release_timer(void *CallbackRef)
+{
+	SCHED_Release((SCHED_Task *) CallbackRef);
+}
+
+
+/*****************************************************************************/
+/**
+*
+* sched_next() - Finds the highest priority task that is ready
+*
+* @return	A pointer to the task, NULL if no task is ready
+*
+******************************************************************************/
+static SCHED_Task *sched_next(void)
+{
+	SCHED_Task	*task;
+
+	for (task = sched_tasks; task != NULL; task = task->Next)
+	{
+		if (task->Ready)
+		{
+			break;
+		}
+	}
+	return task;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SCHED_Initialize() - Initializes the scheduler
+*
+* Forgets the tasks that were added before.  The software timer service (swtimer.c) must
+* be initialized as well.
+*
+* @param    TimestampPtr is a pointer to the msec timestamp of the FIT interrupt handler
+* @param    Background is called by SCHED_Run() before it looks for a task to run, e.g. to
+*			do the work an interrupt handler left behind.  NULL if there is none
+*
+* @return	None
+*
+******************************************************************************/
+void SCHED_Initialize(volatile unsigned long *TimestampPtr, SCHED_Hook Background)
+{
+	sched_timestamp = TimestampPtr;
+	sched_background = Background;
+	sched_tasks = NULL;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SCHED_AddTask() - Adds a task to the scheduler
+*
+* The task does not run until it is started (periodic task) or released.  Tasks with the
+* same priority run in the order they were added.
+*
+* @param    TaskPtr is a pointer to the task
+* @param    Name is the name of the task in SCHED_Dump()
+* @param    Priority is the priority of the task (0 is the highest)
+* @param    Period is the release period (msec), 0 if the task is only released by
+*			SCHED_Release()
+* @param    Deadline is the longest time from a release to the end of the run (msec)
+* @param    Handler is the function that does the work of the task
+* @param    CallbackRef is passed to Handler
+*
+* @return	XST_SUCCESS, or XST_INVALID_PARAM if Deadline is 0
+*
+******************************************************************************/
+int SCHED_AddTask(SCHED_Task *TaskPtr, const char *Name, u32 Priority, u32 Period, u32 Deadline,
+		SCHED_Handler Handler, void *CallbackRef)
+{
+	SCHED_Task	**link;
+
+	if ((Deadline == 0) || (Handler == NULL))
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	TaskPtr->Name = Name;
+	TaskPtr->Handler = Handler;
+	TaskPtr->CallbackRef = CallbackRef;
+	TaskPtr->Priority = Priority;
+	TaskPtr->Period = Period;
+	TaskPtr->Deadline = Deadline;
+	TaskPtr->Timer.Active = 0;
+	TaskPtr->Ready = 0;
+	TaskPtr->ReleaseTime = 0;
+
+	TaskPtr->Stats.Releases = 0;
+	TaskPtr->Stats.Runs = 0;
+	TaskPtr->Stats.Misses = 0;
+	TaskPtr->Stats.Skipped = 0;
+	TaskPtr->Stats.MaxLatency = 0;
+	TaskPtr->Stats.RunMax = 0;
+	TaskPtr->Stats.RunSum = 0;
+
+	// insert it after the tasks with the same or a higher priority
+
+	for (link = &sched_tasks; *link != NULL; link = &(*link)->Next)
+	{
+		if ((*link)->Priority > Priority)
+		{
+			break;
+		}
+	}
+	TaskPtr->Next = *link;
+	*link = TaskPtr;
+
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SCHED_Start() - Starts (or restarts) the releases of a periodic task
+*
+* The task is released Delay msec from now and then every Period msec.  Restarting a
+* task moves the phase of its releases and cancels a release it is still waiting for.
+* Does nothing for a task with a Period of 0.
+*
+* @param    TaskPtr is a pointer to the task
+* @param    Delay is the time to the first release (msec)
+*
+* @return	None
+*
+******************************************************************************/
+void SCHED_Start(SCHED_Task *TaskPtr, u32 Delay)
+{
+	if (TaskPtr->Period != 0)
+	{
+		TaskPtr->Ready = 0;
+		SWTIMER_Start(&TaskPtr->Timer, Delay, TaskPtr->Period, sched_release_timer, TaskPtr);
+	}
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SCHED_Stop() - Stops the releases of a periodic task
+*
+* A release the task is already waiting for is cancelled as well.
+*
+* @param    TaskPtr is a pointer to the task
+*
+* @return	None
+*
+******************************************************************************/
+void SCHED_Stop(SCHED_Task *TaskPtr)
+{
+	SWTIMER_Stop(&TaskPtr->Timer);
+	TaskPtr->Ready = 0;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SCHED_Release() - Releases a task
+*
+* The task runs from SCHED_Run() when no task with a higher priority is ready.  If it is
+* still waiting for an earlier release the new one is lost (counted as skipped) and the
+* deadline stays that of the earlier release.  May be called from a task.
+*
+* @param    TaskPtr is a pointer to the task
+*
+* @return	None
+*
+******************************************************************************/
+void SCHED_Release(SCHED_Task *TaskPtr)
+{
+	TaskPtr->Stats.Releases++;
+
+	if (TaskPtr->Ready)
+	{
+		TaskPtr->Stats.Skipped++;
+		return;
+	}
+
+	TaskPtr->Ready = 1;
+	TaskPtr->ReleaseTime = SCHED_NOW();
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SCHED_Run() - Runs the tasks that are ready
+*
+* Called from the main loop.  Runs the background hook and the software timers, then the
+* highest priority task that is ready, and starts over until no task is ready.  A task
+* runs to completion; it must return for the others to run.
+*
+* @return	None
+*
+******************************************************************************/
+void SCHED_Run(void)
+{
+	SCHED_Task	*task;
+	u32			release, start, clocks, latency;
+
+	for (;;)
+	{
+		if (sched_background != NULL)
+		{
+			sched_background();
+		}
+		SWTIMER_Run(SCHED_NOW());
+
+		task = sched_next();
+		if (task == NULL)
+		{
+			return;
+		}
+
+		// the task may release itself again, which sets a new release time, so the
+		// latency is measured from the release it runs for
+
+		task->Ready = 0;
+		release = task->ReleaseTime;
+
+		start = SCHED_CLOCKS();
+		task->Handler(task->CallbackRef);
+		clocks = SCHED_CLOCKS() - start;
+
+		latency = SCHED_NOW() - release;
+
+		task->Stats.Runs++;
+		task->Stats.RunSum += clocks;
+		if (clocks > task->Stats.RunMax)
+		{
+			task->Stats.RunMax = clocks;
+		}
+		if (latency > task->Stats.MaxLatency)
+		{
+			task->Stats.MaxLatency = latency;
+		}
+		if (latency > task->Deadline)
+		{
+			task->Stats.Misses++;
+		}
+	}
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SCHED_Dump() - Prints the statistics of the tasks on the console
+*
+* @return	None
+*
+******************************************************************************/
+void SCHED_Dump(void)
+{
+	SCHED_Task	*task;
+
+	xil_printf("SCHED task      pri period deadline   releases       runs  mean clk   max clk max lat   misses  skipped\n");
+	for (task = sched_tasks; task != NULL; task = task->Next)
+	{
+		xil_printf("SCHED %-10s %3d %6d %8d %10d %10d %9d %9d %7d %8d %8d\n", task->Name,
+			task->Priority, task->Period, task->Deadline, task->Stats.Releases, task->Stats.Runs,
+			(task->Stats.Runs != 0) ? (u32) (task->Stats.RunSum / task->Stats.Runs) : 0,
+			task->Stats.RunMax, task->Stats.MaxLatency, task->Stats.Misses, task->Stats.Skipped);
+	}
+}
@@ -0,0 +1,99 @@
+/**
+*
+* @file sched.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions and function prototypes for sched.c.
+* sched.c is a cooperative scheduler for the main loop.  A task is a handler that runs to
+* completion, with a priority, a period and a deadline.  A periodic task is released every
+* Period msec by a software timer (swtimer.c), an event-driven task (Period 0) by
+* SCHED_Release().  SCHED_Run() runs the released tasks one at a time, highest priority
+* (lowest number) first, and looks for new releases between tasks, so a task waits for at
+* most one lower priority task.
+*
+* For every task the scheduler keeps the number of releases and runs, the run time and the
+* latency from the release to the end of the run.  A run that ends more than Deadline msec
+* after its release is a deadline miss, and a release that comes while the task is still
+* waiting to run is lost and counted as skipped.  SCHED_Dump() prints them on the console,
+* which shows how the main loop spends its latency budget.  The run times are timed with the
+* profiler clock (profile.h) and are 0 if PROFILE_ENABLE is 0; the latencies are in msec.
+*
+* The scheduler must only be used from the main loop (not from interrupt handlers).  The
+* task structures belong to the caller and must stay valid once they are added.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* </pre>
+*
+******************************************************************************/
+
+#ifndef SCHED_H			/* prevent circular inclusions */
+#define SCHED_H			/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "xil_types.h"
+#include "xstatus.h"
+#include "swtimer.h"
+#include "profile.h"
+
+/************************** Constant Definitions *****************************/
+
+
+/**************************** Type Definitions *******************************/
+typedef void (*SCHED_Handler)(void *CallbackRef);
+typedef void (*SCHED_Hook)(void);
+
+typedef struct {
+	u32		Releases;						// times the task was released
+	u32		Runs;							// times the task ran
+	u32		Misses;							// runs that ended after the deadline
+	u32		Skipped;						// releases lost because the task had not run yet
+	u32		MaxLatency;						// longest time from a release to the end of the run (msec)
+	u32		RunMax;							// longest run (clocks, PROFILE_ENABLE)
+	u64		RunSum;							// sum of the run times (clocks, PROFILE_ENABLE)
+} SCHED_Stats;
+
+typedef struct SCHED_Task {
+	struct SCHED_Task	*Next;				// next task in priority order
+	const char			*Name;
+	SCHED_Handler		Handler;
+	void				*CallbackRef;		// passed to Handler
+	u32					Priority;			// 0 is the highest
+	u32					Period;				// msec, 0 = released by SCHED_Release() only
+	u32					Deadline;			// msec from the release to the end of the run
+	SWTIMER_Timer		Timer;				// releases a periodic task
+	u32					Ready;				// released and waiting to run
+	u32					ReleaseTime;		// timestamp of the release it waits for
+	SCHED_Stats			Stats;
+} SCHED_Task;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+void SCHED_Initialize(volatile unsigned long *TimestampPtr, SCHED_Hook Background);
+int SCHED_AddTask(SCHED_Task *TaskPtr, const char *Name, u32 Priority, u32 Period, u32 Deadline,
+		SCHED_Handler Handler, void *CallbackRef);
+void SCHED_Start(SCHED_Task *TaskPtr, u32 Delay);
+void SCHED_Stop(SCHED_Task *TaskPtr);
+void SCHED_Release(SCHED_Task *TaskPtr);
+void SCHED_Run(void);
+void SCHED_Dump(void);
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -0,0 +1,346 @@
+/**
+*
+* @file swdet.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides an API for measuring the high & low intervals of the PWM signal from
+* edge timestamps captured by an axi_timer.  Timer 0 captures the timer count at every
+* rising edge of the PWM and timer 1 at every falling edge (capturetrig1 is the inverted
+* PWM).  Both timers count up from 0 and are started together, so the captures share one
+* time base and the difference between the last rising edge and the last falling edge is
+* the length of the interval between them, within one timer clock.
+*
+* The capture interrupt is only enabled while a measurement is armed: SWDET_Arm() enables
+* it for at most SWDET_MAX_INTERRUPTS interrupts and the interrupt handler disables it again
+* once it has measured both a high and a low interval.  At high PWM frequencies the edges
+* come faster than the handler could take them, so the application arms the capture at a
+* fixed rate (e.g. every millisecond) instead of taking an interrupt at every edge.  The
+* handler reads the captures some time after the edge that interrupted it; if one of the
+* intervals is shorter than that it is only measured when the handler happens to read
+* during it, which can take several arms.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include "swdet.h"
+
+
+/************************** Constant Definitions *****************************/
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+static void swdet_check_done(SWDET_Instance *InstancePtr);
+
+/************************** Variable Definitions *****************************/
+
+/*****************************************************************************/
+/**
+*
+* swdet_check_done() - Disable the capture interrupt if the measurement is done
+*
+* The capture interrupt is disabled once both intervals have been measured or the
+* interrupts allowed by SWDET_Arm() have been taken.
+*
+* @param    InstancePtr is a pointer to the SWDET instance
+*
+* @return	None
+*
+******************************************************************************/
+static void swdet_check_done(SWDET_Instance *InstancePtr)
+{
+	u32		SWDET_BaseAddress;
+
+	if ((InstancePtr->Measured == SWDET_BOTH) || (InstancePtr->Remaining == 0))
+	{
+		SWDET_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
+		XTmrCtr_DisableIntr(SWDET_BaseAddress, SWDET_RISE_TIMER);
+		XTmrCtr_DisableIntr(SWDET_BaseAddress, SWDET_FALL_TIMER);
+	}
+}
+
+
+/*****************************************************************************/
+/**
+* Initializes a timer/counter instance/driver for edge capture.
+*
+* Initializes the fields of the SWDET_Instance structure and sets both timers to capture
+* mode: counting up, external capture enabled and the capture register overwritten by
+* every edge (auto reload), with the capture interrupt disabled.  The timers are not
+* started.
+*
+* @param    InstancePtr is a pointer to the SWDET instance to be initialized.
+* @param    DeviceId is the unique id of the timer/counter device
+* @param	clkfreq is the input clock frequency for the timer
+*
+* @return
+*
+*   - XST_SUCCESS if initialization was successful
+*   - XST_DEVICE_IS_STARTED if the device has already been started
+*   - XST_DEVICE_NOT_FOUND if the device doesn't exist
+*
+******************************************************************************/
+int SWDET_Initialize(SWDET_Instance *InstancePtr, u16 DeviceId, u32 clkfreq)
+{
+	int		StatusReg;
+	u32		SWDET_BaseAddress;
+	u32		ctlbits;
+
+	// Initialize the timer/counter instance
+	// This clears both timer registers and any pending interrupts
+	StatusReg = XTmrCtr_Initialize(&InstancePtr->TmrCtr, DeviceId);
+	if (StatusReg != XST_SUCCESS)
+	{
+		return StatusReg;
+	}
+
+	// successfully initialized the timer/ctr instance - set both timers to capture mode
+	SWDET_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
+	ctlbits = XTC_CSR_CAPTURE_MODE_MASK | XTC_CSR_EXT_CAPTURE_MASK | XTC_CSR_AUTO_RELOAD_MASK;
+	XTmrCtr_SetControlStatusReg(SWDET_BaseAddress, SWDET_RISE_TIMER, ctlbits);
+	XTmrCtr_SetControlStatusReg(SWDET_BaseAddress, SWDET_FALL_TIMER, ctlbits);
+
+	InstancePtr->ClockFreq = clkfreq;
+	InstancePtr->High = 0;
+	InstancePtr->Low = 0;
+	InstancePtr->Captured = 0;
+	InstancePtr->Measured = 0;
+	InstancePtr->Remaining = 0;
+	InstancePtr->Interrupts = 0;
+
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+* Starts the capture timers
+*
+* Loads 0 into both timer counters and starts them with one write (ENABLE-ALL), so
+* both count the same time base.  Assumes that the instance has been initialized.
+*
+* @param    InstancePtr is a pointer to the SWDET instance
+*
+* @return	XST_SUCCESS if the timers were started, XST_FAILURE if the instance is
+*			not initialized
+*
+******************************************************************************/
+int SWDET_Start(SWDET_Instance *InstancePtr)
+{
+	u32		ctlbits;
+	u32		SWDET_BaseAddress;
+	u32		n;
+
+	if (InstancePtr->TmrCtr.IsReady != XIL_COMPONENT_IS_READY)
+	{
+		return XST_FAILURE;
+	}
+
+	// load 0 into both counters
+	SWDET_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
+	for (n = 0; n < XTC_DEVICE_TIMER_COUNT; n++)
+	{
+		XTmrCtr_SetLoadReg(SWDET_BaseAddress, n, 0);
+		XTmrCtr_LoadTimerCounterReg(SWDET_BaseAddress, n);
+		ctlbits = XTmrCtr_GetControlStatusReg(SWDET_BaseAddress, n) & ~XTC_CSR_LOAD_MASK;
+		XTmrCtr_SetControlStatusReg(SWDET_BaseAddress, n, ctlbits);
+	}
+	InstancePtr->Captured = 0;
+	InstancePtr->Measured = 0;
+
+	// and start both timers - ENABLE-ALL is shadowed in both TCSR registers
+	ctlbits = XTmrCtr_GetControlStatusReg(SWDET_BaseAddress, SWDET_RISE_TIMER);
+	ctlbits |= XTC_CSR_ENABLE_ALL_MASK;
+	XTmrCtr_SetControlStatusReg(SWDET_BaseAddress, SWDET_RISE_TIMER, ctlbits);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+* Stops the capture timers and disables the capture interrupt
+*
+* @param    InstancePtr is a pointer to the SWDET instance
+*
+* @return	XST_SUCCESS if the timers were stopped, XST_FAILURE if the instance is
+*			not initialized
+*
+******************************************************************************/
+int SWDET_Stop(SWDET_Instance *InstancePtr)
+{
+	u32		SWDET_BaseAddress;
+
+	if (InstancePtr->TmrCtr.IsReady != XIL_COMPONENT_IS_READY)
+	{
+		return XST_FAILURE;
+	}
+
+	SWDET_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
+	XTmrCtr_DisableIntr(SWDET_BaseAddress, SWDET_RISE_TIMER);
+	XTmrCtr_DisableIntr(SWDET_BaseAddress, SWDET_FALL_TIMER);
+	XTmrCtr_Disable(SWDET_BaseAddress, SWDET_RISE_TIMER);
+	XTmrCtr_Disable(SWDET_BaseAddress, SWDET_FALL_TIMER);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+* Arms the capture interrupt
+*
+* Enables the capture interrupt of both timers for up to SWDET_MAX_INTERRUPTS
+* interrupts.  Any capture that is pending is cleared, so the handler only uses edges
+* that come after this call.  The interrupt handler disables the interrupt again once
+* a high and a low interval have been measured since the last SWDET_GetCounts(); the
+* intervals measured by earlier arms are kept.
+*
+* @param    InstancePtr is a pointer to the SWDET instance
+*
+* @return	None
+*
+******************************************************************************/
+void SWDET_Arm(SWDET_Instance *InstancePtr)
+{
+	u32		SWDET_BaseAddress;
+
+	if (InstancePtr->Measured == SWDET_BOTH)
+	{
+		return;						// nothing to measure until the counts are read
+	}
+
+	SWDET_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
+	InstancePtr->Remaining = SWDET_MAX_INTERRUPTS;
+
+	// TINT is write 1 to clear, so writing back a pending capture clears it
+	XTmrCtr_EnableIntr(SWDET_BaseAddress, SWDET_RISE_TIMER);
+	XTmrCtr_EnableIntr(SWDET_BaseAddress, SWDET_FALL_TIMER);
+}
+
+
+/*****************************************************************************/
+/**
+* Returns the high & low intervals of the last measurement
+*
+* @param    InstancePtr is a pointer to the SWDET instance
+* @param	high is a pointer to the high interval (timer clocks - 1)
+* @param	low is a pointer to the low interval (timer clocks - 1)
+*
+* @return	XST_SUCCESS if both intervals were measured since the last call, XST_NO_DATA
+*			if not.  The counts are not changed
+*
+* @note
+* The counts use the same convention as the hw_detect counts: an interval of N timer
+* clocks gives a count of N - 1.  Each interval is measured between adjacent edges, but
+* the high and the low interval are not necessarily from the same PWM period.  Call
+* with the capture interrupt disabled or from a handler of the same or higher priority.
+*
+******************************************************************************/
+int SWDET_GetCounts(SWDET_Instance *InstancePtr, u32 *high, u32 *low)
+{
+	if (InstancePtr->Measured != SWDET_BOTH)
+	{
+		return XST_NO_DATA;
+	}
+
+	*high = InstancePtr->High;
+	*low = InstancePtr->Low;
+	InstancePtr->Measured = 0;
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+* Capture interrupt handler
+*
+* Acknowledges the captures and measures the interval between the last rising and
+* the last falling edge: a high interval if the falling edge is the later one, a low
+* interval if the rising edge is.  The rising edge capture is read again after the
+* falling edge capture and both are read again if a new rising edge came in between,
+* so the two captures are always adjacent edges.  Once a high and a low interval have
+* been measured, or after SWDET_MAX_INTERRUPTS interrupts, the capture interrupt is
+* disabled until the next SWDET_Arm().
+*
+* @param    CallBackRef is a pointer to the SWDET instance (passed to XIntc_Connect())
+*
+* @return	None
+*
+******************************************************************************/
+void SWDET_InterruptHandler(void *CallBackRef)
+{
+	SWDET_Instance	*InstancePtr = (SWDET_Instance *) CallBackRef;
+	u32				SWDET_BaseAddress;
+	u32				ctlbits;
+	u32				rise, fall, again;
+	u32				n;
+	int				tries;
+
+	SWDET_BaseAddress = InstancePtr->TmrCtr.BaseAddress;
+	InstancePtr->Interrupts++;
+
+	// acknowledge the captures (TINT is write 1 to clear) and note which timers have
+	// captured an edge.  A capture register holds no edge until its timer captured one
+	for (n = 0; n < XTC_DEVICE_TIMER_COUNT; n++)
+	{
+		ctlbits = XTmrCtr_GetControlStatusReg(SWDET_BaseAddress, n);
+		if (ctlbits & XTC_CSR_INT_OCCURED_MASK)
+		{
+			XTmrCtr_SetControlStatusReg(SWDET_BaseAddress, n, ctlbits);
+			InstancePtr->Captured |= (1 << n);
+		}
+	}
+	if (InstancePtr->Remaining > 0)
+	{
+		InstancePtr->Remaining--;
+	}
+	if (InstancePtr->Captured != ((1 << SWDET_RISE_TIMER) | (1 << SWDET_FALL_TIMER)))
+	{
+		swdet_check_done(InstancePtr);
+		return;
+	}
+
+	// read the last rising and the last falling edge, again if a rising edge came in between
+	rise = XTmrCtr_GetLoadReg(SWDET_BaseAddress, SWDET_RISE_TIMER);
+	for (tries = 0; tries <= SWDET_MAX_RETRIES; tries++)
+	{
+		fall = XTmrCtr_GetLoadReg(SWDET_BaseAddress, SWDET_FALL_TIMER);
+		again = XTmrCtr_GetLoadReg(SWDET_BaseAddress, SWDET_RISE_TIMER);
+		if (again == rise)
+		{
+			break;
+		}
+		rise = again;
+	}
+	if (again != rise)
+	{
+		swdet_check_done(InstancePtr);
+		return;						// the next capture interrupt tries again
+	}
+
+	// the counters wrap, so compare the difference of the captures
+	if ((s32) (fall - rise) > 0)
+	{
+		InstancePtr->High = fall - rise - 1;
+		InstancePtr->Measured |= SWDET_HIGH;
+	}
+	else if ((s32) (rise - fall) > 0)
+	{
+		InstancePtr->Low = rise - fall - 1;
+		InstancePtr->Measured |= SWDET_LOW;
+	}
+
+	swdet_check_done(InstancePtr);
+}
@@ -0,0 +1,80 @@
+/**
+*
+* @file swdet.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions and function prototypes for swdet.c.
+* swdet.c measures the high & low intervals of the PWM signal in software from edge
+* timestamps.  The PWM output drives the capture inputs of an axi_timer: capturetrig0
+* is the PWM and capturetrig1 is the inverted PWM, so timer 0 captures the time of the
+* rising edges and timer 1 the time of the falling edges, at the timer clock resolution.
+* Both timers count up from the same start and are never reloaded, so the difference
+* of two captures is the time between the two edges.  An interval is measured when the
+* capture interrupt handler reads the captures while the PWM is in the other interval,
+* so intervals shorter than the interrupt latency cannot be measured.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* </pre>
+*
+******************************************************************************/
+
+#ifndef SWDET_H		/* prevent circular inclusions */
+#define SWDET_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xtmrctr.h"
+
+/************************** Constant Definitions *****************************/
+#define SWDET_RISE_TIMER		0				// captures the rising edges (capturetrig0 = PWM)
+#define SWDET_FALL_TIMER		1				// captures the falling edges (capturetrig1 = ~PWM)
+
+#define SWDET_HIGH				0x01			// Measured: a high interval was measured
+#define SWDET_LOW				0x02			// Measured: a low interval was measured
+#define SWDET_BOTH				(SWDET_HIGH | SWDET_LOW)
+
+#define SWDET_MAX_RETRIES		4				// extra reads if an edge arrives while reading the captures
+#define SWDET_MAX_INTERRUPTS	16				// capture interrupts taken per SWDET_Arm()
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	XTmrCtr			TmrCtr;				// capture timer/counter instance
+	u32				ClockFreq;			// timer clock frequency (Hz)
+	volatile u32	High;				// last high interval (clocks - 1)
+	volatile u32	Low;				// last low interval (clocks - 1)
+	volatile u32	Captured;			// timers that captured an edge since SWDET_Start() (bit n = timer n)
+	volatile u32	Measured;			// intervals measured since the last SWDET_GetCounts() (SWDET_HIGH/LOW)
+	volatile u32	Remaining;			// capture interrupts left before the interrupt is disabled
+	volatile u32	Interrupts;			// capture interrupts handled
+} SWDET_Instance;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+int SWDET_Initialize(SWDET_Instance *InstancePtr, u16 DeviceId, u32 clkfreq);
+int SWDET_Start(SWDET_Instance *InstancePtr);
+int SWDET_Stop(SWDET_Instance *InstancePtr);
+void SWDET_Arm(SWDET_Instance *InstancePtr);
+int SWDET_GetCounts(SWDET_Instance *InstancePtr, u32 *high, u32 *low);
+void SWDET_InterruptHandler(void *CallBackRef);
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
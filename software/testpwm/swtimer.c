@@ -0,0 +1,318 @@
+/**
+*
+* @file swtimer.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides a timer service driven by the millisecond timestamp of the FIT
+* interrupt handler (see swtimer.h).  Every slot of the wheel is a circular doubly linked
+* list with a sentinel, so a timer is linked and unlinked in O(1) without a search.  A
+* tick first moves the timers that expire in it from their slot to a list of their own and
+* then calls the handlers one at a time, so a handler can start or stop any timer
+* (including one that is about to fire in the same tick) without upsetting the walk.
+*
+* The overhead of a tick is the time from its start to its end less the times measured for
+* the handlers.  The profiler clock reads add one read cost (PROFILE_GetOverhead()) to it
+* for the tick and one for every handler, and these are subtracted, the way profile.c
+* does for a region.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Subtract the cost of the profiler clock reads from the overhead
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include "swtimer.h"
+
+
+/************************** Constant Definitions *****************************/
+#define SWTIMER_SLOT_MASK		(SWTIMER_SLOTS - 1)
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#if PROFILE_ENABLE
+#define SWTIMER_NOW()			PROFILE_Now()
+#define SWTIMER_READ_COST()		PROFILE_GetOverhead()
+#else
+#define SWTIMER_NOW()			0
+#define SWTIMER_READ_COST()		0
+#endif
+
+/************************** Function Prototypes ******************************/
+static void swtimer_link(SWTIMER_Link *ListPtr, SWTIMER_Link *LinkPtr);
+static void swtimer_unlink(SWTIMER_Link *LinkPtr);
+
+/************************** Variable Definitions *****************************/
+static SWTIMER_Link		swtimer_wheel[SWTIMER_SLOTS];	// one list per expiry time modulo SWTIMER_SLOTS
+static SWTIMER_Link		swtimer_due;					// timers that fire in the current tick
+static u32				swtimer_time;					// last tick processed
+static u32				swtimer_running;				// SWTIMER_Run() is running
+static u32				swtimer_read_cost;				// clocks one SWTIMER_NOW() adds to a measured time
+static SWTIMER_Stats	swtimer_stats;
+
+
+/*****************************************************************************/
+/**
+*
+* swtimer_link() - Adds a link at the end of a list
+*
+* @return	None
+*
+******************************************************************************/
+static void swtimer_link(SWTIMER_Link *ListPtr, SWTIMER_Link *LinkPtr)
+{
+	LinkPtr->Next = ListPtr;
+	LinkPtr->Prev = ListPtr->Prev;
+	ListPtr->Prev->Next = LinkPtr;
+	ListPtr->Prev = LinkPtr;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* swtimer_unlink() - Takes a link out of its list
+*
+* @return	None
+*
+******************************************************************************/
+static void swtimer_unlink(SWTIMER_Link *LinkPtr)
+{
+	LinkPtr->Prev->Next = LinkPtr->Next;
+	LinkPtr->Next->Prev = LinkPtr->Prev;
+	LinkPtr->Next = LinkPtr;
+	LinkPtr->Prev = LinkPtr;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SWTIMER_Initialize() - Initializes the timer service
+*
+* Empties the wheel and clears the statistics.  Timers that were running are forgotten
+* (their structures are not touched).  With PROFILE_ENABLE the profiler must be
+* initialized first: its overhead is taken out of the overhead of the ticks.
+*
+* @param    Now is the current timestamp (msec)
+*
+* @return	None
+*
+******************************************************************************/
+void SWTIMER_Initialize(u32 Now)
+{
+	int		i;
+
+	for (i = 0; i < SWTIMER_SLOTS; i++)
+	{
+		swtimer_wheel[i].Next = &swtimer_wheel[i];
+		swtimer_wheel[i].Prev = &swtimer_wheel[i];
+	}
+	swtimer_due.Next = &swtimer_due;
+	swtimer_due.Prev = &swtimer_due;
+
+	swtimer_time = Now;
+	swtimer_running = 0;
+	swtimer_read_cost = SWTIMER_READ_COST();
+
+	swtimer_stats.Ticks = 0;
+	swtimer_stats.Fired = 0;
+	swtimer_stats.Active = 0;
+	swtimer_stats.MaxLag = 0;
+	swtimer_stats.Overruns = 0;
+	swtimer_stats.OverheadSum = 0;
+	swtimer_stats.OverheadMax = 0;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SWTIMER_Start() - Starts (or restarts) a timer
+*
+* The timer expires Delay msec after the last tick the service has processed and then,
+* if Period is not 0, every Period msec.  A timer that is already running is restarted
+* with the new settings.  May be called from a handler, for any timer.
+*
+* @param    TimerPtr is a pointer to the timer
+* @param    Delay is the time to the first expiry (msec, 0 is taken as 1)
+* @param    Period is the period (msec), 0 for a one-shot timer
+* @param    Handler is the function to call when the timer expires
+* @param    CallbackRef is passed to Handler
+*
+* @return	None
+*
+******************************************************************************/
+void SWTIMER_Start(SWTIMER_Timer *TimerPtr, u32 Delay, u32 Period, SWTIMER_Handler Handler,
+		void *CallbackRef)
+{
+	if (TimerPtr->Active)
+	{
+		swtimer_unlink(&TimerPtr->Link);
+		swtimer_stats.Active--;
+	}
+
+	TimerPtr->Expires = swtimer_time + ((Delay != 0) ? Delay : 1);
+	TimerPtr->Period = Period;
+	TimerPtr->Handler = Handler;
+	TimerPtr->CallbackRef = CallbackRef;
+	TimerPtr->Active = 1;
+
+	swtimer_link(&swtimer_wheel[TimerPtr->Expires & SWTIMER_SLOT_MASK], &TimerPtr->Link);
+	swtimer_stats.Active++;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SWTIMER_Stop() - Stops a timer
+*
+* Does nothing if the timer is not running.  May be called from a handler, for any timer.
+*
+* @param    TimerPtr is a pointer to the timer
+*
+* @return	None
+*
+******************************************************************************/
+void SWTIMER_Stop(SWTIMER_Timer *TimerPtr)
+{
+	if (TimerPtr->Active)
+	{
+		swtimer_unlink(&TimerPtr->Link);
+		TimerPtr->Active = 0;
+		swtimer_stats.Active--;
+	}
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SWTIMER_Run() - Processes the ticks up to now and calls the handlers of the timers that
+* expired
+*
+* Called from the main loop, as often as it likes (once a msec is enough).  If it was not
+* called for a while it catches up one tick at a time, so the timers still fire in order.
+* A periodic timer that missed more than one period fires once and skips the others (they
+* are counted as overruns) instead of firing for each of them in a burst.  Does nothing if
+* it is already running (called from a handler).
+*
+* @param    Now is the current timestamp (msec)
+*
+* @return	None
+*
+******************************************************************************/
+void SWTIMER_Run(u32 Now)
+{
+	SWTIMER_Link	*slot, *link, *next;
+	SWTIMER_Timer	*timer;
+	u32				lag, start, handlers, reads, clocks;
+
+	if (swtimer_running || (Now == swtimer_time))
+	{
+		return;
+	}
+	swtimer_running = 1;
+
+	lag = Now - swtimer_time;
+	if (lag > swtimer_stats.MaxLag)
+	{
+		swtimer_stats.MaxLag = lag;
+	}
+
+	while (swtimer_time != Now)
+	{
+		start = SWTIMER_NOW();
+		handlers = 0;
+		reads = swtimer_read_cost;
+
+		swtimer_time++;
+		swtimer_stats.Ticks++;
+
+		// move the timers that expire now to the due list (the others in the slot are a
+		// turn or more of the wheel away)
+
+		slot = &swtimer_wheel[swtimer_time & SWTIMER_SLOT_MASK];
+		for (link = slot->Next; link != slot; link = next)
+		{
+			next = link->Next;
+			if (((SWTIMER_Timer *) link)->Expires == swtimer_time)
+			{
+				swtimer_unlink(link);
+				swtimer_link(&swtimer_due, link);
+			}
+		}
+
+		// fire them.  A periodic timer goes back on the wheel first, so its handler can
+		// stop or restart it
+
+		while (swtimer_due.Next != &swtimer_due)
+		{
+			timer = (SWTIMER_Timer *) swtimer_due.Next;
+			swtimer_unlink(&timer->Link);
+
+			if (timer->Period != 0)
+			{
+				timer->Expires += timer->Period;
+				while ((s32) (Now - timer->Expires) >= 0)
+				{
+					timer->Expires += timer->Period;
+					swtimer_stats.Overruns++;
+				}
+				swtimer_link(&swtimer_wheel[timer->Expires & SWTIMER_SLOT_MASK], &timer->Link);
+			}
+			else
+			{
+				timer->Active = 0;
+				swtimer_stats.Active--;
+			}
+
+			clocks = SWTIMER_NOW();
+			timer->Handler(timer->CallbackRef);
+			handlers += SWTIMER_NOW() - clocks;
+			reads += swtimer_read_cost;
+			swtimer_stats.Fired++;
+		}
+
+		clocks = (SWTIMER_NOW() - start) - handlers;
+		clocks = (clocks > reads) ? clocks - reads : 0;
+		swtimer_stats.OverheadSum += clocks;
+		if (clocks > swtimer_stats.OverheadMax)
+		{
+			swtimer_stats.OverheadMax = clocks;
+		}
+	}
+
+	swtimer_running = 0;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* SWTIMER_GetStats() - Returns the statistics of the timer service
+*
+* The overhead is the time SWTIMER_Run() spends on the ticks without the handlers.  It
+* is timed with the profiler clock (profile.h), less the cost of reading it, and is 0 if
+* PROFILE_ENABLE is 0.  In hostsim only bus accesses take time, so there it is the bus
+* time of the service alone and leaves out its instructions; the cost on the target has
+* to be measured on the target.
+*
+* @param    StatsPtr is a pointer to the statistics
+*
+* @return	None
+*
+******************************************************************************/
+void SWTIMER_GetStats(SWTIMER_Stats *StatsPtr)
+{
+	*StatsPtr = swtimer_stats;
+}
@@ -0,0 +1,95 @@
+/**
+*
+* @file swtimer.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions and function prototypes for swtimer.c.
+* swtimer.c is a timer service with a 1 msec resolution on top of the millisecond
+* timestamp of the FIT interrupt handler.  Timers are one-shot or periodic and call a
+* handler when they expire.  The handlers run from SWTIMER_Run(), which the main loop
+* calls with the current timestamp, so they run outside interrupt context and can do
+* anything the main loop can.
+*
+* The timers are kept in a hashed timer wheel: SWTIMER_SLOTS doubly linked lists, one for
+* every expiry time modulo SWTIMER_SLOTS.  Starting and stopping a timer is O(1), and every
+* tick only looks at the timers in the slot of that tick.  Timers longer than SWTIMER_SLOTS
+* msec go round the wheel and are skipped until their expiry time comes up.
+*
+* The timer structures belong to the caller and must stay valid while the timer runs.
+* The service must only be used from the main loop (not from interrupt handlers), which
+* is why it needs no locking.  SWTIMER_Run() does not run handlers while it is already
+* running, so a handler that waits (e.g. with delay_msecs()) holds up the other timers
+* instead of running them nested; they fire, late, when it returns.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* </pre>
+*
+******************************************************************************/
+
+#ifndef SWTIMER_H		/* prevent circular inclusions */
+#define SWTIMER_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "xil_types.h"
+#include "profile.h"
+
+/************************** Constant Definitions *****************************/
+#define SWTIMER_SLOTS			64				// wheel slots (a power of 2)
+
+/**************************** Type Definitions *******************************/
+typedef void (*SWTIMER_Handler)(void *CallbackRef);
+
+// links of a timer into a wheel slot (or the list of timers about to fire)
+typedef struct SWTIMER_Link {
+	struct SWTIMER_Link	*Next;
+	struct SWTIMER_Link	*Prev;
+} SWTIMER_Link;
+
+typedef struct {
+	SWTIMER_Link		Link;				// must be first
+	u32					Expires;			// timestamp of the next expiry (msec)
+	u32					Period;				// 0 = one-shot, else the period (msec)
+	SWTIMER_Handler		Handler;
+	void				*CallbackRef;		// passed to Handler
+	u32					Active;				// 1 = started and not yet expired or stopped
+} SWTIMER_Timer;
+
+typedef struct {
+	u32		Ticks;							// msec ticks processed
+	u32		Fired;							// handlers called
+	u32		Active;							// timers running now
+	u32		MaxLag;							// most ticks SWTIMER_Run() had to catch up at once
+	u32		Overruns;						// periods skipped by periodic timers that fell behind
+	u64		OverheadSum;					// clocks spent in the service, handlers and clock reads excluded (PROFILE_ENABLE)
+	u32		OverheadMax;					// most clocks spent on one tick (PROFILE_ENABLE)
+} SWTIMER_Stats;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+void SWTIMER_Initialize(u32 Now);
+void SWTIMER_Start(SWTIMER_Timer *TimerPtr, u32 Delay, u32 Period, SWTIMER_Handler Handler,
+		void *CallbackRef);
+void SWTIMER_Stop(SWTIMER_Timer *TimerPtr);
+void SWTIMER_Run(u32 Now);
+void SWTIMER_GetStats(SWTIMER_Stats *StatsPtr);
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
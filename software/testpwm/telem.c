@@ -0,0 +1,318 @@
+/**
+*
+* @file telem.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides the telemetry stream over the axi_uartlite (see telem.h).  The
+* application adds frames and console text at the head of the transmit ring and the
+* UART-Lite interrupt handler takes them from the tail, so the ring needs no locking.
+* The UART-Lite interrupts when its transmit FIFO goes empty.  The handler refills the
+* FIFO from the ring; when the ring is empty the transmitter goes idle and the next frame
+* or character starts it again.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include "telem.h"
+
+#if TELEM_ENABLE
+
+#include <stdbool.h>
+#include "xparameters.h"
+#include "xuartlite_l.h"
+#include "xil_printf.h"
+#include "mb_interface.h"
+#include "idle.h"
+
+/************************** Constant Definitions *****************************/
+
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#define TELEM_USED()			(telem_head - telem_tail)
+
+
+/************************** Function Prototypes ******************************/
+static void telem_fill(void);
+static void telem_kick(void);
+
+/************************** Variable Definitions *****************************/
+static volatile u8		telem_ring[TELEM_RING_SIZE];
+static volatile u32		telem_head;						// bytes queued (written by the application)
+static volatile u32		telem_tail;						// bytes sent to the FIFO (written by the handler)
+static volatile bool	telem_tx_busy;					// the FIFO is being sent and will interrupt
+static UINTPTR			telem_base = 0;					// UART-Lite (0 = not initialized yet)
+static u32				telem_seq;
+static TELEM_Stats		telem_stats;
+
+/*****************************************************************************/
+/**
+*
+* telem_fill() - Moves up to one FIFO of bytes from the ring to the empty transmit FIFO
+*
+* @return	None
+*
+******************************************************************************/
+static void telem_fill(void)
+{
+	u32		tail = telem_tail;
+	u32		n = 0;
+
+	while ((tail != telem_head) && (n < XUL_FIFO_SIZE))
+	{
+		XUartLite_WriteReg(telem_base, XUL_TX_FIFO_OFFSET, telem_ring[tail & (TELEM_RING_SIZE - 1)]);
+		tail++;
+		n++;
+	}
+	telem_tail = tail;
+	telem_tx_busy = (n != 0);
+}
+
+
+/*****************************************************************************/
+/**
+*
+* telem_kick() - Starts the transmitter if it is idle
+*
+* Called by the application after it adds to the ring.  Interrupts are disabled while
+* the FIFO is filled so the interrupt handler cannot fill it at the same time.
+*
+* @return	None
+*
+******************************************************************************/
+static void telem_kick(void)
+{
+	if (telem_tx_busy)
+	{
+		return;
+	}
+
+	microblaze_disable_interrupts();
+	if (!telem_tx_busy)
+	{
+		telem_fill();
+	}
+	microblaze_enable_interrupts();
+}
+
+
+/*****************************************************************************/
+/**
+* Initializes the telemetry stream
+*
+* Waits for the console text already in the transmit FIFO to go out and enables the
+* UART-Lite interrupt.  TELEM_InterruptHandler() must be connected to it.
+*
+* @param	BaseAddress is the base address of the axi_uartlite
+*
+* @return	XST_SUCCESS
+*
+******************************************************************************/
+int TELEM_Initialize(u32 BaseAddress)
+{
+	while ((XUartLite_GetStatusReg(BaseAddress) & XUL_SR_TX_FIFO_EMPTY) == 0)
+	{
+		// wait for the FIFO to empty
+	}
+
+	telem_head = 0;
+	telem_tail = 0;
+	telem_tx_busy = false;
+	telem_seq = 0;
+	telem_stats.Records = 0;
+	telem_stats.Drops = 0;
+	telem_stats.TextBytes = 0;
+	telem_stats.MaxUsed = 0;
+
+	XUartLite_EnableIntr(BaseAddress);
+	telem_base = BaseAddress;
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+* Sends a telemetry record
+*
+* Fills in the sequence number and the drop count of the record, adds the frame to the
+* transmit ring and returns without waiting for the UART.
+*
+* @param	RecPtr is a pointer to the record
+*
+* @return
+*
+*   - XST_SUCCESS if the frame was queued
+*   - XST_DEVICE_BUSY if the ring had no room for it (the record is dropped)
+*
+******************************************************************************/
+int TELEM_SendRecord(TELEM_Record *RecPtr)
+{
+	u8			frame[TELEM_FRAME_SIZE];
+	const u32	*wp = (const u32 *) RecPtr;
+	u32			i, head;
+	u16			crc;
+
+	RecPtr->Seq = telem_seq++;
+	RecPtr->Drops = telem_stats.Drops;
+
+	if ((telem_base == 0) || ((TELEM_RING_SIZE - TELEM_USED()) < TELEM_FRAME_SIZE))
+	{
+		telem_stats.Drops++;
+		return XST_DEVICE_BUSY;
+	}
+
+	frame[0] = TELEM_SYNC0;
+	frame[1] = TELEM_SYNC1;
+	frame[2] = TELEM_RECORD_SIZE;
+	frame[3] = TELEM_TYPE_RECORD;
+	for (i = 0; i < TELEM_RECORD_WORDS; i++)
+	{
+		frame[TELEM_HEADER_SIZE + (4 * i)] = (u8) wp[i];
+		frame[TELEM_HEADER_SIZE + (4 * i) + 1] = (u8) (wp[i] >> 8);
+		frame[TELEM_HEADER_SIZE + (4 * i) + 2] = (u8) (wp[i] >> 16);
+		frame[TELEM_HEADER_SIZE + (4 * i) + 3] = (u8) (wp[i] >> 24);
+	}
+	crc = TELEM_Crc16(0xFFFF, &frame[2], TELEM_HEADER_SIZE - 2 + TELEM_RECORD_SIZE);
+	frame[TELEM_HEADER_SIZE + TELEM_RECORD_SIZE] = (u8) crc;
+	frame[TELEM_HEADER_SIZE + TELEM_RECORD_SIZE + 1] = (u8) (crc >> 8);
+
+	// copy the whole frame before moving the head so the handler never sends part of it
+	head = telem_head;
+	for (i = 0; i < TELEM_FRAME_SIZE; i++)
+	{
+		telem_ring[(head + i) & (TELEM_RING_SIZE - 1)] = frame[i];
+	}
+	telem_head = head + TELEM_FRAME_SIZE;
+
+	telem_stats.Records++;
+	if (TELEM_USED() > telem_stats.MaxUsed)
+	{
+		telem_stats.MaxUsed = TELEM_USED();
+	}
+	telem_kick();
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+* Returns a copy of the telemetry counters
+*
+* @param	StatsPtr is a pointer to the copy
+*
+* @return	None
+*
+******************************************************************************/
+void TELEM_GetStats(TELEM_Stats *StatsPtr)
+{
+	*StatsPtr = telem_stats;
+}
+
+
+/*****************************************************************************/
+/**
+* Handles the UART-Lite interrupt
+*
+* Refills the transmit FIFO from the ring when it is empty.
+*
+* @param	CallBackRef is not used
+*
+* @return	None
+*
+******************************************************************************/
+void TELEM_InterruptHandler(void *CallBackRef)
+{
+	(void) CallBackRef;
+
+	if (XUartLite_GetStatusReg(telem_base) & XUL_SR_TX_FIFO_EMPTY)
+	{
+		telem_fill();
+	}
+}
+
+
+/*****************************************************************************/
+/**
+* Sends a console character (replaces the BSP outbyte() used by xil_printf())
+*
+* Before TELEM_Initialize() the character is written straight to the UART.  After it,
+* the character is added to the transmit ring, waiting only while the ring is full.
+*
+* @param	c is the character
+*
+* @return	None
+*
+* @note
+* Must not be called from an interrupt handler or with interrupts disabled once
+* TELEM_Initialize() has been called.
+*
+******************************************************************************/
+void outbyte(char c)
+{
+	u32		head;
+
+	if (telem_base == 0)
+	{
+		XUartLite_SendByte(STDOUT_BASEADDRESS, (u8) c);
+		return;
+	}
+
+	while (TELEM_USED() >= TELEM_RING_SIZE)
+	{
+		WAIT_FOR_INTERRUPT();		// wait for the interrupt handler to make room
+	}
+
+	head = telem_head;
+	telem_ring[head & (TELEM_RING_SIZE - 1)] = (u8) c;
+	telem_head = head + 1;
+
+	telem_stats.TextBytes++;
+	if (TELEM_USED() > telem_stats.MaxUsed)
+	{
+		telem_stats.MaxUsed = TELEM_USED();
+	}
+	telem_kick();
+}
+
+#endif /* TELEM_ENABLE */
+
+
+/*****************************************************************************/
+/**
+* Computes the CRC-16/CCITT of a buffer
+*
+* Polynomial 0x1021, MSB first, no reflection and no final XOR.  Start with 0xFFFF.
+*
+* @param	Crc is the CRC of the preceding bytes (0xFFFF for the first buffer)
+* @param	Buf is a pointer to the bytes
+* @param	Len is the number of bytes
+*
+* @return	The CRC including the bytes
+*
+******************************************************************************/
+u16 TELEM_Crc16(u16 Crc, const u8 *Buf, u32 Len)
+{
+	u32		i;
+	int		b;
+
+	for (i = 0; i < Len; i++)
+	{
+		Crc ^= (u16) Buf[i] << 8;
+		for (b = 0; b < 8; b++)
+		{
+			Crc = (Crc & 0x8000) ? (u16) ((Crc << 1) ^ 0x1021) : (u16) (Crc << 1);
+		}
+	}
+	return Crc;
+}
@@ -0,0 +1,126 @@
+/**
+*
+* @file telem.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the constant definitions and function prototypes for telem.c.
+* telem.c sends telemetry records to the host as binary frames over the axi_uartlite.
+* Frames and console text (xil_printf(), through outbyte()) go into one transmit ring that
+* the UART-Lite interrupt handler drains 16 bytes (one FIFO) at a time, so neither has to
+* wait for the 19200 baud line.  TELEM_SendRecord() never waits: if the ring has no room
+* for the whole frame the record is dropped and counted.  Console text waits only while
+* the ring is full.
+*
+* Frame format (multi-byte fields are little-endian):
+*
+*	offset	size	field
+*	0		2		sync 0xA5 0x5A (never appears in the ASCII console text)
+*	2		1		payload length in bytes
+*	3		1		frame type (TELEM_TYPE_RECORD)
+*	4		len		payload: the TELEM_Record words in order
+*	4+len	2		CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of the
+*					length, type and payload bytes
+*
+* Records get consecutive sequence numbers whether they are sent or dropped, so a gap in
+* the sequence numbers the host receives is the number of records dropped in between.
+* Each record also carries the total number of records dropped before it.
+*
+* Set TELEM_ENABLE to 0 (e.g. -DTELEM_ENABLE=0) to compile telemetry out: only
+* TELEM_Crc16() is left and the console uses the BSP outbyte().
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release of driver
+* 1.01a	ri	10/16/26	Record type 0x02: detected frequency to 0.001 Hz, duty cycle in 0.01%
+* 1.02a	ri	10/16/26	TELEM_FLAG_SATURATED
+* </pre>
+*
+******************************************************************************/
+
+#ifndef TELEM_H		/* prevent circular inclusions */
+#define TELEM_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "xil_types.h"
+#include "xstatus.h"
+
+/************************** Constant Definitions *****************************/
+#ifndef TELEM_ENABLE
+#define TELEM_ENABLE			1				// 0 = compile telemetry out
+#endif
+
+#define TELEM_RING_SIZE			1024			// transmit ring (bytes, power of 2)
+
+#define TELEM_SYNC0				0xA5
+#define TELEM_SYNC1				0x5A
+#define TELEM_TYPE_RECORD		0x02
+
+#define TELEM_HEADER_SIZE		4				// sync, length, type
+#define TELEM_CRC_SIZE			2
+#define TELEM_RECORD_WORDS		15
+#define TELEM_RECORD_SIZE		(TELEM_RECORD_WORDS * 4)
+#define TELEM_FRAME_SIZE		(TELEM_HEADER_SIZE + TELEM_RECORD_SIZE + TELEM_CRC_SIZE)
+
+// TELEM_Record Flags
+#define TELEM_FLAG_HW			0x01			// the detected values are from hw_detect (sw[3] = 1)
+#define TELEM_FLAG_GATED		0x02			// the detected frequency is from the gated counter
+#define TELEM_FLAG_SATURATED	0x04			// HwHigh or HwLow is saturated (the PWM is below the range
+												// of hw_detect); with TELEM_FLAG_HW and without
+												// TELEM_FLAG_GATED the detected values are out of range
+
+/**************************** Type Definitions *******************************/
+// a telemetry record.  Only u32 words, in the order they are sent
+typedef struct {
+	u32		Timestamp;					// msec since the program began
+	u32		Seq;						// record sequence number (filled in by TELEM_SendRecord())
+	u32		Drops;						// records dropped so far (filled in by TELEM_SendRecord())
+	u32		SetFreq;					// PWM frequency (Hz)
+	u32		SetDuty;					// PWM duty cycle (%)
+	u32		HwHigh;						// hw_detect high count (sum over 2^HwK periods)
+	u32		HwLow;						// hw_detect low count (sum over 2^HwK periods)
+	u32		HwK;						// hw_detect accumulation exponent
+	u32		SwHigh;						// software detect high count
+	u32		SwLow;						// software detect low count
+	u32		DetFreq;					// detected frequency (whole Hz, filtered)
+	u32		DetFreqMilli;				// detected frequency (mHz above DetFreq, 0 to 999)
+	u32		DetDuty;					// detected duty cycle (0.01%, filtered)
+	u32		DetErr;						// error bound of the detected frequency (ppm)
+	u32		Flags;						// TELEM_FLAG_*
+} TELEM_Record;
+
+typedef struct {
+	u32		Records;					// records queued
+	u32		Drops;						// records dropped because the ring was full
+	u32		TextBytes;					// console bytes queued
+	u32		MaxUsed;					// most bytes waiting in the ring
+} TELEM_Stats;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+u16 TELEM_Crc16(u16 Crc, const u8 *Buf, u32 Len);
+
+#if TELEM_ENABLE
+int TELEM_Initialize(u32 BaseAddress);
+int TELEM_SendRecord(TELEM_Record *RecPtr);
+void TELEM_GetStats(TELEM_Stats *StatsPtr);
+void TELEM_InterruptHandler(void *CallBackRef);
+#endif
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
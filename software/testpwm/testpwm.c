@@ -15,11 +15,44 @@ The test program uses the rotary encoder and switches to choose a PWM frequency
 frequency and duty cycle are displayed on line 1 of the LCD.   The program also illustrates the use of a Xilinx
 fixed interval timer module to generate a periodic interrupt for handling time-based (maybe) and/or sampled inputs/outputs
 
+The frequency and duty cycle measured by the detector selected with sw[3] are sampled every MEASURE_MSEC,
+filtered and displayed on line 2 of the LCD, so line 2 keeps following the PWM after the settings change.
+The counts are converted with the fixed-point calculations of meas.c (frequency in mHz, duty cycle in
+hundredths of a percent).  The LCD shows the duty cycle to 0.1% and the console the full resolution.
+
+Pressing BTNU runs a sweep of every PWM_FREQ_* frequency (including the ones the switches cannot select)
+and duty cycle and prints a table of the settings, the readback and the statistics of both detectors on
+the console (see sweep()).  It is the regression and acceptance benchmark of the detectors.  The sweep is
+also the characterization run of the detector calibration (calib.c): it derives a correction of the
+systematic error of each detector per frequency range, prints the error before and after the correction
+and from then on measure() applies it.
+
+Pressing BTND times the frequency and duty cycle calculations of meas.c against the former ones
+(calc_freq() and calc_duty()) and checks their rounding (see bench_calc()).
+
+Pressing BTNC prints the execution time profile of the interrupt handlers and the display code (profile.c)
+and the number of bytes sent to the LCD on the console.  It also prints the period and high time statistics
+and the histogram of the period jitter that the statistics unit of hw_detect (hwstats.c) has kept since the
+last settings change or BTNC.  The display is drawn into a shadow framebuffer
+(lcdfb.c) that only queues the characters that changed.  FIT_BottomHalf() sends the queue to the LCD a
+byte at a time, so the main loop never waits for the LCD.  BTNC also prints the statistics of the
+timer service and the scheduler.
+
+The main loop only runs the cooperative scheduler (sched.c).  Reading the inputs, applying new PWM
+settings, measuring, refreshing the display and sending telemetry are prioritized run-to-completion
+tasks with their own periods and deadlines, released by the software timers (swtimer.c), a timer
+wheel on the millisecond timestamp.  BTNC prints the run time, latency and deadline misses of each
+task next to the timer statistics.
+
 Configuration Notes:
 
 The minimal hardware configuration for this test is a Microblaze-based system with at least 32KB of memory,
-an instance of Nexys4IO, an instance of the PMod544IOR2, an instance of an axi_timer, an instance of an axi_gpio
-and an instance of an axi_uartlite (used for xil_printf() console output)
+an instance of Nexys4IO, an instance of the PMod544IOR2, an instance of an axi_timer, three instances of axi_gpio
+(GPIO_2 connects the statistics unit of hw_detect) and an instance of an axi_uartlite (used for xil_printf() console output).  With TELEM_ENABLE set the
+axi_uartlite interrupt must be connected to the interrupt controller: the console text and the binary
+telemetry records (telem.c) are sent from a ring by the UART-Lite interrupt handler.  With SW_DETECT_CAPTURE set the
+software pulse-width detect needs a second axi_timer (axi_timer_1) with its capture inputs connected to the
+PWM (capturetrig0) and the inverted PWM (capturetrig1) and its interrupt connected to the interrupt controller
 
 */
 
@@ -38,6 +71,18 @@ and an instance of an axi_uartlite (used for xil_printf() console output)
 #include "Nexys4IO.h"
 #include "PMod544IOR2.h"
 #include "pwm_tmrctr.h"
+#include "hwdet.h"
+#include "swdet.h"
+#include "profile.h"
+#include "lcdfb.h"
+#include "telem.h"
+#include "calib.h"
+#include "meas.h"
+#include "hwstats.h"
+#include "swtimer.h"
+#include "sched.h"
+#include "testpwm.h"
+#include "idle.h"
 
 /************************** Constant Definitions ****************************/
 
@@ -49,6 +94,7 @@ and an instance of an axi_uartlite (used for xil_printf() console output)
 // PWM and pulse detect timer parameters
 
 #define PWM_TIMER_DEVICE_ID		XPAR_TMRCTR_0_DEVICE_ID
+#define SWDET_TIMER_DEVICE_ID	XPAR_TMRCTR_1_DEVICE_ID
 
 // Nexys4 I/O parameters
 
@@ -67,16 +113,26 @@ and an instance of an axi_uartlite (used for xil_printf() console output)
 #define GPIO_0_DEVICE_ID		XPAR_AXI_GPIO_0_DEVICE_ID
 #define GPIO_0_INPUT_CHANNEL	1
 #define GPIO_0_OUTPUT_CHANNEL	2
+#define GPIO_0_ACCUM_SHIFT		4				// hw_detect accumulation exponent is bits[7:4] of the output
+#define GPIO_0_GATE_SEL			0x02			// hw_detect outputs show the gated edge counter
 
 #define GPIO_1_DEVICE_ID		XPAR_AXI_GPIO_1_DEVICE_ID
-#define GPIO_1_HIGH_COUNT		1
-#define GPIO_1_LOW_COUNT		2									
+#define GPIO_1_HIGH_COUNT		HWDET_HIGH_CHANNEL
+#define GPIO_1_LOW_COUNT		HWDET_LOW_CHANNEL									
+
+#define GPIO_2_DEVICE_ID		XPAR_AXI_GPIO_2_DEVICE_ID	// hw_detect statistics unit (hwstats.c)
+
+// UART-Lite parameters (console and telemetry)
+
+#define TELEM_UART_BASEADDR		XPAR_UARTLITE_0_BASEADDR
 		
 // Interrupt Controller parameters
 
 #define INTC_DEVICE_ID			XPAR_INTC_0_DEVICE_ID
 #define FIT_INTERRUPT_ID		XPAR_MICROBLAZE_0_AXI_INTC_FIT_TIMER_0_INTERRUPT_INTR
 #define PWM_TIMER_INTERRUPT_ID	XPAR_MICROBLAZE_0_AXI_INTC_AXI_TIMER_0_INTERRUPT_INTR
+#define SWDET_INTERRUPT_ID		XPAR_MICROBLAZE_0_AXI_INTC_AXI_TIMER_1_INTERRUPT_INTR
+#define TELEM_INTERRUPT_ID		XPAR_MICROBLAZE_0_AXI_INTC_AXI_UARTLITE_0_INTERRUPT_INTR
 
 // Fixed Interval timer - 100 MHz input clock, 40KHz output clock
 // FIT_COUNT_1MSEC = FIT_CLOCK_FREQ_HZ * .001
@@ -102,6 +158,98 @@ and an instance of an axi_uartlite (used for xil_printf() console output)
 #define PWM_FREQ_5MHZ			5000000
 #define PWM_FREQ_10MHZ			10000000
 
+// 1 = change the PWM parameters without stopping the PWM (PWM_UpdateParams())
+// 0 = stop the PWM, change the parameters and restart it after the display is updated
+
+#define PWM_GLITCH_FREE_UPDATE	1
+
+// 1 = software detect from edge timestamps captured by axi_timer_1 (swdet.c)
+// 0 = software detect by polling the PWM signal in the FIT interrupt handler
+
+#define SW_DETECT_CAPTURE		1
+
+// 1 = the main loop sleeps until FIT_Handler() wakes it (every msec)
+// 0 = the main loop polls continuously
+// Either way the work is done by the tasks of the cooperative scheduler (sched.c), highest
+// priority first: the PWM task applies new settings within PWM_DEADLINE_MSEC, the input task
+// reads the switches, the buttons and the rotary encoder every INPUT_CHECK_MSEC, then come the
+// measure, display (line 2 of the LCD, every DISPLAY_MSEC) and telemetry tasks.  The greeting
+// is shown for SPLASH_MSEC
+
+#define MAIN_LOOP_EVENT_DRIVEN	1
+#define SPLASH_MSEC				2000
+#define PWM_DEADLINE_MSEC		5
+#define INPUT_CHECK_MSEC		20
+#define DISPLAY_MSEC			100
+
+// The detected frequency & duty cycle (line 2 of the LCD and the console) are sampled every
+// MEASURE_MSEC and filtered with an exponential moving average in which each sample weighs
+// 1/2^MEASURE_FILTER_SHIFT.  The filter starts over when the PWM parameters change and the
+// first sample is taken MEASURE_MSEC later, after the detectors have settled
+
+#define MEASURE_MSEC			50
+#define MEASURE_FILTER_SHIFT	2
+
+// A saturated HWDET pair (HWDET_IsSaturated()) means the PWM is below the range of hw_detect.
+// Its error bound is MEAS_ERR_OUT_OF_RANGE, so the gated count is used when there is one, and
+// otherwise line 2 of the LCD shows MEAS_RANGE_TEXT instead of a reading
+
+#define MEAS_ERR_OUT_OF_RANGE	1000000			// ppm
+#define MEAS_RANGE_TEXT			"<6Hz"			// every duty cycle is measured down to 5.97Hz
+
+// A telemetry record (telem.h) with the PWM settings, the raw detector counts and the
+// detected values is sent every TELEMETRY_MSEC.  TELEM_ENABLE = 0 compiles telemetry out
+
+#define TELEMETRY_MSEC			100
+
+// BTNU runs the frequency/duty cycle sweep (see sweep()): every PWM_FREQ_* frequency with
+// the duty cycles from SWEEP_DUTY_MIN to 99 in steps of SWEEP_DUTY_STEP.  Each point settles
+// for SWEEP_SETTLE_MSEC, then SWEEP_READINGS readings of both detectors are taken.  A reading
+// that does not arrive within SWEEP_TIMEOUT_MSEC is given up
+
+#define SWEEP_DUTY_MIN			1
+#ifndef SWEEP_DUTY_STEP
+#define SWEEP_DUTY_STEP			1
+#endif
+#ifndef SWEEP_READINGS
+#define SWEEP_READINGS			8
+#endif
+#define SWEEP_SETTLE_MSEC		20
+#define SWEEP_TIMEOUT_MSEC		250
+
+// BTND times the frequency & duty cycle calculations (see bench_calc()).  Every call is
+// timed BENCH_REPEAT times and the fastest is taken, so interrupts do not count
+
+#define BENCH_REPEAT			8
+
+#define SWDET_TIMER_CLOCK_FREQ_HZ	XPAR_TMRCTR_1_CLOCK_FREQ_HZ
+
+#if SW_DETECT_CAPTURE
+#define SWDET_CLOCK_FREQ_HZ		SWDET_TIMER_CLOCK_FREQ_HZ
+#else
+#define SWDET_CLOCK_FREQ_HZ		FIT_CLOCK_FREQ_HZ
+#endif
+
+// Profiled regions (profile.h).  PROFILE_ENABLE = 0 compiles the profiling out.  The
+// profiler times with the counter of axi_timer_1 and BTNC prints the statistics
+
+#define PROF_FIT_HANDLER		0
+#define PROF_FIT_BOTTOM_HALF	1
+#define PROF_PWM_SETPARAMS		2
+#define PROF_UPDATE_LCD			3
+#define PROF_LCD_FLUSH			4
+#define PROF_NUM_REGIONS		5
+
+// FIT_Handler() runs 40000 times a second, so timing every run would double its bus
+// traffic.  It is timed once every PROF_FIT_EVERY interrupts (0 = not timed)
+
+#define PROF_FIT_EVERY			64
+
+// FIT_Handler() only samples the PWM signal into a ring that FIT_BottomHalf() works
+// through from the main loop.  256 samples are 6.4 msec of FIT interrupts
+
+#define FIT_RING_SIZE			256				// must be a power of 2
+
 #define INITIAL_FREQUENCY		PWM_FREQ_1KHZ
 #define INITIAL_DUTY_CYCLE		50
 #define DUTY_CYCLE_CHANGE		5
@@ -121,12 +269,33 @@ and an instance of an axi_uartlite (used for xil_printf() console output)
 
 /************************** Variable Definitions ****************************/	
 
+// every PWM_FREQ_* frequency (the sweep and the calculation benchmark)
+
+const u32				pwm_freqs[] = { PWM_FREQ_10HZ, PWM_FREQ_100HZ, PWM_FREQ_1KHZ, PWM_FREQ_5KHZ,
+							PWM_FREQ_10KHZ, PWM_FREQ_50KHZ, PWM_FREQ_100KHZ, PWM_FREQ_200KHZ,
+							PWM_FREQ_500KHZ, PWM_FREQ_1MHZ, PWM_FREQ_2MHZ, PWM_FREQ_5MHZ,
+							PWM_FREQ_10MHZ };
+
+#if PROFILE_ENABLE
+const char * const		prof_names[PROF_NUM_REGIONS] = {
+							"FIT_Handler", "FIT_BottomHalf",
+#if PWM_GLITCH_FREE_UPDATE
+							"PWM_UpdateParams",
+#else
+							"PWM_SetParams",
+#endif
+							"update_lcd", "LCDFB_Flush" };
+#endif
+
 // Microblaze peripheral instances
 
 XIntc 	IntrptCtlrInst;						// Interrupt Controller instance
-XTmrCtr	PWMTimerInst;						// PWM timer instance
+PWM_Instance	PWMTimerInst;						// PWM timer instance
+SWDET_Instance	SWDetInst;							// edge capture timer instance (software detect)
 XGpio	GPIOInst0;							// GPIO instance - used for PWM duty & AXI Timer
 XGpio	GPIOInst1;							// GPIO instance 1 - used by hw_detect
+XGpio	GPIOInst2;							// GPIO instance 2 - used by the hw_detect statistics unit
+HWSTATS_Instance	HWStatsInst;				// hw_detect statistics unit instance
 
 
 // The following variables are shared between non-interrupt processing and
@@ -138,13 +307,32 @@ XGpio	GPIOInst1;							// GPIO instance 1 - used by hw_detect
 
 volatile unsigned int	clkfit;					// clock signal is bit[0] (rightmost) of gpio 0 output port									
 volatile unsigned long	timestamp;				// timestamp since the program began
+volatile u32			gpio_out_bits;			// gpio 0 output port bits other than clkfit (hw_detect k, gate_sel)
+volatile bool			main_wake;				// set every msec to wake the main loop
+
+// PWM samples from FIT_Handler() to FIT_BottomHalf().  FIT_Handler() is the only writer
+// of fit_ring_head and fit_ring_drops and FIT_BottomHalf() the only writer of fit_ring_tail,
+// so the ring needs no locking.  The indices count samples and are masked to index the ring
 
-volatile u32			gpio_in;				// GPIO input port
+volatile u8				fit_ring[FIT_RING_SIZE];	// GPIO input port samples, one per FIT interrupt
+volatile unsigned int	fit_ring_head;			// samples written by FIT_Handler()
+volatile unsigned int	fit_ring_tail;			// samples read by FIT_BottomHalf()
+volatile unsigned int	fit_ring_drops;			// samples dropped because the ring was full
+
+// The following variables are updated by FIT_BottomHalf(), which runs from the main loop
+
+u32						gpio_in;				// GPIO input port (last sample)
 volatile unsigned int	hw_high_count;			// high count from hw_detect on GPIO 1 (Channel 1)
 volatile unsigned int	hw_low_count; 			// low count from hw_detect on GPIO 1 (Channel 2)
+volatile unsigned int	hw_accum_k;				// hw_detect counts are sums over 2^hw_accum_k periods
+volatile unsigned int	hwdet_k;				// accumulation exponent written to hw_detect
+volatile unsigned int	hw_gate_edges;			// rising edges in the last hw_detect gate
+volatile unsigned int	hw_gate_clocks;			// length of the hw_detect gate (0 = no gate yet)
+volatile unsigned int	hw_samples;				// new HWDET pairs so far
 
-unsigned  int 			sw_high_count = 0;		// high count from sw detect in FIT interrupt routine	
-unsigned  int 			sw_low_count = 0; 		// low count for sw detect in FIT interrupt routine
+volatile unsigned int	sw_high_count = 0;		// high count from sw detect in FIT interrupt routine	
+volatile unsigned int	sw_low_count = 0; 		// low count for sw detect in FIT interrupt routine
+volatile unsigned int	sw_samples = 0;			// new SWDET pairs so far
 
 
 // The following variables are shared between the functions in the program
@@ -153,6 +341,26 @@ unsigned  int 			sw_low_count = 0; 		// low count for sw detect in FIT interrupt
 int						pwm_freq;			// PWM frequency 
 int						pwm_duty;			// PWM duty cycle
 bool					new_perduty;		// new period/duty cycle flag
+
+bool					done;				// the rotary encoder button was pressed, quit
+bool					hw_switch;			// sw[3]: display the hardware (1) or software (0) detect
+bool					measure_restart;	// start the filter over with the next sample
+
+SWTIMER_Timer			splash_timer;		// ends the greeting
+
+SCHED_Task				pwm_task;			// applies new PWM settings
+SCHED_Task				input_task;			// reads the inputs every INPUT_CHECK_MSEC
+SCHED_Task				measure_task;		// samples the detector every MEASURE_MSEC
+SCHED_Task				display_task;		// writes line 2 of the LCD every DISPLAY_MSEC
+#if TELEM_ENABLE
+SCHED_Task				telem_task;			// sends a telemetry record every TELEMETRY_MSEC
+#endif
+
+u64						meas_freq;			// detected frequency (mHz, filtered, from measure())
+u32						meas_duty;			// detected duty cycle (0.01%, filtered, from measure())
+unsigned int			meas_err;			// error bound of the last detector sample (ppm)
+bool					meas_gated;			// the last sample is from the gated counter
+bool					meas_saturated;		// the last sample is a saturated HWDET pair (out of range)
 				
 /*---------------------------------------------------------------------------*/					
 int						debugen = 0;		// debug level/flag
@@ -161,13 +369,28 @@ int						debugen = 0;		// debug level/flag
 
 /************************** Function Prototypes ******************************/
 
-int				do_init(void);															// initialize system
 void			delay_msecs(unsigned int msecs);										// busy-wait delay for "msecs" miliseconds
-void			update_lcd(int freq, int dutycycle, u32 linenum);						// update LCD display
+void			measure(bool hw_switch, bool restart);									// sample, filter and publish the detected frequency
+void			send_telemetry(bool hw_switch);											// send a telemetry record
+bool			sweep(void);															// run the frequency/duty cycle sweep benchmark
+unsigned int	sweep_wait(unsigned int want, unsigned int *hw_seen, unsigned int *sw_seen);	// wait for new detector samples
+int				sweep_ppm(u64 freq, u32 ref);											// error of freq in ppm of ref
+void			sweep_print_freq(u64 freq);												// print a frequency column
+void			print_hwstats(void);													// print the hw_detect statistics
+void			print_swtimer(void);													// print the timer service statistics
+void			end_splash(void *unused);												// end the greeting (splash_timer)
+void			scan_inputs(void *unused);												// read the inputs (input task)
+void			set_pwm(void *unused);													// apply new PWM settings (PWM task)
+void			measure_tick(void *unused);												// sample the detector (measure task)
+void			display_tick(void *unused);												// write line 2 of the LCD (display task)
+#if TELEM_ENABLE
+void			telem_tick(void *unused);												// send a telemetry record (telemetry task)
+#endif
+#if PROFILE_ENABLE
+void			bench_calc(void);														// time the frequency & duty cycle calculations
+#endif
 				
-void			FIT_Handler(void);														// fixed interval timer interrupt handler
-unsigned int 	calc_freq(unsigned int high, unsigned int low, bool hw_switch); 		// calculates frequency from high & low counts
-unsigned int	calc_duty(unsigned int high, unsigned int low);							// calculates duty cycle from high & low counts
+unsigned int	calc_error_ppm(unsigned int counts);											// bounds the error of a measurement of "counts"
 
 
 /************************** MAIN PROGRAM ************************************/
@@ -175,10 +398,6 @@ unsigned int	calc_duty(unsigned int high, unsigned int low);							// calculates
 int main() {
 
 	XStatus 		status;
-	u16				sw, oldSw =0xFFFF;				// 0xFFFF is invalid --> makes sure the PWM freq is updated 1st time
-	int				rotcnt, oldRotcnt = 0x1000;	
-	bool			done = false;
-	bool 			hw_switch = 0;
 	
 	init_platform();
 
@@ -201,7 +420,13 @@ int main() {
 	pwm_freq = INITIAL_FREQUENCY;
 	pwm_duty = INITIAL_DUTY_CYCLE;
 	clkfit = 0;
+	hwdet_k = 0;
+	gpio_out_bits = 0;
 	new_perduty = false;
+	done = false;
+	hw_switch = 0;
+	measure_restart = true;
+	CALIB_Initialize(NULL);
 	
 	// start the PWM timer and kick of the processing by enabling the Microblaze interrupt
 
@@ -209,137 +434,67 @@ int main() {
 	PWM_Start(&PWMTimerInst);
 	microblaze_enable_interrupts();
 	
+#if TELEM_ENABLE
+	// console output goes through the interrupt driven telemetry stream from here on
+
+	TELEM_Initialize(TELEM_UART_BASEADDR);
+#endif
+
+	// from now on the display is only written through the framebuffer.  Clearing it waits
+	// for the LCD, so do it with the interrupts enabled
+
+	LCDFB_Initialize(PMDIO_BASEADDR);
+
 	// display the greeting   
 
-	PMDIO_LCD_setcursor(1,0);
-	PMDIO_LCD_wrstring("ECE544 Project 1");
-	PMDIO_LCD_setcursor(2,0);
-	PMDIO_LCD_wrstring(" by Rehan Iqbal ");
+	LCDFB_SetCursor(1,0);
+	LCDFB_WrString("ECE544 Project 1");
+	LCDFB_SetCursor(2,0);
+	LCDFB_WrString(" by Rehan Iqbal ");
+	LCDFB_Flush();
 	NX4IO_setLEDs(0x0000FFFF);
-	delay_msecs(2000);
-	NX4IO_setLEDs(0x00000000);
-		
-   // write the static text to the display
 
-	PMDIO_LCD_clrd();
-	PMDIO_LCD_setcursor(1,0);
-	PMDIO_LCD_wrstring("G|FR:    DCY:  %");
-	PMDIO_LCD_setcursor(2,0);
-	PMDIO_LCD_wrstring("D|FR:    DCY:  %");
+	// the tasks of the scheduler do the rest of the work, highest priority first.  The
+	// greeting is shown for SPLASH_MSEC, then end_splash() starts the input & display tasks
 
-	// turn off the LEDs and clear the seven segment display
+	SWTIMER_Initialize((u32) timestamp);
+	SCHED_Initialize(&timestamp, FIT_BottomHalf);
 
-	NX4IO_setLEDs(0x00000000);
-	NX410_SSEG_setAllDigits(SSEGLO, CC_BLANK, CC_BLANK, CC_BLANK, CC_BLANK, DP_NONE);
-	NX410_SSEG_setAllDigits(SSEGHI, CC_BLANK, CC_BLANK, CC_BLANK, CC_BLANK, DP_NONE);
+	SCHED_AddTask(&pwm_task, "pwm", 0, 0, PWM_DEADLINE_MSEC, set_pwm, NULL);
+	SCHED_AddTask(&input_task, "input", 1, INPUT_CHECK_MSEC, INPUT_CHECK_MSEC, scan_inputs, NULL);
+	SCHED_AddTask(&measure_task, "measure", 2, MEASURE_MSEC, MEASURE_MSEC, measure_tick, NULL);
+	SCHED_AddTask(&display_task, "display", 3, DISPLAY_MSEC, DISPLAY_MSEC, display_tick, NULL);
+#if TELEM_ENABLE
+	SCHED_AddTask(&telem_task, "telemetry", 4, TELEMETRY_MSEC, TELEMETRY_MSEC, telem_tick, NULL);
+	SCHED_Start(&telem_task, TELEMETRY_MSEC);
+#endif
+
+	SWTIMER_Start(&splash_timer, SPLASH_MSEC, 0, end_splash, NULL);
 	  
 	// main loop
 
 	do	{ 
 		
-		// check rotary encoder pushbutton to see if it's time to quit
-		
-		if (PMDIO_ROT_isBtnPressed()) {
-			done = true;
+#if MAIN_LOOP_EVENT_DRIVEN
+		// sleep until FIT_Handler() wakes us up (see idle.h).  main_wake is in local
+		// memory, so checking it makes no bus transactions.  An interrupt that lands
+		// between the check and the sleep leaves the core asleep until the next FIT
+		// interrupt, 25 usec later
+
+		while (!main_wake) {
+			WAIT_FOR_INTERRUPT();
 		}
 
-		else {
-			
-			new_perduty = false;
-			
-			// get the switches and mask out all but the switches that determine the PWM timer frequency
-			
-			sw &= PWM_FREQ_MSK;
-			sw = NX4IO_getSwitches();
-			
-			if (sw != oldSw) {	 
-				
-				// check the status of sw[2:0] and assign appropriate PWM output frequency
-
-				switch (sw & 0x07) {
-					
-					case 0x00:	pwm_freq = PWM_FREQ_100HZ;	break;
-					case 0x01:	pwm_freq = PWM_FREQ_1KHZ;	break;
-					case 0x02:	pwm_freq = PWM_FREQ_10KHZ;	break;
-					case 0x03:	pwm_freq = PWM_FREQ_50KHZ;	break;
-					case 0x04:	pwm_freq = PWM_FREQ_100KHZ;	break;
-					case 0x05:	pwm_freq = PWM_FREQ_500KHZ;	break;
-					case 0x06:	pwm_freq = PWM_FREQ_1MHZ;	break;
-					case 0x07:	pwm_freq = PWM_FREQ_5MHZ;	break;
-
-				}
-				
-				// check the status of sw[3] and assign to global variable
-
-				hw_switch = (sw & 0x08);
-
-				// update global variable indicating there are new changes
-
-				oldSw = sw;
-				new_perduty = true;
-			}
-		
-			// read rotary count and handle duty cycle changes
-			// limit duty cycle to 0% to 99%
-			
-			PMDIO_ROT_readRotcnt(&rotcnt);
-
-			if (rotcnt != oldRotcnt) {
-				
-				// show the rotary count in hex on the seven segment display
-				
-				NX4IO_SSEG_putU16Hex(SSEGLO, rotcnt);
-
-				// change the duty cycle
-				
-				pwm_duty = MAX(1, MIN(rotcnt, 99));
-				oldRotcnt = rotcnt;
-				new_perduty = true;
-			}
-
-			// update generated frequency and duty cycle	
-			
-			if (new_perduty) {
-				
-				u32 			freq, 
-								dutycycle;
-
-				unsigned int 	detect_freq = 0x00;
-				unsigned int 	detect_duty = 0x00;
-			
-				// set the new PWM parameters - PWM_SetParams stops the timer
-				
-				status = PWM_SetParams(&PWMTimerInst, pwm_freq, pwm_duty);
-				
-				if (status == XST_SUCCESS) {
-					
-					PWM_GetParams(&PWMTimerInst, &freq, &dutycycle);
-
-					update_lcd(freq, dutycycle, 1);
-
-					// check if sw[3] is high or low (HWDET / SWDET)
-					// pass functions different args depending on which mode is selected
-
-					if (hw_switch) {
-
-						detect_freq = calc_freq(hw_high_count, hw_low_count, hw_switch);
-						detect_duty = calc_duty(hw_high_count, hw_low_count);
-					}
-
-					else {
-
-						detect_freq = calc_freq(sw_high_count, sw_low_count, hw_switch);
-						detect_duty = calc_duty(sw_high_count, sw_low_count);
-					}
+		main_wake = false;
+#endif
 
-					// update the LCD display with detected frequency & duty cycle
+		// do the work the FIT interrupt handler left for us (the scheduler calls
+		// FIT_BottomHalf() before every task) and run the tasks that are ready
 
-					update_lcd(detect_freq, detect_duty, 2);
-										
-					PWM_Start(&PWMTimerInst);
-				}
-			}
-		}
+		SCHED_Run();
+#if !MAIN_LOOP_EVENT_DRIVEN
+		SPIN_WAIT();
+#endif
 
 	} while (!done);
 	
@@ -353,10 +508,10 @@ int main() {
 
 	xil_printf("\nThat's All Folks!\n\n");
 	
-	PMDIO_LCD_setcursor(1,0);
-	PMDIO_LCD_wrstring("That's All Folks");
-	PMDIO_LCD_setcursor(2,0);
-	PMDIO_LCD_wrstring("                ");
+	LCDFB_Clear();
+	LCDFB_SetCursor(1,0);
+	LCDFB_WrString("That's All Folks");
+	LCDFB_Flush();
 	
 	NX410_SSEG_setAllDigits(SSEGHI, CC_BLANK, CC_B, CC_LCY, CC_E, DP_NONE);
 	NX410_SSEG_setAllDigits(SSEGLO, CC_B, CC_LCY, CC_E, CC_BLANK, DP_NONE);
@@ -365,7 +520,9 @@ int main() {
 
 	// turn the lights out
 
-	PMDIO_LCD_clrd();
+	LCDFB_Clear();
+	LCDFB_Flush();
+	LCDFB_Sync();
 	NX410_SSEG_setAllDigits(SSEGHI, CC_BLANK, CC_BLANK, CC_BLANK, CC_BLANK, DP_NONE);
 	NX410_SSEG_setAllDigits(SSEGLO, CC_BLANK, CC_BLANK, CC_BLANK, CC_BLANK, DP_NONE);
 
@@ -428,11 +585,18 @@ int do_init(void) {
 		return XST_FAILURE;
 	}
 
+	status = XGpio_Initialize(&GPIOInst2, GPIO_2_DEVICE_ID);
+	
+	if (status != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+
 	// GPIO_0 channel 1 is an 8-bit input port.  bit[7:1] = reserved, bit[0] = PWM output (for duty cycle calculation)
-	// GPIO_0 channel 2 is an 8-bit output port.  bit[7:1] = reserved, bit[0] = FIT clock
+	// GPIO_0 channel 2 is an 8-bit output port.  bit[7:4] = hw_detect accumulation exponent, bit[3:2] = reserved,
+	// bit[1] = hw_detect gated counter select, bit[0] = FIT clock
 
 	XGpio_SetDataDirection(&GPIOInst0, GPIO_0_INPUT_CHANNEL, 0xFF);
-	XGpio_SetDataDirection(&GPIOInst0, GPIO_0_OUTPUT_CHANNEL, 0xFE);
+	XGpio_SetDataDirection(&GPIOInst0, GPIO_0_OUTPUT_CHANNEL, 0x0C);
 
 	// GPIO_1 channel 1 is a 32-bit input port - used to pass hw_detect 'high' count to application
 	// GPIO_1 channel 2 is an 8-bit output port - used to pass hw_detect 'low' count to application
@@ -440,6 +604,11 @@ int do_init(void) {
 	XGpio_SetDataDirection(&GPIOInst1, GPIO_1_HIGH_COUNT, 0xFFFFFFFF);
 	XGpio_SetDataDirection(&GPIOInst1, GPIO_1_LOW_COUNT, 0xFFFFFFFF);
 
+	// GPIO_2 channel 1 is a 32-bit output port (statistics command), channel 2 a 32-bit input port
+	// (selected statistics register).  HWSTATS_Initialize() sets the directions
+
+	HWSTATS_Initialize(&HWStatsInst, &GPIOInst2);
+
 	// initialize the PWM timer/counter instance but do not start it
 	// do not enable PWM interrupts.  Clock frequency is the AXI clock frequency
 	
@@ -448,6 +617,17 @@ int do_init(void) {
 	if (status != XST_SUCCESS) {
 		return XST_FAILURE;
 	}
+
+#if SW_DETECT_CAPTURE || PROFILE_ENABLE
+	// initialize the edge capture timer/counter.  It is started below, once its
+	// interrupt handler is connected.  The profiler uses its counter as a clock
+
+	status = SWDET_Initialize(&SWDetInst, SWDET_TIMER_DEVICE_ID, SWDET_TIMER_CLOCK_FREQ_HZ);
+
+	if (status != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+#endif
 	
 	// initialize the interrupt controller
 	
@@ -464,6 +644,27 @@ int do_init(void) {
 	if (status != XST_SUCCESS) {
 		return XST_FAILURE;
 	}
+
+#if SW_DETECT_CAPTURE
+	// connect the edge capture interrupt handler.  The capture interrupt is only
+	// enabled while a measurement is armed (by the FIT interrupt handler)
+
+	status = XIntc_Connect(&IntrptCtlrInst, SWDET_INTERRUPT_ID, (XInterruptHandler)SWDET_InterruptHandler, &SWDetInst);
+
+	if (status != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+#endif
+
+#if TELEM_ENABLE
+	// connect the UART-Lite interrupt handler.  It sends the telemetry stream
+
+	status = XIntc_Connect(&IntrptCtlrInst, TELEM_INTERRUPT_ID, (XInterruptHandler)TELEM_InterruptHandler, (void *)0);
+
+	if (status != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+#endif
  
 	// start the interrupt controller such that interrupts are enabled for
 	// all devices that cause interrupts
@@ -478,6 +679,35 @@ int do_init(void) {
 
 	XIntc_Enable(&IntrptCtlrInst, FIT_INTERRUPT_ID);
 
+#if SW_DETECT_CAPTURE
+	// enable the edge capture interrupt
+
+	XIntc_Enable(&IntrptCtlrInst, SWDET_INTERRUPT_ID);
+#endif
+
+#if TELEM_ENABLE
+	// enable the UART-Lite interrupt
+
+	XIntc_Enable(&IntrptCtlrInst, TELEM_INTERRUPT_ID);
+#endif
+
+#if SW_DETECT_CAPTURE || PROFILE_ENABLE
+	// start capturing.  The counters count up from here on
+
+	SWDET_Start(&SWDetInst);
+#endif
+
+#if PROFILE_ENABLE
+	// time the profiled regions with the counter of timer 0 of axi_timer_1
+
+	status = PROFILE_Initialize(SWDetInst.TmrCtr.BaseAddress, SWDET_RISE_TIMER, SWDET_TIMER_CLOCK_FREQ_HZ,
+								prof_names, PROF_NUM_REGIONS);
+
+	if (status != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+#endif
+
 	// set the duty cycles for RGB1.  The channels will be enabled/disabled
 	// in the FIT interrupt handler.  Red and Blue make purple
 
@@ -497,6 +727,8 @@ global "timestamp" which is incremented every msec by FIT_Handler().
 
 Assumes that this loop is running faster than the fit_interval ISR 
 
+With MAIN_LOOP_EVENT_DRIVEN the loop sleeps until the FIT interrupt sets main_wake and runs FIT_BottomHalf() once a msec
+
 If your program seems to hang it could be because the function never returns
 Possible causes for this are almost certainly related to the FIT timer.  Check
 your connections...is the timer clocked?  is it stuck in reset?  is the interrupt 
@@ -516,195 +748,1316 @@ void delay_msecs(unsigned int msecs) {
 
 	while (timestamp != target)
 	{
-		// spin until delay is over
+		// spin until delay is over, doing the FIT work in the meantime
+#if MAIN_LOOP_EVENT_DRIVEN
+		while (!main_wake) {
+			WAIT_FOR_INTERRUPT();
+		}
+
+		main_wake = false;
+#else
+		SPIN_WAIT();
+#endif
+		FIT_BottomHalf();
 	}
 }
  
 /****************************************************************************/
 
-/* update_lcd - update the frequency/duty cycle LCD display
- 
-writes the frequency and duty cycle to the specified line.  Assumes the
-static portion of the display is already written and the format of each
-line of the display is the same.
-
-freq is the  PWM frequency to be displayed
+/* end_splash - ends the greeting (splash_timer handler)
 
-dutycycle is the PWM duty cycle to be displayed
-
-linenum is the line (1 or 2) in the display to update
+Writes the static text to the display, turns off the LEDs, clears the seven segment display
+and starts reading the switches, the buttons and the rotary encoder
 
 */
 
-void update_lcd(int freq, int dutycycle, u32 linenum) {
+void end_splash(void *unused) {
 
-	PMDIO_LCD_setcursor(linenum, 5);
-	PMDIO_LCD_wrstring("    ");
-	PMDIO_LCD_setcursor(linenum, 5);
+	// write the static text to the display
 
-	// write the frequency 
-
-	if (freq < 1000) {								// display Hz if frequency < 1KHz
-		PMDIO_LCD_putnum(freq, 10);
-	}
+	LCDFB_Clear();
+	LCDFB_SetCursor(1,0);
+	LCDFB_WrString("G|F:     D:    %");
+	LCDFB_SetCursor(2,0);
+	LCDFB_WrString("D|F:     D:    %");
+	LCDFB_Flush();
 
-	else if (freq < 1000000) {						// display Hz if frequency < 1MHz
-		PMDIO_LCD_putnum((freq / 1000), 10);
-		PMDIO_LCD_wrstring("K");
-	}
+	// turn off the LEDs and clear the seven segment display
 
-	else {											// otherwise, use the MHz suffix
-		PMDIO_LCD_putnum((freq / 1000000), 10);
-		PMDIO_LCD_wrstring("M");
-	}
+	NX4IO_setLEDs(0x00000000);
+	NX410_SSEG_setAllDigits(SSEGLO, CC_BLANK, CC_BLANK, CC_BLANK, CC_BLANK, DP_NONE);
+	NX410_SSEG_setAllDigits(SSEGHI, CC_BLANK, CC_BLANK, CC_BLANK, CC_BLANK, DP_NONE);
 
-	// write the duty cycle
+	// the first scan sees new switch settings and releases the PWM task, which sets the
+	// PWM and line 1 of the display and starts the measurement
 
-	PMDIO_LCD_setcursor(linenum, 13);
-	PMDIO_LCD_wrstring("  %");
-	PMDIO_LCD_setcursor(linenum, 13);
-	PMDIO_LCD_putnum(dutycycle, 10);
+	SCHED_Start(&input_task, 1);
+	SCHED_Start(&display_task, DISPLAY_MSEC);
 }
 
-/**************************** INTERRUPT HANDLERS ******************************/
 
-/* FIT_Handler - Fixed interval timer interrupt handler 
-  
-updates the global "timestamp" every millisecond.  "timestamp" is used for the delay_msecs() function
-and as a time stamp for data collection and reporting.  Toggles the FIT clock which can be used as a visual
-indication that the interrupt handler is being called.  Also makes RGB1 a PWM duty cycle indicator
+/* scan_inputs - reads the switches, the buttons and the rotary encoder (input task)
 
-ECE 544 students - When you implement your software solution for pulse width detection in
-Project 1 this could be a reasonable place to do that processing.
+Runs every INPUT_CHECK_MSEC.  Sets "done" when the rotary encoder button is pressed, takes the
+PWM frequency, hw_switch and the duty cycle from the switches and the encoder, runs the button
+commands and releases the PWM task when the settings change.  The sweep and the calculation
+benchmark run in this task, so every task misses its deadlines while they run
 
 */
 
-void FIT_Handler(void) {
-		
-	static	unsigned int	ts_interval = 0;			// interval counter for incrementing timestamp
-	static 	unsigned int	debug_count = 0; 			// counter used for debugging GPIO read
+void scan_inputs(void *unused) {
 
-	static 	unsigned int	count = 0;					// used for sw counting high & low intervals
+	static u16		sw, oldSw = 0xFFFF;			// 0xFFFF is invalid --> makes sure the PWM freq is updated 1st time
+	static int		rotcnt, oldRotcnt = 0x1000;
+	bool			btnc;						// BTNC prints the profile and the LCD traffic
+	bool			btnu;						// BTNU runs the sweep
+	static bool		oldBtnc = false, oldBtnu = false;
+#if PROFILE_ENABLE
+	bool			btnd;						// BTND times the frequency & duty cycle calculations
+	static bool		oldBtnd = false;
+#endif
 
-	static 	bool		 	prev_pwm = 0; 				// boolean to store previous PWM value (high / low)
-	static 	bool		 	curr_pwm = 0; 				// boolean to store current PWM value (high / low)
+	// check rotary encoder pushbutton to see if it's time to quit
+	
+	if (PMDIO_ROT_isBtnPressed()) {
+		done = true;
+	}
+
+	else {
+		
+		// get the switches and mask out all but the switches that determine the PWM timer frequency
+		
+		sw &= PWM_FREQ_MSK;
+		sw = NX4IO_getSwitches();
+		
+		if (sw != oldSw) {	 
+			
+			// check the status of sw[2:0] and assign appropriate PWM output frequency
 
-	// toggle FIT clock
+			switch (sw & 0x07) {
+				
+				case 0x00:	pwm_freq = PWM_FREQ_100HZ;	break;
+				case 0x01:	pwm_freq = PWM_FREQ_1KHZ;	break;
+				case 0x02:	pwm_freq = PWM_FREQ_10KHZ;	break;
+				case 0x03:	pwm_freq = PWM_FREQ_50KHZ;	break;
+				case 0x04:	pwm_freq = PWM_FREQ_100KHZ;	break;
+				case 0x05:	pwm_freq = PWM_FREQ_500KHZ;	break;
+				case 0x06:	pwm_freq = PWM_FREQ_1MHZ;	break;
+				case 0x07:	pwm_freq = PWM_FREQ_5MHZ;	break;
 
-	clkfit ^= 0x01;
-	XGpio_DiscreteWrite(&GPIOInst0, GPIO_0_OUTPUT_CHANNEL, clkfit);	
+			}
+			
+			// check the status of sw[3] and assign to global variable
 
-	// update timestamp	
+			hw_switch = (sw & 0x08);
 
-	ts_interval++;	
+			// update global variable indicating there are new changes
 
-	if (ts_interval > FIT_COUNT_1MSEC) {
-		timestamp++;
-		ts_interval = 1;
-	}
+			oldSw = sw;
+			new_perduty = true;
+		}
+	
+		// print the profile and the LCD traffic on the console when BTNC is pressed
+
+		btnc = NX4IO_isPressed(BTNC);
+
+		if (btnc && !oldBtnc) {
+
+			LCDFB_Stats		lcd_stats;
+#if TELEM_ENABLE
+			TELEM_Stats		telem_stats;
+#endif
+
+#if PROFILE_ENABLE
+			PROFILE_Dump();
+#endif
+			LCDFB_GetStats(&lcd_stats);
+			xil_printf("LCD: %d updates, %d bytes sent (last update %d chars), %d replaced, %d overflows\n",
+				lcd_stats.Flushes, lcd_stats.Bytes, lcd_stats.LastChars, lcd_stats.Replaced,
+				lcd_stats.Overflows);
+#if TELEM_ENABLE
+			TELEM_GetStats(&telem_stats);
+			xil_printf("TELEM: %d records, %d dropped, %d text bytes, ring max %d bytes\n",
+				telem_stats.Records, telem_stats.Drops, telem_stats.TextBytes, telem_stats.MaxUsed);
+#endif
+			print_hwstats();
+			print_swtimer();
+			SCHED_Dump();
+		}
 
-	// Use an RGB LED (RGB1) as a PWM duty cycle indicator
-	// we can read the current state of PWM out on GPIO[0] because we
-	// fed it back around in the top level of our hardware design.
-	// Note that this won't work well as the PWM frequency approaches
-	// or exceeds 10KHz
+		oldBtnc = btnc;
 
-	gpio_in = XGpio_DiscreteRead(&GPIOInst0, GPIO_0_INPUT_CHANNEL);
-	curr_pwm = (gpio_in & 0x00000001);
+		// run the sweep when BTNU is pressed, then go back to the settings from the
+		// switches and the rotary encoder
 
-	// use tri-color LED RGB1 as an indicator of PWM duty
-	// this will breakdown at higher frequencies (e.g. higher than 10kHz)
+		btnu = NX4IO_isPressed(BTNU);
 
-	if (curr_pwm) {
+		if (btnu && !oldBtnu) {
+			sweep();
+			btnu = NX4IO_isPressed(BTNU);
+			new_perduty = true;
+		}
 
-		NX4IO_RGBLED_setChnlEn(RGB1, true, true, true);
-	} 
+		oldBtnu = btnu;
 
-	else {
+#if PROFILE_ENABLE
+		// time the frequency & duty cycle calculations when BTND is pressed
 
-		NX4IO_RGBLED_setChnlEn(RGB1, false, false, false);
-	}
+		btnd = NX4IO_isPressed(BTND);
 
-	// update HWDET high & low counts by reading GPIO
+		if (btnd && !oldBtnd) {
+			bench_calc();
+		}
 
-	hw_high_count = XGpio_DiscreteRead(&GPIOInst1, GPIO_1_HIGH_COUNT);
-	hw_low_count  = XGpio_DiscreteRead(&GPIOInst1, GPIO_1_LOW_COUNT);
+		oldBtnd = btnd;
+#endif
 
-	// update the SWDET high & low counts through state machine
-	// this detect low-to-high and high-to-low transitions
-	// then places the count into one of two registers
+		// read rotary count and handle duty cycle changes
+		// limit duty cycle to 0% to 99%
+		
+		PMDIO_ROT_readRotcnt(&rotcnt);
 
-	if (curr_pwm) {
+		if (rotcnt != oldRotcnt) {
+			
+			// show the rotary count in hex on the seven segment display
+			
+			NX4IO_SSEG_putU16Hex(SSEGLO, rotcnt);
 
-		if (curr_pwm != prev_pwm) {
-			sw_low_count = count;
-			prev_pwm = curr_pwm;
-			count = 0;
+			// change the duty cycle
+			
+			pwm_duty = MAX(1, MIN(rotcnt, 99));
+			oldRotcnt = rotcnt;
+			new_perduty = true;
 		}
 
-		else {
-			count += 1;
+		// new settings are applied by the PWM task, which has the highest priority
+
+		if (new_perduty) {
+			SCHED_Release(&pwm_task);
 		}
 	}
+}
 
-	else {
 
-		if (curr_pwm != prev_pwm) {
-			sw_high_count = count;
-			prev_pwm = curr_pwm;
-			count = 0;
-		}
+/* set_pwm - applies new PWM settings (PWM task)
 
-		else {
-			count += 1;
-			}
+Released by the input task when the switches or the rotary encoder change (new_perduty).
+Sets the PWM, writes the settings to line 1 of the LCD, starts the measurement over and
+starts a new interval of the hw_detect statistics
+
+*/
+
+void set_pwm(void *unused) {
+
+	XStatus 		status;
+	u32 			freq, 
+					dutycycle;
+
+	// set the new PWM parameters - PWM_SetParams stops the timer,
+	// PWM_UpdateParams changes them at the next period boundary
+	
+#if PWM_GLITCH_FREE_UPDATE
+	PROFILE_CALL(PROF_PWM_SETPARAMS, status = PWM_UpdateParams(&PWMTimerInst, pwm_freq, pwm_duty));
+#else
+	PROFILE_CALL(PROF_PWM_SETPARAMS, status = PWM_SetParams(&PWMTimerInst, pwm_freq, pwm_duty));
+#endif
+	
+	if (status == XST_SUCCESS) {
+		
+		PWM_GetParams(&PWMTimerInst, &freq, &dutycycle);
+
+		update_lcd((u64) freq * MEAS_FREQ_SCALE, dutycycle * 100, 1);
+
+		// start the measurement of the new settings over and center the period
+		// histogram on the new period (1 clock bins) from a fresh interval
+
+		SCHED_Start(&measure_task, MEASURE_MSEC);
+		measure_restart = true;
+
+		if (HWSTATS_Configure(&HWStatsInst, PWMTimerInst.Tlr0 + 2, 0) == XST_SUCCESS) {
+			HWSTATS_Snapshot snap;
+
+			HWSTATS_TakeSnapshot(&HWStatsInst, &snap);
 		}
 
-	// debugging counts through terminal statements every ~ 3 sec:
+#if !PWM_GLITCH_FREE_UPDATE
+		PWM_Start(&PWMTimerInst);
+#endif
+	}
+
+	new_perduty = false;
+}
+
 
-/*	debug_count++;
+/* measure_tick - samples the detector and publishes the filtered reading (measure task)
 
-	if (debug_count == 120000) {
+Runs every MEASURE_MSEC, restarted by the PWM task.  The first sample after new PWM settings
+starts the filter over
 
-		xil_printf("sw high count: %d \n", sw_high_count);
-		xil_printf("sw low count: %d \n\n", sw_low_count);
-		debug_count = 0;
-	}*/
+*/
+
+void measure_tick(void *unused) {
+
+	measure(hw_switch, measure_restart);
+	measure_restart = false;
 }
 
-/****************************************************************************/
 
-/* 	calc_freq - calculates frequency given counts for high & low intervals
- 	
- 	depending on sw[3] state, will use either CPU clock frequency or FIT Timer frequency
- 	uses integer math only, so there may be some rounding error
+/* display_tick - writes the filtered reading to line 2 of the LCD (display task)
+
+Runs every DISPLAY_MSEC.  The LCD is written through the framebuffer, FIT_BottomHalf() sends
+the characters that changed
+
 */
 
-unsigned int calc_freq(unsigned int high, unsigned int low, bool hw_switch) {
+void display_tick(void *unused) {
 
-	unsigned int sum;
-	unsigned int frq;
+	// a saturated HWDET pair is no reading - show that the PWM is out of range
 
-	sum = (high + 1) + (low + 1);
-	frq = hw_switch ? (CPU_CLOCK_FREQ_HZ / sum) : (FIT_CLOCK_FREQ_HZ / sum);
+	if (meas_saturated) {
+		LCDFB_SetCursor(2, 4);
+		LCDFB_WrString(MEAS_RANGE_TEXT);
+		LCDFB_SetCursor(2, 11);
+		LCDFB_WrString("  --");
+		LCDFB_Flush();
+	}
 
-	return frq;
-};
+	else {
+		update_lcd(meas_freq, meas_duty, 2);
+	}
+}
 
-/****************************************************************************/
 
-/* 	calc_duty - calculates duty cycle given counts for high & low intervals
- 
-  	uses integer math only, so there may be some rounding error
+#if TELEM_ENABLE
+/* telem_tick - sends a telemetry record (telemetry task)
+
+Runs every TELEMETRY_MSEC
+
 */
 
-unsigned int calc_duty(unsigned int high, unsigned int low) {
+void telem_tick(void *unused) {
 
-	unsigned int sum;
-	unsigned int duty;
+	send_telemetry(hw_switch);
+}
+#endif
 
-	sum = (high + 1) + (low + 1);
-	duty = (100 * (high + 1)) / sum;
 
-	return duty;
-};
\ No newline at end of file
+/* print_swtimer - prints the statistics of the timer service
+
+The overhead is the time the timer service spends per msec tick, without the handlers and
+the profiler clock reads (0 without PROFILE_ENABLE).  In hostsim it is bus time only
+
+*/
+
+void print_swtimer(void) {
+
+	SWTIMER_Stats	stats;
+
+	SWTIMER_GetStats(&stats);
+	xil_printf("SWTIMER: %d ticks, %d handlers called, %d timers active, overhead mean %d max %d clocks/tick, max lag %d msec, %d overruns\n",
+		stats.Ticks, stats.Fired, stats.Active,
+		(stats.Ticks != 0) ? (u32) (stats.OverheadSum / stats.Ticks) : 0, stats.OverheadMax,
+		stats.MaxLag, stats.Overruns);
+}
+
+
+/* update_lcd - update the frequency/duty cycle LCD display
+ 
+writes the frequency and duty cycle to the specified line.  Assumes the
+static portion of the display is already written and the format of each
+line of the display is the same.  The line is drawn in the LCD framebuffer and
+only the characters that changed are queued for the LCD.  Does not wait for the LCD.
+
+freq is the  PWM frequency to be displayed (mHz)
+
+dutycycle is the PWM duty cycle to be displayed (0.01%)
+
+linenum is the line (1 or 2) in the display to update
+
+*/
+
+void update_lcd(u64 freq, u32 dutycycle, u32 linenum) {
+
+	u32		hz;										// frequency rounded to Hz
+	u32		unit;									// Hz per displayed unit
+	u32		tenths;									// frequency (duty cycle) in tenths of a unit (percent)
+	char	*suffix;								// unit suffix
+
+	PROFILE_BEGIN(PROF_UPDATE_LCD);
+
+	LCDFB_SetCursor(linenum, 4);
+	LCDFB_WrString("    ");
+	LCDFB_SetCursor(linenum, 4);
+
+	// write the frequency rounded to the resolution of the 4 character field
+	// (e.g. 9.99, 10.0, 999, 1.0K, 12K, 4.9M, 10M)
+
+	if (freq < 9995) {								// two decimals below 9.995 Hz
+		LCDFB_PutNum((u32) freq / 1000, 10);
+		LCDFB_WrString(".");
+		tenths = (((u32) freq % 1000) + 5) / 10;	// hundredths
+		LCDFB_PutNum(tenths / 10, 10);
+		LCDFB_PutNum(tenths % 10, 10);
+	}
+
+	else if (freq < 99950) {						// one decimal below 99.95 Hz
+		tenths = ((u32) freq + 50) / 100;
+		LCDFB_PutNum(tenths / 10, 10);
+		LCDFB_WrString(".");
+		LCDFB_PutNum(tenths % 10, 10);
+	}
+
+	else {
+
+		hz = (u32) ((freq + (MEAS_FREQ_SCALE / 2)) / MEAS_FREQ_SCALE);
+
+		if (hz < 1000) {							// display Hz if frequency < 1KHz
+			LCDFB_PutNum(hz, 10);
+		}
+
+		else {
+
+			if (hz < 999500) {						// use the KHz suffix if frequency < 1MHz
+				unit = 1000;
+				suffix = "K";
+			}
+
+			else {									// otherwise, use the MHz suffix
+				unit = 1000000;
+				suffix = "M";
+			}
+
+			if (hz < (unit / 100) * 995) {			// one decimal below 9.95 units
+				tenths = (hz + (unit / 20)) / (unit / 10);
+				LCDFB_PutNum(tenths / 10, 10);
+				LCDFB_WrString(".");
+				LCDFB_PutNum(tenths % 10, 10);
+			}
+
+			else {
+				LCDFB_PutNum((hz + (unit / 2)) / unit, 10);
+			}
+
+			LCDFB_WrString(suffix);
+		}
+	}
+
+	// write the duty cycle to 0.1% (e.g. 5.3, 50.0, 100)
+
+	LCDFB_SetCursor(linenum, 11);
+	LCDFB_WrString("    ");
+	LCDFB_SetCursor(linenum, 11);
+
+	tenths = (dutycycle + 5) / 10;
+
+	if (tenths >= 1000) {
+		LCDFB_PutNum(tenths / 10, 10);
+	}
+
+	else {
+		LCDFB_PutNum(tenths / 10, 10);
+		LCDFB_WrString(".");
+		LCDFB_PutNum(tenths % 10, 10);
+	}
+
+	// send what changed to the LCD
+
+	PROFILE_CALL(PROF_LCD_FLUSH, LCDFB_Flush());
+
+	PROFILE_END(PROF_UPDATE_LCD);
+}
+
+/****************************************************************************/
+
+/* measure - samples the selected detector and publishes the filtered result
+
+takes the high & low counts of the detector selected by sw[3] as FIT_BottomHalf() last refreshed them,
+converts them to a frequency (mHz) and duty cycle (0.01%) with meas.c, corrects those with the detector
+calibration (calib.c) and adds them to an exponential moving average (each sample
+weighs 1/2^MEASURE_FILTER_SHIFT).  The filtered result is published in meas_freq & meas_duty for
+the display task (line 2 of the LCD) and, when it changes, reported on the console with the error bound and the method of the last sample.
+A saturated HWDET pair gets the error bound MEAS_ERR_OUT_OF_RANGE and, unless the gated count replaces it,
+is published as out of range (meas_saturated).  The filter starts over when a pair saturates or stops saturating.
+
+hw_switch selects the detector (true = HWDET, false = SWDET)
+
+restart starts the filter over with this sample (use it after the PWM parameters change)
+
+*/
+
+void measure(bool hw_switch, bool restart) {
+
+	static	u64				freq_acc = 0;				// filtered frequency * 2^MEASURE_FILTER_SHIFT
+	static	u32				duty_acc = 0;				// filtered duty cycle * 2^MEASURE_FILTER_SHIFT
+	static	u64				shown_freq = 0;				// last frequency reported on the console
+	static	u32				shown_duty = 0;				// last duty cycle reported on the console
+	static	bool			was_saturated = false;		// the last sample was out of range
+
+	u64				detect_freq;						// mHz
+	u32				detect_duty;						// 0.01%
+	unsigned int	detect_err;							// bound on the relative error of detect_freq (ppm)
+	bool			detect_gated = false;				// detect_freq is from the gated counter
+	bool			detect_saturated = false;			// the HWDET pair is below the range of hw_detect
+
+	// check if sw[3] is high or low (HWDET / SWDET)
+	// pass functions different args depending on which mode is selected.  FIT_BottomHalf()
+	// runs in this context, so the counts cannot change while they are copied
+
+	if (hw_switch) {
+
+		unsigned int	high, low, k;
+		unsigned int	edges, clocks;
+		unsigned int	gate_err;
+
+		high = hw_high_count;
+		low = hw_low_count;
+		k = hw_accum_k;
+		edges = hw_gate_edges;
+		clocks = hw_gate_clocks;
+
+		detect_freq = MEAS_FreqMilliHz(CPU_CLOCK_FREQ_HZ, high, low, k);
+		detect_duty = MEAS_DutyHundredths(high, low, k);
+		detect_saturated = HWDET_IsSaturated(high, low);
+		detect_err = detect_saturated ? MEAS_ERR_OUT_OF_RANGE : calc_error_ppm(high + low + (2 << k));
+
+		// correct the systematic error of the period counts
+
+		detect_duty = CALIB_Duty(CALIB_DET_HW, detect_freq, detect_duty);
+		detect_freq = CALIB_Freq(CALIB_DET_HW, detect_freq);
+
+		// the period counts are off by at most one clock, the gated count by at
+		// most one edge - use whichever gives the smaller error bound
+
+		gate_err = calc_error_ppm(edges);
+
+		if ((clocks != 0) && (gate_err < detect_err)) {
+			detect_freq = MEAS_GateFreqMilliHz(CPU_CLOCK_FREQ_HZ, edges, clocks);
+			detect_err = gate_err;
+			detect_gated = true;
+			detect_saturated = false;
+		}
+	}
+
+	else {
+
+		unsigned int	high, low;
+
+		high = sw_high_count;
+		low = sw_low_count;
+
+		detect_freq = MEAS_FreqMilliHz(SWDET_CLOCK_FREQ_HZ, high, low, 0);
+		detect_duty = MEAS_DutyHundredths(high, low, 0);
+		detect_duty = CALIB_Duty(CALIB_DET_SW, detect_freq, detect_duty);
+		detect_freq = CALIB_Freq(CALIB_DET_SW, detect_freq);
+#if SW_DETECT_CAPTURE
+		detect_err = calc_error_ppm(high + low + 2);				// each capture is off by up to one timer clock
+#else
+		detect_err = calc_error_ppm((high + low + 2) / 2);		// both intervals are off by up to one FIT tick
+#endif
+	}
+
+	// filter the frequency & duty cycle.  Samples in and out of range are not averaged together
+
+	if (detect_saturated != was_saturated) {
+		restart = true;
+		was_saturated = detect_saturated;
+	}
+
+	if (restart) {
+		freq_acc = detect_freq << MEASURE_FILTER_SHIFT;
+		duty_acc = detect_duty << MEASURE_FILTER_SHIFT;
+	}
+
+	else {
+		freq_acc += detect_freq - (freq_acc >> MEASURE_FILTER_SHIFT);
+		duty_acc += detect_duty - (duty_acc >> MEASURE_FILTER_SHIFT);
+	}
+
+	detect_freq = (freq_acc + ((1 << MEASURE_FILTER_SHIFT) >> 1)) >> MEASURE_FILTER_SHIFT;
+	detect_duty = (duty_acc + ((1 << MEASURE_FILTER_SHIFT) >> 1)) >> MEASURE_FILTER_SHIFT;
+
+	// publish the detected frequency & duty cycle for the display task
+	// and report the method and error bound on the console
+
+	meas_freq = detect_freq;
+	meas_duty = detect_duty;
+	meas_err = detect_err;
+	meas_gated = detect_gated;
+	meas_saturated = detect_saturated;
+
+	if (restart || (detect_freq != shown_freq) || (detect_duty != shown_duty)) {
+		xil_printf("D: %d.%03d Hz +/- %d ppm, duty %d.%02d (%s)\n", (u32) (detect_freq / MEAS_FREQ_SCALE),
+			(u32) (detect_freq % MEAS_FREQ_SCALE), detect_err, detect_duty / 100, detect_duty % 100,
+			detect_gated ? "gated" : (hw_switch ? (detect_saturated ? "period, saturated: out of range" : "period") : "sw period"));
+		shown_freq = detect_freq;
+		shown_duty = detect_duty;
+	}
+}
+
+/****************************************************************************/
+
+/* send_telemetry - sends a telemetry record
+
+sends the PWM settings, the raw HWDET and SWDET counts and the last result of measure() as a
+telemetry record (telem.h).  Does not wait for the UART; a record that does not fit in the
+transmit ring is dropped and counted by telem.c
+
+hw_switch is the detector measure() uses (true = HWDET, false = SWDET)
+
+*/
+
+#if TELEM_ENABLE
+void send_telemetry(bool hw_switch) {
+
+	TELEM_Record	rec;
+	u32				freq, dutycycle;
+
+	PWM_GetParams(&PWMTimerInst, &freq, &dutycycle);
+
+	rec.Timestamp = timestamp;
+	rec.SetFreq = freq;
+	rec.SetDuty = dutycycle;
+	rec.HwHigh = hw_high_count;
+	rec.HwLow = hw_low_count;
+	rec.HwK = hw_accum_k;
+	rec.SwHigh = sw_high_count;
+	rec.SwLow = sw_low_count;
+	rec.DetFreq = (u32) (meas_freq / MEAS_FREQ_SCALE);
+	rec.DetFreqMilli = (u32) (meas_freq % MEAS_FREQ_SCALE);
+	rec.DetDuty = meas_duty;
+	rec.DetErr = meas_err;
+	rec.Flags = (hw_switch ? TELEM_FLAG_HW : 0) | (meas_gated ? TELEM_FLAG_GATED : 0) |
+		(HWDET_IsSaturated(rec.HwHigh, rec.HwLow) ? TELEM_FLAG_SATURATED : 0);
+
+	TELEM_SendRecord(&rec);
+}
+#endif
+
+/****************************************************************************/
+
+/* sweep - runs the frequency/duty cycle sweep benchmark
+
+steps the PWM through every PWM_FREQ_* frequency and, at each, the duty cycles from SWEEP_DUTY_MIN to 99
+in steps of SWEEP_DUTY_STEP.  At every point it waits SWEEP_SETTLE_MSEC and for two new samples of each
+detector (the first ones after a change can still hold counts of the old settings), then takes
+SWEEP_READINGS readings of both detectors, each from a new sample.  A detector that gives no sample
+within SWEEP_TIMEOUT_MSEC is not waited for again at that point.  HWDET readings are from the period
+counts (not the gated count).  The results are printed on the console as a table, one line per point:
+
+	SWP,set_freq,set_duty,pwm_freq,pwm_duty,hw_n,hw_freq,hw_min,hw_max,hw_err,hw_worst,hw_duty,sw_n,...
+
+pwm_freq and pwm_duty are what PWM_GetParams() reads back and the readings are compared with them.
+n is the number of readings (fewer if some timed out), freq the mean frequency, min and max the lowest
+and highest reading (Hz, to 0.001 Hz), err the error of the mean and worst the largest error of a single
+reading (ppm), duty the mean duty cycle in hundredths of a percent.  A point the PWM cannot generate is printed with the status instead.  A summary follows.
+
+The readings in the table are not corrected.  They are added to a characterization run of the detector
+calibration (calib.c), compared with the frequency and the exact duty cycle of the PWM.  When the sweep
+ends (or is stopped) the correction of every frequency range with enough readings is derived and used by
+measure() from then on, and the error of the readings before and after the correction is printed.
+
+The main loop stops while the sweep runs (the FIT work goes on).  Pressing BTNU again stops the sweep.
+Returns true if the sweep ran to the end
+
+*/
+
+bool sweep(void) {
+
+	unsigned int	f, duty, i, det;
+	unsigned int	hw_seen = hw_samples;
+	unsigned int	sw_seen = sw_samples;
+	unsigned int	want;								// detectors still giving samples (bit 0 = HWDET)
+	unsigned int	fresh;								// detectors with a new sample
+	u64				freq;								// one reading (mHz)
+	u32				dutycycle;							// one reading (0.01%)
+	u32				pwm_f, pwm_d;						// readback
+	u32				ref_duty;							// exact duty cycle of the PWM (0.01%)
+	unsigned int	n[2];
+	u64				fmin[2], fmax[2], fsum[2], dsum[2];
+	int				worst[2], err;
+	int				max_err[2] = { 0, 0 };				// largest |error of the mean| of all points
+	unsigned int	points = 0, failed = 0, missing = 0;
+	unsigned long	start = timestamp;
+	bool			btnu = true, stopped = false;
+	int				status;
+
+	xil_printf("SWP,set_freq,set_duty,pwm_freq,pwm_duty,"
+		"hw_n,hw_freq,hw_min,hw_max,hw_err,hw_worst,hw_duty,"
+		"sw_n,sw_freq,sw_min,sw_max,sw_err,sw_worst,sw_duty\n");
+
+	CALIB_Begin();
+
+	for (f = 0; (f < sizeof(pwm_freqs) / sizeof(pwm_freqs[0])) && !stopped; f++) {
+
+		for (duty = SWEEP_DUTY_MIN; (duty <= 99) && !stopped; duty += SWEEP_DUTY_STEP) {
+
+			// stop if BTNU is pressed again
+
+			if (NX4IO_isPressed(BTNU)) {
+				stopped = !btnu;
+			}
+
+			else {
+				btnu = false;
+			}
+
+			points++;
+
+#if PWM_GLITCH_FREE_UPDATE
+			status = PWM_UpdateParams(&PWMTimerInst, pwm_freqs[f], duty);
+#else
+			status = PWM_SetParams(&PWMTimerInst, pwm_freqs[f], duty);
+			if (status == XST_SUCCESS) {
+				PWM_Start(&PWMTimerInst);
+			}
+#endif
+
+			if (status != XST_SUCCESS) {
+				xil_printf("SWP,%d,%d,status %d\n", pwm_freqs[f], duty, status);
+				failed++;
+				continue;
+			}
+
+			PWM_GetParams(&PWMTimerInst, &pwm_f, &pwm_d);
+			update_lcd((u64) pwm_f * MEAS_FREQ_SCALE, pwm_d * 100, 1);
+
+			ref_duty = (u32) (((((u64) PWMTimerInst.Tlr1 + 2) * 10000) + ((PWMTimerInst.Tlr0 + 2) / 2)) /
+				((u64) PWMTimerInst.Tlr0 + 2));
+
+			// let the PWM and the detectors settle
+
+			delay_msecs(SWEEP_SETTLE_MSEC);
+			want = sweep_wait(0x03, &hw_seen, &sw_seen);
+			want = sweep_wait(want, &hw_seen, &sw_seen);
+
+			// take the readings
+
+			for (det = 0; det < 2; det++) {
+				n[det] = 0;
+				fsum[det] = 0;
+				dsum[det] = 0;
+				fmin[det] = ~0ULL;
+				fmax[det] = 0;
+				worst[det] = 0;
+			}
+
+			for (i = 0; i < SWEEP_READINGS; i++) {
+
+				fresh = sweep_wait(want, &hw_seen, &sw_seen);
+				want = fresh;
+
+				for (det = 0; det < 2; det++) {
+
+					if ((fresh & (1 << det)) == 0) {
+						missing++;
+						continue;
+					}
+
+					if (det == CALIB_DET_HW) {
+						freq = MEAS_FreqMilliHz(CPU_CLOCK_FREQ_HZ, hw_high_count, hw_low_count, hw_accum_k);
+						dutycycle = MEAS_DutyHundredths(hw_high_count, hw_low_count, hw_accum_k);
+					}
+
+					else {
+						freq = MEAS_FreqMilliHz(SWDET_CLOCK_FREQ_HZ, sw_high_count, sw_low_count, 0);
+						dutycycle = MEAS_DutyHundredths(sw_high_count, sw_low_count, 0);
+					}
+
+					CALIB_AddReading(det, pwm_f, ref_duty, freq, dutycycle);
+
+					n[det]++;
+					fsum[det] += freq;
+					dsum[det] += dutycycle;
+					fmin[det] = MIN(fmin[det], freq);
+					fmax[det] = MAX(fmax[det], freq);
+
+					err = sweep_ppm(freq, pwm_f);
+					err = (err < 0) ? -err : err;
+					worst[det] = MAX(worst[det], err);
+				}
+			}
+
+			// print the point
+
+			xil_printf("SWP,%d,%d,%d,%d", pwm_freqs[f], duty, pwm_f, pwm_d);
+
+			for (det = 0; det < 2; det++) {
+
+				if (n[det] == 0) {
+					xil_printf(",0,0,0,0,0,0,0");
+					continue;
+				}
+
+				freq = (fsum[det] + (n[det] / 2)) / n[det];
+				dutycycle = (u32) ((dsum[det] + (n[det] / 2)) / n[det]);
+				err = sweep_ppm(freq, pwm_f);
+				max_err[det] = MAX(max_err[det], (err < 0) ? -err : err);
+
+				xil_printf(",%d", n[det]);
+				sweep_print_freq(freq);
+				sweep_print_freq(fmin[det]);
+				sweep_print_freq(fmax[det]);
+				xil_printf(",%d,%d,%d", err, worst[det], dutycycle);
+
+				if (det == CALIB_DET_HW) {
+					update_lcd(freq, dutycycle, 2);
+				}
+			}
+
+			xil_printf("\n");
+		}
+	}
+
+	xil_printf("SWP: %d points, %d not generated, %d readings timed out, worst error of the mean hw %d ppm, "
+		"sw %d ppm, %d msec%s\n", points, failed, missing, max_err[0], max_err[1],
+		(int) (timestamp - start), stopped ? " (stopped)" : "");
+
+	// correct the detectors from now on
+
+	CALIB_Derive();
+	CALIB_Report();
+
+	return !stopped;
+}
+
+/****************************************************************************/
+
+/* sweep_wait - waits for new detector samples
+
+waits until the detectors in want (bit 0 = HWDET, bit 1 = SWDET) have a sample newer than the
+ones counted in hw_seen and sw_seen, or for SWEEP_TIMEOUT_MSEC.  Does the FIT work while it
+waits.  Updates hw_seen and sw_seen
+
+returns the detectors in want with a new sample
+
+*/
+
+unsigned int sweep_wait(unsigned int want, unsigned int *hw_seen, unsigned int *sw_seen) {
+
+	unsigned long	start = timestamp;
+	unsigned int	fresh = 0;
+
+	while ((fresh & want) != want) {
+
+		if (hw_samples != *hw_seen) {
+			*hw_seen = hw_samples;
+			fresh |= 0x01;
+		}
+
+		if (sw_samples != *sw_seen) {
+			*sw_seen = sw_samples;
+			fresh |= 0x02;
+		}
+
+		if ((timestamp - start) >= SWEEP_TIMEOUT_MSEC) {
+			break;
+		}
+
+		delay_msecs(1);
+	}
+
+	return fresh & want;
+}
+
+/****************************************************************************/
+
+/* sweep_ppm - error of a frequency in parts per million of a reference
+
+freq is in mHz and ref in Hz.  the result is limited to +/- 999999999 ppm
+
+*/
+
+int sweep_ppm(u64 freq, u32 ref) {
+
+	s64 ppm;
+
+	if (ref == 0) {
+		return 0;
+	}
+
+	ppm = (((s64) freq - ((s64) ref * MEAS_FREQ_SCALE)) * (1000000 / MEAS_FREQ_SCALE)) / ref;
+
+	return (int) MAX(-999999999, MIN(ppm, 999999999));
+}
+
+/****************************************************************************/
+
+/* sweep_print_freq - prints a frequency column of the sweep table
+
+prints ",<Hz>.<mHz>" for a frequency in mHz
+
+*/
+
+void sweep_print_freq(u64 freq) {
+
+	xil_printf(",%d.%03d", (u32) (freq / MEAS_FREQ_SCALE), (u32) (freq % MEAS_FREQ_SCALE));
+}
+
+/****************************************************************************/
+
+/* print_hwstats - prints the statistics of the hw_detect statistics unit
+
+takes a snapshot, which also starts a new interval, and prints the number of periods in the interval,
+the min/max/mean/standard deviation of the period and the high time in clocks and the nonzero bins of
+the period histogram as <deviation from the reference period in clocks>:<periods>.  The first and the
+last bin also count the periods outside the histogram
+
+*/
+
+void print_hwstats(void) {
+
+	static u32			bins[HWSTATS_MAX_BINS];
+
+	HWSTATS_Snapshot	snap;
+	HWSTATS_Moments		*mom;
+	u64					mean;
+	u32					std, i;
+	int					dev;
+
+	if (HWSTATS_TakeSnapshot(&HWStatsInst, &snap) != XST_SUCCESS) {
+		xil_printf("HWSTATS: no response\n");
+		return;
+	}
+
+	xil_printf("HWSTATS: snapshot %d, %d periods in %d clocks, reference %d clocks%s\n", snap.Seq,
+		snap.Periods, snap.Clocks, snap.Ref, snap.Overflow ? ", sum of squares overflow" : "");
+
+	for (i = 0; i < 2; i++) {
+		mom = (i == 0) ? &snap.Period : &snap.High;
+		mean = HWSTATS_MeanMilli(mom, snap.Periods);
+		std = HWSTATS_StdMilli(mom, snap.Periods);
+		xil_printf("HWSTATS: %s min %d max %d mean %d.%03d std %d.%03d\n", (i == 0) ? "period" : "high  ",
+			(snap.Periods != 0) ? mom->Min : 0, mom->Max, (u32) (mean / 1000), (u32) (mean % 1000),
+			std / 1000, std % 1000);
+	}
+
+	if (HWSTATS_ReadHist(&HWStatsInst, 0, snap.Bins, bins) != XST_SUCCESS) {
+		return;
+	}
+
+	xil_printf("HWSTATS: histogram");
+	for (i = 0; i < snap.Bins; i++) {
+		if (bins[i] != 0) {
+			dev = ((int) i - (int) (snap.Bins / 2)) << snap.Shift;
+			xil_printf(" %d:%d", dev, bins[i]);
+		}
+	}
+	xil_printf("\n");
+}
+
+/****************************************************************************/
+
+/* bench_calc - times the frequency & duty cycle calculations
+
+calls the calculations of meas.c and the former calc_freq() and calc_duty() with the hw_detect counts of
+every PWM_FREQ_* frequency at 1%, 50% and 99% duty cycle (with the accumulation exponent that makes
+about 2^20 clocks, as hw_detect would) and with the largest counts.  Each call is timed BENCH_REPEAT
+times with the profiler clock and the fastest is taken, less the time of an empty measurement.  Prints
+the mean clocks per call of each function and the number of results of meas.c that differ from the
+exact rounded values (worked out with 64-bit divisions)
+
+*/
+
+#if PROFILE_ENABLE
+void bench_calc(void) {
+
+	static const u32	duties[] = { 1, 50, 99 };
+
+	volatile u64	sink;								// keeps the calls from being optimized away
+	u32				clk[4] = { 0, 0, 0, 0 };			// clocks of calc_freq, MEAS_FreqMilliHz, calc_duty, MEAS_DutyHundredths
+	u32				t, dt, best, empty = ~0U;
+	u32				high, low, k, period, fn, i, j, rep;
+	u32				inputs = 0, mismatches = 0;
+	u64				sum, exact;
+
+	// the time of an empty measurement
+
+	for (rep = 0; rep < BENCH_REPEAT; rep++) {
+		t = PROFILE_Now();
+		dt = PROFILE_Now() - t;
+		empty = MIN(empty, dt);
+	}
+
+	for (i = 0; i <= sizeof(pwm_freqs) / sizeof(pwm_freqs[0]); i++) {
+
+		for (j = 0; j < sizeof(duties) / sizeof(duties[0]); j++) {
+
+			// the counts hw_detect gives for this frequency and duty cycle (the last
+			// input is the largest counts)
+
+			if (i < sizeof(pwm_freqs) / sizeof(pwm_freqs[0])) {
+				period = CPU_CLOCK_FREQ_HZ / pwm_freqs[i];
+				k = 0;
+				while ((k < MEAS_MAX_K) && ((period << (k + 1)) <= (1 << 20))) {
+					k++;
+				}
+				high = ((period * duties[j]) / 100) << k;
+				low = (period << k) - high;
+				high = (high > (1U << k)) ? high - (1U << k) : 0;
+				low = (low > (1U << k)) ? low - (1U << k) : 0;
+			}
+
+			else if (j == 0) {
+				high = 0xFFFFFFFF;
+				low = 0xFFFFFFFF;
+				k = MEAS_MAX_K;
+			}
+
+			else {
+				continue;
+			}
+
+			inputs++;
+
+			for (fn = 0; fn < 4; fn++) {
+
+				best = ~0U;
+
+				for (rep = 0; rep < BENCH_REPEAT; rep++) {
+
+					t = PROFILE_Now();
+
+					switch (fn) {
+						case 0:	sink = calc_freq(high, low, k, true);						break;
+						case 1:	sink = MEAS_FreqMilliHz(CPU_CLOCK_FREQ_HZ, high, low, k);	break;
+						case 2:	sink = calc_duty(high, low, k);								break;
+						default: sink = MEAS_DutyHundredths(high, low, k);					break;
+					}
+
+					dt = PROFILE_Now() - t;
+					best = MIN(best, dt);
+				}
+
+				clk[fn] += (best > empty) ? best - empty : 0;
+			}
+
+			// check the rounding: (2 * num + den) / (2 * den) is num / den rounded, halves up
+
+			sum = (u64) high + low + (2ULL << k);
+			exact = (((((u64) CPU_CLOCK_FREQ_HZ * MEAS_FREQ_SCALE) << k) * 2) + sum) / (sum * 2);
+			mismatches += (MEAS_FreqMilliHz(CPU_CLOCK_FREQ_HZ, high, low, k) != exact) ? 1 : 0;
+			exact = ((((u64) high + (1ULL << k)) * MEAS_DUTY_SCALE * 2) + sum) / (sum * 2);
+			mismatches += (MEAS_DutyHundredths(high, low, k) != exact) ? 1 : 0;
+		}
+	}
+
+	(void) sink;
+
+	xil_printf("BENCH: %d inputs, clocks/call: calc_freq %d, MEAS_FreqMilliHz %d, calc_duty %d, "
+		"MEAS_DutyHundredths %d, %d results not exactly rounded\n", inputs,
+		(clk[0] + (inputs / 2)) / inputs, (clk[1] + (inputs / 2)) / inputs,
+		(clk[2] + (inputs / 2)) / inputs, (clk[3] + (inputs / 2)) / inputs, mismatches);
+}
+#endif
+
+/**************************** INTERRUPT HANDLERS ******************************/
+
+/* FIT_Handler - Fixed interval timer interrupt handler 
+  
+updates the global "timestamp" every millisecond.  "timestamp" is used for the delay_msecs() function
+and as a time stamp for data collection and reporting.  Toggles the FIT clock which can be used as a visual
+indication that the interrupt handler is being called.  Sets main_wake every millisecond to wake the main loop.
+
+Everything else is left to FIT_BottomHalf(): the handler only samples the PWM signal (fed back on GPIO 0)
+into fit_ring, one sample per interrupt.  If the ring is full the sample is dropped and counted.
+
+*/
+
+void FIT_Handler(void) {
+		
+	static	unsigned int	ts_interval = 0;			// interval counter for incrementing timestamp
+
+	unsigned int			head;						// fit_ring index of this sample
+
+#if PROFILE_ENABLE && PROF_FIT_EVERY
+	static	unsigned int	prof_count = 0;				// interrupts since the last timed one
+	bool					prof_timed;					// this interrupt is timed
+	u32						prof_start = 0;				// profiler clock at the start
+
+	prof_timed = (++prof_count >= PROF_FIT_EVERY);
+
+	if (prof_timed) {
+		prof_count = 0;
+		prof_start = PROFILE_Now();
+	}
+#endif
+
+	// toggle FIT clock.  The other bits of the port are set by FIT_BottomHalf()
+
+	clkfit ^= 0x01;
+	XGpio_DiscreteWrite(&GPIOInst0, GPIO_0_OUTPUT_CHANNEL, gpio_out_bits | clkfit);
+
+	// update timestamp	
+
+	ts_interval++;	
+
+	if (ts_interval > FIT_COUNT_1MSEC) {
+		timestamp++;
+		ts_interval = 1;
+		main_wake = true;
+	}
+
+	// sample the PWM signal for FIT_BottomHalf()
+
+	head = fit_ring_head;
+
+	if ((head - fit_ring_tail) < FIT_RING_SIZE) {
+		fit_ring[head & (FIT_RING_SIZE - 1)] = XGpio_DiscreteRead(&GPIOInst0, GPIO_0_INPUT_CHANNEL);
+		fit_ring_head = head + 1;
+	}
+
+	else {
+		fit_ring_drops++;
+	}
+
+#if PROFILE_ENABLE && PROF_FIT_EVERY
+	if (prof_timed) {
+		PROFILE_Record(PROF_FIT_HANDLER, PROFILE_Now() - prof_start);
+	}
+#endif
+}
+
+/****************************************************************************/
+
+/* FIT_BottomHalf - deferred work of the FIT interrupt handler
+
+Called from the main loop and from delay_msecs().  Works through the PWM samples FIT_Handler() left in
+fit_ring: makes RGB1 a PWM duty cycle indicator and (without SW_DETECT_CAPTURE) measures the high & low
+intervals in FIT ticks.  Sends the next byte of the LCD queue if the LCD is ready.  Once a millisecond it also refreshes the HWDET counts and the gated count,
+and takes the SWDET counts and arms the capture interrupt again.
+
+ECE 544 students - When you implement your software solution for pulse width detection in
+Project 1 this could be a reasonable place to do that processing.
+
+*/
+
+void FIT_BottomHalf(void) {
+
+#if !SW_DETECT_CAPTURE
+	static 	unsigned int	count = 0;					// used for sw counting high & low intervals
+	static 	bool		 	prev_pwm = 0; 				// boolean to store previous PWM value (high / low)
+	static	bool			synced = false;				// count started at a transition
+	static	unsigned int	drops = 0;					// fit_ring_drops already accounted for
+#endif
+	static	bool			led_on = false;				// RGB1 is on
+	static	unsigned long	last_msec = 0;				// timestamp of the last millisecond work
+
+	static	unsigned int	hw_seq = 0;					// sequence number of the last HWDET pair
+	static	unsigned long	hw_seq_time = 0;			// timestamp of the last new HWDET pair
+
+	bool		 			curr_pwm = led_on; 			// boolean to store current PWM value (high / low)
+	unsigned int			tail;						// fit_ring index of the next sample
+	HWDET_Sample			sample;						// HWDET high & low counts
+	HWDET_Gate				gate;						// HWDET gated edge count
+	int						status;						// status from HWDET_Read/HWDET_ReadGate
+
+	// nothing to do but the LCD: the polling main loop calls us all the time, so only
+	// the calls with samples or the millisecond work are timed
+
+	if ((fit_ring_tail == fit_ring_head) && (timestamp == last_msec)) {
+		LCDFB_Drain();
+		return;
+	}
+
+	PROFILE_BEGIN(PROF_FIT_BOTTOM_HALF);
+
+	// work through the PWM samples
+
+	for (tail = fit_ring_tail; tail != fit_ring_head; tail++) {
+
+		gpio_in = fit_ring[tail & (FIT_RING_SIZE - 1)];
+		curr_pwm = (gpio_in & PWM_SIGNAL_MSK);
+
+#if !SW_DETECT_CAPTURE
+		// update the SWDET high & low counts through state machine
+		// this detect low-to-high and high-to-low transitions
+		// then places the count into one of two registers
+
+		if (curr_pwm != prev_pwm) {
+
+			if (synced) {
+
+				if (curr_pwm) {
+					sw_low_count = count;
+					sw_samples++;
+				}
+
+				else {
+					sw_high_count = count;
+				}
+			}
+
+			prev_pwm = curr_pwm;
+			synced = true;
+			count = 0;
+		}
+
+		else {
+			count += 1;
+		}
+#endif
+	}
+
+	fit_ring_tail = tail;
+
+#if !SW_DETECT_CAPTURE
+	// samples dropped after these break the interval being counted
+
+	if (fit_ring_drops != drops) {
+		drops = fit_ring_drops;
+		synced = false;
+	}
+#endif
+
+	// use tri-color LED RGB1 as an indicator of PWM duty
+	// this will breakdown at higher frequencies (e.g. higher than 10kHz)
+
+	if (curr_pwm != led_on) {
+		NX4IO_RGBLED_setChnlEn(RGB1, curr_pwm, curr_pwm, curr_pwm);
+		led_on = curr_pwm;
+	}
+
+	// send the next queued byte to the LCD if it is ready
+
+	LCDFB_Drain();
+
+	if (timestamp == last_msec) {
+		PROFILE_END(PROF_FIT_BOTTOM_HALF);
+		return;
+	}
+
+	last_msec = timestamp;
+
+	// update HWDET high & low counts by reading GPIO
+	// HWDET_Read only returns a pair from the same PWM period(s).  Every new pair
+	// chooses how many periods hw_detect adds up for the next ones; if no pair
+	// arrives for a while (the frequency dropped a lot) go back to single periods.
+	// Interrupts are disabled so no interrupt handler delays the second read
+
+	microblaze_disable_interrupts();
+	status = HWDET_Read(&GPIOInst1, &sample);
+	microblaze_enable_interrupts();
+
+	if (status == XST_SUCCESS) {
+		hw_high_count = sample.High;
+		hw_low_count  = sample.Low;
+		hw_accum_k = sample.K;
+
+		if (sample.Seq != hw_seq) {
+			hw_seq = sample.Seq;
+			hw_seq_time = timestamp;
+			hw_samples++;
+			hwdet_k = HWDET_SelectAccum(&sample);
+		}
+	}
+
+	if ((timestamp - hw_seq_time) > HWDET_ACCUM_TIMEOUT_MS) {
+		hwdet_k = 0;
+	}
+
+	// switch the HWDET outputs to the gated edge counter and read it, then give
+	// hw_detect its accumulation exponent.  FIT_Handler() writes the same port
+
+	microblaze_disable_interrupts();
+
+	gpio_out_bits = (hwdet_k << GPIO_0_ACCUM_SHIFT) | GPIO_0_GATE_SEL;
+	XGpio_DiscreteWrite(&GPIOInst0, GPIO_0_OUTPUT_CHANNEL, gpio_out_bits | clkfit);
+
+	if (HWDET_ReadGate(&GPIOInst1, &gate) == XST_SUCCESS) {
+		hw_gate_edges = gate.Edges;
+		hw_gate_clocks = gate.Clocks;
+	}
+
+	gpio_out_bits = (hwdet_k << GPIO_0_ACCUM_SHIFT);
+	XGpio_DiscreteWrite(&GPIOInst0, GPIO_0_OUTPUT_CHANNEL, gpio_out_bits | clkfit);
+
+	microblaze_enable_interrupts();
+
+#if SW_DETECT_CAPTURE
+	// take the SWDET high & low counts if both have been measured and arm the capture
+	// interrupt again.  The capture interrupt handler measures the intervals from the
+	// edge timestamps and takes a limited number of interrupts per arm, so the
+	// interrupt load does not grow with the PWM frequency
+
+	{
+		u32		high, low;
+
+		microblaze_disable_interrupts();
+
+		if (SWDET_GetCounts(&SWDetInst, &high, &low) == XST_SUCCESS) {
+			sw_high_count = high;
+			sw_low_count = low;
+			sw_samples++;
+		}
+
+		SWDET_Arm(&SWDetInst);
+		microblaze_enable_interrupts();
+	}
+#endif
+
+	PROFILE_END(PROF_FIT_BOTTOM_HALF);
+}
+
+/****************************************************************************/
+
+/* 	calc_freq - calculates frequency given counts for high & low intervals
+ 	
+ 	replaced by MEAS_FreqMilliHz() (meas.c) and kept as the reference of bench_calc()
+ 	depending on sw[3] state, will use either CPU clock frequency or the software detect
+ 	clock frequency (capture timer clock or FIT Timer frequency)
+ 	the counts are sums over 2^k periods (k = 0 for a single period), so the result is
+ 	(clock * 2^k) / (clocks in 2^k periods), rounded to the nearest Hz
+ 	uses integer math only
+*/
+
+unsigned int calc_freq(unsigned int high, unsigned int low, unsigned int k, bool hw_switch) {
+
+	u64 sum;
+	u64 clk;
+	unsigned int frq;
+
+	sum = (u64) high + low + (2ULL << k);			// each period counts (interval - 1) twice
+	clk = hw_switch ? CPU_CLOCK_FREQ_HZ : SWDET_CLOCK_FREQ_HZ;
+	frq = (unsigned int) (((clk << k) + (sum / 2)) / sum);
+
+	return frq;
+};
+
+/****************************************************************************/
+
+/* 	calc_duty - calculates duty cycle given counts for high & low intervals
+ 
+ 	replaced by MEAS_DutyHundredths() (meas.c) and kept as the reference of bench_calc()
+ 	the counts are sums over 2^k periods (k = 0 for a single period)
+  	uses integer math only, rounded to the nearest percent
+*/
+
+unsigned int calc_duty(unsigned int high, unsigned int low, unsigned int k) {
+
+	u64 sum;
+	unsigned int duty;
+
+	sum = (u64) high + low + (2ULL << k);
+	duty = (unsigned int) (((100 * ((u64) high + (1ULL << k))) + (sum / 2)) / sum);
+
+	return duty;
+};
+
+/****************************************************************************/
+
+/* 	calc_error_ppm - bounds the relative error of a frequency measurement
+
+ 	a frequency measured as "counts" of something that can be off by one (clocks in
+ 	the period counts, edges in the gated count) is within 1 / (counts - 1) of the
+ 	real one.  returns that bound in parts per million, rounded up (1000000 if there
+ 	are too few counts for a bound)
+*/
+
+unsigned int calc_error_ppm(unsigned int counts) {
+
+	if (counts < 2) {
+		return 1000000;
+	}
+
+	return (1000000 + (counts - 2)) / (counts - 1);
+};
@@ -0,0 +1,57 @@
+/**
+*
+* @file testpwm.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the function prototypes of testpwm.c that are used outside of it:
+* the host simulation harness (hostsim_main.c) calls the interrupt handlers, the display
+* code and the former frequency and duty cycle calculations directly, and the hw_detect
+* co-simulation (hardware/cosim) checks the calculations against its golden model.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	10/16/26	First release
+* </pre>
+*
+******************************************************************************/
+
+#ifndef TESTPWM_H		/* prevent circular inclusions */
+#define TESTPWM_H		/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include <stdbool.h>
+#include "xil_types.h"
+
+/************************** Constant Definitions *****************************/
+
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+int				do_init(void);															// initialize system
+void			update_lcd(u64 freq, u32 dutycycle, u32 linenum);						// update LCD display
+void			FIT_Handler(void);														// fixed interval timer interrupt handler
+void			FIT_BottomHalf(void);													// deferred work of the FIT interrupt handler
+unsigned int 	calc_freq(unsigned int high, unsigned int low, unsigned int k, bool hw_switch);	// former frequency calculation (bench_calc())
+unsigned int	calc_duty(unsigned int high, unsigned int low, unsigned int k);					// former duty cycle calculation (bench_calc())
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */